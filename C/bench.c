@@ -0,0 +1,384 @@
+#include <stdio.h>
+#include <time.h>
+#include "runrecorder.h"
+
+// Paths to the SQLite databases used by the benchmarks, they are deleted
+// at the beginning and the end of the benchmarks
+#define PATH_DB "./bench.db"
+#define PATH_DB_WRITE "./benchWrite.db"
+
+// Numbers of metrics per project used by the benchmark
+#define NB_NB_METRIC 3
+static long const nbMetrics[NB_NB_METRIC] = {1, 10, 50};
+
+// Numbers of measures per project used by the benchmark
+#define NB_NB_MEASURE 3
+static long const nbMeasures[NB_NB_MEASURE] = {1000, 10000, 100000};
+
+// Number of measures added per batch when filling the database
+#define SIZE_BATCH 1000
+
+// Number of measures added one at a time by the writing benchmark
+#define NB_MEASURE_WRITE 1000
+
+// Get the current time in seconds
+// Output:
+//   Return the time
+static double GetTime(
+  void) {
+
+  struct timespec ts;
+  timespec_get(
+    &ts,
+    TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+
+}
+
+// Add measures to a project until it reaches a given number of measures
+// Inputs:
+//       project: the handle on the project
+//      nbMetric: the number of metrics of the project
+//   fromMeasure: the current number of measures in the project
+//     toMeasure: the requested number of measures in the project
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+static void FillProject(
+  struct RunRecorderProject* const project,
+                        long const nbMetric,
+                        long const fromMeasure,
+                        long const toMeasure) {
+
+  // Allocate the batch of measures
+  struct RunRecorderMeasure* batch[SIZE_BATCH];
+  for (
+    long iMeasure = 0;
+    iMeasure < SIZE_BATCH;
+    ++iMeasure) batch[iMeasure] = NULL;
+
+  Try {
+
+    // Create the measures, the same measures are reused for all the
+    // batches
+    char label[32];
+    for (
+      long iMeasure = 0;
+      iMeasure < SIZE_BATCH;
+      ++iMeasure) {
+
+      batch[iMeasure] = RunRecorderMeasureCreate();
+      for (
+        long iMetric = 0;
+        iMetric < nbMetric;
+        ++iMetric) {
+
+        sprintf(
+          label,
+          "m%ld",
+          iMetric);
+        RunRecorderMeasureAddValue(
+          batch[iMeasure],
+          label,
+          (double)(iMeasure * nbMetric + iMetric));
+
+      }
+
+    }
+
+    // Add the batches of measures
+    for (
+      long iMeasure = fromMeasure;
+      iMeasure < toMeasure;
+      iMeasure += SIZE_BATCH) {
+
+      long nbMeasure = toMeasure - iMeasure;
+      if (nbMeasure > SIZE_BATCH) nbMeasure = SIZE_BATCH;
+      RunRecorderProjectAddMeasures(
+        project,
+        batch,
+        nbMeasure);
+
+    }
+
+  } CatchDefault {
+
+    for (
+      long iMeasure = 0;
+      iMeasure < SIZE_BATCH;
+      ++iMeasure) RunRecorderMeasureFree(batch + iMeasure);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  for (
+    long iMeasure = 0;
+    iMeasure < SIZE_BATCH;
+    ++iMeasure) RunRecorderMeasureFree(batch + iMeasure);
+
+}
+
+// Benchmark the reading of the measures of a project
+// Input:
+//         recorder: the struct RunRecorder
+//         nbMetric: the number of metrics of the project
+//   isMaterialized: flag to use a materialized table for the project
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SQLRequestFailed
+//   RunRecorderExc_MaterializeFailed
+static void BenchRead(
+  struct RunRecorder* const recorder,
+                 long const nbMetric,
+                 bool const isMaterialized) {
+
+  // Create the project and its metrics, the values are doubles
+  char label[32];
+  sprintf(
+    label,
+    "Bench%s%ld",
+    (isMaterialized ? "Mat" : ""),
+    nbMetric);
+  RunRecorderAddProject(
+    recorder,
+    label);
+  for (
+    long iMetric = 0;
+    iMetric < nbMetric;
+    ++iMetric) {
+
+    char metric[32];
+    sprintf(
+      metric,
+      "m%ld",
+      iMetric);
+    RunRecorderAddTypedMetric(
+      recorder,
+      label,
+      metric,
+      "0",
+      RunRecorderMetricType_double);
+
+  }
+
+  // Enable the materialized table if requested
+  if (isMaterialized == true)
+    RunRecorderSetMaterialized(
+      recorder,
+      label,
+      isMaterialized);
+
+  // Open a handle on the project
+  struct RunRecorderProject* project =
+    RunRecorderOpenProject(
+      recorder,
+      label);
+
+  Try {
+
+    // Loop on the numbers of measures
+    long nbMeasure = 0;
+    for (
+      long iNbMeasure = 0;
+      iNbMeasure < NB_NB_MEASURE;
+      ++iNbMeasure) {
+
+      // Add the measures
+      FillProject(
+        project,
+        nbMetric,
+        nbMeasure,
+        nbMeasures[iNbMeasure]);
+      nbMeasure = nbMeasures[iNbMeasure];
+
+      // Read all the measures and measure the time it takes
+      double start = GetTime();
+      struct RunRecorderMeasures* measures =
+        RunRecorderProjectGetMeasures(project);
+      double end = GetTime();
+      RunRecorderMeasuresFree(&measures);
+
+      // Read all the measures by column and measure the time it takes
+      double startColumns = GetTime();
+      struct RunRecorderColumns* columns =
+        RunRecorderGetColumns(
+          recorder,
+          label);
+      double endColumns = GetTime();
+      RunRecorderColumnsFree(&columns);
+
+      // Display the result
+      printf(
+        "%8s %8ld metrics %8ld measures %10.3fs %10.3fs\n",
+        (isMaterialized ? "mat." : "view"),
+        nbMetric,
+        nbMeasure,
+        end - start,
+        endColumns - startColumns);
+      fflush(stdout);
+
+    }
+
+  } CatchDefault {
+
+    RunRecorderProjectFree(&project);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  RunRecorderProjectFree(&project);
+
+}
+
+// Benchmark the adding of measures one at a time, each in its own
+// transaction, with given options of the database
+// Inputs:
+//   options: the options of the database
+//     label: the label of the options in the results
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_OpenDbFailed
+static void BenchWrite(
+  struct RunRecorderOptions const* const options,
+                       char const* const label) {
+
+  // Create the database with the options, and the project
+  remove(PATH_DB_WRITE);
+  struct RunRecorder* recorder =
+    RunRecorderAllocWithOptions(
+      PATH_DB_WRITE,
+      options);
+  struct RunRecorderMeasure* measure = NULL;
+  Try {
+
+    RunRecorderInit(recorder);
+    RunRecorderAddProject(
+      recorder,
+      "BenchWrite");
+    RunRecorderAddTypedMetric(
+      recorder,
+      "BenchWrite",
+      "m",
+      "0",
+      RunRecorderMetricType_double);
+
+    // Add the measures and measure the time it takes
+    measure = RunRecorderMeasureCreate();
+    double start = GetTime();
+    for (
+      long iMeasure = 0;
+      iMeasure < NB_MEASURE_WRITE;
+      ++iMeasure) {
+
+      RunRecorderMeasureAddValue(
+        measure,
+        "m",
+        (double)iMeasure);
+      RunRecorderAddMeasure(
+        recorder,
+        "BenchWrite",
+        measure);
+
+    }
+
+    double end = GetTime();
+
+    // Display the result
+    printf(
+      "%16s %8d measures %10.3fms per measure\n",
+      label,
+      NB_MEASURE_WRITE,
+      (end - start) * 1e3 / NB_MEASURE_WRITE);
+    fflush(stdout);
+
+  } CatchDefault {
+
+    RunRecorderMeasureFree(&measure);
+    RunRecorderFree(&recorder);
+    remove(PATH_DB_WRITE);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  RunRecorderMeasureFree(&measure);
+  RunRecorderFree(&recorder);
+  remove(PATH_DB_WRITE);
+
+}
+
+// Main function
+int main(
+     int argc,
+  char** argv) {
+
+  // Unused parameters
+  (void)argc; (void)argv;
+
+  // Start from an empty database
+  remove(PATH_DB);
+
+  // Create the RunRecorder instance
+  struct RunRecorder* recorder = NULL;
+  Try {
+
+    recorder = RunRecorderAlloc(PATH_DB);
+    RunRecorderInit(recorder);
+
+    // Loop on the numbers of metrics and run the reading benchmark,
+    // through the view and through the materialized table
+    printf("Reading measures (by row, by column):\n");
+    for (
+      int isMaterialized = 0;
+      isMaterialized <= 1;
+      ++isMaterialized) {
+
+      for (
+        long iNbMetric = 0;
+        iNbMetric < NB_NB_METRIC;
+        ++iNbMetric)
+        BenchRead(
+          recorder,
+          nbMetrics[iNbMetric],
+          isMaterialized);
+
+    }
+
+    // Run the writing benchmark with the default options, and with the
+    // WAL journal mode and the normal synchronous level
+    printf("Adding measures one at a time:\n");
+    struct RunRecorderOptions options = RunRecorderOptionsCreate();
+    BenchWrite(
+      &options,
+      "default");
+    options.journalMode = RunRecorderJournalMode_wal;
+    options.synchronous = RunRecorderSynchronous_normal;
+    BenchWrite(
+      &options,
+      "WAL, normal");
+
+  } CatchDefault {
+
+    fprintf(
+      stderr,
+      "Caught exception %s.\n",
+      TryCatchExcToStr(TryCatchGetLastExc()));
+    if (recorder != NULL && recorder->errMsg != NULL)
+      fprintf(
+        stderr,
+        "%s\n",
+        recorder->errMsg);
+    RunRecorderFree(&recorder);
+    remove(PATH_DB);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Free memory
+  RunRecorderFree(&recorder);
+  remove(PATH_DB);
+
+  return EXIT_SUCCESS;
+
+}
@@ -60,6 +60,7 @@ enum CLIStatus {
   CLIStatus_listMeasure,
   CLIStatus_deleteMeasure,
   CLIStatus_deleteProject,
+  CLIStatus_setRetention,
   CLIStatus_quit,
   CLIStatus_lastID,
 
@@ -192,6 +193,12 @@ void PrintMenuDeleteMeasure(
 void PrintMenuDeleteProject(
   struct CLI* const that);
 
+// Print the menu to set the retention policy of a project
+// Input:
+//   that: the struct CLI
+void PrintMenuSetRetention(
+  struct CLI* const that);
+
 // Process the user input in the main menu
 // Input:
 //    that: the struct CLI
@@ -240,6 +247,13 @@ void ProcessInputListMeasure(
   struct CLI* const that,
   char const* const input);
 
+// Print all the measures of the current project in CSV format, reading
+// them one at a time to support projects of any size
+// Input:
+//   that: the struct CLI
+void PrintAllMeasures(
+  struct CLI* const that);
+
 // Process the user input in the menu to delete a measure
 // Input:
 //    that: the struct CLI
@@ -256,6 +270,21 @@ void ProcessInputDeleteProject(
   struct CLI* const that,
   char const* const input);
 
+// Process the user input in the menu to set the retention policy of a
+// project
+// Input:
+//    that: the struct CLI
+//   input: the user input
+void ProcessInputSetRetention(
+  struct CLI* const that,
+  char const* const input);
+
+// Apply the retention policies of all the projects
+// Input:
+//    that: the struct CLI
+void ApplyRetention(
+  struct CLI* const that);
+
 // Print the list of projects
 // Input:
 //    that: the struct CLI
@@ -362,6 +391,7 @@ struct CLI* CLICreate(
   cli->printMenu[CLIStatus_listMeasure] = PrintMenuListMeasure;
   cli->printMenu[CLIStatus_deleteMeasure] = PrintMenuDeleteMeasure;
   cli->printMenu[CLIStatus_deleteProject] = PrintMenuDeleteProject;
+  cli->printMenu[CLIStatus_setRetention] = PrintMenuSetRetention;
   cli->printMenu[CLIStatus_quit] = NULL;
   cli->processInput[CLIStatus_main] = ProcessInputMain;
   cli->processInput[CLIStatus_addProject] = ProcessInputAddProject;
@@ -371,6 +401,7 @@ struct CLI* CLICreate(
   cli->processInput[CLIStatus_listMeasure] = ProcessInputListMeasure;
   cli->processInput[CLIStatus_deleteMeasure] = ProcessInputDeleteMeasure;
   cli->processInput[CLIStatus_deleteProject] = ProcessInputDeleteProject;
+  cli->processInput[CLIStatus_setRetention] = ProcessInputSetRetention;
   cli->processInput[CLIStatus_quit] = NULL;
   cli->projects = NULL;
   cli->curProject = NULL;
@@ -565,7 +596,9 @@ void PrintMenuMain(
       "6 - Add one measure to %s\n"
       "7 - List measures in %s\n"
       "8 - Delete a measure in %s\n"
-      "9 - Delete the project %s\n",
+      "9 - Delete the project %s\n"
+      "r - Set the retention policy of %s\n",
+      that->curProject,
       that->curProject,
       that->curProject,
       that->curProject,
@@ -575,7 +608,9 @@ void PrintMenuMain(
 
   }
 
-  printf("q - Quit\n");
+  printf(
+    "a - Apply the retention policies of all the projects\n"
+    "q - Quit\n");
 
 }
 
@@ -723,6 +758,22 @@ void PrintMenuDeleteProject(
 
 }
 
+// Print the menu to set the retention policy of a project
+// Input:
+//   that: the struct CLI
+void PrintMenuSetRetention(
+  struct CLI* const that) {
+
+  // Print the menu
+  printf(
+    "\n--- Set the retention policy ---\n"
+    "Input the maximum age of the measures of %s in seconds and their "
+    "maximum number, separated by a space (0 for no limit), or leave blank "
+    "to cancel\n",
+    that->curProject);
+
+}
+
 // Process the user input in the main menu
 // Input:
 //    that: the struct CLI
@@ -735,7 +786,7 @@ void ProcessInputMain(
   if (input != NULL) {
 
     // Variable to memorise the acceptable commands
-    #define NbCmdMain 10
+    #define NbCmdMain 12
     char* cmds[NbCmdMain] = {
 
       "1",
@@ -747,7 +798,9 @@ void ProcessInputMain(
       "7",
       "8",
       "9",
-      "q"
+      "q",
+      "a",
+      "r"
 
     };
 
@@ -815,6 +868,15 @@ void ProcessInputMain(
             that->status = CLIStatus_quit;
             break;
 
+          case 10:
+            ApplyRetention(that);
+            break;
+
+          case 11:
+            if (that->curProject != NULL)
+              that->status = CLIStatus_setRetention;
+            break;
+
           default:
             break;
 
@@ -1134,6 +1196,68 @@ void ProcessInputAddMeasure(
 
 }
 
+// Print all the measures of the current project in CSV format, reading
+// them one at a time to support projects of any size
+// Input:
+//   that: the struct CLI
+void PrintAllMeasures(
+  struct CLI* const that) {
+
+  // Variable to memorise the cursor on the measures
+  struct RunRecorderMeasuresCursor* cursor = NULL;
+
+  Try {
+
+    // Open the cursor on the measures
+    cursor =
+      RunRecorderMeasuresCursorOpen(
+        that->runRecorder,
+        that->curProject);
+
+    // If there are measures
+    bool hasMeasure = RunRecorderMeasuresCursorNext(cursor);
+    if (hasMeasure == true) {
+
+      // Print the metrics label
+      ForZeroTo(iMetric, cursor->nbMetric)
+        printf(
+          "%s%c",
+          cursor->metrics[iMetric],
+          (iMetric == cursor->nbMetric - 1 ? '\n' : '&'));
+
+      // Loop on the measures and print their values
+      while (hasMeasure == true) {
+
+        ForZeroTo(iMetric, cursor->nbMetric)
+          printf(
+            "%s%c",
+            cursor->values[iMetric],
+            (iMetric == cursor->nbMetric - 1 ? '\n' : '&'));
+        hasMeasure = RunRecorderMeasuresCursorNext(cursor);
+
+      }
+
+    // Else, there are no measures
+    } else {
+
+      printf(
+        "No measures in %s\n",
+        that->curProject);
+
+    }
+
+    // Free memory
+    RunRecorderMeasuresCursorClose(&cursor);
+
+  } CatchDefault {
+
+    PrintCaughtException(that);
+    RunRecorderMeasuresCursorClose(&cursor);
+
+  } EndCatch;
+
+}
+
 // Process the user input in the menu to list measures
 // Input:
 //    that: the struct CLI
@@ -1169,6 +1293,11 @@ void ProcessInputListMeasure(
 
       printf("Invalid number of measure\n");
 
+    // Else, if all the measures are requested
+    } else if (nbMeasure == 0) {
+
+      PrintAllMeasures(that);
+
     // Else, we have the correct number of requested measures
     } else {
 
@@ -1313,6 +1442,84 @@ void ProcessInputDeleteProject(
 
 }
 
+// Process the user input in the menu to set the retention policy of a
+// project
+// Input:
+//    that: the struct CLI
+//   input: the user input
+void ProcessInputSetRetention(
+  struct CLI* const that,
+  char const* const input) {
+
+  // If there was a user input
+  if (input != NULL && *input != '\0') {
+
+    // Convert the user input to the maximum age and number of measures
+    long maxAge = 0;
+    long maxNbMeasure = 0;
+    int retScan =
+      sscanf(
+        input,
+        "%ld %ld",
+        &maxAge,
+        &maxNbMeasure);
+
+    // If the conversion fails
+    if (retScan != 2) {
+
+      printf("Invalid retention policy\n");
+
+    // Else, the conversion succeeded
+    } else {
+
+      Try {
+
+        // Set the retention policy
+        RunRecorderSetRetention(
+          that->runRecorder,
+          that->curProject,
+          maxAge,
+          maxNbMeasure);
+        printf(
+          "Retention policy of %s set\n",
+          that->curProject);
+
+      } CatchDefault {
+
+        PrintCaughtException(that);
+
+      } EndCatch;
+
+    }
+
+  }
+
+  // Move back to main menu
+  that->status = CLIStatus_main;
+
+}
+
+// Apply the retention policies of all the projects
+// Input:
+//    that: the struct CLI
+void ApplyRetention(
+  struct CLI* const that) {
+
+  Try {
+
+    long nbDeleted = RunRecorderApplyRetention(that->runRecorder);
+    printf(
+      "Deleted %ld expired measure(s)\n",
+      nbDeleted);
+
+  } CatchDefault {
+
+    PrintCaughtException(that);
+
+  } EndCatch;
+
+}
+
 // Print the list of projects
 // Input:
 //    that: the struct CLI
@@ -32,6 +32,232 @@ void PrintCaughtException(
 
 }
 
+// Helper function to check a result of the example, exit if it's not
+// the expected one
+// Inputs:
+//       isOk: the result of the check
+//      check: string to identify the check
+//   recorder: the struct RunRecorder, freed if the check failed
+void CheckOrExit(
+                 bool const isOk,
+          char const* const check,
+  struct RunRecorder** const recorder) {
+
+  if (isOk == false) {
+
+    fprintf(
+      stderr,
+      "Check failed: %s\n",
+      check);
+    RunRecorderFree(recorder);
+    exit(EXIT_FAILURE);
+
+  }
+
+  printf(
+    "Check passed: %s\n",
+    check);
+
+}
+
+// Helper function to create an empty project for a check, the project
+// is removed first in case it remains from a previous run
+// Inputs:
+//   recorder: the struct RunRecorder
+//    project: the project's name
+void CreateCheckProject(
+  struct RunRecorder* const recorder,
+          char const* const project) {
+
+  struct RunRecorderRefVal* projects = RunRecorderGetProjects(recorder);
+  bool isUsed = false;
+  for (
+    long iProject = 0;
+    iProject < projects->nb;
+    ++iProject)
+    if (strcmp(projects->values[iProject], project) == 0) isUsed = true;
+  RunRecorderRefValFree(&projects);
+  if (isUsed == true)
+    RunRecorderFlushProject(
+      recorder,
+      project);
+  RunRecorderAddProject(
+    recorder,
+    project);
+
+}
+
+// Helper function to get the integer result of a SQL query on the local
+// database of a check
+// Inputs:
+//   recorder: the struct RunRecorder
+//        sql: the query, giving one integer
+// Output:
+//   Return the result of the query, or -1 if it failed
+long QueryLong(
+  struct RunRecorder const* const recorder,
+                char const* const sql) {
+
+  long res = -1;
+  sqlite3_stmt* stmt = NULL;
+  int retPrepare =
+    sqlite3_prepare_v2(
+      recorder->db,
+      sql,
+      -1,
+      &stmt,
+      NULL);
+  if (retPrepare == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW)
+    res = sqlite3_column_int64(
+      stmt,
+      0);
+  sqlite3_finalize(stmt);
+  return res;
+
+}
+
+// Helper function to create a database with the schema of the version
+// 01.00.00, holding the project "Old" with one measure of its metric
+// "Value" dated Mon Mar  8 15:45:00 2021 (local time), to check the
+// migration
+// Input:
+//   path: the path of the database, replaced if it exists
+// Output:
+//   Return true if the database could be created, else false
+bool CreateDbV1(
+  char const* const path) {
+
+  remove(path);
+  sqlite3* db = NULL;
+  int retOpen =
+    sqlite3_open(
+      path,
+      &db);
+  int retExec =
+    sqlite3_exec(
+      db,
+      "CREATE TABLE _Version (Ref INTEGER PRIMARY KEY, "
+      "Label TEXT NOT NULL);"
+      "CREATE TABLE _Project (Ref INTEGER PRIMARY KEY, "
+      "Label TEXT UNIQUE NOT NULL);"
+      "CREATE TABLE _Measure (Ref INTEGER PRIMARY KEY, "
+      "RefProject INTEGER NOT NULL, DateMeasure DATETIME NOT NULL);"
+      "CREATE TABLE _Value (Ref INTEGER PRIMARY KEY, "
+      "RefMeasure INTEGER NOT NULL, RefMetric INTEGER NOT NULL, "
+      "Value TEXT NOT NULL);"
+      "CREATE TABLE _Metric (Ref INTEGER PRIMARY KEY, "
+      "RefProject INTEGER NOT NULL, Label TEXT NOT NULL, "
+      "DefaultValue TEXT NOT NULL);"
+      "INSERT INTO _Version (Ref, Label) VALUES (NULL, '01.00.00');"
+      "INSERT INTO _Project (Ref, Label) VALUES (1, 'Old');"
+      "INSERT INTO _Metric (Ref, RefProject, Label, DefaultValue) "
+      "VALUES (1, 1, 'Value', '-');"
+      "INSERT INTO _Measure (Ref, RefProject, DateMeasure) "
+      "VALUES (1, 1, 'Mon Mar  8 15:45:00 2021');"
+      "INSERT INTO _Value (Ref, RefMeasure, RefMetric, Value) "
+      "VALUES (1, 1, 1, '12');",
+      NULL,
+      NULL,
+      NULL);
+  sqlite3_close(db);
+  return retOpen == SQLITE_OK && retExec == SQLITE_OK;
+
+}
+
+// Helper function to check the addition of a measure fails
+// Inputs:
+//   recorder: the struct RunRecorder
+//    project: the project's name
+//    measure: the measure
+// Output:
+//   Return true if the addition raised RunRecorderExc_AddMeasureFailed,
+//   else false
+bool IsAddMeasureFailed(
+         struct RunRecorder* const recorder,
+                 char const* const project,
+  struct RunRecorderMeasure* const measure) {
+
+  bool isFailed = false;
+  Try {
+
+    RunRecorderAddMeasure(
+      recorder,
+      project,
+      measure);
+
+  } CatchDefault {
+
+    isFailed = (TryCatchGetLastExc() == RunRecorderExc_AddMeasureFailed);
+
+  } EndCatch;
+  return isFailed;
+
+}
+
+// Number of threads and of measures per thread of the check of the pool
+#define CHECK_POOL_NB_THREAD 4
+#define CHECK_POOL_NB_MEASURE 25
+
+// Arguments of the threads of the check of the pool
+struct CheckPoolArg {
+
+  // The pool shared by the threads
+  struct RunRecorderPool* pool;
+
+  // Flag set by the thread to memorise if all its operations succeeded
+  bool isOk;
+
+};
+
+// Helper function run by the threads of the check of the pool: get the
+// struct RunRecorder of the thread from the pool, add one measure and
+// give it back to the pool, CHECK_POOL_NB_MEASURE times
+// Input:
+//   arg: the struct CheckPoolArg of the thread
+// Output:
+//   Return NULL
+void* CheckPoolThread(
+  void* arg) {
+
+  struct CheckPoolArg* const that = arg;
+  struct RunRecorderMeasure* measure = NULL;
+  that->isOk = true;
+  Try {
+
+    measure = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      measure,
+      "Value",
+      "a");
+    for (
+      int iMeasure = 0;
+      iMeasure < CHECK_POOL_NB_MEASURE;
+      ++iMeasure) {
+
+      // The thread gets the same struct RunRecorder until it releases it
+      struct RunRecorder* recorder = RunRecorderPoolGet(that->pool);
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckPool",
+        measure);
+      that->isOk =
+        that->isOk &&
+        recorder->refLastAddedMeasure > 0 &&
+        RunRecorderPoolGet(that->pool) == recorder;
+      RunRecorderPoolRelease(that->pool);
+
+    }
+
+  } CatchDefault {
+
+    that->isOk = false;
+
+  } EndCatch;
+  RunRecorderMeasureFree(&measure);
+  return NULL;
+
+}
+
 // Main function
 int main(
      int argc,
@@ -271,6 +497,83 @@ int main(
 
   } EndCatch;
 
+  // Add several measurements at once
+  #define NB_MEASURE_BATCH 2
+  struct RunRecorderMeasure* batch[NB_MEASURE_BATCH] = {NULL, NULL};
+  Try {
+
+    batch[0] = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      batch[0],
+      "Date",
+      "2021-03-08 16:45:00");
+    RunRecorderMeasureAddValue(
+      batch[0],
+      "Temperature",
+      19.4);
+    batch[1] = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      batch[1],
+      "Date",
+      "2021-03-08 17:15:00");
+    RunRecorderAddMeasures(
+      recorder,
+      "RoomTemperature",
+      batch,
+      NB_MEASURE_BATCH);
+    printf(
+      "Added measures up to ref. %ld\n",
+      recorder->refLastAddedMeasure);
+    RunRecorderMeasureFree(batch);
+    RunRecorderMeasureFree(batch + 1);
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "RunRecorderAddMeasures",
+      recorder);
+    RunRecorderMeasureFree(batch);
+    RunRecorderMeasureFree(batch + 1);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Add a measurement through a handle on the project
+  struct RunRecorderProject* project = NULL;
+  measure = NULL;
+  Try {
+
+    project =
+      RunRecorderOpenProject(
+        recorder,
+        "RoomTemperature");
+    measure = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      measure,
+      "Temperature",
+      19.8);
+    RunRecorderProjectAddMeasure(
+      project,
+      measure);
+    printf(
+      "Added measure ref. %ld through the project's handle\n",
+      recorder->refLastAddedMeasure);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderProjectFree(&project);
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "RunRecorderProjectAddMeasure",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderProjectFree(&project);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
   // Delete measurement
   Try {
 
@@ -346,6 +649,2331 @@ int main(
 
   } EndCatch;
 
+  // Check the measures are added in batches, on the local database as
+  // through the Web API
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckBatch");
+    RunRecorderAddTypedMetric(
+      recorder,
+      "CheckBatch",
+      "I",
+      "0",
+      RunRecorderMetricType_int);
+    batch[0] = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      batch[0],
+      "I",
+      1);
+    batch[1] = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      batch[1],
+      "I",
+      "x");
+
+    // Add more measures than a batch of the Web API, with one invalid
+    // value in the middle
+    struct RunRecorderMeasure* manyMeasures[2500];
+    for (
+      long iMeasure = 0;
+      iMeasure < 2500;
+      ++iMeasure)
+      manyMeasures[iMeasure] = batch[iMeasure == 1234 ? 1 : 0];
+    bool isOk = false;
+    Try {
+
+      RunRecorderAddMeasures(
+        recorder,
+        "CheckBatch",
+        manyMeasures,
+        2500);
+
+    } CatchDefault {
+
+      isOk = TryCatchGetLastExc() == RunRecorderExc_AddMeasureFailed;
+
+    } EndCatch;
+    RunRecorderMeasureFree(batch);
+    RunRecorderMeasureFree(batch + 1);
+
+    // All the measures are saved, the invalid value is replaced with the
+    // default value
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckBatch");
+    isOk = isOk && measures->nbMeasure == 2500;
+    for (
+      long iMeasure = 0;
+      isOk == true && iMeasure < measures->nbMeasure;
+      ++iMeasure)
+      isOk =
+        strcmp(
+          measures->values[iMeasure][2],
+          (iMeasure == 1234 ? "0" : "1")) == 0;
+    RunRecorderMeasuresFree(&measures);
+    CheckOrExit(
+      isOk,
+      "batch of measures",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckBatch");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckBatch",
+      recorder);
+    RunRecorderMeasureFree(batch);
+    RunRecorderMeasureFree(batch + 1);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // The following checks use the local database
+#if TEST_REMOTE==0
+
+  // Path to a database in the first version, used to check the
+  // migration, and its struct RunRecorder
+  char const* pathDbV1 = "./runrecorder_v1.db";
+  struct RunRecorder* recorderV1 = NULL;
+
+  // Cursor on the measures
+  struct RunRecorderMeasuresCursor* cursor = NULL;
+
+  // Measures by column
+  struct RunRecorderColumns* columns = NULL;
+
+  // Aggregated values per interval
+  struct RunRecorderAggregates* aggregates = NULL;
+
+  // struct RunRecorder using a Web API
+  struct RunRecorder* recorderApi = NULL;
+
+  // Path to the spool database of the struct RunRecorder using a Web API
+  char const* pathDbSpool = "./runrecorder_spool.db";
+
+  // Other connection to the local database, used to hold its lock
+  sqlite3* dbLock = NULL;
+
+  // Path to a database opened with options, and its struct RunRecorder
+  char const* pathDbOptions = "./runrecorder_options.db";
+  struct RunRecorder* recorderOptions = NULL;
+
+  // Pool of struct RunRecorder shared by threads
+  struct RunRecorderPool* pool = NULL;
+
+  // Check the prepared statements are cached and reused
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckStmt");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckStmt",
+      "Value",
+      "-");
+    measure = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      measure,
+      "Value",
+      "a");
+    RunRecorderAddMeasure(
+      recorder,
+      "CheckStmt",
+      measure);
+    sqlite3_stmt* stmt = recorder->stmts[RunRecorderStmt_addMeasure];
+    RunRecorderMeasureAddValue(
+      measure,
+      "Value",
+      "b");
+    RunRecorderAddMeasure(
+      recorder,
+      "CheckStmt",
+      measure);
+    RunRecorderMeasureFree(&measure);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckStmt");
+    bool isOk =
+      stmt != NULL &&
+      stmt == recorder->stmts[RunRecorderStmt_addMeasure] &&
+      measures->nbMeasure == 2 &&
+      strcmp(measures->values[0][2], "a") == 0 &&
+      strcmp(measures->values[1][2], "b") == 0;
+    RunRecorderMeasuresFree(&measures);
+    CheckOrExit(
+      isOk,
+      "cached statements",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckStmt");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckStmt",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the handle on a project caches its reference and metrics
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckHandle");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckHandle",
+      "Value",
+      "-");
+    projects = RunRecorderGetProjects(recorder);
+    long refProject = 0;
+    for (
+      long iProject = 0;
+      iProject < projects->nb;
+      ++iProject)
+      if (strcmp(projects->values[iProject], "CheckHandle") == 0)
+        refProject = projects->refs[iProject];
+    RunRecorderRefValFree(&projects);
+    project =
+      RunRecorderOpenProject(
+        recorder,
+        "CheckHandle");
+    bool isOk =
+      refProject != 0 &&
+      project->ref == refProject &&
+      project->metrics->nb == 1 &&
+      strcmp(project->metrics->values[0], "Value") == 0;
+    RunRecorderProjectFree(&project);
+    CheckOrExit(
+      isOk,
+      "project handle",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckHandle");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckHandle",
+      recorder);
+    RunRecorderRefValFree(&projects);
+    RunRecorderProjectFree(&project);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check a database in the first version is upgraded
+  Try {
+
+    // Create the database with the schema of the version 01.00.00
+    bool isCreated = CreateDbV1(pathDbV1);
+    CheckOrExit(
+      isCreated,
+      "creation of a 01.00.00 database",
+      &recorder);
+
+    // Open the database, which upgrades it to the current version
+    recorderV1 = RunRecorderAlloc(pathDbV1);
+    RunRecorderInit(recorderV1);
+    char* version = RunRecorderGetVersion(recorder);
+    char* versionV1 = RunRecorderGetVersion(recorderV1);
+    bool isOk = strcmp(version, versionV1) == 0;
+    free(version);
+    free(versionV1);
+    measures =
+      RunRecorderGetMeasures(
+        recorderV1,
+        "Old");
+    isOk =
+      isOk &&
+      measures->nbMeasure == 1 &&
+      strcmp(measures->values[0][2], "12") == 0;
+    RunRecorderMeasuresFree(&measures);
+    CheckOrExit(
+      isOk,
+      "migration of a 01.00.00 database",
+      &recorder);
+    RunRecorderFree(&recorderV1);
+    remove(pathDbV1);
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckMigration",
+      recorder);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorderV1);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the view of a project gives the default values of the missing
+  // values without looking them up
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckView");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckView",
+      "A",
+      "-");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckView",
+      "B",
+      "it's");
+    measure = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      measure,
+      "A",
+      "1");
+    RunRecorderAddMeasure(
+      recorder,
+      "CheckView",
+      measure);
+    RunRecorderMeasureFree(&measure);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckView");
+    bool isOk =
+      measures->nbMeasure == 1 &&
+      strcmp(measures->values[0][2], "1") == 0 &&
+      strcmp(measures->values[0][3], "it's") == 0;
+    RunRecorderMeasuresFree(&measures);
+
+    // The view must not look up the default values when it's read
+    sqlite3_stmt* stmt = NULL;
+    sqlite3_prepare_v2(
+      recorder->db,
+      "SELECT sql FROM sqlite_master WHERE type = 'view' "
+      "AND name = 'CheckView' AND sql NOT LIKE '%DefaultValue%'",
+      -1,
+      &stmt,
+      NULL);
+    isOk = isOk && sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    CheckOrExit(
+      isOk,
+      "default values in the view",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckView");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckView",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the materialized table of a project is kept up to date
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckMat");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckMat",
+      "A",
+      "-");
+    measure = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      measure,
+      "A",
+      "1");
+    RunRecorderAddMeasure(
+      recorder,
+      "CheckMat",
+      measure);
+    RunRecorderSetMaterialized(
+      recorder,
+      "CheckMat",
+      true);
+    RunRecorderMeasureAddValue(
+      measure,
+      "A",
+      "2");
+    RunRecorderAddMeasure(
+      recorder,
+      "CheckMat",
+      measure);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderAddMetric(
+      recorder,
+      "CheckMat",
+      "B",
+      "x");
+    long nbRow =
+      QueryLong(
+        recorder,
+        "SELECT COUNT(*) FROM _Mat_CheckMat");
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckMat");
+    bool isOk =
+      nbRow == 2 &&
+      measures->nbMeasure == 2 &&
+      strcmp(measures->values[0][2], "1") == 0 &&
+      strcmp(measures->values[1][2], "2") == 0 &&
+      strcmp(measures->values[0][3], "x") == 0 &&
+      strcmp(measures->values[1][3], "x") == 0;
+    RunRecorderDeleteMeasure(
+      recorder,
+      atol(measures->values[0][0]));
+    RunRecorderMeasuresFree(&measures);
+    nbRow =
+      QueryLong(
+        recorder,
+        "SELECT COUNT(*) FROM _Mat_CheckMat");
+    isOk = isOk && nbRow == 1;
+    CheckOrExit(
+      isOk,
+      "materialized table",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckMat");
+    nbRow =
+      QueryLong(
+        recorder,
+        "SELECT COUNT(*) FROM sqlite_master WHERE name = '_Mat_CheckMat'");
+    CheckOrExit(
+      nbRow == 0,
+      "materialized table dropped with its project",
+      &recorder);
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckMat",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the deletions don't vacuum the database and it can be compacted
+  Try {
+
+    // Deleting measures leaves free pages, reclaimed by RunRecorderCompact
+    CreateCheckProject(
+      recorder,
+      "CheckCompact");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckCompact",
+      "Value",
+      "-");
+    char value[1000];
+    memset(
+      value,
+      'a',
+      sizeof(value) - 1);
+    value[sizeof(value) - 1] = '\0';
+    measure = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      measure,
+      "Value",
+      value);
+    RunRecorderBeginSession(recorder);
+    for (
+      int iMeasure = 0;
+      iMeasure < 100;
+      ++iMeasure)
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckCompact",
+        measure);
+    RunRecorderCommitSession(recorder);
+    RunRecorderMeasureFree(&measure);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckCompact");
+    for (
+      long iMeasure = 0;
+      iMeasure < measures->nbMeasure;
+      ++iMeasure)
+      RunRecorderDeleteMeasure(
+        recorder,
+        atol(measures->values[iMeasure][0]));
+    RunRecorderMeasuresFree(&measures);
+    long nbFreePage =
+      QueryLong(
+        recorder,
+        "PRAGMA freelist_count");
+    long nbRemaining =
+      RunRecorderCompact(
+        recorder,
+        1);
+    bool isOk =
+      QueryLong(
+        recorder,
+        "PRAGMA auto_vacuum") == 2 &&
+      nbFreePage > 1 &&
+      nbRemaining == nbFreePage - 1 &&
+      RunRecorderCompact(
+        recorder,
+        0) == 0 &&
+      QueryLong(
+        recorder,
+        "PRAGMA freelist_count") == 0;
+    CheckOrExit(
+      isOk,
+      "deletion without vacuum and compaction",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckCompact");
+
+    // The migration switches the older databases to incremental vacuum
+    bool isCreated = CreateDbV1(pathDbV1);
+    recorderV1 = RunRecorderAlloc(pathDbV1);
+    RunRecorderInit(recorderV1);
+    isOk =
+      isCreated &&
+      QueryLong(
+        recorderV1,
+        "PRAGMA auto_vacuum") == 2;
+    RunRecorderFree(&recorderV1);
+    remove(pathDbV1);
+    CheckOrExit(
+      isOk,
+      "incremental vacuum of a migrated database",
+      &recorder);
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckCompact",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorderV1);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the bulk and range deletions of measures
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckDelete");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckDelete",
+      "Value",
+      "-");
+    measure = RunRecorderMeasureCreate();
+    for (
+      long iMeasure = 0;
+      iMeasure < 10;
+      ++iMeasure) {
+
+      RunRecorderMeasureAddValue(
+        measure,
+        "Value",
+        iMeasure);
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckDelete",
+        measure);
+
+    }
+    RunRecorderMeasureFree(&measure);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckDelete");
+    long refs[10];
+    for (
+      long iMeasure = 0;
+      iMeasure < measures->nbMeasure;
+      ++iMeasure)
+      refs[iMeasure] = atol(measures->values[iMeasure][0]);
+    bool isOk = measures->nbMeasure == 10;
+    RunRecorderMeasuresFree(&measures);
+
+    // Delete the two first measures, then the three next ones by range
+    // of references
+    RunRecorderDeleteMeasures(
+      recorder,
+      refs,
+      2);
+    RunRecorderDeleteMeasuresByRef(
+      recorder,
+      refs[2],
+      refs[4]);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckDelete");
+    isOk =
+      isOk &&
+      measures->nbMeasure == 5 &&
+      strcmp(measures->values[0][2], "5") == 0;
+    RunRecorderMeasuresFree(&measures);
+
+    // Delete by dates, the measures were all recorded now
+    RunRecorderDeleteMeasuresByDate(
+      recorder,
+      "CheckDelete",
+      0,
+      1);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckDelete");
+    isOk = isOk && measures->nbMeasure == 5;
+    RunRecorderMeasuresFree(&measures);
+
+    // time() may still give the previous second of the date of the
+    // measures, use a bound far enough in the future
+    RunRecorderDeleteMeasuresByDate(
+      recorder,
+      "CheckDelete",
+      0,
+      time(NULL) + 3600);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckDelete");
+    isOk = isOk && measures->nbMeasure == 0;
+    RunRecorderMeasuresFree(&measures);
+    CheckOrExit(
+      isOk,
+      "bulk and range deletions",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckDelete");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckDelete",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the retention policy of a project
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckRetention");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckRetention",
+      "Value",
+      "-");
+    measure = RunRecorderMeasureCreate();
+    for (
+      long iMeasure = 0;
+      iMeasure < 10;
+      ++iMeasure) {
+
+      RunRecorderMeasureAddValue(
+        measure,
+        "Value",
+        iMeasure);
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckRetention",
+        measure);
+
+    }
+    RunRecorderMeasureFree(&measure);
+
+    // The measures are recent enough for the maximum age, only the
+    // maximum number of measures applies
+    RunRecorderSetRetention(
+      recorder,
+      "CheckRetention",
+      3600,
+      3);
+    long nbDeleted = RunRecorderApplyRetention(recorder);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckRetention");
+    bool isOk =
+      nbDeleted == 7 &&
+      measures->nbMeasure == 3 &&
+      strcmp(measures->values[0][2], "7") == 0 &&
+      strcmp(measures->values[2][2], "9") == 0 &&
+      RunRecorderApplyRetention(recorder) == 0;
+    RunRecorderMeasuresFree(&measures);
+    CheckOrExit(
+      isOk,
+      "retention policy",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckRetention");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckRetention",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the dates of the measures are stored as integer microseconds
+  // since the Epoch
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckDate");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckDate",
+      "Value",
+      "-");
+    measure = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      measure,
+      "Value",
+      "a");
+    // The bounds are taken with the clock used by the library, time()
+    // may still give the previous second
+    struct timespec ts;
+    timespec_get(
+      &ts,
+      TIME_UTC);
+    long dateBefore = (long)ts.tv_sec * 1000000 + (long)ts.tv_nsec / 1000;
+    RunRecorderAddMeasure(
+      recorder,
+      "CheckDate",
+      measure);
+    timespec_get(
+      &ts,
+      TIME_UTC);
+    long dateAfter = (long)ts.tv_sec * 1000000 + (long)ts.tv_nsec / 1000;
+    RunRecorderMeasureFree(&measure);
+    long date =
+      QueryLong(
+        recorder,
+        "SELECT DateMeasure FROM _Measure WHERE Ref = (SELECT MAX(Ref) "
+        "FROM _Measure WHERE typeof(DateMeasure) = 'integer')");
+    bool isOk =
+      date >= dateBefore &&
+      date <= dateAfter &&
+      QueryLong(
+        recorder,
+        "SELECT COUNT(*) FROM _Measure "
+        "WHERE typeof(DateMeasure) <> 'integer'") == 0;
+    CheckOrExit(
+      isOk,
+      "integer date of a new measure",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckDate");
+
+    // The migration converts the local dates of the first version
+    bool isCreated = CreateDbV1(pathDbV1);
+    recorderV1 = RunRecorderAlloc(pathDbV1);
+    RunRecorderInit(recorderV1);
+    struct tm tmV1 = {
+      .tm_year = 121,
+      .tm_mon = 2,
+      .tm_mday = 8,
+      .tm_hour = 15,
+      .tm_min = 45,
+      .tm_sec = 0,
+      .tm_isdst = -1};
+    isOk =
+      isCreated &&
+      QueryLong(
+        recorderV1,
+        "SELECT DateMeasure FROM _Measure WHERE Ref = 1") ==
+        (long)mktime(&tmV1) * 1000000;
+    RunRecorderFree(&recorderV1);
+    remove(pathDbV1);
+    CheckOrExit(
+      isOk,
+      "integer date of a migrated measure",
+      &recorder);
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckDate",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderFree(&recorderV1);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the measures are read in a range of dates
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckRange");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckRange",
+      "Value",
+      "-");
+    measure = RunRecorderMeasureCreate();
+    for (
+      long iMeasure = 0;
+      iMeasure < 3;
+      ++iMeasure) {
+
+      RunRecorderMeasureAddValue(
+        measure,
+        "Value",
+        iMeasure);
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckRange",
+        measure);
+
+    }
+    RunRecorderMeasureFree(&measure);
+
+    // Date the measures 1000s, 2000s and 3000s after the Epoch
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckRange");
+    bool isOk = measures->nbMeasure == 3;
+    for (
+      long iMeasure = 0;
+      iMeasure < measures->nbMeasure;
+      ++iMeasure) {
+
+      char cmd[100];
+      sprintf(
+        cmd,
+        "UPDATE _Measure SET DateMeasure = %ld000000 WHERE Ref = %s",
+        (iMeasure + 1) * 1000,
+        measures->values[iMeasure][0]);
+      int retExec =
+        sqlite3_exec(
+          recorder->db,
+          cmd,
+          NULL,
+          NULL,
+          NULL);
+      isOk = isOk && retExec == SQLITE_OK;
+
+    }
+    RunRecorderMeasuresFree(&measures);
+    measures =
+      RunRecorderGetMeasuresInRange(
+        recorder,
+        "CheckRange",
+        1500,
+        3000,
+        0);
+    isOk =
+      isOk &&
+      measures->nbMeasure == 1 &&
+      strcmp(measures->values[0][2], "1") == 0;
+    RunRecorderMeasuresFree(&measures);
+    measures =
+      RunRecorderGetMeasuresInRange(
+        recorder,
+        "CheckRange",
+        0,
+        4000,
+        2);
+    isOk =
+      isOk &&
+      measures->nbMeasure == 2 &&
+      strcmp(measures->values[0][2], "0") == 0 &&
+      strcmp(measures->values[1][2], "1") == 0;
+    RunRecorderMeasuresFree(&measures);
+    CheckOrExit(
+      isOk,
+      "measures in a range of dates",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckRange");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckRange",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the measures are read one at a time with a cursor
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckCursor");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckCursor",
+      "Value",
+      "-");
+    measure = RunRecorderMeasureCreate();
+    for (
+      long iMeasure = 0;
+      iMeasure < 5;
+      ++iMeasure) {
+
+      RunRecorderMeasureAddValue(
+        measure,
+        "Value",
+        iMeasure);
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckCursor",
+        measure);
+
+    }
+    RunRecorderMeasureFree(&measure);
+    cursor =
+      RunRecorderMeasuresCursorOpen(
+        recorder,
+        "CheckCursor");
+    bool isOk =
+      cursor->nbMetric == 3 &&
+      strcmp(cursor->metrics[2], "Value") == 0;
+    long nbMeasure = 0;
+    while (RunRecorderMeasuresCursorNext(cursor) == true) {
+
+      char value[20];
+      sprintf(
+        value,
+        "%ld",
+        nbMeasure);
+      isOk = isOk && strcmp(cursor->values[2], value) == 0;
+      ++nbMeasure;
+
+    }
+    RunRecorderMeasuresCursorClose(&cursor);
+    CheckOrExit(
+      isOk && nbMeasure == 5 && cursor == NULL,
+      "cursor on the measures",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckCursor");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckCursor",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresCursorClose(&cursor);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the values of many measures are intact once read
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckArena");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckArena",
+      "Value",
+      "-");
+    measure = RunRecorderMeasureCreate();
+    RunRecorderBeginSession(recorder);
+    for (
+      long iMeasure = 0;
+      iMeasure < 5000;
+      ++iMeasure) {
+
+      RunRecorderMeasureAddValue(
+        measure,
+        "Value",
+        iMeasure);
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckArena",
+        measure);
+
+    }
+    RunRecorderCommitSession(recorder);
+    RunRecorderMeasureFree(&measure);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckArena");
+    bool isOk = measures->nbMeasure == 5000;
+    for (
+      long iMeasure = 0;
+      isOk == true && iMeasure < measures->nbMeasure;
+      ++iMeasure) {
+
+      char value[20];
+      sprintf(
+        value,
+        "%ld",
+        iMeasure);
+      isOk =
+        strcmp(measures->metrics[2], "Value") == 0 &&
+        strcmp(measures->values[iMeasure][2], value) == 0;
+
+    }
+    RunRecorderMeasuresFree(&measures);
+    CheckOrExit(
+      isOk,
+      "values of many measures",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckArena");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckArena",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the values of numeric metrics are stored as numbers and the
+  // invalid ones are rejected
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckType");
+    RunRecorderAddTypedMetric(
+      recorder,
+      "CheckType",
+      "I",
+      "0",
+      RunRecorderMetricType_int);
+    RunRecorderAddTypedMetric(
+      recorder,
+      "CheckType",
+      "D",
+      "0.5",
+      RunRecorderMetricType_double);
+    measure = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      measure,
+      "I",
+      42);
+    RunRecorderMeasureAddValue(
+      measure,
+      "D",
+      0.1);
+    RunRecorderAddMeasure(
+      recorder,
+      "CheckType",
+      measure);
+
+    // Invalid values aren't saved, the valid ones are
+    RunRecorderMeasureAddValue(
+      measure,
+      "I",
+      "notanumber");
+    RunRecorderMeasureAddValue(
+      measure,
+      "D",
+      "2.5");
+    bool isOk =
+      IsAddMeasureFailed(
+        recorder,
+        "CheckType",
+        measure);
+    RunRecorderMeasureAddValue(
+      measure,
+      "I",
+      1.5);
+    RunRecorderMeasureAddValue(
+      measure,
+      "D",
+      "nan");
+    isOk =
+      isOk &&
+      IsAddMeasureFailed(
+        recorder,
+        "CheckType",
+        measure);
+    RunRecorderMeasureFree(&measure);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckType");
+    int iI =
+      RunRecorderMeasuresGetIdxMetric(
+        measures,
+        "I");
+    int iD =
+      RunRecorderMeasuresGetIdxMetric(
+        measures,
+        "D");
+    isOk =
+      isOk &&
+      measures->nbMeasure == 3 &&
+      RunRecorderMeasuresGetLong(
+        measures,
+        0,
+        iI) == 42 &&
+      RunRecorderMeasuresGetDouble(
+        measures,
+        0,
+        iD) == 0.1 &&
+      RunRecorderMeasuresGetLong(
+        measures,
+        1,
+        iI) == 0 &&
+      RunRecorderMeasuresGetDouble(
+        measures,
+        1,
+        iD) == 2.5 &&
+      RunRecorderMeasuresGetLong(
+        measures,
+        2,
+        iI) == 0 &&
+      RunRecorderMeasuresGetDouble(
+        measures,
+        2,
+        iD) == 0.5;
+    RunRecorderMeasuresFree(&measures);
+    isOk =
+      isOk &&
+      QueryLong(
+        recorder,
+        "SELECT COUNT(*) FROM _Value WHERE typeof(Value) = 'integer' "
+        "AND Value = 42") >= 1;
+    CheckOrExit(
+      isOk,
+      "typed values",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckType");
+
+    // The metrics of a migrated database are text metrics
+    bool isCreated = CreateDbV1(pathDbV1);
+    recorderV1 = RunRecorderAlloc(pathDbV1);
+    RunRecorderInit(recorderV1);
+    isOk =
+      isCreated &&
+      QueryLong(
+        recorderV1,
+        "SELECT COUNT(*) FROM _Metric WHERE Type = 0") == 1 &&
+      QueryLong(
+        recorderV1,
+        "SELECT COUNT(*) FROM _Value WHERE typeof(Value) = 'text'") == 1;
+    RunRecorderFree(&recorderV1);
+    remove(pathDbV1);
+    CheckOrExit(
+      isOk,
+      "text values of a migrated database",
+      &recorder);
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckType",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorderV1);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the measures are read by column
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckColumns");
+    RunRecorderAddTypedMetric(
+      recorder,
+      "CheckColumns",
+      "I",
+      "0",
+      RunRecorderMetricType_int);
+    RunRecorderAddMetric(
+      recorder,
+      "CheckColumns",
+      "T",
+      "-");
+    measure = RunRecorderMeasureCreate();
+    RunRecorderBeginSession(recorder);
+    for (
+      long iMeasure = 0;
+      iMeasure < 100;
+      ++iMeasure) {
+
+      char value[20];
+      sprintf(
+        value,
+        "v%ld",
+        iMeasure % 50);
+      RunRecorderMeasureAddValue(
+        measure,
+        "I",
+        iMeasure);
+      RunRecorderMeasureAddValue(
+        measure,
+        "T",
+        value);
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckColumns",
+        measure);
+
+    }
+    RunRecorderCommitSession(recorder);
+    RunRecorderMeasureFree(&measure);
+
+    // Corrupt the value of I of the 6th measure to make it invalid
+    int retExec =
+      sqlite3_exec(
+        recorder->db,
+        "UPDATE _Value SET Value = 'x' WHERE Value = 5 AND RefMetric = "
+        "(SELECT _Metric.Ref FROM _Metric, _Project "
+        "WHERE _Metric.RefProject = _Project.Ref "
+        "AND _Project.Label = 'CheckColumns' AND _Metric.Label = 'I')",
+        NULL,
+        NULL,
+        NULL);
+    columns =
+      RunRecorderGetColumns(
+        recorder,
+        "CheckColumns");
+    struct RunRecorderColumn* colI =
+      columns->columns +
+      RunRecorderColumnsGetIdxMetric(
+        columns,
+        "I");
+    struct RunRecorderColumn* colT =
+      columns->columns +
+      RunRecorderColumnsGetIdxMetric(
+        columns,
+        "T");
+    bool isOk =
+      retExec == SQLITE_OK &&
+      columns->nbMeasure == 100 &&
+      colI->type == RunRecorderMetricType_int &&
+      colT->type == RunRecorderMetricType_text &&
+      colT->nbDict == 50;
+    for (
+      long iMeasure = 0;
+      isOk == true && iMeasure < columns->nbMeasure;
+      ++iMeasure) {
+
+      char value[20];
+      sprintf(
+        value,
+        "v%ld",
+        iMeasure % 50);
+      bool isValid =
+        RunRecorderColumnIsValid(
+          colI,
+          iMeasure);
+      isOk =
+        (iMeasure == 5 ?
+          isValid == false && colI->ints[iMeasure] == 0 :
+          isValid == true && colI->ints[iMeasure] == iMeasure) &&
+        strcmp(colT->dict[colT->codes[iMeasure]], value) == 0;
+
+    }
+    RunRecorderColumnsFree(&columns);
+    CheckOrExit(
+      isOk,
+      "columns, validity and dictionary",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckColumns");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckColumns",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderColumnsFree(&columns);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the aggregation of the values of a metric
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckAggregate");
+    RunRecorderAddTypedMetric(
+      recorder,
+      "CheckAggregate",
+      "V",
+      "0",
+      RunRecorderMetricType_int);
+    measure = RunRecorderMeasureCreate();
+    for (
+      long iMeasure = 1;
+      iMeasure <= 4;
+      ++iMeasure) {
+
+      RunRecorderMeasureAddValue(
+        measure,
+        "V",
+        iMeasure);
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckAggregate",
+        measure);
+
+    }
+    RunRecorderMeasureFree(&measure);
+    // time() may still give the previous second of the date of the
+    // measures, use a bound far enough in the future
+    time_t now = time(NULL) + 3600;
+    double expected[RunRecorderAggregateFn_nb] = {1.0, 4.0, 2.5, 10.0, 4.0};
+    bool isOk = true;
+    for (
+      int fn = 0;
+      fn < RunRecorderAggregateFn_nb;
+      ++fn) {
+
+      double val =
+        RunRecorderAggregate(
+          recorder,
+          "CheckAggregate",
+          "V",
+          fn,
+          0,
+          now);
+      isOk = isOk && val == expected[fn];
+
+    }
+
+    // Aggregation of an empty range
+    isOk =
+      isOk &&
+      isnan(
+        RunRecorderAggregate(
+          recorder,
+          "CheckAggregate",
+          "V",
+          RunRecorderAggregateFn_mean,
+          0,
+          1)) &&
+      RunRecorderAggregate(
+        recorder,
+        "CheckAggregate",
+        "V",
+        RunRecorderAggregateFn_count,
+        0,
+        1) == 0.0;
+
+    // Aggregation per interval, all the measures are in the same one
+    aggregates =
+      RunRecorderAggregateByInterval(
+        recorder,
+        "CheckAggregate",
+        "V",
+        RunRecorderAggregateFn_sum,
+        0,
+        now,
+        now);
+    isOk = isOk && aggregates->nb == 1 && aggregates->values[0] == 10.0;
+    RunRecorderAggregatesFree(&aggregates);
+
+    // Aggregation of a metric which is not in the project
+    Try {
+
+      RunRecorderAggregate(
+        recorder,
+        "CheckAggregate",
+        "Nope",
+        RunRecorderAggregateFn_max,
+        0,
+        now);
+      isOk = false;
+
+    } CatchDefault {
+
+      isOk =
+        isOk &&
+        TryCatchGetLastExc() == RunRecorderExc_InvalidMetricLabel &&
+        strcmp(recorder->errMsg, "The metric Nope is invalid.") == 0;
+
+    } EndCatch;
+    CheckOrExit(
+      isOk,
+      "aggregation",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckAggregate");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckAggregate",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderAggregatesFree(&aggregates);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the reduction of the measures per interval to their minimum, mean
+  // and maximum, as the Web API action downsample
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckDownsample");
+    RunRecorderAddTypedMetric(
+      recorder,
+      "CheckDownsample",
+      "V",
+      "0",
+      RunRecorderMetricType_double);
+    measure = RunRecorderMeasureCreate();
+    for (
+      long iMeasure = 0;
+      iMeasure < 6;
+      ++iMeasure) {
+
+      RunRecorderMeasureAddValue(
+        measure,
+        "V",
+        (double)iMeasure);
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckDownsample",
+        measure);
+
+    }
+    RunRecorderMeasureFree(&measure);
+
+    // Date the measures at 1000s, 1100s, 1200s, 3000s, 3100s and 3200s
+    // after the Epoch, leaving the interval [2000s, 3000s[ empty
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckDownsample");
+    bool isOk = measures->nbMeasure == 6;
+    for (
+      long iMeasure = 0;
+      iMeasure < measures->nbMeasure;
+      ++iMeasure) {
+
+      char cmd[100];
+      sprintf(
+        cmd,
+        "UPDATE _Measure SET DateMeasure = %ld00000000 WHERE Ref = %s",
+        10 + (iMeasure / 3) * 20 + iMeasure % 3,
+        measures->values[iMeasure][0]);
+      int retExec =
+        sqlite3_exec(
+          recorder->db,
+          cmd,
+          NULL,
+          NULL,
+          NULL);
+      isOk = isOk && retExec == SQLITE_OK;
+
+    }
+    RunRecorderMeasuresFree(&measures);
+
+    // Reduce each interval of 1000s
+    enum RunRecorderAggregateFn fns[3] = {
+      RunRecorderAggregateFn_min,
+      RunRecorderAggregateFn_mean,
+      RunRecorderAggregateFn_max};
+    double expected[3][2] = {{0.0, 3.0}, {1.0, 4.0}, {2.0, 5.0}};
+    for (
+      int iFn = 0;
+      iFn < 3;
+      ++iFn) {
+
+      aggregates =
+        RunRecorderAggregateByInterval(
+          recorder,
+          "CheckDownsample",
+          "V",
+          fns[iFn],
+          0,
+          4000,
+          1000);
+      isOk =
+        isOk &&
+        aggregates->nb == 2 &&
+        aggregates->dates[0] == 1000 &&
+        aggregates->dates[1] == 3000 &&
+        aggregates->values[0] == expected[iFn][0] &&
+        aggregates->values[1] == expected[iFn][1];
+      RunRecorderAggregatesFree(&aggregates);
+
+    }
+    CheckOrExit(
+      isOk,
+      "reduction per interval",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckDownsample");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckDownsample",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderAggregatesFree(&aggregates);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check only the measures added since the last read are fetched
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckSince");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckSince",
+      "Value",
+      "-");
+    measure = RunRecorderMeasureCreate();
+    for (
+      long iMeasure = 0;
+      iMeasure < 3;
+      ++iMeasure) {
+
+      RunRecorderMeasureAddValue(
+        measure,
+        "Value",
+        iMeasure);
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckSince",
+        measure);
+
+    }
+
+    // Read all the measures
+    long refLast = 0;
+    measures =
+      RunRecorderGetMeasuresSince(
+        recorder,
+        "CheckSince",
+        &refLast);
+    bool isOk =
+      measures->nbMeasure == 3 &&
+      refLast == atol(measures->values[2][0]);
+    RunRecorderMeasuresFree(&measures);
+
+    // Nothing new, the reference is unchanged
+    long refPrev = refLast;
+    measures =
+      RunRecorderGetMeasuresSince(
+        recorder,
+        "CheckSince",
+        &refLast);
+    isOk = isOk && measures->nbMeasure == 0 && refLast == refPrev;
+    RunRecorderMeasuresFree(&measures);
+
+    // Only the new measure is read
+    RunRecorderMeasureAddValue(
+      measure,
+      "Value",
+      "new");
+    RunRecorderAddMeasure(
+      recorder,
+      "CheckSince",
+      measure);
+    RunRecorderMeasureFree(&measure);
+    measures =
+      RunRecorderGetMeasuresSince(
+        recorder,
+        "CheckSince",
+        &refLast);
+    isOk =
+      isOk &&
+      measures->nbMeasure == 1 &&
+      strcmp(measures->values[0][2], "new") == 0 &&
+      refLast == recorder->refLastAddedMeasure;
+    RunRecorderMeasuresFree(&measures);
+    CheckOrExit(
+      isOk,
+      "measures since the last read",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckSince");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckSince",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the Curl instance of a freed struct RunRecorder is reused, with
+  // its connection, by the next one, and a failed request doesn't prevent
+  // the next ones
+  Try {
+
+    // Nothing listens on the port 1, the initialisations fail on the
+    // request of the version of the database, each time
+    CURL* curl = NULL;
+    bool isOk = true;
+    for (
+      int iRecorder = 0;
+      iRecorder < 2;
+      ++iRecorder) {
+
+      recorderApi = RunRecorderAlloc("http://127.0.0.1:1/api.php");
+      Try {
+
+        RunRecorderInit(recorderApi);
+        isOk = false;
+
+      } CatchDefault {
+
+        isOk =
+          isOk &&
+          TryCatchGetLastExc() == RunRecorderExc_CurlRequestFailed;
+
+      } EndCatch;
+      isOk =
+        isOk &&
+        recorderApi->curl != NULL &&
+        (curl == NULL || recorderApi->curl == curl);
+      curl = recorderApi->curl;
+      RunRecorderFree(&recorderApi);
+
+    }
+    CheckOrExit(
+      isOk,
+      "reuse of the Curl instances",
+      &recorder);
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckCurl",
+      recorder);
+    RunRecorderFree(&recorderApi);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the asynchronous writing of the measures
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckAsync");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckAsync",
+      "Value",
+      "-");
+    measure = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      measure,
+      "Value",
+      "a");
+
+    // Block policy, all the measures are written. The busy timeout of
+    // the struct RunRecorder is not changed by the writer
+    long busyTimeout = recorder->options.busyTimeout;
+    recorder->options.busyTimeout = 100;
+    RunRecorderStartAsync(
+      recorder,
+      4,
+      RunRecorderAsyncPolicy_block);
+    bool isOk = recorder->options.busyTimeout == 100;
+    recorder->options.busyTimeout = busyTimeout;
+    for (
+      int iMeasure = 0;
+      iMeasure < 100;
+      ++iMeasure)
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckAsync",
+        measure);
+    RunRecorderFlush(recorder);
+    RunRecorderStopAsync(recorder);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckAsync");
+    isOk =
+      isOk &&
+      measures->nbMeasure == 100 &&
+      recorder->refLastAddedMeasure == atol(measures->values[99][0]);
+    RunRecorderMeasuresFree(&measures);
+    CheckOrExit(
+      isOk,
+      "asynchronous writing, block policy",
+      &recorder);
+
+    // Drop oldest policy, the database is locked by another connection
+    // to keep the writer waiting while the queue fills up
+    int retOpen =
+      sqlite3_open(
+        pathDb,
+        &dbLock);
+    int retExec =
+      sqlite3_exec(
+        dbLock,
+        "BEGIN IMMEDIATE",
+        NULL,
+        NULL,
+        NULL);
+    isOk = retOpen == SQLITE_OK && retExec == SQLITE_OK;
+    RunRecorderStartAsync(
+      recorder,
+      2,
+      RunRecorderAsyncPolicy_dropOldest);
+    for (
+      int iMeasure = 0;
+      iMeasure < 10;
+      ++iMeasure)
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckAsync",
+        measure);
+    sqlite3_exec(
+      dbLock,
+      "ROLLBACK",
+      NULL,
+      NULL,
+      NULL);
+    RunRecorderFlush(recorder);
+    long nbDropped = recorder->async->nbDropped;
+    RunRecorderStopAsync(recorder);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckAsync");
+    isOk =
+      isOk &&
+      nbDropped > 0 &&
+      measures->nbMeasure == 110 - nbDropped;
+    RunRecorderMeasuresFree(&measures);
+    CheckOrExit(
+      isOk,
+      "asynchronous writing, drop oldest policy",
+      &recorder);
+
+    // Fail policy, the database is locked again
+    retExec =
+      sqlite3_exec(
+        dbLock,
+        "BEGIN IMMEDIATE",
+        NULL,
+        NULL,
+        NULL);
+    isOk = retExec == SQLITE_OK;
+    RunRecorderStartAsync(
+      recorder,
+      2,
+      RunRecorderAsyncPolicy_fail);
+    bool isFull = false;
+    for (
+      int iMeasure = 0;
+      isFull == false && iMeasure < 10;
+      ++iMeasure) {
+
+      Try {
+
+        RunRecorderAddMeasure(
+          recorder,
+          "CheckAsync",
+          measure);
+
+      } CatchDefault {
+
+        isFull = TryCatchGetLastExc() == RunRecorderExc_AsyncQueueFull;
+
+      } EndCatch;
+
+    }
+    sqlite3_exec(
+      dbLock,
+      "ROLLBACK",
+      NULL,
+      NULL,
+      NULL);
+    sqlite3_close(dbLock);
+    dbLock = NULL;
+    RunRecorderFlush(recorder);
+    CheckOrExit(
+      isOk && isFull,
+      "asynchronous writing, fail policy",
+      &recorder);
+
+    // The failure of the writer is reported by the flush
+    RunRecorderMeasureAddValue(
+      measure,
+      "Nope",
+      "b");
+    RunRecorderAddMeasure(
+      recorder,
+      "CheckAsync",
+      measure);
+    RunRecorderMeasureFree(&measure);
+    isOk = false;
+    Try {
+
+      RunRecorderFlush(recorder);
+
+    } CatchDefault {
+
+      isOk =
+        TryCatchGetLastExc() == RunRecorderExc_AddMeasureFailed &&
+        recorder->errMsg != NULL &&
+        strstr(recorder->errMsg, "Nope") != NULL;
+
+    } EndCatch;
+    RunRecorderStopAsync(recorder);
+    CheckOrExit(
+      isOk,
+      "asynchronous writing, failure reported by the flush",
+      &recorder);
+
+    // The measures are dated when they're queued, not when the writer,
+    // kept waiting by the lock of another connection, writes them
+    retOpen =
+      sqlite3_open(
+        pathDb,
+        &dbLock);
+    retExec =
+      sqlite3_exec(
+        dbLock,
+        "BEGIN IMMEDIATE",
+        NULL,
+        NULL,
+        NULL);
+    isOk = retOpen == SQLITE_OK && retExec == SQLITE_OK;
+    RunRecorderStartAsync(
+      recorder,
+      4,
+      RunRecorderAsyncPolicy_block);
+    measure = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      measure,
+      "Value",
+      "c");
+    struct timespec ts;
+    timespec_get(
+      &ts,
+      TIME_UTC);
+    long dateBefore = (long)ts.tv_sec * 1000000 + (long)ts.tv_nsec / 1000;
+    for (
+      int iMeasure = 0;
+      iMeasure < 2;
+      ++iMeasure)
+      RunRecorderAddMeasure(
+        recorder,
+        "CheckAsync",
+        measure);
+    timespec_get(
+      &ts,
+      TIME_UTC);
+    long dateAfter = (long)ts.tv_sec * 1000000 + (long)ts.tv_nsec / 1000;
+    RunRecorderMeasureFree(&measure);
+    sqlite3_sleep(500);
+    sqlite3_exec(
+      dbLock,
+      "ROLLBACK",
+      NULL,
+      NULL,
+      NULL);
+    sqlite3_close(dbLock);
+    dbLock = NULL;
+    RunRecorderFlush(recorder);
+    long refLast = recorder->refLastAddedMeasure;
+    RunRecorderStopAsync(recorder);
+    char sql[200];
+    sprintf(
+      sql,
+      "SELECT COUNT(*) FROM _Measure WHERE Ref >= %ld AND Ref <= %ld "
+      "AND DateMeasure >= %ld AND DateMeasure <= %ld",
+      refLast - 1,
+      refLast,
+      dateBefore,
+      dateAfter);
+    isOk =
+      isOk &&
+      QueryLong(
+        recorder,
+        sql) == 2;
+    CheckOrExit(
+      isOk,
+      "asynchronous writing, measures dated when queued",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckAsync");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckAsync",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderMeasuresFree(&measures);
+    sqlite3_close(dbLock);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the measures are spooled while the Web API can't be reached
+  Try {
+
+    // The spool is only available with the Web API
+    bool isOk = false;
+    Try {
+
+      RunRecorderStartSpool(
+        recorder,
+        pathDbSpool,
+        RunRecorderSpoolMode_onFailure);
+
+    } CatchDefault {
+
+      isOk = TryCatchGetLastExc() == RunRecorderExc_SpoolFailed;
+
+    } EndCatch;
+    CheckOrExit(
+      isOk,
+      "no spool with a local database",
+      &recorder);
+
+    // Nothing listens on the port 1, the measures are spooled
+    remove(pathDbSpool);
+    recorderApi = RunRecorderAlloc("http://127.0.0.1:1/api.php");
+    Try {
+
+      RunRecorderInit(recorderApi);
+
+    } CatchDefault {
+
+      // The Web API can't be reached, the spool can still be started
+
+    } EndCatch;
+    RunRecorderStartSpool(
+      recorderApi,
+      pathDbSpool,
+      RunRecorderSpoolMode_onFailure);
+    measure = RunRecorderMeasureCreate();
+    RunRecorderMeasureAddValue(
+      measure,
+      "Value",
+      "a");
+    isOk = true;
+    for (
+      long iMeasure = 1;
+      iMeasure <= 2;
+      ++iMeasure) {
+
+      RunRecorderAddMeasure(
+        recorderApi,
+        "CheckSpool",
+        measure);
+      isOk =
+        isOk &&
+        recorderApi->refLastAddedMeasure == 0 &&
+        recorderApi->refLastSpooledMeasure == iMeasure &&
+        RunRecorderGetSpooledMeasureRef(
+          recorderApi,
+          iMeasure) == 0;
+
+    }
+    RunRecorderMeasureFree(&measure);
+    isOk =
+      isOk &&
+      RunRecorderGetNbSpooledMeasure(recorderApi) == 2 &&
+      RunRecorderGetSpooledMeasureRef(
+        recorderApi,
+        3) == -1;
+    RunRecorderFree(&recorderApi);
+
+    // The spooled measures are kept for the next start of the spool
+    recorderApi = RunRecorderAlloc("http://127.0.0.1:1/api.php");
+    Try {
+
+      RunRecorderInit(recorderApi);
+
+    } CatchDefault {
+
+      // The Web API can't be reached, the spool can still be started
+
+    } EndCatch;
+    RunRecorderStartSpool(
+      recorderApi,
+      pathDbSpool,
+      RunRecorderSpoolMode_always);
+    isOk = isOk && RunRecorderGetNbSpooledMeasure(recorderApi) == 2;
+    RunRecorderStopSpool(recorderApi);
+    Try {
+
+      RunRecorderGetSpooledMeasureRef(
+        recorderApi,
+        1);
+      isOk = false;
+
+    } CatchDefault {
+
+      isOk = isOk && TryCatchGetLastExc() == RunRecorderExc_SpoolFailed;
+
+    } EndCatch;
+    RunRecorderFree(&recorderApi);
+    remove(pathDbSpool);
+    CheckOrExit(
+      isOk,
+      "spool of the measures while the Web API is unreachable",
+      &recorder);
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckSpool",
+      recorder);
+    RunRecorderMeasureFree(&measure);
+    RunRecorderFree(&recorderApi);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the options of the connection are applied to a new database
+  Try {
+
+    remove(pathDbOptions);
+    struct RunRecorderOptions options = RunRecorderOptionsCreate();
+    options.journalMode = RunRecorderJournalMode_wal;
+    options.synchronous = RunRecorderSynchronous_normal;
+    options.cacheSize = 4096;
+    options.pageSize = 8192;
+    recorderOptions =
+      RunRecorderAllocWithOptions(
+        pathDbOptions,
+        &options);
+    RunRecorderInit(recorderOptions);
+    bool isOk =
+      QueryLong(
+        recorderOptions,
+        "SELECT journal_mode = 'wal' FROM pragma_journal_mode()") == 1 &&
+      QueryLong(
+        recorderOptions,
+        "PRAGMA synchronous") == 1 &&
+      QueryLong(
+        recorderOptions,
+        "PRAGMA cache_size") == -4096 &&
+      QueryLong(
+        recorderOptions,
+        "PRAGMA page_size") == 8192;
+    RunRecorderFree(&recorderOptions);
+
+    // The journal mode is persistent, the default keeps it
+    options = RunRecorderOptionsCreate();
+    recorderOptions =
+      RunRecorderAllocWithOptions(
+        pathDbOptions,
+        &options);
+    RunRecorderInit(recorderOptions);
+    isOk =
+      isOk &&
+      QueryLong(
+        recorderOptions,
+        "SELECT journal_mode = 'wal' FROM pragma_journal_mode()") == 1;
+    RunRecorderFree(&recorderOptions);
+
+    // Invalid options are rejected at the initialisation
+    options.journalMode = RunRecorderJournalMode_nb;
+    recorderOptions =
+      RunRecorderAllocWithOptions(
+        pathDbOptions,
+        &options);
+    Try {
+
+      RunRecorderInit(recorderOptions);
+      isOk = false;
+
+    } CatchDefault {
+
+      isOk = isOk && TryCatchGetLastExc() == RunRecorderExc_OpenDbFailed;
+
+    } EndCatch;
+    RunRecorderFree(&recorderOptions);
+    remove(pathDbOptions);
+    CheckOrExit(
+      isOk,
+      "options of the connection to the local database",
+      &recorder);
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckOptions",
+      recorderOptions);
+    RunRecorderFree(&recorderOptions);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the wait for the lock held by another connection
+  Try {
+
+    struct RunRecorderOptions options = RunRecorderOptionsCreate();
+    options.busyTimeout = 200;
+    options.busyBackoff = 20;
+    recorderOptions =
+      RunRecorderAllocWithOptions(
+        pathDb,
+        &options);
+    RunRecorderInit(recorderOptions);
+    int retOpen =
+      sqlite3_open(
+        pathDb,
+        &dbLock);
+    int retExec =
+      sqlite3_exec(
+        dbLock,
+        "BEGIN IMMEDIATE",
+        NULL,
+        NULL,
+        NULL);
+    bool isOk = retOpen == SQLITE_OK && retExec == SQLITE_OK;
+
+    // The session can't start while the lock is held, the connection
+    // gives up after several attempts once the busy timeout is reached
+    struct timespec tsStart;
+    timespec_get(
+      &tsStart,
+      TIME_UTC);
+    bool isBusy = false;
+    Try {
+
+      RunRecorderBeginSession(recorderOptions);
+
+    } CatchDefault {
+
+      isBusy = TryCatchGetLastExc() == RunRecorderExc_SessionFailed;
+
+    } EndCatch;
+    struct timespec tsEnd;
+    timespec_get(
+      &tsEnd,
+      TIME_UTC);
+    long waitMs =
+      (long)(tsEnd.tv_sec - tsStart.tv_sec) * 1000L +
+      (long)(tsEnd.tv_nsec - tsStart.tv_nsec) / 1000000L;
+    isOk =
+      isOk &&
+      isBusy &&
+      recorderOptions->nbBusyRetry > 1 &&
+      waitMs >= 150 &&
+      waitMs < 2000;
+
+    // The session starts once the lock is released
+    sqlite3_exec(
+      dbLock,
+      "ROLLBACK",
+      NULL,
+      NULL,
+      NULL);
+    sqlite3_close(dbLock);
+    dbLock = NULL;
+    RunRecorderBeginSession(recorderOptions);
+    RunRecorderCommitSession(recorderOptions);
+    RunRecorderFree(&recorderOptions);
+    CheckOrExit(
+      isOk,
+      "wait for the lock held by another connection",
+      &recorder);
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckBusy",
+      recorderOptions);
+    sqlite3_close(dbLock);
+    RunRecorderFree(&recorderOptions);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+  // Check the pool of struct RunRecorder shared by several threads
+  Try {
+
+    CreateCheckProject(
+      recorder,
+      "CheckPool");
+    RunRecorderAddMetric(
+      recorder,
+      "CheckPool",
+      "Value",
+      "-");
+    struct RunRecorderOptions options = RunRecorderOptionsCreate();
+    pool =
+      RunRecorderPoolAlloc(
+        pathDb,
+        &options);
+    pthread_t threads[CHECK_POOL_NB_THREAD];
+    struct CheckPoolArg args[CHECK_POOL_NB_THREAD];
+    bool isOk = true;
+    int nbThread = 0;
+    for (
+      int iThread = 0;
+      isOk == true && iThread < CHECK_POOL_NB_THREAD;
+      ++iThread) {
+
+      args[iThread].pool = pool;
+      args[iThread].isOk = false;
+      int ret =
+        pthread_create(
+          threads + iThread,
+          NULL,
+          CheckPoolThread,
+          args + iThread);
+      if (ret == 0) ++nbThread;
+      else isOk = false;
+
+    }
+
+    for (
+      int iThread = 0;
+      iThread < nbThread;
+      ++iThread) {
+
+      pthread_join(
+        threads[iThread],
+        NULL);
+      isOk = isOk && args[iThread].isOk;
+
+    }
+
+    // An opened session is rolled back when the struct RunRecorder is
+    // given back to the pool
+    struct RunRecorder* recorderPool = RunRecorderPoolGet(pool);
+    RunRecorderBeginSession(recorderPool);
+    RunRecorderPoolRelease(pool);
+    isOk = isOk && recorderPool->isInSession == false;
+
+    // All the measures are added, and all the struct RunRecorder are
+    // back in the pool
+    isOk =
+      isOk &&
+      pool->nbRecorder > 0 &&
+      pool->nbRecorder <= CHECK_POOL_NB_THREAD &&
+      pool->nbIdle == pool->nbRecorder;
+    RunRecorderPoolFree(&pool);
+    measures =
+      RunRecorderGetMeasures(
+        recorder,
+        "CheckPool");
+    isOk =
+      isOk &&
+      measures->nbMeasure == CHECK_POOL_NB_THREAD * CHECK_POOL_NB_MEASURE;
+    RunRecorderMeasuresFree(&measures);
+    CheckOrExit(
+      isOk,
+      "pool of struct RunRecorder shared by several threads",
+      &recorder);
+    RunRecorderFlushProject(
+      recorder,
+      "CheckPool");
+
+  } CatchDefault {
+
+    PrintCaughtException(
+      "CheckPool",
+      recorder);
+    RunRecorderPoolFree(&pool);
+    RunRecorderMeasuresFree(&measures);
+    RunRecorderFree(&recorder);
+    exit(EXIT_FAILURE);
+
+  } EndCatch;
+
+#endif
+
   // Free memory
   RunRecorderFree(&recorder);
 
@@ -1,19 +1,194 @@
 // ------------------ runrecorder.c ------------------
 
+// Needed for clock_gettime() and CLOCK_MONOTONIC
+#define _POSIX_C_SOURCE 200809L
+
 // Include the header
 #include "runrecorder.h"
 
 // ================== Macros =========================
 
 // Last version of the database
-#define VERSION_DB "01.00.00"
+#define VERSION_DB "01.08.00"
 
 // Number of tables in the database
 #define NB_TABLE 5
 
+// SQL commands to create the indexes of the database
+#define SQL_CREATE_INDEXES \
+  "CREATE INDEX IF NOT EXISTS _ValueByMeasure " \
+  "ON _Value (RefMeasure, RefMetric, Value);" \
+  "CREATE INDEX IF NOT EXISTS _MeasureByProject " \
+  "ON _Measure (RefProject, DateMeasure);" \
+  "CREATE INDEX IF NOT EXISTS _MetricByProject " \
+  "ON _Metric (RefProject, Label)"
+
+// SQL command to set the vacuum mode of the database. In incremental mode
+// the pages freed by deletions are kept in the database file until
+// they're released by RunRecorderCompact, instead of requiring a VACUUM
+// which rebuilds the whole file
+#define SQL_AUTO_VACUUM "PRAGMA auto_vacuum = INCREMENTAL"
+
+// SQL command to convert the dates of the measures recorded by previous
+// versions to the UTC date as "YYYY-MM-DD HH:MM:SS". The C library used
+// the local date formatted by ctime(), "Www Mmm dd hh:mm:ss yyyy", and the
+// Web API the local date as "YYYY-MM-DD HH:MM:SS". Unrecognised dates are
+// left unchanged.
+#define SQL_MIGRATE_DATE_MEASURE \
+  "UPDATE _Measure SET DateMeasure = IFNULL(datetime(" \
+  "CASE WHEN length(DateMeasure) = 24 AND substr(DateMeasure, 4, 1) = ' ' " \
+  "THEN printf('%s-%02d-%s %s', substr(DateMeasure, 21, 4), " \
+  "(instr('JanFebMarAprMayJunJulAugSepOctNovDec', " \
+  "substr(DateMeasure, 5, 3)) + 2) / 3, " \
+  "replace(substr(DateMeasure, 9, 2), ' ', '0'), " \
+  "substr(DateMeasure, 12, 8)) " \
+  "ELSE DateMeasure END, 'utc'), DateMeasure)"
+
+// SQL command to convert the dates of the measures from the UTC date as
+// "YYYY-MM-DD HH:MM:SS" to the number of microseconds since the Epoch.
+// Unrecognised dates are converted to the Epoch.
+#define SQL_MIGRATE_DATE_MEASURE_EPOCH \
+  "UPDATE _Measure SET DateMeasure = " \
+  "IFNULL(CAST(strftime('%s', DateMeasure) AS INTEGER), 0) * 1000000 " \
+  "WHERE typeof(DateMeasure) = 'text'"
+
+// SQL commands to store the values in their native type: add the type of
+// the metrics, and rebuild _Value without the TEXT affinity of its column
+// Value, which converted the numbers to strings. The existing metrics are
+// text metrics and their values are left unchanged.
+#define SQL_MIGRATE_TYPED_VALUES \
+  "ALTER TABLE _Metric ADD COLUMN Type INTEGER NOT NULL DEFAULT 0;" \
+  "ALTER TABLE _Value RENAME TO _ValueText;" \
+  "CREATE TABLE _Value (" \
+  "  Ref INTEGER PRIMARY KEY," \
+  "  RefMeasure INTEGER NOT NULL," \
+  "  RefMetric INTEGER NOT NULL," \
+  "  Value NOT NULL);" \
+  "INSERT INTO _Value (Ref, RefMeasure, RefMetric, Value) " \
+  "SELECT Ref, RefMeasure, RefMetric, Value FROM _ValueText;" \
+  "DROP TABLE _ValueText;" \
+  SQL_CREATE_INDEXES
+
+// Number of microseconds per second, the dates of the measures are
+// memorised as the number of microseconds since the Epoch (UTC)
+#define USEC_PER_SEC 1000000L
+
+// Number of measures deleted per transaction when applying the retention
+// policies
+#define SIZE_BATCH_RETENTION 1000
+
+// Maximum number of measures sent per request to the Web API when adding
+// several measures
+#define SIZE_BATCH_ADD_MEASURES_API 1000
+
+// Number of migration steps of the database
+#define NB_MIGRATION 8
+
+// Prefix of the name of the materialized table of a project. Project
+// labels start with a letter, so it can't collide with another project
+#define MATERIALIZED_PREFIX "_Mat_"
+
 // Default CSV separator
 #define CSV_SEP '&'
 
+// 2^63 as a double, the doubles in [-2^63, 2^63[ convert to long
+#define LONG_LIMIT_DOUBLE 9223372036854775808.0
+
+// Minimum and maximum size in byte of the blocks of memory storing the
+// labels and values of a struct RunRecorderMeasures
+#define SIZE_MIN_ARENA_BLOCK 4096
+#define SIZE_MAX_ARENA_BLOCK 1048576
+
+// Minimum number of measures allocated at once in a struct
+// RunRecorderMeasures or RunRecorderColumns
+#define NB_MIN_MEASURE_ALLOC 64
+
+// Minimum size of the hash tables used to build the dictionaries of the
+// text columns of a struct RunRecorderColumns, must be a power of 2
+#define SIZE_MIN_DICT_HASH 16
+
+// Size of the buffer to convert a number to a string
+#define LENGTH_NUM_STR 32
+
+// Maximum number of Curl instances kept, with their open connections to
+// the Web API, after their struct RunRecorder has been freed, to be
+// reused by the next ones
+#define NB_MAX_IDLE_CURL 8
+
+// Default delays in seconds before sending the first TCP keep-alive probe
+// on an idle connection to the Web API, and between probes
+#define KEEP_ALIVE_IDLE 60L
+#define KEEP_ALIVE_INTERVAL 30L
+
+// Maximum number of measures taken at once from the queue by the
+// asynchronous writer thread
+#define SIZE_BATCH_ASYNC 1000
+
+// Default maximum delay in milliseconds a connection to a local database
+// waits for the lock held by another connection, and default maximum
+// delay in milliseconds between two attempts to get the lock
+#define BUSY_TIMEOUT 5000L
+#define BUSY_BACKOFF 100L
+
+// Minimum delay in milliseconds the connection of the asynchronous writer
+// to a local database waits for the lock held by another connection
+#define ASYNC_BUSY_TIMEOUT 5000L
+
+// SQL commands to create the spool database, get the number of spooled
+// measures not yet forwarded, add a measure to the spool, get the oldest
+// spooled measures not yet forwarded, memorise the reference in the Web
+// API of a forwarded measure, forget the forwarded measures older than a
+// given number of measures, and get the reference in the Web API of a
+// spooled measure. Refs of forwarded measures must not be reused, hence
+// the AUTOINCREMENT
+#define SQL_CREATE_SPOOL \
+  "PRAGMA journal_mode = WAL;" \
+  "CREATE TABLE IF NOT EXISTS _Spool (" \
+  "  Ref INTEGER PRIMARY KEY AUTOINCREMENT," \
+  "  Project TEXT NOT NULL," \
+  "  Measure TEXT," \
+  "  RefAPI INTEGER NOT NULL DEFAULT 0);" \
+  "CREATE INDEX IF NOT EXISTS _SpoolPending " \
+  "ON _Spool (Ref) WHERE Measure IS NOT NULL"
+#define SQL_GET_NB_SPOOLED \
+  "SELECT COUNT(*) FROM _Spool WHERE Measure IS NOT NULL"
+#define SQL_ADD_SPOOLED \
+  "INSERT INTO _Spool (Project, Measure) VALUES (?1, ?2)"
+#define SQL_GET_SPOOLED \
+  "SELECT Ref, Project, Measure FROM _Spool " \
+  "WHERE Measure IS NOT NULL ORDER BY Ref LIMIT ?1"
+#define SQL_SET_SPOOLED_REF \
+  "UPDATE _Spool SET Measure = NULL, RefAPI = ?1 WHERE Ref = ?2"
+#define SQL_PURGE_SPOOL \
+  "DELETE FROM _Spool WHERE Measure IS NULL AND " \
+  "Ref <= (SELECT MAX(Ref) FROM _Spool) - ?1"
+#define SQL_GET_SPOOLED_REF \
+  "SELECT Measure IS NULL, RefAPI FROM _Spool WHERE Ref = ?1"
+
+// Delay in milliseconds the connections to the spool database wait for
+// each other's lock
+#define SPOOL_BUSY_TIMEOUT 5000
+
+// Delay in seconds to connect to the Web API before considering it
+// unreachable, when the spool is used
+#define SPOOL_CONNECT_TIMEOUT 10L
+
+// Minimum and maximum delays in seconds before retrying to forward the
+// spooled measures after a failure
+#define SPOOL_BACKOFF_MIN 1
+#define SPOOL_BACKOFF_MAX 300
+
+// Number of consecutive rejections by the Web API after which spooled
+// measures are given up
+#define SPOOL_NB_MAX_REJECTION 5
+
+// Number of the last spooled measures whose reference in the Web API is
+// kept for reconciliation
+#define SPOOL_NB_KEPT_REF 100000
+
+// Initial size of the arrays of struct RunRecorder of a pool
+#define POOL_CAPACITY_INIT 8
+
 // Loop from 0 to (n - 1)
 #define ForZeroTo(I, N) for (long I = 0; I < N; ++I)
 
@@ -24,6 +199,8 @@ static void FreeNullStrPtrPtr(char*** s) {free(*s);*s=NULL;}
 
 static void FreeNullStrPtrPtrPtr(char**** s) {free(*s);*s=NULL;}
 
+static void FreeNullConstStrPtrPtr(char const*** s) {free(*s);*s=NULL;}
+
 // Polymorphic free
 #define PolyFree(P) _Generic(P, \
   struct RunRecorder**: RunRecorderFree, \
@@ -31,27 +208,23 @@ static void FreeNullStrPtrPtrPtr(char**** s) {free(*s);*s=NULL;}
   struct RunRecorderRefValDef**: RunRecorderRefValDefFree, \
   struct RunRecorderMeasure**: RunRecorderMeasureFree, \
   struct RunRecorderMeasures**: RunRecorderMeasuresFree, \
+  struct RunRecorderProject**: RunRecorderProjectFree, \
+  struct RunRecorderMeasuresCursor**: RunRecorderMeasuresCursorClose, \
+  struct RunRecorderColumns**: RunRecorderColumnsFree, \
+  struct RunRecorderAggregates**: RunRecorderAggregatesFree, \
+  struct RunRecorderPool**: RunRecorderPoolFree, \
   char**: FreeNullStrPtr, \
+  char const***: FreeNullConstStrPtrPtr, \
   char***: FreeNullStrPtrPtr, \
   char****: FreeNullStrPtrPtrPtr)(P)
 
 // Strdup freeing the assigned variable and raising exception if it fails
-#ifndef strdup
-static void StringCreate(
-  char** str,
-   char* fmt,
-         ...);
-static char* strdup(char const* in) {
-  if (in == NULL) return NULL;
-  char* out = NULL;
-  StringCreate(&out, "%s", in);
-  return out;
-}
-#endif
+// (including when the duplicated string is NULL)
 #define SafeStrDup(T, S)  \
   do { \
+    char const* src = (S); \
     free(T); \
-    T = strdup(S); \
+    T = (src != NULL ? strdup(src) : NULL); \
     if (T == NULL) Raise(TryCatchExc_MallocFailed); \
   } while(false)
 
@@ -74,7 +247,8 @@ static char* strdup(char const* in) {
 // sprintf at the end of a string
 #define StringAppend(S, F, ...) \
   do { \
-    char* oldStr = strdup(*(S)); \
+    char* oldStr = (*(S) != NULL ? strdup(*(S)) : NULL); \
+    if (*(S) != NULL && oldStr == NULL) Raise(TryCatchExc_MallocFailed); \
     StringCreate(S, "%s" F, oldStr, __VA_ARGS__); \
     free(oldStr); \
   } while(false)
@@ -107,9 +281,187 @@ static char* exceptionStr[NbExceptions] = {
   "RunRecorderExc_MetricNameAlreadyUsed",
   "RunRecorderExc_AddMeasureFailed",
   "RunRecorderExc_DeleteMeasureFailed",
+  "RunRecorderExc_SessionFailed",
+  "RunRecorderExc_UpgradeDbFailed",
+  "RunRecorderExc_MaterializeFailed",
+  "RunRecorderExc_CompactFailed",
+  "RunRecorderExc_RetentionFailed",
+  "RunRecorderExc_InvalidMetricType",
+  "RunRecorderExc_InvalidAggregate",
+  "RunRecorderExc_AsyncFailed",
+  "RunRecorderExc_AsyncQueueFull",
+  "RunRecorderExc_SpoolFailed",
+  "RunRecorderExc_PoolFailed",
+
+};
+
+// SQLite types of the columns of the metrics in the materialized tables
+// and views, per enum RunRecorderMetricType
+static char const* const metricTypeSql[RunRecorderMetricType_nb] = {
+
+  [RunRecorderMetricType_text] = "TEXT",
+  [RunRecorderMetricType_int] = "INTEGER",
+  [RunRecorderMetricType_double] = "REAL",
+
+};
+
+// SQL functions of the aggregate functions, per enum
+// RunRecorderAggregateFn
+static char const* const aggregateFnSql[RunRecorderAggregateFn_nb] = {
+
+  [RunRecorderAggregateFn_min] = "MIN",
+  [RunRecorderAggregateFn_max] = "MAX",
+  [RunRecorderAggregateFn_mean] = "AVG",
+  [RunRecorderAggregateFn_sum] = "SUM",
+  [RunRecorderAggregateFn_count] = "COUNT",
+
+};
+
+// Names of the aggregate functions in the requests to the Web API, per
+// enum RunRecorderAggregateFn
+static char const* const aggregateFnStr[RunRecorderAggregateFn_nb] = {
+
+  [RunRecorderAggregateFn_min] = "min",
+  [RunRecorderAggregateFn_max] = "max",
+  [RunRecorderAggregateFn_mean] = "mean",
+  [RunRecorderAggregateFn_sum] = "sum",
+  [RunRecorderAggregateFn_count] = "count",
+
+};
+
+// Values of the PRAGMA journal_mode, per enum RunRecorderJournalMode
+static char const* const journalModeSql[RunRecorderJournalMode_nb] = {
+
+  [RunRecorderJournalMode_default] = NULL,
+  [RunRecorderJournalMode_delete] = "DELETE",
+  [RunRecorderJournalMode_truncate] = "TRUNCATE",
+  [RunRecorderJournalMode_wal] = "WAL",
+
+};
+
+// Values of the PRAGMA synchronous, per enum RunRecorderSynchronous
+static char const* const synchronousSql[RunRecorderSynchronous_nb] = {
+
+  [RunRecorderSynchronous_default] = NULL,
+  [RunRecorderSynchronous_off] = "OFF",
+  [RunRecorderSynchronous_normal] = "NORMAL",
+  [RunRecorderSynchronous_full] = "FULL",
+
+};
+
+// SQL commands of the cached prepared statements
+static char const* const stmtSql[RunRecorderStmt_nb] = {
+
+  [RunRecorderStmt_getVersion] =
+    "SELECT Label FROM _Version LIMIT 1",
+  [RunRecorderStmt_addProject] =
+    "INSERT INTO _Project (Ref, Label) VALUES (NULL, ?1)",
+  [RunRecorderStmt_getProjectRef] =
+    "SELECT Ref FROM _Project WHERE Label = ?1",
+  [RunRecorderStmt_isMaterialized] =
+    "SELECT Materialized FROM _Project WHERE Label = ?1",
+  [RunRecorderStmt_setMaterialized] =
+    "UPDATE _Project SET Materialized = ?1 WHERE Label = ?2",
+  [RunRecorderStmt_getMaterializedOfMeasure] =
+    "SELECT _Project.Label FROM _Measure, _Project "
+    "WHERE _Measure.Ref = ?1 AND _Project.Ref = _Measure.RefProject "
+    "AND _Project.Materialized = 1",
+  [RunRecorderStmt_getProjects] =
+    "SELECT Ref, Label FROM _Project",
+  [RunRecorderStmt_getMetrics] =
+    "SELECT _Metric.Ref, _Metric.Label, _Metric.DefaultValue, _Metric.Type "
+    "FROM _Metric, _Project "
+    "WHERE _Metric.RefProject = _Project.Ref AND "
+    "_Project.Label = ?1 ORDER BY _Metric.Label",
+  [RunRecorderStmt_addMetric] =
+    "INSERT INTO _Metric (Ref, RefProject, Label, DefaultValue, Type) "
+    "SELECT NULL, _Project.Ref, ?1, ?2, ?4 FROM _Project "
+    "WHERE _Project.Label = ?3",
+  [RunRecorderStmt_addMeasure] =
+    "INSERT INTO _Measure (RefProject, DateMeasure) VALUES (?1, ?2)",
+  [RunRecorderStmt_addValue] =
+    "INSERT INTO _Value (RefMeasure, RefMetric, Value) VALUES (?1, ?2, ?3)",
+  [RunRecorderStmt_deleteValues] =
+    "DELETE FROM _Value WHERE RefMeasure = ?1",
+  [RunRecorderStmt_deleteMeasure] =
+    "DELETE FROM _Measure WHERE Ref = ?1",
+  [RunRecorderStmt_deleteValuesByRef] =
+    "DELETE FROM _Value WHERE RefMeasure BETWEEN ?1 AND ?2",
+  [RunRecorderStmt_deleteMeasuresByRef] =
+    "DELETE FROM _Measure WHERE Ref BETWEEN ?1 AND ?2",
+  [RunRecorderStmt_deleteValuesByDate] =
+    "DELETE FROM _Value WHERE RefMeasure IN "
+    "(SELECT _Measure.Ref FROM _Measure, _Project "
+    "WHERE _Measure.RefProject = _Project.Ref AND _Project.Label = ?1 "
+    "AND _Measure.DateMeasure >= ?2 AND _Measure.DateMeasure < ?3)",
+  [RunRecorderStmt_deleteMeasuresByDate] =
+    "DELETE FROM _Measure WHERE RefProject = "
+    "(SELECT Ref FROM _Project WHERE Label = ?1) "
+    "AND DateMeasure >= ?2 AND DateMeasure < ?3",
+  [RunRecorderStmt_getMaterializedProjects] =
+    "SELECT Ref, Label FROM _Project WHERE Materialized = 1",
+  [RunRecorderStmt_setRetention] =
+    "UPDATE _Project SET RetentionAge = ?1, RetentionCount = ?2 "
+    "WHERE Label = ?3",
+  [RunRecorderStmt_getRetentionProjects] =
+    "SELECT Ref, Label FROM _Project "
+    "WHERE RetentionAge > 0 OR RetentionCount > 0",
+  [RunRecorderStmt_getRetention] =
+    "SELECT RetentionAge, RetentionCount FROM _Project WHERE Ref = ?1",
+  [RunRecorderStmt_getNthLastMeasure] =
+    "SELECT DateMeasure, Ref FROM _Measure WHERE RefProject = ?1 "
+    "ORDER BY DateMeasure DESC, Ref DESC LIMIT 1 OFFSET ?2",
+  [RunRecorderStmt_getExpiredMeasures] =
+    "SELECT Ref FROM _Measure WHERE RefProject = ?1 AND "
+    "(DateMeasure < ?2 OR (DateMeasure = ?2 AND Ref <= ?3)) LIMIT ?4",
+  [RunRecorderStmt_flushValues] =
+    "DELETE FROM _Value WHERE RefMeasure IN "
+    "(SELECT _Measure.Ref FROM _Measure, _Project "
+    "WHERE _Measure.RefProject = _Project.Ref "
+    "AND _Project.Label = ?1)",
+  [RunRecorderStmt_flushMeasures] =
+    "DELETE FROM _Measure WHERE Ref IN "
+    "(SELECT _Measure.Ref FROM _Measure, _Project "
+    "WHERE _Measure.RefProject = _Project.Ref "
+    "AND _Project.Label = ?1)",
+  [RunRecorderStmt_flushMetrics] =
+    "DELETE FROM _Metric WHERE RefProject = "
+    "(SELECT Ref FROM _Project "
+    "WHERE _Project.Label = ?1)",
+  [RunRecorderStmt_flushProject] =
+    "DELETE FROM _Project "
+    "WHERE _Project.Label = ?1",
+  [RunRecorderStmt_begin] =
+    "BEGIN IMMEDIATE",
+  [RunRecorderStmt_commit] =
+    "COMMIT",
+  [RunRecorderStmt_rollback] =
+    "ROLLBACK",
+  [RunRecorderStmt_getFreePages] =
+    "PRAGMA freelist_count",
 
 };
 
+// Flag to initialise Curl once per process, from any thread
+static pthread_once_t curlInitOnce = PTHREAD_ONCE_INIT;
+
+// Result of the initialisation of Curl
+static CURLcode curlInitRes = CURLE_FAILED_INIT;
+
+// Curl share object shared by all the struct RunRecorder using the Web
+// API to reuse the DNS resolutions and TLS sessions, and its locks per
+// type of shared data
+static CURLSH* curlShare = NULL;
+static pthread_mutex_t curlShareLocks[CURL_LOCK_DATA_LAST];
+
+// Curl instances of freed struct RunRecorder, kept with their open
+// connections to be reused by the next ones. The connection cache of
+// Curl can't be shared between threads, so the connections are kept
+// alive by recycling the instances instead.
+static CURL* idleCurls[NB_MAX_IDLE_CURL];
+static int nbIdleCurl = 0;
+static pthread_mutex_t idleCurlsLock = PTHREAD_MUTEX_INITIALIZER;
+
 // ================== Private functions declaration =========================
 
 // Clone of asprintf
@@ -122,6 +474,48 @@ static void StringCreate(
    char* fmt,
          ...);
 
+// Convert a string to an integer
+// Inputs:
+//   str: the string
+//   val: where to memorise the integer
+// Output:
+//   Return true if the whole string is an integer, else false and val is
+//   left unchanged
+static bool StrToLong(
+  char const* const str,
+         long* const val);
+
+// Convert a string to a double
+// Inputs:
+//   str: the string
+//   val: where to memorise the double
+// Output:
+//   Return true if the whole string is a number, else false and val is
+//   left unchanged
+static bool StrToDouble(
+  char const* const str,
+       double* const val);
+
+// Convert a double to the shortest string, among 15 and 17 significant
+// digits, which converts back exactly to the same double
+// Inputs:
+//   val: the double
+//   str: the buffer where to write the string, of size LENGTH_NUM_STR
+static void FormatDouble(
+  double const val,
+   char* const str);
+
+// Init the connection of a struct RunRecorder to the local database or
+// Web API
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_OpenDbFailed
+//   RunRecorderExc_CreateCurlFailed
+//   RunRecorderExc_CurlSetOptFailed
+static void InitConnection(
+  struct RunRecorder* const that);
+
 // Init a struct RunRecorder using a local SQLite database
 // Input:
 //   that: the struct RunRecorder
@@ -130,6 +524,30 @@ static void StringCreate(
 static void InitLocal(
   struct RunRecorder* const that);
 
+// Set the options of the connection to a local database
+// Inputs:
+//    that: the struct RunRecorder
+//   isNew: flag to memorise if the database has just been created, the
+//          page size is only set in that case
+// Raise:
+//   RunRecorderExc_OpenDbFailed
+static void SetOptionsLocal(
+  struct RunRecorder* const that,
+                 bool const isNew);
+
+// Busy handler of the connection to a local database, called by SQLite
+// when a lock is held by another connection. Waits before the next
+// attempt for a delay doubling from 1ms up to the backoff, with a random
+// jitter, until the busy timeout is reached.
+// Inputs:
+//      arg: the struct RunRecorder
+//   nbCall: the number of previous calls for the same lock
+// Output:
+//   Return 1 to make another attempt, 0 to fail with SQLITE_BUSY
+static int BusyHandler(
+  void* const arg,
+    int const nbCall);
+
 // Init a struct RunRecorder using the Web API
 // Input:
 //   that: the struct RunRecorder
@@ -139,6 +557,63 @@ static void InitLocal(
 static void InitWebAPI(
   struct RunRecorder* const that);
 
+// Initialise Curl for the process and create the share object, called
+// once with pthread_once. If the share object can't be created the
+// struct RunRecorder work without it.
+static void InitCurlOnce(
+  void);
+
+// Release the Curl resources of the process, registered with atexit
+static void CleanupCurl(
+  void);
+
+// Lock function of the Curl share object
+// Inputs:
+//     curl: the Curl instance (unused)
+//     data: the type of shared data to lock
+//   access: the type of access (unused)
+//      ptr: the user pointer (unused)
+static void LockCurlShare(
+               CURL* const curl,
+    curl_lock_data const data,
+  curl_lock_access const access,
+               void* const ptr);
+
+// Unlock function of the Curl share object
+// Inputs:
+//   curl: the Curl instance (unused)
+//   data: the type of shared data to unlock
+//    ptr: the user pointer (unused)
+static void UnlockCurlShare(
+           CURL* const curl,
+  curl_lock_data const data,
+           void* const ptr);
+
+// Get a Curl instance, an idle one with its open connections if there is
+// one, else a new one
+// Output:
+//   Return the Curl instance, with its default options, or NULL if it
+//   couldn't be created
+static CURL* AcquireCurl(
+  void);
+
+// Release a Curl instance, it is kept with its open connections to be
+// reused if there are less than NB_MAX_IDLE_CURL idle instances, else it
+// is freed
+// Input:
+//   curl: the Curl instance
+static void ReleaseCurl(
+  CURL* const curl);
+
+// Set the TCP keep-alive options of the Curl instance of a struct
+// RunRecorder
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_CurlSetOptFailed
+static void SetCurlKeepAlive(
+  struct RunRecorder* const that);
+
 // Free the error messages of a struct RunRecorder
 // Input:
 //   that: The struct RunRecorder to be freed
@@ -162,6 +637,95 @@ static bool UsesAPI(
 static void ResetCurlReply(
   struct RunRecorder* const that);
 
+
+// Get a prepared statement from the cache of a struct RunRecorder, ready
+// to be bound and executed. The statement is prepared at its first use.
+// Inputs:
+//   that: the struct RunRecorder
+//     id: the identifier of the statement
+// Output:
+//   Return the statement
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static sqlite3_stmt* GetStmt(
+  struct RunRecorder* const that,
+  enum RunRecorderStmt const id);
+
+// Bind a string to a parameter of a prepared statement
+// Inputs:
+//     that: the struct RunRecorder
+//     stmt: the statement
+//   iParam: the index of the parameter (starting at 1)
+//      val: the string, must stay valid until the statement is executed
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static void BindStmtText(
+  struct RunRecorder* const that,
+        sqlite3_stmt* const stmt,
+                  int const iParam,
+          char const* const val);
+
+// Bind an integer to a parameter of a prepared statement
+// Inputs:
+//     that: the struct RunRecorder
+//     stmt: the statement
+//   iParam: the index of the parameter (starting at 1)
+//      val: the integer
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static void BindStmtLong(
+  struct RunRecorder* const that,
+        sqlite3_stmt* const stmt,
+                  int const iParam,
+                 long const val);
+
+// Bind a double to a parameter of a prepared statement
+// Inputs:
+//     that: the struct RunRecorder
+//     stmt: the statement
+//   iParam: the index of the parameter (starting at 1)
+//      val: the double
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static void BindStmtDouble(
+  struct RunRecorder* const that,
+        sqlite3_stmt* const stmt,
+                  int const iParam,
+               double const val);
+
+// Bind a value of a measure to a parameter of a prepared statement,
+// converted to the type of its metric. Numeric values are bound as
+// native INTEGER or REAL, strings are parsed for numeric metrics. A value
+// which is not a number, or not an integer for an integer metric, is
+// invalid and left unbound.
+// Inputs:
+//      that: the struct RunRecorder
+//      stmt: the statement
+//    iParam: the index of the parameter (starting at 1)
+//   measure: the measure
+//      iVal: the index of the value in the measure
+//      type: the type of the metric of the value
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+//   RunRecorderExc_InvalidValue
+static void BindStmtValue(
+               struct RunRecorder* const that,
+                     sqlite3_stmt* const stmt,
+                               int const iParam,
+  struct RunRecorderMeasure const* const measure,
+                              long const iVal,
+        enum RunRecorderMetricType const type);
+
+// Execute one step of a prepared statement
+// Inputs:
+//   that: the struct RunRecorder
+//   stmt: the statement
+// Output:
+//   Return SQLITE_ROW or SQLITE_DONE if successful, else the error code,
+//   in which case the error message is memorised in that->errMsg
+static int StepStmt(
+  struct RunRecorder* const that,
+        sqlite3_stmt* const stmt);
 // Create the RunRecorder's tables in an empty database
 // Input:
 //   that: The struct RunRecorder
@@ -176,26 +740,16 @@ static void CreateDb(
 static void CreateDbLocal(
   struct RunRecorder* const that);
 
-// Upgrade the database
+// Upgrade the database to the last version by applying the migration
+// steps in sequence, then recreate the views of the projects and update
+// the dates in their materialized tables if at least one step was applied
 // Input:
 //   that: The struct RunRecorder
+// Raise:
+//   RunRecorderExc_UpgradeDbFailed
 static void UpgradeDb(
   struct RunRecorder* const that);
 
-// Callback for RunRecorderGetVersionLocal
-// Input:
-//      data: The version
-//     nbCol: Number of columns in the returned rows
-//    colVal: Row values
-//   colName: Columns name
-// Output:
-//   Return 0 if successfull, else 1
-static int GetVersionLocalCb(
-   void* data,
-     int nbCol,
-  char** colVal,
-  char** colName);
-
 // Get the version of the local database
 // Input:
 //   that: The struct RunRecorder
@@ -332,42 +886,26 @@ static void PairsRefValAdd(
 //          ref: the reference of the pair
 //          val: the value of the pair
 //   defaultVal: the default value of the pair
+//         type: the type of the pair
 static void PairsRefValDefAdd(
   struct RunRecorderRefValDef* const pairs,
                           long const ref,
                    char const* const val,
-                   char const* const defaultVal);
-
-// Callback to receive pairs of ref/value from sqlite3
-// Input:
-//      data: The pairs
-//     nbCol: Number of columns in the returned rows
-//    colVal: Row values, the reference is expected to be in the first
-//            column and the value in the second column
-//   colName: Columns name
-// Output:
-//   Return 0 if successful, else 1
-static int GetPairsLocalCb(
-   void* data,
-     int nbCol,
-  char** colVal,
-  char** colName);
-
-// Callback to receive pairs of ref/value and their default value
-// from sqlite3
-// Input:
-//      data: The pairs
-//     nbCol: Number of columns in the returned rows
-//    colVal: Row values, the reference is expected to be in the first
-//            column and the value in the second column
-//   colName: Columns name
-// Output:
-//   Return 0 if successful, else 1
-static int GetPairsWithDefaultLocalCb(
-   void* data,
-     int nbCol,
-  char** colVal,
-  char** colName);
+                   char const* const defaultVal,
+    enum RunRecorderMetricType const type);
+
+// Get a list of projects in the local database with a cached statement
+// returning their reference and label
+// Inputs:
+//     that: the struct RunRecorder
+//   idStmt: the statement
+// Output:
+//   Return the projects' reference/label
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderRefVal* GetProjectsOfStmtLocal(
+       struct RunRecorder* const that,
+  enum RunRecorderStmt const idStmt);
 
 // Get the list of projects in the local database
 // Input:
@@ -392,7 +930,7 @@ static struct RunRecorderRefVal* GetPairsRefValFromJSON(
 // Extract a struct RunRecorderRefValDef from a JSON string
 // Input:
 //   json: the JSON string for the metricss, expected to be formatted
-//         as "1":["Label":"A","DefaultValue":"B"],...
+//         as "1":["Label":"A","DefaultValue":"B","Type":"0"],...
 // Output:
 //   Return a new struct RunRecorderRefValDef
 // Raise:
@@ -444,7 +982,22 @@ static struct RunRecorderRefValDef* GetMetricsAPI(
   struct RunRecorder* const that,
           char const* const project);
 
-// Update the view for a project
+// Append to that->cmd the columns of the measures of a project, in the
+// order of the metrics: for each metric its value for the measure
+// _Measure.Ref, found through the covering index on _Value, or its
+// default value if the measure has no value for it. The default values
+// are inlined in the command to be resolved once instead of once per row.
+// Inputs:
+//      that: the struct RunRecorder
+//   metrics: the metrics of the project
+// Raise:
+//   TryCatchExc_MallocFailed
+static void AppendCmdColumnsMeasure(
+            struct RunRecorder* const that,
+  struct RunRecorderRefValDef const* const metrics);
+
+// Update the view for a project. If the project has a materialized
+// table the view reads it, else it resolves the values of each measure.
 // Input:
 //         that: the struct RunRecorder
 //      project: the name of the project
@@ -454,6 +1007,14 @@ static void UpdateViewProject(
   struct RunRecorder* const that,
           char const* const project);
 
+
+// Update the views of all the projects in a local database
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_UpdateViewFailed
+static void UpdateViewAllProjects(
+  struct RunRecorder* const that);
 // Add a metric to a project to a local database
 // Input:
 //         that: the struct RunRecorder
@@ -461,18 +1022,21 @@ static void UpdateViewProject(
 //        label: the label of the metric, it must respect the following
 //               pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
 //               There cannot be two metrics with the same label for the
-//               same project. A metric label can't be 'action' or 'project'
-//               (case sensitive, so 'Action' is fine).
+//               same project. A metric label can't be 'action',
+//               'project' or 'DateMeasure' (case sensitive, so 'Action' is
+//               fine).
 //   defaultVal: the default value of the metric, it must respect the
 //               following pattern: /^[^"=&]+$*/
+//         type: the type of the values of the metric
 // Raise:
 //   RunRecorderExc_InvalidMetricLabel
 //   RunRecorderExc_MetricNameAlreadyUsed
 static void AddMetricLocal(
-  struct RunRecorder* const that,
-          char const* const project,
-          char const* const label,
-          char const* const defaultVal);
+             struct RunRecorder* const that,
+                     char const* const project,
+                     char const* const label,
+                     char const* const defaultVal,
+  enum RunRecorderMetricType const type);
 
 // Add a metric to a project through the Web API
 // Input:
@@ -481,30 +1045,158 @@ static void AddMetricLocal(
 //        label: the label of the metric, it must respect the following
 //               pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
 //               There cannot be two metrics with the same label for the
-//               same project. A metric label can't be 'action' or 'project'
-//               (case sensitive, so 'Action' is fine).
+//               same project. A metric label can't be 'action',
+//               'project' or 'DateMeasure' (case sensitive, so 'Action' is
+//               fine).
 //   defaultVal: the default value of the metric, it must respect the
 //               following pattern: /^[^"=&]+$*/
+//         type: the type of the values of the metric
 // Raise:
 //   RunRecorderExc_InvalidMetricLabel
 //   RunRecorderExc_MetricNameAlreadyUsed
 static void AddMetricAPI(
+             struct RunRecorder* const that,
+                     char const* const project,
+                     char const* const label,
+                     char const* const defaultVal,
+  enum RunRecorderMetricType const type);
+
+// Get the reference of a project in a local database
+// Inputs:
+//   that: the struct RunRecorder
+//   name: the project's name
+// Output:
+//   Return the reference of the project, or 0 if it doesn't exist
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static long GetProjectRefLocal(
+  struct RunRecorder* const that,
+          char const* const name);
+
+// Get the index of a metric in the metrics of a project, sorted by
+// label
+// Inputs:
+//   metrics: the metrics
+//     label: the metric's label
+// Output:
+//   Return the index of the metric, or -1 if it doesn't exist
+static long SearchIdxMetric(
+  struct RunRecorderRefValDef const* const metrics,
+                         char const* const label);
+
+// Get the index of a metric in the metrics of a project from its handle.
+// If the metric is not in the cache, the cache is reloaded once from the
+// database in case the metric has been added since the project was
+// opened.
+// Inputs:
+//   that: the handle on the project
+//  label: the metric's label
+// Output:
+//   Return the index of the metric in that->metrics, or -1 if it doesn't
+//   exist
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static long ProjectGetIdxMetric(
+  struct RunRecorderProject* const that,
+                 char const* const label);
+
+// Add a measure to the materialized table of a project in a local
+// database. The metrics without value in the measure get their default
+// value.
+// Inputs:
+//   project: the handle on the project
+//   measure: the measure to add, already added to _Measure and _Value
+//      date: the date of the measure, in microseconds since the Epoch
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+static void AddMeasureMaterialized(
+         struct RunRecorderProject* const project,
+  struct RunRecorderMeasure const* const measure,
+                              long const date);
+
+// Check if a project has a materialized table in a local database
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+// Output:
+//   Return true if the project has a materialized table, else false
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static bool IsMaterializedLocal(
+  struct RunRecorder* const that,
+          char const* const project);
+
+// Get the projects having a materialized table in a local database
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the projects' reference/label
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderRefVal* GetMaterializedProjectsLocal(
+  struct RunRecorder* const that);
+
+// Copy the dates of the measures into the materialized tables of all the
+// projects in a local database, after a migration which changed them
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static void SyncMaterializedDatesLocal(
+  struct RunRecorder* const that);
+
+// Enable or disable the materialized table of a project in a local
+// database
+// Inputs:
+//             that: the struct RunRecorder
+//          project: the project's name
+//   isMaterialized: true to enable, false to disable
+// Raise:
+//   RunRecorderExc_MaterializeFailed
+//   RunRecorderExc_SessionFailed
+static void SetMaterializedLocal(
   struct RunRecorder* const that,
           char const* const project,
-          char const* const label,
-          char const* const defaultVal);
+                 bool const isMaterialized);
+
+// Enable or disable the materialized table of a project through the Web
+// API
+// Inputs:
+//             that: the struct RunRecorder
+//          project: the project's name
+//   isMaterialized: true to enable, false to disable
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static void SetMaterializedAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+                 bool const isMaterialized);
+
+// Get the current date in the format of _Measure.DateMeasure, the number
+// of microseconds since the Epoch (UTC)
+// Output:
+//   Return the date
+static long GetDateMeasureNow(
+  void);
+
+// Get the current time of the monotonic clock, in microseconds since an
+// unspecified point, unaffected by the changes of the system date
+// Output:
+//   Return the time
+static long GetMonotonicNow(
+  void);
 
 // Add a measure to a project in a local database
 // Inputs:
-//         that: the struct RunRecorder
-//      project: the project to add the measure to
+//      project: the handle on the project to add the measure to
 //      measure: the measure to add
+//         date: the date of the measure, in microseconds since the Epoch
 // Raise:
 //   RunRecorderExc_AddMeasureFailed
 static void AddMeasureLocal(
-               struct RunRecorder* const that,
-                       char const* const project,
-  struct RunRecorderMeasure const* const measure);
+         struct RunRecorderProject* const project,
+  struct RunRecorderMeasure const* const measure,
+                              long const date);
 
 // Add a measure to a project through the WebAPI
 // Inputs:
@@ -518,76 +1210,601 @@ static void AddMeasureAPI(
                        char const* const project,
   struct RunRecorderMeasure const* const measure);
 
-// Delete a measure in a local database
+// Add several measures to a project in a local database, in one single
+// transaction if there is no opened session
 // Inputs:
-//          that: the struct RunRecorder
-//    refMeasure: the reference of the measure to delete
+//      project: the handle on the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+//        dates: the dates of the measures, in microseconds since the
+//               Epoch, or NULL to date them when they're added
 // Raise:
-//   RunRecorderExc_DeleteMeasureFailed
-static void DeleteMeasureLocal(
-  struct RunRecorder* const that,
-                 long const refMeasure);
-
-// Delete a measure through the Web API
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SessionFailed
+static void AddMeasuresLocal(
+              struct RunRecorderProject* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure,
+                              long const* const dates);
+
+// Add several measures to a project through the Web API, by batches of
+// SIZE_BATCH_ADD_MEASURES_API measures per request. If the Web API can't
+// be reached and the struct RunRecorder has a spool, the measures not yet
+// sent are spooled
 // Inputs:
-//          that: the struct RunRecorder
-//    refMeasure: the reference of the measure to delete
-static void DeleteMeasureAPI(
-  struct RunRecorder* const that,
-                 long const refMeasure);
-
-// Callback to receive the measures from sqlite3
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+//        dates: the dates of the measures, in microseconds since the
+//               Epoch, or NULL to let the Web API date them. The spooled
+//               measures are dated when they're spooled.
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SpoolFailed
+static void AddMeasuresAPI(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure,
+                              long const* const dates);
+
+// Add several measures to a project through the Web API in one single
+// request, the measures are sent as a JSON array
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+//        dates: the dates of the measures, in microseconds since the
+//               Epoch, or NULL to let the Web API date them
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+//   RunRecorderExc_AddMeasureFailed
+static void AddMeasuresOfReqAPI(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure,
+                              long const* const dates);
+
+// Get the length of a string once escaped in a JSON string
 // Input:
-//      data: The measures
-//     nbCol: Number of columns in the returned rows
-//    colVal: Row values
-//   colName: Columns name
+//   str: the string
 // Output:
-//   Return 0 if successfull, else 1
-static int GetMeasuresLocalCb(
-   void* data,
-     int nbCol,
-  char** colVal,
-  char** colName);
+//   Return the length, without the terminating '\0'
+static size_t JSONStrLen(
+  char const* const str);
 
-// Helper function to commonalize code between GetMeasures and
-// GetLastMeasures
+// Copy a string escaped as in a JSON string
 // Inputs:
-//        that: the struct RunRecorder
-//     project: the project's name
-//   nbMeasure: the number of measures returned, if 0 all measures are
-//              returned
+//   dest: where to copy the string, must be at least of size
+//         JSONStrLen(str)
+//    str: the string
 // Output:
-//   Set the SQL command in that->cmd to get measures as a struct
-//    RunRecorderMeasures
-static void SetCmdToGetMeasuresLocal(
-  struct RunRecorder* const that,
-          char const* const project,
-                 long const nbMeasure);
-
-// Get the measures of a project from a local database
+//   Return a pointer to the character after the copied string in dest,
+//   the copied string is not terminated by '\0'
+static char* JSONStrCpy(
+         char* const dest,
+  char const* const str);
+
+// Create the asynchronous writer of a struct RunRecorder, with its own
+// connection to the database or Web API. The writer thread is not
+// started.
 // Inputs:
-//         that: the struct RunRecorder
-//      project: the project's name
+//       that: the struct RunRecorder
+//   capacity: the maximum number of measures in the queue
+//     policy: the policy when the queue is full
 // Output:
-//   Return the measures as a struct RunRecorderMeasures
+//   Return the new struct RunRecorderAsync
 // Raise:
-//   RunRecorderExc_SQLRequestFailed
-static struct RunRecorderMeasures* GetMeasuresLocal(
-  struct RunRecorder* const that,
-          char const* const project);
+//   RunRecorderExc_AsyncFailed
+static struct RunRecorderAsync* RunRecorderAsyncCreate(
+            struct RunRecorder* const that,
+                           long const capacity,
+  enum RunRecorderAsyncPolicy const policy);
+
+// Free a struct RunRecorderAsync, stopping its writer thread if it is
+// running. The writer thread writes the queued measures before ending.
+// Input:
+//   that: the struct RunRecorderAsync
+static void RunRecorderAsyncFree(
+  struct RunRecorderAsync** const that);
 
-// Helper function to commonalize code in RunRecorderCSVToData
-// Inputs
-//   csv: Pointer to the start of the row in CSV data
-//   tgt: The array of char* where to copy the values
-//   sep: The separator character
+// Copy a struct RunRecorderMeasure
+// Input:
+//   that: the struct RunRecorderMeasure
+// Output:
+//   Return the new struct RunRecorderMeasure
+static struct RunRecorderMeasure* MeasureClone(
+  struct RunRecorderMeasure const* const that);
+
+// Queue several measures to be added to a project by the asynchronous
+// writer of a struct RunRecorder. The measures are copied, and if the queue
+// is full the policy of the writer is applied.
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_AsyncQueueFull
+static void AddMeasuresAsync(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure);
+
+// Main function of the writer thread of a struct RunRecorderAsync. Take
+// the queued measures by batches of SIZE_BATCH_ASYNC and write them,
+// until the writer is stopped and the queue is empty.
+// Input:
+//   arg: the struct RunRecorderAsync
+// Output:
+//   Return NULL
+static void* AsyncWriterMain(
+  void* arg);
+
+// Add several measures to a project with given dates, in one single
+// transaction or by batches of requests to the Web API. Used by the
+// asynchronous writer, which has no spool and no session.
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+//        dates: the dates of the measures, in microseconds since the Epoch
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SessionFailed
+static void AddMeasuresDated(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure,
+                             long const* const dates);
+
+// Write a batch of measures taken from the queue of a struct
+// RunRecorderAsync, with the date they were queued. The consecutive
+// measures of a same project are written in one single transaction or
+// request. Failures are memorised in the struct RunRecorderAsync, to be
+// reported by RunRecorderFlush.
+// Inputs:
+//        that: the struct RunRecorderAsync
+//    projects: the labels of the projects of the measures
+//    measures: the measures
+//       dates: the dates of the measures, in microseconds since the Epoch
+//   nbMeasure: the number of measures
+static void AsyncWriteBatch(
+           struct RunRecorderAsync* const that,
+                       char* const* const projects,
+  struct RunRecorderMeasure* const* const measures,
+                        long const* const dates,
+                               long const nbMeasure);
+
+// Get the length of a measure as a JSON dictionary {"metric":"value",...}
+// Inputs:
+//   that: the struct RunRecorderMeasure
+//   date: the date of the measure in microseconds since the Epoch, added
+//         to the dictionary as "_date" if it is not 0
+// Output:
+//   Return the length, without the terminating '\0'
+static size_t MeasureJSONLen(
+  struct RunRecorderMeasure const* const that,
+                              long const date);
+
+// Copy a measure as a JSON dictionary {"metric":"value",...}
+// Inputs:
+//   dest: where to copy the measure, must be at least of size
+//         MeasureJSONLen(that, date)
+//   that: the struct RunRecorderMeasure
+//   date: the date of the measure in microseconds since the Epoch, added
+//         to the dictionary as "_date" if it is not 0
+// Output:
+//   Return a pointer to the character after the copied measure in dest,
+//   the copied measure is not terminated by '\0'
+static char* MeasureJSONCpy(
+                              char* const dest,
+  struct RunRecorderMeasure const* const that,
+                              long const date);
+
+// Send measures to a project through the Web API in one single request
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project to add the measures to
+//      json: the measures as a JSON array of dictionaries
+// Output:
+//   Return the number of measures which couldn't be entirely added, and
+//   set the reference of the last added measure
+// Raise:
+//   RunRecorderExc_CurlRequestFailed
+//   RunRecorderExc_ApiRequestFailed
+static long SendMeasuresJSONAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+          char const* const json);
+
+// Open a connection to a spool database, creating it if necessary
+// Inputs:
+//        that: the struct RunRecorder
+//   pathSpool: path of the spool database
+// Output:
+//   Return the connection
+// Raise:
+//   RunRecorderExc_SpoolFailed
+static sqlite3* OpenSpoolDb(
+  struct RunRecorder* const that,
+          char const* const pathSpool);
+
+// Create the spool of a struct RunRecorder. The forwarder thread is not
+// started.
+// Inputs:
+//        that: the struct RunRecorder
+//   pathSpool: path of the spool database
+//        mode: the mode of the spool
+// Output:
+//   Return the new struct RunRecorderSpool
+// Raise:
+//   RunRecorderExc_SpoolFailed
+static struct RunRecorderSpool* RunRecorderSpoolCreate(
+        struct RunRecorder* const that,
+                char const* const pathSpool,
+  enum RunRecorderSpoolMode const mode);
+
+// Free a struct RunRecorderSpool, stopping its forwarder thread if it is
+// running
+// Input:
+//   that: the struct RunRecorderSpool
+static void RunRecorderSpoolFree(
+  struct RunRecorderSpool** const that);
+
+// Add several measures to a project through the Web API and the spool of
+// a struct RunRecorder. In RunRecorderSpoolMode_always, or if measures
+// are still waiting in the spool (to keep the measures in order), the
+// measures are spooled, else they're sent to the Web API and spooled only
+// if it can't be reached.
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SpoolFailed
+static void AddMeasuresSpool(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure);
+
+// Add several measures to the spool of a struct RunRecorder, in one
+// single transaction, and wake up the forwarder thread
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_SpoolFailed
+static void SpoolMeasures(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure);
+
+// Main function of the forwarder thread of a struct RunRecorderSpool.
+// Forward the spooled measures to the Web API by batches, until the
+// spool is stopped. After a failure, wait SPOOL_BACKOFF_MIN seconds
+// before retrying, then twice longer after each new failure, up to
+// SPOOL_BACKOFF_MAX seconds.
+// Input:
+//   arg: the struct RunRecorderSpool
+// Output:
+//   Return NULL
+static void* SpoolForwarderMain(
+  void* arg);
+
+// Forward the oldest spooled measures of a same project to the Web API,
+// in one single request of at most SIZE_BATCH_ADD_MEASURES_API measures.
+// The forwarded measures are kept in the spool with their reference in
+// the Web API, to reconcile them, until they're older than the
+// SPOOL_NB_KEPT_REF last spooled measures. Measures rejected by the Web
+// API SPOOL_NB_MAX_REJECTION times in a row are given up.
+// Input:
+//   that: the struct RunRecorderSpool
+// Output:
+//   Return true if the measures have been forwarded (or given up), false
+//   if they must be retried later
+static bool ForwardSpooledMeasures(
+  struct RunRecorderSpool* const that);
+
+// Free the memory used by the properties of a struct RunRecorderPool and
+// the struct itself, shared by RunRecorderPoolFree and the failure of
+// RunRecorderPoolAlloc. The struct RunRecorder, the key and the lock must
+// have been freed already, or never created.
+// Input:
+//   that: the struct RunRecorderPool to be freed
+static void PoolFreeProperties(
+  struct RunRecorderPool** const that);
+
+// Create and initialise a new struct RunRecorder of a pool, the lock of
+// the pool must be held. The first one checks the database, and upgrades
+// it if necessary, the next ones only open their connection.
+// Input:
+//   that: the struct RunRecorderPool
+// Output:
+//   Return the new struct RunRecorder
+// Raise:
+//   the exceptions of RunRecorderInit
+static struct RunRecorder* PoolCreateRecorder(
+  struct RunRecorderPool* const that);
+
+// Give back a struct RunRecorder to the idle ones of its pool, called when
+// the thread using it ends or calls RunRecorderPoolRelease. An opened
+// session is rolled back.
+// Input:
+//   arg: the struct RunRecorder
+static void ReleaseToPool(
+  void* arg);
+
+// Begin a transaction in a local database
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_SessionFailed
+static void BeginSessionLocal(
+  struct RunRecorder* const that);
+
+// Commit the current transaction in a local database, if the commit fails
+// the transaction is rolled back
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_SessionFailed
+static void CommitSessionLocal(
+  struct RunRecorder* const that);
+
+
+// Rollback the current transaction in a local database
+// Input:
+//   that: the struct RunRecorder
+static void RollbackSessionLocal(
+  struct RunRecorder* const that);
+// Delete a measure in a local database
+// Inputs:
+//          that: the struct RunRecorder
+//    refMeasure: the reference of the measure to delete
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+static void DeleteMeasureLocal(
+  struct RunRecorder* const that,
+                 long const refMeasure);
+
+// Delete a measure through the Web API
+// Inputs:
+//          that: the struct RunRecorder
+//    refMeasure: the reference of the measure to delete
+static void DeleteMeasureAPI(
+  struct RunRecorder* const that,
+                 long const refMeasure);
+
+// Delete several measures in a local database, in one single transaction
+// if there is no opened session
+// Inputs:
+//          that: the struct RunRecorder
+//   refMeasures: the references of the measures to delete
+//     nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+static void DeleteMeasuresLocal(
+  struct RunRecorder* const that,
+           long const* const refMeasures,
+                 long const nbMeasure);
+
+// Delete several measures through the Web API
+// Inputs:
+//          that: the struct RunRecorder
+//   refMeasures: the references of the measures to delete
+//     nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static void DeleteMeasuresAPI(
+  struct RunRecorder* const that,
+           long const* const refMeasures,
+                 long const nbMeasure);
+
+// Delete the measures whose reference is in [fromRef, toRef] in a local
+// database, in one single transaction if there is no opened session
+// Inputs:
+//      that: the struct RunRecorder
+//   fromRef: the first reference to delete
+//     toRef: the last reference to delete
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+static void DeleteMeasuresByRefLocal(
+  struct RunRecorder* const that,
+                 long const fromRef,
+                 long const toRef);
+
+// Delete the measures whose reference is in [fromRef, toRef] through the
+// Web API
+// Inputs:
+//      that: the struct RunRecorder
+//   fromRef: the first reference to delete
+//     toRef: the last reference to delete
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static void DeleteMeasuresByRefAPI(
+  struct RunRecorder* const that,
+                 long const fromRef,
+                 long const toRef);
+
+// Delete the measures of a project recorded in [fromDate, toDate[ in a
+// local database, in one single transaction if there is no opened session
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+static void DeleteMeasuresByDateLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate);
+
+// Delete the measures of a project recorded in [fromDate, toDate[ through
+// the Web API
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static void DeleteMeasuresByDateAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate);
+
+// Set the retention policy of a project in a local database
+// Inputs:
+//           that: the struct RunRecorder
+//        project: the project's name
+//         maxAge: the maximum age of the measures in seconds, 0 for no
+//                 limit
+//   maxNbMeasure: the maximum number of measures, 0 for no limit
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+//   RunRecorderExc_RetentionFailed
+static void SetRetentionLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const maxAge,
+                 long const maxNbMeasure);
+
+// Set the retention policy of a project through the Web API
+// Inputs:
+//           that: the struct RunRecorder
+//        project: the project's name
+//         maxAge: the maximum age of the measures in seconds, 0 for no
+//                 limit
+//   maxNbMeasure: the maximum number of measures, 0 for no limit
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static void SetRetentionAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const maxAge,
+                 long const maxNbMeasure);
+
+// Apply the retention policy of a project in a local database
+// Inputs:
+//         that: the struct RunRecorder
+//   refProject: the reference of the project
+// Output:
+//   Return the number of deleted measures
+// Raise:
+//   RunRecorderExc_RetentionFailed
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+static long ApplyRetentionProjectLocal(
+  struct RunRecorder* const that,
+                 long const refProject);
+
+// Apply the retention policy of all the projects in a local database
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the number of deleted measures
+// Raise:
+//   RunRecorderExc_RetentionFailed
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+static long ApplyRetentionLocal(
+  struct RunRecorder* const that);
+
+// Apply the retention policy of all the projects through the Web API
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the number of deleted measures
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static long ApplyRetentionAPI(
+  struct RunRecorder* const that);
+
+// Execute the SQL command in that->cmd on a local database and get the
+// returned rows as a struct RunRecorderMeasures. The numeric values are
+// memorised in their native type in addition to their string.
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the measures as a struct RunRecorderMeasures
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderMeasures* GetMeasuresOfCmdLocal(
+  struct RunRecorder* const that);
+
+// Helper function to commonalize code between GetMeasures and
+// GetLastMeasures
+// Inputs:
+//        that: the struct RunRecorder
+//     project: the project's name
+//   nbMeasure: the number of measures returned, if 0 all measures are
+//              returned
+// Output:
+//   Set the SQL command in that->cmd to get measures as a struct
+//    RunRecorderMeasures
+static void SetCmdToGetMeasuresLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const nbMeasure);
+
+// Set the SQL command in that->cmd to get the measures of a project
+// given its metrics
+// Inputs:
+//        that: the struct RunRecorder
+//     project: the project's name
+//     metrics: the metrics of the project
+//   nbMeasure: the number of measures returned, if 0 all measures are
+//              returned
+static void SetCmdToGetMeasuresOfMetricsLocal(
+                struct RunRecorder* const that,
+                        char const* const project,
+  struct RunRecorderRefValDef const* const metrics,
+                               long const nbMeasure);
+
+// Restrict the SQL command in that->cmd, created by
+// SetCmdToGetMeasuresLocal with no limit, to a period of time
+// Inputs:
+//       that: the struct RunRecorder
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+static void AppendCmdInRangeLocal(
+  struct RunRecorder* const that,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit);
+
+// Get the measures of a project from a local database
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project's name
 // Output:
-//   Return a pointer to the end of the row
-static char const* SplitCSVRowToData(
-   char const* const csv,
-        char** const tgt,
-          char const sep);
+//   Return the measures as a struct RunRecorderMeasures
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderMeasures* GetMeasuresLocal(
+  struct RunRecorder* const that,
+          char const* const project);
 
 // Convert CSV data to a new struct RunRecorderMeasures. The CSV data are
 // expected to be formatted as:
@@ -642,38 +1859,675 @@ static struct RunRecorderMeasures* GetLastMeasuresAPI(
           char const* const project,
                  long const nbMeasure);
 
-// Create a struct RunRecorderMeasures
+// Get the measures of a project in a period of time from a local
+// database
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
 // Output:
-//   Return the dynamically allocated struct RunRecorderMeasures
-static struct RunRecorderMeasures* RunRecorderMeasuresCreate(
-  void);
+//   Return the measures as a struct RunRecorderMeasures, ordered from the
+//   oldest to the most recent
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderMeasures* GetMeasuresInRangeLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit);
 
-// Remove a project from a local database
+// Get the measures of a project in a period of time through the Web API
 // Inputs:
-//         that: the struct RunRecorder
-//      project: the project's name
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a struct RunRecorderMeasures, ordered from the
+//   oldest to the most recent
+static struct RunRecorderMeasures* GetMeasuresInRangeAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit);
+
+// Get the measures of a project added after a given measure from a
+// local database
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   refSince: the reference of the last measure already read
+// Output:
+//   Return the measures as a struct RunRecorderMeasures, ordered by
+//   reference
 // Raise:
-//   RunRecorderExc_FlushProjectFailed
-static void FlushProjectLocal(
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderMeasures* GetMeasuresSinceLocal(
   struct RunRecorder* const that,
-          char const* const project);
+          char const* const project,
+                 long const refSince);
 
-// Remove a project through the Web API
+// Get the measures of a project added after a given measure through the
+// Web API
 // Inputs:
-//         that: the struct RunRecorder
-//      project: the project's name
-static void FlushProjectAPI(
+//       that: the struct RunRecorder
+//    project: the project's name
+//   refSince: the reference of the last measure already read
+// Output:
+//   Return the measures as a struct RunRecorderMeasures, ordered by
+//   reference
+static struct RunRecorderMeasures* GetMeasuresSinceAPI(
   struct RunRecorder* const that,
-          char const* const project);
+          char const* const project,
+                 long const refSince);
 
-// Function to convert a RunRecorder exception ID to char*
+// Split a row of CSV data in place, replacing the separators with '\0'
+// Inputs:
+//     row: the row, without its line return
+//     tgt: the array where to memorise the pointers to the columns, or
+//          NULL to only count the columns (the row is then unchanged)
+//   nbCol: the size of tgt
+//     sep: the separator between columns
+// Output:
+//   Return the number of columns in the row
+static long SplitCSVRowInPlace(
+  char* const row,
+  char** const tgt,
+   long const nbCol,
+   char const sep);
+
+// Callback to memorise the incoming data from the Web API for a cursor.
+// The transfer is paused while the buffer contains a row not read yet,
+// so the buffer never holds more than one row and one chunk of data.
 // Input:
-//   exc: the exception ID
+//    data: incoming data
+//    size: always 1
+//   nmemb: number of incoming byte
+//     ptr: the struct RunRecorderMeasuresCursor
 // Output:
-//   Return a pointer to a static string describing the exception, or
-//   NULL if the ID is not one of RunRecorderException
-static char const* ExcToStr(
-  int exc);
+//   Return the number of received byte, CURL_WRITEFUNC_PAUSE to pause
+//   the transfer, or 0 to abort it if the memory allocation failed
+static size_t GetReplyCursorAPI(
+   char* data,
+  size_t size,
+  size_t nmemb,
+   void* ptr);
+
+// Receive data from the Web API for a cursor until its buffer contains
+// a complete row not read yet, or the transfer is completed
+// Input:
+//   that: the struct RunRecorderMeasuresCursor
+// Output:
+//   Return a pointer to the line return at the end of the row in the
+//   buffer, or NULL if there is no more row
+// Raise:
+//   RunRecorderExc_CurlRequestFailed
+static char* FillCursorBufferAPI(
+  struct RunRecorderMeasuresCursor* const that);
+
+// Open a cursor on the measures of a project in a local database
+// Inputs:
+//      that: the struct RunRecorderMeasuresCursor
+//   project: the project's name
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static void OpenCursorLocal(
+  struct RunRecorderMeasuresCursor* const that,
+                        char const* const project);
+
+// Open a cursor on the measures of a project through the Web API. The
+// CSV reply of the Web API is received and parsed as the measures are
+// read.
+// Inputs:
+//      that: the struct RunRecorderMeasuresCursor
+//   project: the project's name
+// Raise:
+//   RunRecorderExc_CreateCurlFailed
+//   RunRecorderExc_CurlSetOptFailed
+//   RunRecorderExc_CurlRequestFailed
+//   RunRecorderExc_ApiRequestFailed
+static void OpenCursorAPI(
+  struct RunRecorderMeasuresCursor* const that,
+                        char const* const project);
+
+// Move a cursor on the measures of a local database to the next measure
+// Input:
+//   that: the struct RunRecorderMeasuresCursor
+// Output:
+//   Return true if there is a next measure, else false
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static bool NextCursorLocal(
+  struct RunRecorderMeasuresCursor* const that);
+
+// Move a cursor on the measures through the Web API to the next measure
+// Input:
+//   that: the struct RunRecorderMeasuresCursor
+// Output:
+//   Return true if there is a next measure, else false
+// Raise:
+//   RunRecorderExc_CurlRequestFailed
+//   RunRecorderExc_ApiRequestFailed
+static bool NextCursorAPI(
+  struct RunRecorderMeasuresCursor* const that);
+
+// Set the value of a metric in a struct RunRecorderMeasure, adding the
+// metric if it is not yet in the measure
+// Input:
+//     that: the struct RunRecorderMeasure
+//   metric: the value's metric
+//      val: the value as a string
+//     type: the type of the value
+//      num: the numeric value, used according to type
+static void MeasureSetValue(
+   struct RunRecorderMeasure* const that,
+                  char const* const metric,
+                  char const* const val,
+   enum RunRecorderMetricType const type,
+      union RunRecorderNumVal const num);
+
+// Create a struct RunRecorderMeasures
+// Output:
+//   Return the dynamically allocated struct RunRecorderMeasures
+static struct RunRecorderMeasures* RunRecorderMeasuresCreate(
+  void);
+
+// Allocate memory in a chain of struct RunRecorderArenaBlock
+// Inputs:
+//   arena: the chain of blocks
+//    size: the number of byte to allocate
+// Output:
+//   Return a pointer to the allocated memory, it stays valid until the
+//   chain of blocks is freed
+// Raise:
+//   TryCatchExc_MallocFailed
+static char* ArenaAlloc(
+  struct RunRecorderArenaBlock** const arena,
+                          size_t const size);
+
+// Copy a string in a chain of struct RunRecorderArenaBlock
+// Inputs:
+//   arena: the chain of blocks
+//     str: the string to copy
+// Output:
+//   Return the copy of the string, or NULL if str is NULL
+// Raise:
+//   TryCatchExc_MallocFailed
+static char* ArenaStrDup(
+  struct RunRecorderArenaBlock** const arena,
+                     char const* const str);
+
+// Free a chain of struct RunRecorderArenaBlock
+// Input:
+//   arena: the chain of blocks
+static void ArenaFree(
+  struct RunRecorderArenaBlock** const arena);
+
+// Allocate memory for a given number of measures in a struct
+// RunRecorderMeasures, its nbMetric must be set
+// Inputs:
+//       that: the struct RunRecorderMeasures
+//   capacity: the number of measures
+// Raise:
+//   TryCatchExc_MallocFailed
+static void MeasuresReserve(
+  struct RunRecorderMeasures* const that,
+                         long const capacity);
+
+// Add a measure at the end of a struct RunRecorderMeasures, its
+// nbMetric must be set. The capacity is doubled when it is reached.
+// Input:
+//   that: the struct RunRecorderMeasures
+// Output:
+//   Return the array of values of the new measure, uninitialised
+// Raise:
+//   TryCatchExc_MallocFailed
+static char** MeasuresAddRow(
+  struct RunRecorderMeasures* const that);
+
+// Get the measures of a project by column from a local database
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+// Output:
+//   Return the measures as a struct RunRecorderColumns
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderColumns* GetColumnsLocal(
+  struct RunRecorder* const that,
+          char const* const project);
+
+// Get the measures of a project in a period of time by column from a
+// local database
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a struct RunRecorderColumns, ordered from the
+//   oldest to the most recent
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderColumns* GetColumnsInRangeLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit);
+
+// Execute the SQL command in that->cmd on a local database and get the
+// returned rows as a struct RunRecorderColumns. The numeric values are
+// copied in the columns without conversion to a string.
+// Inputs:
+//      that: the struct RunRecorder
+//   metrics: the metrics of the project, giving the type of the columns
+// Output:
+//   Return the measures as a struct RunRecorderColumns
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderColumns* GetColumnsOfCmdLocal(
+                struct RunRecorder* const that,
+  struct RunRecorderRefValDef const* const metrics);
+
+// Get the measures of a project by column through the Web API
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+// Output:
+//   Return the measures as a struct RunRecorderColumns
+static struct RunRecorderColumns* GetColumnsAPI(
+  struct RunRecorder* const that,
+          char const* const project);
+
+// Get the measures of a project in a period of time by column through
+// the Web API
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a struct RunRecorderColumns, ordered from the
+//   oldest to the most recent
+static struct RunRecorderColumns* GetColumnsInRangeAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit);
+
+// Send the request in that->cmd to the Web API and convert its CSV reply
+// to a struct RunRecorderColumns
+// Inputs:
+//      that: the struct RunRecorder
+//   metrics: the metrics of the project, giving the type of the columns
+// Output:
+//   Return the measures as a struct RunRecorderColumns
+static struct RunRecorderColumns* GetColumnsOfReqAPI(
+                struct RunRecorder* const that,
+  struct RunRecorderRefValDef const* const metrics);
+
+// Convert CSV data, formatted as for CSVToData, to a new struct
+// RunRecorderColumns. The CSV data are split in place.
+// Inputs:
+//       csv: the CSV data
+//       sep: the separator between columns
+//   metrics: the metrics of the project, giving the type of the columns
+// Output:
+//   Return a newly allocated struct RunRecorderColumns
+static struct RunRecorderColumns* CSVToColumns(
+                              char* const csv,
+                               char const sep,
+  struct RunRecorderRefValDef const* const metrics);
+
+// Create a struct RunRecorderColumns with no measure
+// Inputs:
+//     labels: the labels of the columns
+//   nbMetric: the number of columns
+//    metrics: the metrics of the project, giving the type of the columns.
+//             'Ref' and 'DateMeasure' are integers, and the columns
+//             without metric are text
+// Output:
+//   Return the dynamically allocated struct RunRecorderColumns
+static struct RunRecorderColumns* RunRecorderColumnsCreate(
+                char const* const* const labels,
+                               long const nbMetric,
+  struct RunRecorderRefValDef const* const metrics);
+
+// Allocate memory for a given number of measures in a struct
+// RunRecorderColumns
+// Inputs:
+//       that: the struct RunRecorderColumns
+//   capacity: the number of measures
+// Raise:
+//   TryCatchExc_MallocFailed
+static void ColumnsReserve(
+  struct RunRecorderColumns* const that,
+                        long const capacity);
+
+// Add a measure at the end of a struct RunRecorderColumns. The capacity
+// is doubled when it is reached.
+// Input:
+//   that: the struct RunRecorderColumns
+// Output:
+//   Return the index of the new measure, its values are uninitialised and
+//   invalid
+// Raise:
+//   TryCatchExc_MallocFailed
+static long ColumnsAddRow(
+  struct RunRecorderColumns* const that);
+
+// Set a value of a struct RunRecorderColumns from its string, converted
+// to the type of the column
+// Inputs:
+//       that: the struct RunRecorderColumns
+//    iMetric: the index of the column
+//   iMeasure: the index of the measure
+//        str: the value, NULL for a null value
+// Raise:
+//   TryCatchExc_MallocFailed
+static void ColumnsSetValueStr(
+  struct RunRecorderColumns* const that,
+                        long const iMetric,
+                        long const iMeasure,
+                 char const* const str);
+
+// Set a value of a struct RunRecorderColumns from a column of the current
+// row of a SQL request
+// Inputs:
+//       that: the struct RunRecorderColumns
+//    iMetric: the index of the column, in the columns and in the request
+//   iMeasure: the index of the measure
+//       stmt: the SQL request
+// Raise:
+//   TryCatchExc_MallocFailed
+static void ColumnsSetValueLocal(
+  struct RunRecorderColumns* const that,
+                        long const iMetric,
+                        long const iMeasure,
+                sqlite3_stmt* const stmt);
+
+// Get the index of a string in the dictionary of a text column of a
+// struct RunRecorderColumns, adding it if it is not yet in the dictionary
+// Inputs:
+//     that: the struct RunRecorderColumns
+//   column: the column
+//      str: the string
+// Output:
+//   Return the index of the string in the dictionary
+// Raise:
+//   TryCatchExc_MallocFailed
+static long ColumnDictAdd(
+  struct RunRecorderColumns* const that,
+    struct RunRecorderColumn* const column,
+                 char const* const str);
+
+// Hash a string (FNV-1a)
+// Input:
+//   str: the string
+// Output:
+//   Return the hash of the string
+static unsigned long long HashStr(
+  char const* const str);
+
+// Check a metric exists in a project of a local database
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+//    metric: the metric's label
+// Raise:
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_SQLRequestFailed
+static void CheckMetricLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+          char const* const metric);
+
+// Aggregate the values of a metric of a project in a period of time in a
+// local database
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+// Output:
+//   Return the aggregated value
+// Raise:
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_SQLRequestFailed
+static double AggregateLocal(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate);
+
+// Aggregate the values of a metric of a project in a period of time
+// through the Web API
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+// Output:
+//   Return the aggregated value
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static double AggregateAPI(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate);
+
+// Aggregate the values of a metric of a project in a period of time, per
+// interval of time, in a local database
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//   interval: the duration of the intervals in seconds
+// Output:
+//   Return the aggregated values as a struct RunRecorderAggregates
+// Raise:
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderAggregates* AggregateByIntervalLocal(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate,
+                         long const interval);
+
+// Aggregate the values of a metric of a project in a period of time, per
+// interval of time, through the Web API
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//   interval: the duration of the intervals in seconds
+// Output:
+//   Return the aggregated values as a struct RunRecorderAggregates
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static struct RunRecorderAggregates* AggregateByIntervalAPI(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate,
+                         long const interval);
+
+// Create a struct RunRecorderAggregates
+// Output:
+//   Return the dynamically allocated struct RunRecorderAggregates
+static struct RunRecorderAggregates* RunRecorderAggregatesCreate(
+  void);
+
+// Add an interval at the end of a struct RunRecorderAggregates. The
+// capacity is doubled when it is reached.
+// Inputs:
+//    that: the struct RunRecorderAggregates
+//    date: the start date of the interval
+//     val: the aggregated value of the interval
+// Raise:
+//   TryCatchExc_MallocFailed
+static void AggregatesAdd(
+  struct RunRecorderAggregates* const that,
+                         time_t const date,
+                         double const val);
+
+// Get a column of the current row of a SQL request as a double
+// Inputs:
+//   stmt: the SQL request
+//   iCol: the index of the column
+// Output:
+//   Return the value, or NAN if it's not a number
+static double GetStmtColumnDouble(
+  sqlite3_stmt* const stmt,
+            int const iCol);
+
+// Remove a project from a local database
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project's name
+// Raise:
+//   RunRecorderExc_FlushProjectFailed
+static void FlushProjectLocal(
+  struct RunRecorder* const that,
+          char const* const project);
+
+// Remove a project through the Web API
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project's name
+static void FlushProjectAPI(
+  struct RunRecorder* const that,
+          char const* const project);
+
+// Release free pages of a local database
+// Inputs:
+//     that: the struct RunRecorder
+//   budget: the maximum number of pages to release, if <= 0 all the
+//           free pages are released
+// Output:
+//   Return the number of free pages remaining after the call
+// Raise:
+//   RunRecorderExc_CompactFailed
+static long CompactLocal(
+  struct RunRecorder* const that,
+                 long const budget);
+
+// Release free pages of the database through the Web API
+// Inputs:
+//     that: the struct RunRecorder
+//   budget: the maximum number of pages to release, if <= 0 all the
+//           free pages are released
+// Output:
+//   Return the number of free pages remaining after the call
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static long CompactAPI(
+  struct RunRecorder* const that,
+                 long const budget);
+
+// Function to convert a RunRecorder exception ID to char*
+// Input:
+//   exc: the exception ID
+// Output:
+//   Return a pointer to a static string describing the exception, or
+//   NULL if the ID is not one of RunRecorderException
+static char const* ExcToStr(
+  int exc);
+
+// Migration step of the database from one version to the next one
+struct MigrationStep {
+
+  // Version the step applies to
+  char const* from;
+
+  // Version of the database after the step
+  char const* to;
+
+  // SQL commands of the step, executed in one single transaction with
+  // the update of the version
+  char const* sql;
+
+  // SQL commands of the step which can't be executed in a transaction
+  // (like VACUUM), or NULL. They are executed before the transaction and
+  // must be harmless if executed again after a failure of the step.
+  char const* sqlNoTransaction;
+
+};
+
+// Migration steps of the database, applied in sequence by UpgradeDb
+// until the database reaches VERSION_DB. The views of the projects are
+// recreated, and the dates in the materialized tables updated, after the
+// last step as they depend on the version.
+static struct MigrationStep const migrations[NB_MIGRATION] = {
+
+  // Add the indexes
+  {"01.00.00", "01.01.00", SQL_CREATE_INDEXES, NULL},
+
+  // Inline the default values in the views of the projects
+  {"01.01.00", "01.02.00", "", NULL},
+
+  // Add the flag for the materialized table of the projects
+  {"01.02.00", "01.03.00",
+   "ALTER TABLE _Project "
+   "ADD COLUMN Materialized INTEGER NOT NULL DEFAULT 0", NULL},
+
+  // Switch to incremental vacuum, which requires to rebuild the database
+  // once
+  {"01.03.00", "01.04.00", "", SQL_AUTO_VACUUM ";VACUUM"},
+
+  // Convert the dates of the measures to a format sorting in
+  // chronological order
+  {"01.04.00", "01.05.00", SQL_MIGRATE_DATE_MEASURE, NULL},
+
+  // Add the retention policy of the projects
+  {"01.05.00", "01.06.00",
+   "ALTER TABLE _Project "
+   "ADD COLUMN RetentionAge INTEGER NOT NULL DEFAULT 0;"
+   "ALTER TABLE _Project "
+   "ADD COLUMN RetentionCount INTEGER NOT NULL DEFAULT 0", NULL},
+
+  // Convert the dates of the measures to integers, faster to compare and
+  // index than strings
+  {"01.06.00", "01.07.00", SQL_MIGRATE_DATE_MEASURE_EPOCH, NULL},
+
+  // Add the type of the metrics and store the numeric values as native
+  // INTEGER or REAL
+  {"01.07.00", "01.08.00", SQL_MIGRATE_TYPED_VALUES, NULL},
+
+};
 
 // ================== Public functions definition =========================
 
@@ -697,6 +2551,17 @@ struct RunRecorder RunRecorderCreate(
   that.cmd = NULL;
   that.sqliteErrMsg = NULL;
   that.refLastAddedMeasure = 0;
+  that.isInSession = false;
+  that.keepAliveIdle = KEEP_ALIVE_IDLE;
+  that.keepAliveInterval = KEEP_ALIVE_INTERVAL;
+  that.options = RunRecorderOptionsCreate();
+  that.async = NULL;
+  that.spool = NULL;
+  that.refLastSpooledMeasure = 0;
+  that.dateBusy = 0;
+  that.nbBusyRetry = 0;
+  that.pool = NULL;
+  ForZeroTo(iStmt, RunRecorderStmt_nb) that.stmts[iStmt] = NULL;
 
   // Copy the url
   SafeStrDup(
@@ -730,6 +2595,50 @@ struct RunRecorder* RunRecorderAlloc(
 
 }
 
+// Allocate memory for a struct RunRecorder with given options for the
+// connection to a local database
+// Inputs:
+//       url: Path to the SQLite database or Web API
+//   options: the options
+// Output:
+//  Return a new struct RunRecorder
+struct RunRecorder* RunRecorderAllocWithOptions(
+                 char const* const url,
+  struct RunRecorderOptions const* const options) {
+
+  // Allocate the struct RunRecorder and set its options
+  struct RunRecorder* that = RunRecorderAlloc(url);
+  that->options = *options;
+
+  // Return the struct RunRecorder
+  return that;
+
+}
+
+// Create a struct RunRecorderOptions with the default of SQLite for all
+// the options, except the busy timeout (5s) and backoff (100ms)
+// Output:
+//  Return a new struct RunRecorderOptions
+struct RunRecorderOptions RunRecorderOptionsCreate(
+  void) {
+
+  // Variable to memorise the new struct RunRecorderOptions
+  struct RunRecorderOptions that;
+
+  // Initialise the properties
+  that.journalMode = RunRecorderJournalMode_default;
+  that.synchronous = RunRecorderSynchronous_default;
+  that.cacheSize = 0;
+  that.mmapSize = 0;
+  that.pageSize = 0;
+  that.busyTimeout = BUSY_TIMEOUT;
+  that.busyBackoff = BUSY_BACKOFF;
+
+  // Return the struct RunRecorderOptions
+  return that;
+
+}
+
 // Initialise a struct RunRecorder
 // Input:
 //   that: The struct RunRecorder
@@ -751,19 +2660,8 @@ void RunRecorderInit(
   // eventual previous messages
   FreeErrMsg(that);
 
-  // If the recorder doesn't use the API
-  if (UsesAPI(that) == false) {
-
-    // Init the local connection to the database
-    InitLocal(that);
-
-  // Else, the recorder uses the API
-  } else {
-
-    // Init the Web API
-    InitWebAPI(that);
-
-  }
+  // Init the connection to the local database or Web API
+  InitConnection(that);
 
   // If the version of the database is different from the last version
   // upgrade the database
@@ -786,6 +2684,13 @@ void RunRecorderFree(
   // If it's already freed, nothing to do
   if (that == NULL || *that == NULL) return;
 
+  // Stop the asynchronous writer if any, it writes the queued measures
+  // before ending
+  RunRecorderAsyncFree(&((*that)->async));
+
+  // Stop the spool if any
+  RunRecorderSpoolFree(&((*that)->spool));
+
   // Free memory used by the properties
   free((*that)->url);
   free((*that)->errMsg);
@@ -793,16 +2698,16 @@ void RunRecorderFree(
   free((*that)->curlReply);
   free((*that)->cmd);
 
+  // Finalize the cached statements, they must be finalized before the
+  // connection to the database can be closed
+  ForZeroTo(iStmt, RunRecorderStmt_nb) sqlite3_finalize((*that)->stmts[iStmt]);
+
   // Close the connection to the local database if it was opened
   if ((*that)->db != NULL) sqlite3_close((*that)->db);
 
-  // Clean up the curl instance if it was created
-  if ((*that)->curl != NULL) {
-
-    curl_easy_cleanup((*that)->curl);
-    curl_global_cleanup();
-
-  }
+  // Release the curl instance if it was created, it is kept with its open
+  // connection for the next struct RunRecorder
+  if ((*that)->curl != NULL) ReleaseCurl((*that)->curl);
 
   // Free memory used by the RunRecorder
   free(*that);
@@ -810,9 +2715,38 @@ void RunRecorderFree(
 
 }
 
-// Get the version of the database
-// Input:
-//   that: the struct RunRecorder
+// Set the TCP keep-alive of the connection to the Web API. Probes are
+// sent on the idle connection to keep it open between requests (by
+// default after 60s, then every 30s). Can be called before or after
+// RunRecorderInit, has no effect on a local database.
+// Inputs:
+//       that: the struct RunRecorder
+//       idle: the delay in seconds before the first probe, 0 to disable
+//             the probes
+//   interval: the delay in seconds between probes
+// Raise:
+//   RunRecorderExc_CurlSetOptFailed
+void RunRecorderSetKeepAlive(
+  struct RunRecorder* const that,
+                 long const idle,
+                 long const interval) {
+
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
+
+  // Memorise the delays
+  that->keepAliveIdle = idle;
+  that->keepAliveInterval = interval;
+
+  // If the Web API is already initialised, apply them
+  if (that->curl != NULL) SetCurlKeepAlive(that);
+
+}
+
+// Get the version of the database
+// Input:
+//   that: the struct RunRecorder
 // Output:
 //   Return the version as a new string
 char* RunRecorderGetVersion(
@@ -1010,8 +2944,9 @@ struct RunRecorderRefValDef* RunRecorderGetMetrics(
 //        label: the label of the metric, it must respect the following
 //               pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
 //               There cannot be two metrics with the same label for the
-//               same project. A metric label can't be 'action' or 'project'
-//               (case sensitive, so 'Action' is fine).
+//               same project. A metric label can't be 'action',
+//               'project' or 'DateMeasure' (case sensitive, so 'Action' is
+//               fine).
 //   defaultVal: the default value of the metric, it must respect the
 //               following pattern: /^[^"=&]+$*/
 // Raise:
@@ -1024,6 +2959,40 @@ void RunRecorderAddMetric(
           char const* const label,
           char const* const defaultVal) {
 
+  // Add the metric as a text metric
+  RunRecorderAddTypedMetric(
+    that,
+    project,
+    label,
+    defaultVal,
+    RunRecorderMetricType_text);
+
+}
+
+// Add a metric with a given type to a project. The values of numeric
+// metrics are stored as native SQLite INTEGER or REAL, RunRecorderAddMetric
+// adds a RunRecorderMetricType_text metric.
+// Input:
+//         that: the struct RunRecorder
+//      project: the name of the project to which add to the metric
+//        label: the label of the metric, same constraints as for
+//               RunRecorderAddMetric
+//   defaultVal: the default value of the metric, same constraints as for
+//               RunRecorderAddMetric, and it must be a number if the
+//               metric is numeric
+//         type: the type of the values of the metric
+// Raise:
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_InvalidMetricDefVal
+//   RunRecorderExc_InvalidMetricType
+//   RunRecorderExc_MetricNameAlreadyUsed
+void RunRecorderAddTypedMetric(
+             struct RunRecorder* const that,
+                     char const* const project,
+                     char const* const label,
+                     char const* const defaultVal,
+  enum RunRecorderMetricType const type) {
+
   // Ensure the error messages are freed to avoid confusion with
   // eventual previous messages
   FreeErrMsg(that);
@@ -1043,6 +3012,11 @@ void RunRecorderAddMetric(
       label,
       "project");
   if (retCmp == 0) Raise(RunRecorderExc_InvalidMetricLabel);
+  retCmp =
+    strcmp(
+      label,
+      "DateMeasure");
+  if (retCmp == 0) Raise(RunRecorderExc_InvalidMetricLabel);
 
   // Check if there is no other metric with same label for this project
   struct RunRecorderRefValDef* metrics =
@@ -1056,8 +3030,29 @@ void RunRecorderAddMetric(
   PolyFree(&metrics);
   if (alreadyUsed == true) Raise(RunRecorderExc_MetricNameAlreadyUsed);
 
-  // Check the default value
+  // Check the type
+  if (type < 0 || type >= RunRecorderMetricType_nb)
+    Raise(RunRecorderExc_InvalidMetricType);
+
+  // Check the default value, it must be a number for numeric metrics
   bool isValidDefVal = RunRecorderIsValidValue(defaultVal);
+  if (isValidDefVal == true && type == RunRecorderMetricType_int) {
+
+    long val = 0;
+    isValidDefVal =
+      StrToLong(
+        defaultVal,
+        &val);
+
+  } else if (isValidDefVal == true && type == RunRecorderMetricType_double) {
+
+    double val = 0.0;
+    isValidDefVal =
+      StrToDouble(
+        defaultVal,
+        &val);
+
+  }
   if (isValidDefVal == false) Raise(RunRecorderExc_InvalidMetricDefVal);
 
   // If the RunRecorder uses a local database
@@ -1067,7 +3062,8 @@ void RunRecorderAddMetric(
       that,
       project,
       label,
-      defaultVal);
+      defaultVal,
+      type);
 
   // Else, the RunRecorder uses the Web API
   } else {
@@ -1076,7 +3072,8 @@ void RunRecorderAddMetric(
       that,
       project,
       label,
-      defaultVal);
+      defaultVal,
+      type);
 
   }
 
@@ -1098,6 +3095,8 @@ struct RunRecorderMeasure* RunRecorderMeasureCreate(
   measure->nbMetric = 0;
   measure->metrics = NULL;
   measure->values = NULL;
+  measure->types = NULL;
+  measure->nums = NULL;
 
   // Return the new struct RunRecorderMeasure
   return measure;
@@ -1124,6 +3123,8 @@ void RunRecorderMeasureFree(
   // Free memory
   free((*that)->metrics);
   free((*that)->values);
+  free((*that)->types);
+  free((*that)->nums);
   free(*that);
   *that = NULL;
 
@@ -1146,56 +3147,14 @@ void RunRecorderMeasureAddValueStr(
   if (RunRecorderIsValidValue(val) == false)
     Raise(RunRecorderExc_InvalidValue);
 
-  // Flag to memorise if the metric is already present in the measure
-  bool flagAlreadyHere = false;
-
-  // Loop on the metric
-  ForZeroTo(iMetric, that->nbMetric) {
-
-    // If this is the requested metric, return the value
-    int retCmp =
-      strcmp(
-        that->metrics[iMetric],
-        metric);
-    if (retCmp == 0) {
-
-      // Replace the value
-      SafeStrDup(
-        that->values[iMetric],
-        val);
-
-      // Update the flag to memorise the metric is already in the measure
-      flagAlreadyHere = true;
-
-    }
-
-  }
-
-  // If the metric wasn't already in the measure
-  if (flagAlreadyHere == false) {
-
-    // Reallocate memory for the added value and its metric
-    SafeRealloc(
-      that->metrics,
-      sizeof(char*) * (that->nbMetric + 1));
-    SafeRealloc(
-      that->values,
-      sizeof(char*) * (that->nbMetric + 1));
-    that->metrics[that->nbMetric] = NULL;
-    that->values[that->nbMetric] = NULL;
-
-    // Update the number of metric in the measure
-    ++(that->nbMetric);
-
-    // Copy the value and its metric in the measure
-    SafeStrDup(
-      that->metrics[that->nbMetric - 1],
-      metric);
-    SafeStrDup(
-      that->values[that->nbMetric - 1],
-      val);
-
-  }
+  // Set the value, with no numeric value
+  union RunRecorderNumVal num = {.i = 0};
+  MeasureSetValue(
+    that,
+    metric,
+    val,
+    RunRecorderMetricType_text,
+    num);
 
 }
 
@@ -1211,43 +3170,28 @@ void RunRecorderMeasureAddValueInt(
                         long const val) {
 
   // Convert the value to a string
-  int lenStr =
-    snprintf(
-      NULL,
-      0,
-      "%ld",
-      val);
-  char* str = NULL;
-  SafeMalloc(
-    str,
-    lenStr + 1);
-  sprintf(
+  char str[LENGTH_NUM_STR];
+  snprintf(
     str,
+    LENGTH_NUM_STR,
     "%ld",
     val);
 
-  // Add the value
-  Try {
-
-    RunRecorderMeasureAddValueStr(
-      that,
-      metric,
-      str);
-
-    // Free memory
-    free(str);
-
-  } CatchDefault {
-
-    free(str);
-    Raise(TryCatchGetLastExc());
-
-  } EndCatch;
+  // Set the value and its numeric value
+  union RunRecorderNumVal num = {.i = val};
+  MeasureSetValue(
+    that,
+    metric,
+    str,
+    RunRecorderMetricType_int,
+    num);
 
 }
 
 // Add a double value to a struct RunRecorderMeasure if there is not yet a
-// value for the metric, or replace its value else
+// value for the metric, or replace its value else. The value is kept as
+// it is for numeric metrics, and converted to a string with enough digits
+// to convert back exactly for text metrics and the Web API.
 // Input:
 //     that: the struct RunRecorderMeasure
 //   metric: the value's metric
@@ -1258,38 +3202,19 @@ void RunRecorderMeasureAddValueDouble(
                       double const val) {
 
   // Convert the value to a string
-  int lenStr =
-    snprintf(
-      NULL,
-      0,
-      "%lf",
-      val);
-  char* str = NULL;
-  SafeMalloc(
-    str,
-    lenStr + 1);
-  sprintf(
+  char str[LENGTH_NUM_STR];
+  FormatDouble(
+    val,
+    str);
+
+  // Set the value and its numeric value
+  union RunRecorderNumVal num = {.d = val};
+  MeasureSetValue(
+    that,
+    metric,
     str,
-    "%lf",
-    val);
-
-  // Add the value
-  Try {
-
-    RunRecorderMeasureAddValueStr(
-      that,
-      metric,
-      str);
-
-    // Free memory
-    free(str);
-
-  } CatchDefault {
-
-    free(str);
-    Raise(TryCatchGetLastExc());
-
-  } EndCatch;
+    RunRecorderMetricType_double,
+    num);
 
 }
 
@@ -1310,1849 +3235,2585 @@ void RunRecorderAddMeasure(
   // eventual previous messages
   FreeErrMsg(that);
 
-  // If the RunRecorder uses a local database
-  if (UsesAPI(that) == false) {
+  // If the asynchronous writing is started, queue the measure
+  if (that->async != NULL) {
 
-    AddMeasureLocal(
+    long const nbMeasure = 1;
+    AddMeasuresAsync(
       that,
       project,
-      measure);
+      &measure,
+      nbMeasure);
 
-  // Else, the RunRecorder uses the Web API
-  } else {
+  // Else, if the measures are spooled, send or spool the measure
+  } else if (that->spool != NULL) {
 
-    AddMeasureAPI(
+    long const nbMeasure = 1;
+    AddMeasuresSpool(
       that,
       project,
-      measure);
+      &measure,
+      nbMeasure);
 
-  }
+  // Else, if the RunRecorder uses a local database
+  } else if (UsesAPI(that) == false) {
 
-}
+    // Open a handle on the project to resolve the metrics once for all
+    // the values
+    struct RunRecorderProject* handle =
+      RunRecorderOpenProject(
+        that,
+        project);
 
-// Delete a measure
-// Inputs:
-//          that: the struct RunRecorder
-//    refMeasure: the reference of the measure to delete
-void RunRecorderDeleteMeasure(
-  struct RunRecorder* const that,
-                 long const refMeasure) {
+    Try {
 
-  // Ensure the error messages are freed to avoid confusion with
-  // eventual previous messages
-  FreeErrMsg(that);
+      RunRecorderProjectAddMeasure(
+        handle,
+        measure);
 
-  // If the RunRecorder uses a local database
-  if (UsesAPI(that) == false) {
+    } CatchDefault {
 
-    DeleteMeasureLocal(
-      that,
-      refMeasure);
+      PolyFree(&handle);
+      Raise(TryCatchGetLastExc());
+
+    } EndCatch;
+    PolyFree(&handle);
 
   // Else, the RunRecorder uses the Web API
   } else {
 
-    DeleteMeasureAPI(
+    AddMeasureAPI(
       that,
-      refMeasure);
+      project,
+      measure);
 
   }
 
 }
 
-// Get the measures of a project
+// Add several measures to a project. The measures are written in one
+// single transaction (or in the current session if there is one). The
+// policy is to save as much as possible: if a measure fails the remaining
+// ones are still added and the exception is raised at the end.
 // Inputs:
 //         that: the struct RunRecorder
-//      project: the project's name
-// Output:
-//   Return the measures as a new struct RunRecorderMeasures
-struct RunRecorderMeasures* RunRecorderGetMeasures(
-  struct RunRecorder* const that,
-          char const* const project) {
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SessionFailed
+//   RunRecorderExc_AsyncQueueFull
+//   RunRecorderExc_SpoolFailed
+void RunRecorderAddMeasures(
+               struct RunRecorder* const that,
+                       char const* const project,
+  struct RunRecorderMeasure* const* const measures,
+                              long const nbMeasure) {
+
+  // Reset the reference of the last added measure
+  that->refLastAddedMeasure = 0;
 
   // Ensure the error messages are freed to avoid confusion with
   // eventual previous messages
   FreeErrMsg(that);
 
-  // If the RunRecorder uses a local database
-  if (UsesAPI(that) == false) {
+  // If the asynchronous writing is started, queue the measures
+  if (that->async != NULL) {
 
-    return
-      GetMeasuresLocal(
+    AddMeasuresAsync(
+      that,
+      project,
+      (struct RunRecorderMeasure const* const*)measures,
+      nbMeasure);
+
+  // Else, if the measures are spooled, send or spool the measures
+  } else if (that->spool != NULL) {
+
+    AddMeasuresSpool(
+      that,
+      project,
+      (struct RunRecorderMeasure const* const*)measures,
+      nbMeasure);
+
+  // Else, if the RunRecorder uses a local database
+  } else if (UsesAPI(that) == false) {
+
+    // Open a handle on the project to resolve the metrics once for all
+    // the measures
+    struct RunRecorderProject* handle =
+      RunRecorderOpenProject(
         that,
         project);
 
-  // Else, the RunRecorder uses the Web API
+    Try {
+
+      RunRecorderProjectAddMeasures(
+        handle,
+        measures,
+        nbMeasure);
+
+    } CatchDefault {
+
+      PolyFree(&handle);
+      Raise(TryCatchGetLastExc());
+
+    } EndCatch;
+    PolyFree(&handle);
+
+  // Else, the RunRecorder uses the Web API, which dates the measures
   } else {
 
-    return
-      GetMeasuresAPI(
-        that,
-        project);
+    long const* const dates = NULL;
+    AddMeasuresAPI(
+      that,
+      project,
+      (struct RunRecorderMeasure const* const*)measures,
+      nbMeasure,
+      dates);
 
   }
 
 }
 
-// Get the most recent measures of a project
-// Inputs:
-//        that: the struct RunRecorder
-//     project: the project's name
-//   nbMeasure: the number of measures to be returned
-// Output:
-//   Return the measures as a new struct RunRecorderMeasures, ordered
-//   from the most recent to the oldest
-struct RunRecorderMeasures* RunRecorderGetLastMeasures(
-  struct RunRecorder* const that,
-          char const* const project,
-                 long const nbMeasure) {
+// Begin a session: all the measures added until the end of the session
+// are written to the database in one single transaction. The write lock
+// of the database is taken at the beginning of the session, so other
+// connections wait for its end to write. Has no effect when using the
+// Web API.
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_SessionFailed
+void RunRecorderBeginSession(
+  struct RunRecorder* const that) {
 
   // Ensure the error messages are freed to avoid confusion with
   // eventual previous messages
   FreeErrMsg(that);
 
-  // If the RunRecorder uses a local database
-  if (UsesAPI(that) == false) {
+  // Sessions can't be nested
+  if (that->isInSession == true) {
 
-    return
-      GetLastMeasuresLocal(
-        that,
-        project,
-        nbMeasure);
+    SafeStrDup(
+      that->errMsg,
+      "A session is already opened");
+    Raise(RunRecorderExc_SessionFailed);
 
-  // Else, the RunRecorder uses the Web API
-  } else {
+  }
 
-    return
-      GetLastMeasuresAPI(
-        that,
-        project,
-        nbMeasure);
+  // If the RunRecorder uses a local database, begin the transaction
+  // The Web API requests are atomic on the server side, so there is
+  // nothing to do in that case
+  if (UsesAPI(that) == false) BeginSessionLocal(that);
 
-  }
+  // Update the flag
+  that->isInSession = true;
 
 }
 
-// Free a struct RunRecorderMeasures
+// Commit a session opened with RunRecorderBeginSession
 // Input:
-//   that: the struct RunRecorderMeasures
-void RunRecorderMeasuresFree(
-  struct RunRecorderMeasures** that) {
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_SessionFailed
+void RunRecorderCommitSession(
+  struct RunRecorder* const that) {
 
-  // If it's already freed, nothing to do
-  if (that == NULL || *that == NULL) return;
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-  // If there was metrics
-  if ((*that)->metrics != NULL) {
+  // If there is no opened session
+  if (that->isInSession == false) {
 
-    // Free the metrics label
-    ForZeroTo(iMetric, (*that)->nbMetric) free((*that)->metrics[iMetric]);
+    SafeStrDup(
+      that->errMsg,
+      "No session opened");
+    Raise(RunRecorderExc_SessionFailed);
 
   }
 
-  // If there was measures
-  if ((*that)->values != NULL) {
-
-    // Loop on the measures
-    ForZeroTo(iMeasure, (*that)->nbMeasure) {
+  // The session is closed even if the commit fails, as in that case
+  // the transaction is rolled back
+  that->isInSession = false;
 
-      // If there was values for the measure
-      if ((*that)->values[iMeasure] != NULL) {
+  // If the RunRecorder uses a local database, commit the transaction
+  if (UsesAPI(that) == false) CommitSessionLocal(that);
 
-        // Free the values
-        ForZeroTo(iMetric, (*that)->nbMetric)
-          free((*that)->values[iMeasure][iMetric]);
+}
 
-        // Free the measure
-        free((*that)->values[iMeasure]);
+// Start the asynchronous writing of the measures: RunRecorderAddMeasure,
+// RunRecorderAddMeasures and RunRecorderProjectAddMeasure(s) copy the
+// measures in a queue and return immediately, and a dedicated thread
+// writes them by batches through its own connection. The errors of the
+// writer thread and the reference of the last written measure are
+// reported by RunRecorderFlush. The measures written asynchronously are
+// not part of the current session.
+// Inputs:
+//       that: the struct RunRecorder, already initialised
+//   capacity: the maximum number of measures in the queue
+//     policy: the policy when the queue is full
+// Raise:
+//   RunRecorderExc_AsyncFailed
+void RunRecorderStartAsync(
+            struct RunRecorder* const that,
+                           long const capacity,
+  enum RunRecorderAsyncPolicy const policy) {
 
-      }
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-    }
+  // Check the arguments
+  if (that->async != NULL) {
+
+    SafeStrDup(
+      that->errMsg,
+      "The asynchronous writing is already started");
+    Raise(RunRecorderExc_AsyncFailed);
 
   }
 
-  // Free memory
-  free((*that)->metrics);
-  free((*that)->values);
-  free(*that);
-  *that = NULL;
+  if (that->spool != NULL) {
+
+    SafeStrDup(
+      that->errMsg,
+      "The asynchronous writing can't be used with the spool");
+    Raise(RunRecorderExc_AsyncFailed);
+
+  }
+
+  if (capacity <= 0 || policy < 0 || policy >= RunRecorderAsyncPolicy_nb) {
+
+    SafeStrDup(
+      that->errMsg,
+      "Invalid capacity or policy");
+    Raise(RunRecorderExc_AsyncFailed);
+
+  }
+
+  // Create the asynchronous writer
+  struct RunRecorderAsync* async =
+    RunRecorderAsyncCreate(
+      that,
+      capacity,
+      policy);
+
+  // Start the writer thread
+  int ret =
+    pthread_create(
+      &(async->thread),
+      NULL,
+      AsyncWriterMain,
+      async);
+  if (ret != 0) {
+
+    RunRecorderAsyncFree(&async);
+    SafeStrDup(
+      that->errMsg,
+      strerror(ret));
+    Raise(RunRecorderExc_AsyncFailed);
+
+  }
+
+  async->isRunning = true;
+
+  // Memorise the writer
+  that->async = async;
 
 }
 
-// Print a struct RunRecorderMeasures on a stream in CSV format as:
-// Metric1&Metric2&...
-// Value1_1&Value1_2&...
-// Value2_1&Value2_2&...
-// ...
+// Wait until all the measures queued for asynchronous writing have been
+// written. Has no effect if the asynchronous writing is not started.
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_AddMeasureFailed (if a batch failed since the last
+//   call, errMsg is the one of the last failure)
+void RunRecorderFlush(
+  struct RunRecorder* const that) {
+
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
+
+  // If the asynchronous writing is not started, nothing to do
+  struct RunRecorderAsync* async = that->async;
+  if (async == NULL) return;
+
+  // Wait until the queue is empty and the last batch is written
+  pthread_mutex_lock(&(async->lock));
+  while (async->nb > 0 || async->nbWriting > 0)
+    pthread_cond_wait(
+      &(async->condWritten),
+      &(async->lock));
+
+  // Get the result of the writer thread and reset its failure
+  that->refLastAddedMeasure = async->refLastAddedMeasure;
+  bool hasFailed = async->hasFailed;
+  that->errMsg = async->errMsg;
+  async->errMsg = NULL;
+  async->hasFailed = false;
+  pthread_mutex_unlock(&(async->lock));
+
+  // If a batch has failed, raise an exception
+  if (hasFailed == true) Raise(RunRecorderExc_AddMeasureFailed);
+
+}
+
+// Write the queued measures and stop the asynchronous writing, the
+// measures are written synchronously again. Done automatically, without
+// reporting errors, by RunRecorderFree.
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_AddMeasureFailed (if a batch failed since the last
+//   RunRecorderFlush)
+void RunRecorderStopAsync(
+  struct RunRecorder* const that) {
+
+  // Write the queued measures and get the result of the writer thread
+  Try {
+
+    RunRecorderFlush(that);
+
+  } CatchDefault {
+
+    RunRecorderAsyncFree(&(that->async));
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Stop the writer thread and free it
+  RunRecorderAsyncFree(&(that->async));
+
+}
+
+// Start the spool of the measures added through the Web API. The
+// measures which can't be sent because the Web API is unreachable (or all
+// the measures, according to the mode) are stored in a local SQLite
+// database instead, with their date, and a dedicated thread forwards them
+// to the Web API by batches, retrying with an exponential backoff. The
+// measures still in the spool when it is stopped are forwarded after the
+// next start. Can be used even if RunRecorderInit failed with
+// RunRecorderExc_CurlRequestFailed. Can't be used together with the
+// asynchronous writing.
 // Inputs:
-//     that: the struct RunRecorderMeasures
-//   stream: the stream to write on
-void RunRecorderMeasuresPrintCSV(
-  struct RunRecorderMeasures const* const that,
-                              FILE* const stream) {
+//        that: the struct RunRecorder
+//   pathSpool: path of the spool database, created if it doesn't exist
+//        mode: the mode of the spool
+// Raise:
+//   RunRecorderExc_SpoolFailed
+void RunRecorderStartSpool(
+        struct RunRecorder* const that,
+                char const* const pathSpool,
+  enum RunRecorderSpoolMode const mode) {
 
-  // If there are metrics
-  if (that->metrics != NULL) {
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-    // Declare a variable to memorise the separator after the column
-    char sep = CSV_SEP;
+  // Check the arguments
+  char const* errMsg = NULL;
+  if (UsesAPI(that) == false)
+    errMsg = "The spool is only available with the Web API";
+  else if (that->curl == NULL)
+    errMsg = "The struct RunRecorder is not initialised";
+  else if (that->spool != NULL)
+    errMsg = "The spool is already started";
+  else if (that->async != NULL)
+    errMsg = "The spool can't be used with the asynchronous writing";
+  else if (mode < 0 || mode >= RunRecorderSpoolMode_nb)
+    errMsg = "Invalid mode";
+  if (errMsg != NULL) {
 
-    // Loop on the metrics
-    ForZeroTo(iMetric, that->nbMetric) {
+    SafeStrDup(
+      that->errMsg,
+      errMsg);
+    Raise(RunRecorderExc_SpoolFailed);
 
-      // If it's the last column, change the separator to line return
-      if (iMetric == that->nbMetric - 1) sep = '\n';
+  }
 
-      // Print the column value and its separator
-      fprintf(
-        stream,
-        "%s%c",
-        that->metrics[iMetric],
-        sep);
+  // Create the spool
+  struct RunRecorderSpool* spool =
+    RunRecorderSpoolCreate(
+      that,
+      pathSpool,
+      mode);
 
-    }
+  // Start the forwarder thread
+  int ret =
+    pthread_create(
+      &(spool->thread),
+      NULL,
+      SpoolForwarderMain,
+      spool);
+  if (ret != 0) {
+
+    RunRecorderSpoolFree(&spool);
+    SafeStrDup(
+      that->errMsg,
+      strerror(ret));
+    Raise(RunRecorderExc_SpoolFailed);
 
   }
 
-  // If there are measures
-  if (that->values != NULL) {
+  spool->isRunning = true;
 
-    // Loop on the measures
-    ForZeroTo(iMeasure, that->nbMeasure) {
+  // Detect quickly that the Web API can't be reached, instead of waiting
+  // for the default timeout of Curl
+  curl_easy_setopt(
+    that->curl,
+    CURLOPT_CONNECTTIMEOUT,
+    SPOOL_CONNECT_TIMEOUT);
 
-      // Declare a variable to memorise the separator after the column
-      char sep = CSV_SEP;
+  // Memorise the spool
+  that->spool = spool;
 
-      // Loop on the metrics
-      ForZeroTo(iMetric, that->nbMetric) {
+}
 
-        // If it's the last column, change the separator to line return
-        if (iMetric == that->nbMetric - 1) sep = '\n';
+// Stop the spool, the measures not yet forwarded stay in the spool
+// database. Done automatically by RunRecorderFree.
+// Input:
+//   that: the struct RunRecorder
+void RunRecorderStopSpool(
+  struct RunRecorder* const that) {
 
-        // Print the column value and its separator
-        fprintf(
-          stream,
-          "%s%c",
-          that->values[iMeasure][iMetric],
-          sep);
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-      }
+  // Stop the forwarder thread and free the spool
+  RunRecorderSpoolFree(&(that->spool));
 
-    }
+}
 
-  }
+// Get the number of spooled measures not yet forwarded to the Web API
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the number of measures, 0 if the spool is not started
+long RunRecorderGetNbSpooledMeasure(
+  struct RunRecorder* const that) {
+
+  // If the spool is not started, there is no spooled measure
+  struct RunRecorderSpool* spool = that->spool;
+  if (spool == NULL) return 0;
+
+  // Return the number of measures not yet forwarded
+  pthread_mutex_lock(&(spool->lock));
+  long nbPending = spool->nbPending;
+  pthread_mutex_unlock(&(spool->lock));
+  return nbPending;
 
 }
 
-// Remove a project
+// Get the reference in the Web API of a spooled measure
 // Inputs:
 //         that: the struct RunRecorder
-//      project: the project's name
-void RunRecorderFlushProject(
+//   refSpooled: the reference of the measure in the spool (as given by
+//               refLastSpooledMeasure)
+// Output:
+//   Return the reference of the measure in the Web API, 0 if it has not
+//   been forwarded yet, -1 if it has been rejected by the Web API or is
+//   unknown
+// Raise:
+//   RunRecorderExc_SpoolFailed
+long RunRecorderGetSpooledMeasureRef(
   struct RunRecorder* const that,
-          char const* const project) {
+                 long const refSpooled) {
 
   // Ensure the error messages are freed to avoid confusion with
   // eventual previous messages
   FreeErrMsg(that);
 
-  // If the RunRecorder uses a local database
-  if (UsesAPI(that) == false) {
+  // If the spool is not started
+  if (that->spool == NULL) {
 
-    FlushProjectLocal(
-      that,
-      project);
+    SafeStrDup(
+      that->errMsg,
+      "The spool is not started");
+    Raise(RunRecorderExc_SpoolFailed);
 
-  // Else, the RunRecorder uses the Web API
-  } else {
+  }
 
-    FlushProjectAPI(
-      that,
-      project);
+  // Get the measure in the spool. The measures are set to NULL once
+  // forwarded, and their reference in the Web API memorised in RefAPI
+  sqlite3_stmt* stmt = NULL;
+  int ret =
+    sqlite3_prepare_v2(
+      that->spool->db,
+      SQL_GET_SPOOLED_REF,
+      -1,
+      &stmt,
+      NULL);
+  if (ret == SQLITE_OK)
+    ret =
+      sqlite3_bind_int64(
+        stmt,
+        1,
+        refSpooled);
+  if (ret == SQLITE_OK) ret = sqlite3_step(stmt);
+  long refAPI = -1;
+  if (ret == SQLITE_ROW) {
+
+    bool isForwarded =
+      sqlite3_column_int(
+        stmt,
+        0);
+    refAPI =
+      (isForwarded == true ?
+        (long)sqlite3_column_int64(
+          stmt,
+          1) :
+        0);
+
+  } else if (ret != SQLITE_DONE) {
+
+    sqlite3_finalize(stmt);
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(that->spool->db));
+    Raise(RunRecorderExc_SpoolFailed);
 
   }
 
+  sqlite3_finalize(stmt);
+
+  // Return the reference
+  return refAPI;
+
 }
 
-// Free a struct RunRecorderRefVal
+// Create a new pool of struct RunRecorder, one per thread, all using the
+// same database or Web API
+// Inputs:
+//       url: Path to the SQLite database or Web API
+//   options: the options of the connections to the local database
+// Output:
+//   Return a new struct RunRecorderPool
+// Raise:
+//   RunRecorderExc_PoolFailed
+struct RunRecorderPool* RunRecorderPoolAlloc(
+                 char const* const url,
+  struct RunRecorderOptions const* const options) {
+
+  // Allocate the struct RunRecorderPool
+  struct RunRecorderPool* that = NULL;
+  SafeMalloc(
+    that,
+    sizeof(struct RunRecorderPool));
+  that->url = NULL;
+  that->options = *options;
+  that->nbRecorder = 0;
+  that->nbIdle = 0;
+  that->capacity = POOL_CAPACITY_INIT;
+  that->isInit = false;
+  that->recorders = NULL;
+  that->idles = NULL;
+
+  Try {
+
+    // Allocate its properties
+    SafeStrDup(
+      that->url,
+      url);
+    SafeRealloc(
+      that->recorders,
+      sizeof(struct RunRecorder*) * that->capacity);
+    SafeRealloc(
+      that->idles,
+      sizeof(struct RunRecorder*) * that->capacity);
+
+    // Create the key of the struct RunRecorder of each thread, which is
+    // given back to the pool when the thread ends
+    int ret =
+      pthread_key_create(
+        &(that->key),
+        ReleaseToPool);
+    if (ret != 0) Raise(RunRecorderExc_PoolFailed);
+
+  } CatchDefault {
+
+    // The key doesn't exist, only free the properties
+    PoolFreeProperties(&that);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  pthread_mutex_init(
+    &(that->lock),
+    NULL);
+
+  // Return the struct RunRecorderPool
+  return that;
+
+}
+
+// Free memory used by a struct RunRecorderPool and all its struct
+// RunRecorder. Must be called once no thread uses the pool anymore.
 // Input:
-//   that: the struct RunRecorderRefVal
-void RunRecorderRefValFree(
-  struct RunRecorderRefVal** const that) {
+//   that: The struct RunRecorderPool to be freed
+void RunRecorderPoolFree(
+  struct RunRecorderPool** const that) {
 
   // If it's already freed, nothing to do
   if (that == NULL || *that == NULL) return;
 
-  // If there are values, free the values
-  if ((*that)->values != NULL)
-    ForZeroTo(iPair, (*that)->nb) free((*that)->values[iPair]);
+  // Delete the key first, the struct RunRecorder are not given back to
+  // the pool anymore when their thread ends
+  pthread_key_delete((*that)->key);
 
-  // Free memory
-  free((*that)->values);
-  free((*that)->refs);
-  free(*that);
-  *that = NULL;
+  // Free the struct RunRecorder
+  ForZeroTo(iRecorder, (*that)->nbRecorder)
+    RunRecorderFree((*that)->recorders + iRecorder);
+
+  // Free memory used by the properties and the struct RunRecorderPool
+  pthread_mutex_destroy(&((*that)->lock));
+  PoolFreeProperties(that);
 
 }
 
-// Free a struct RunRecorderRefValDef
+// Free the memory used by the properties of a struct RunRecorderPool and
+// the struct itself, shared by RunRecorderPoolFree and the failure of
+// RunRecorderPoolAlloc. The struct RunRecorder, the key and the lock must
+// have been freed already, or never created.
 // Input:
-//   that: the struct RunRecorderRefValDef
-void RunRecorderRefValDefFree(
-  struct RunRecorderRefValDef** const that) {
+//   that: the struct RunRecorderPool to be freed
+static void PoolFreeProperties(
+  struct RunRecorderPool** const that) {
 
   // If it's already freed, nothing to do
   if (that == NULL || *that == NULL) return;
 
-  // If there are values, free the values
-  if ((*that)->values != NULL)
-    ForZeroTo(iPair, (*that)->nb) free((*that)->values[iPair]);
-
-  // If there are default values, free the default values
-  if ((*that)->defaultValues != NULL)
-    ForZeroTo(iPair, (*that)->nb) free((*that)->defaultValues[iPair]);
+  // Free memory used by the properties
+  free((*that)->url);
+  free((*that)->recorders);
+  free((*that)->idles);
 
-  // Free memory
-  free((*that)->defaultValues);
-  free((*that)->values);
-  free((*that)->refs);
+  // Free memory used by the struct RunRecorderPool
   free(*that);
   *that = NULL;
 
 }
 
-// Get the index of a metric in a RunRecorderMeasures
-// Inputs:
-//     that: the struct RunRecorderMeasures
-//   metric: the metric's label
+// Get the struct RunRecorder of the calling thread. At the first call in
+// a thread, an idle struct RunRecorder of the pool is given to the
+// thread, or a new one is created and initialised. It is used by this
+// thread only, until the thread ends or calls RunRecorderPoolRelease,
+// and must not be freed.
+// Input:
+//   that: the struct RunRecorderPool
 // Output:
-//   Return the index of the metric
-int RunRecorderMeasuresGetIdxMetric(
-  struct RunRecorderMeasures const* const that,
-                        char const* const metric) {
+//   Return the struct RunRecorder of the calling thread
+// Raise:
+//   RunRecorderExc_PoolFailed
+//   and the exceptions of RunRecorderInit
+struct RunRecorder* RunRecorderPoolGet(
+  struct RunRecorderPool* const that) {
+
+  // If the thread already has its struct RunRecorder, return it without
+  // locking the pool
+  struct RunRecorder* recorder = pthread_getspecific(that->key);
+  if (recorder != NULL) return recorder;
+
+  // Take an idle struct RunRecorder, or create a new one
+  pthread_mutex_lock(&(that->lock));
+  Try {
 
-  // Variables to memorise the index of the metric
-  int idx = -1;
+    if (that->nbIdle > 0) {
 
-  Try {
+      --(that->nbIdle);
+      recorder = that->idles[that->nbIdle];
 
-    // Loop on the metrics
-    ForZeroTo(iMetric, that->nbMetric) {
+    } else {
 
-      // If it's the metric, memorise the index
-      int retStrCmp =
-        strcmp(
-          that->metrics[iMetric],
-          metric);
-      if (retStrCmp == 0) idx = iMetric;
+      recorder = PoolCreateRecorder(that);
 
     }
 
-    // If we couldn't find the indices, raise an exception
-    if (idx == -1 ) Raise(RunRecorderExc_InvalidMetricLabel);
-
   } CatchDefault {
 
-    // Forward the exception
+    pthread_mutex_unlock(&(that->lock));
     Raise(TryCatchGetLastExc());
 
   } EndCatch;
+  pthread_mutex_unlock(&(that->lock));
 
-  return idx;
+  // Memorise it as the struct RunRecorder of the thread
+  int ret =
+    pthread_setspecific(
+      that->key,
+      recorder);
+  if (ret != 0) {
 
-}
+    ReleaseToPool(recorder);
+    Raise(RunRecorderExc_PoolFailed);
 
-// ================== Private functions definition =========================
+  }
 
-// Clone of asprintf
-// Inputs:
-//   str: pointer to the string to be created
-//   fmt: format as in sprintf
-//   ...: arguments as in sprintf
-static void StringCreate(
-  char** str,
-   char* fmt,
-         ...) {
-
-  // Get the length of the string
-  char c[1];
-  va_list argp;
-  va_start(
-    argp,
-    fmt);
-  int len =
-    vsnprintf(
-      c,
-      1,
-      fmt,
-      argp) + 1;
-  va_end(argp);
-
-  // Allocate memory
-  SafeMalloc(
-    *str,
-    len);
+  // Reset the state of the previous thread which used it
+  recorder->refLastAddedMeasure = 0;
+  FreeErrMsg(recorder);
 
-  // Create the string
-  va_start(
-    argp,
-    fmt);
-  vsnprintf(
-    *str,
-    len,
-    fmt,
-    argp);
-  va_end(argp);
+  // Return the struct RunRecorder
+  return recorder;
 
 }
 
-// Init a struct RunRecorder using a local SQLite database
+// Give back the struct RunRecorder of the calling thread to the pool, to
+// be reused by another thread. Done automatically when the thread ends.
+// An opened session is rolled back.
 // Input:
-//   that: the struct RunRecorder
-// Raise:
-//   RunRecorderExc_OpenDbFailed
-static void InitLocal(
-  struct RunRecorder* const that) {
-
-  // Try to open the file in reading mode to check if it exists
-  FILE* fp =
-    fopen(
-      that->url,
-      "r");
-
-  // Open the connection to the local database, if the database doesn't
-  // exist an empty one will be created automatically by SQLite3
-  int ret =
-    sqlite3_open(
-      that->url,
-      &(that->db));
+//   that: the struct RunRecorderPool
+void RunRecorderPoolRelease(
+  struct RunRecorderPool* const that) {
 
-  // If the database couldn't be opened/created
-  if (ret != SQLITE_OK) {
+  // If the thread has no struct RunRecorder, nothing to do
+  struct RunRecorder* recorder = pthread_getspecific(that->key);
+  if (recorder == NULL) return;
 
-    // If it could be opend through fopen, close it
-    if (fp != NULL) fclose(fp);
+  // Give it back to the pool
+  pthread_setspecific(
+    that->key,
+    NULL);
+  ReleaseToPool(recorder);
 
-    // Copy the error message and raise an exception
-    SafeStrDup(
-      that->errMsg,
-      sqlite3_errmsg(that->db));
-    Raise(RunRecorderExc_OpenDbFailed);
+}
 
-  // Else, the database could be opened/created
-  } else {
+// Delete a measure
+// Inputs:
+//          that: the struct RunRecorder
+//    refMeasure: the reference of the measure to delete
+void RunRecorderDeleteMeasure(
+  struct RunRecorder* const that,
+                 long const refMeasure) {
 
-    // If we couldn't open it with fopen before opening it with
-    // sqlite3_open it means the database has just been created by
-    // SQLite3
-    if (fp == NULL) {
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-      // Create the RunRecorder's tables in the database
-      CreateDb(that);
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-    // Else, the database could be opened and is ready to use by RunRecorder
-    } else {
+    DeleteMeasureLocal(
+      that,
+      refMeasure);
 
-      // Close the FILE*
-      fclose(fp);
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-    }
+    DeleteMeasureAPI(
+      that,
+      refMeasure);
 
   }
 
 }
 
-// Init a struct RunRecorder using the Web API
-// Input:
-//   that: the struct RunRecorder
+// Delete several measures in one single transaction
+// Inputs:
+//          that: the struct RunRecorder
+//   refMeasures: the references of the measures to delete
+//     nbMeasure: the number of measures
 // Raise:
-//   RunRecorderExc_CreateCurlFailed
-//   RunRecorderExc_CurlSetOptFailed
-static void InitWebAPI(
-  struct RunRecorder* const that) {
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+void RunRecorderDeleteMeasures(
+  struct RunRecorder* const that,
+           long const* const refMeasures,
+                 long const nbMeasure) {
 
-  // Create the Curl instance
-  curl_global_init(CURL_GLOBAL_ALL);
-  that->curl = curl_easy_init();
-  if (that->curl == NULL) {
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-    curl_global_cleanup();
-    Raise(RunRecorderExc_CreateCurlFailed);
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-  }
+    DeleteMeasuresLocal(
+      that,
+      refMeasures,
+      nbMeasure);
 
-  // Set the url of the Web API in the Curl instance
-  CURLcode res =
-    curl_easy_setopt(
-      that->curl,
-      CURLOPT_URL,
-      that->url);
-  if (res != CURLE_OK) {
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-    curl_easy_cleanup(that->curl);
-    curl_global_cleanup();
-    SafeStrDup(
-      that->errMsg,
-      curl_easy_strerror(res));
-    Raise(RunRecorderExc_CurlSetOptFailed);
+    DeleteMeasuresAPI(
+      that,
+      refMeasures,
+      nbMeasure);
 
   }
 
-  // Set the pointer where to memorise received data
-  res =
-    curl_easy_setopt(
-      that->curl,
-      CURLOPT_WRITEDATA,
-      &(that->curlReply));
-  if (res != CURLE_OK) {
+}
 
-    curl_easy_cleanup(that->curl);
-    curl_global_cleanup();
-    SafeStrDup(
-      that->errMsg,
-      curl_easy_strerror(res));
-    Raise(RunRecorderExc_CurlSetOptFailed);
+// Delete the measures whose reference is in [fromRef, toRef], in one
+// single transaction
+// Inputs:
+//      that: the struct RunRecorder
+//   fromRef: the first reference to delete
+//     toRef: the last reference to delete
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+void RunRecorderDeleteMeasuresByRef(
+  struct RunRecorder* const that,
+                 long const fromRef,
+                 long const toRef) {
 
-  }
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-  // Set the callback to receive data
-  res =
-    curl_easy_setopt(
-      that->curl,
-      CURLOPT_WRITEFUNCTION,
-      GetReplyAPI);
-  if (res != CURLE_OK) {
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-    curl_easy_cleanup(that->curl);
-    curl_global_cleanup();
-    SafeStrDup(
-      that->errMsg,
-      curl_easy_strerror(res));
-    Raise(RunRecorderExc_CurlSetOptFailed);
+    DeleteMeasuresByRefLocal(
+      that,
+      fromRef,
+      toRef);
+
+  // Else, the RunRecorder uses the Web API
+  } else {
+
+    DeleteMeasuresByRefAPI(
+      that,
+      fromRef,
+      toRef);
 
   }
 
 }
 
-// Free the error messages of a struct RunRecorder
-// Input:
-//   that: The struct RunRecorder to be freed
-static void FreeErrMsg(
-  struct RunRecorder* const that) {
+// Delete the measures of a project recorded in [fromDate, toDate[, in
+// one single transaction
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+void RunRecorderDeleteMeasuresByDate(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate) {
 
-  // Free the error messages
-  // SQLite3 error message needs to be freed its own way
-  free(that->errMsg);
-  that->errMsg = NULL;
-  sqlite3_free(that->sqliteErrMsg);
-  that->sqliteErrMsg = NULL;
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-}
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-// Check if a struct RunRecorder uses a local SQLite database or the
-// Web API
-// Input:
-//   that: The struct RunRecorder
-// Return:
-//   Return true if the struct RunRecorder uses the Web API, else false
-static bool UsesAPI(
-  struct RunRecorder const* const that) {
+    DeleteMeasuresByDateLocal(
+      that,
+      project,
+      fromDate,
+      toDate);
 
-  // If the url starts with http the struct RunRecorder uses the Web API
-  char const* http =
-    strstr(
-      that->url,
-      "http");
-  return (http == that->url);
+  // Else, the RunRecorder uses the Web API
+  } else {
+
+    DeleteMeasuresByDateAPI(
+      that,
+      project,
+      fromDate,
+      toDate);
+
+  }
 
 }
 
-// Reset the Curl reply, to be called before sending a new curl request
-// or the result of the new request will be appended to the eventual
-// one of the previous request
-// Input:
-//   The struct RunRecorder
-static void ResetCurlReply(
-  struct RunRecorder* const that) {
+// Set the retention policy of a project. The measures older than the
+// maximum age, and the oldest measures beyond the maximum number of
+// measures, are deleted by RunRecorderApplyRetention.
+// Inputs:
+//           that: the struct RunRecorder
+//        project: the project's name
+//         maxAge: the maximum age of the measures in seconds, 0 for no
+//                 limit
+//   maxNbMeasure: the maximum number of measures, 0 for no limit
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+//   RunRecorderExc_RetentionFailed
+void RunRecorderSetRetention(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const maxAge,
+                 long const maxNbMeasure) {
 
-  // Free the Curl reply
-  free(that->curlReply);
-  that->curlReply = NULL;
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-}
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-// Create the RunRecorder's tables in an empty database
-// Input:
-//   that: The struct RunRecorder
-static void CreateDb(
-  struct RunRecorder* const that) {
+    SetRetentionLocal(
+      that,
+      project,
+      maxAge,
+      maxNbMeasure);
 
-  // If the RunRecorder uses a local database, create the local database
-  if (UsesAPI(that) == false) CreateDbLocal(that);
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-  // If the RunRecorder uses the Web API there is nothing to do as the
-  // remote API will take care of creating the  database as necessary
+    SetRetentionAPI(
+      that,
+      project,
+      maxAge,
+      maxNbMeasure);
+
+  }
 
 }
 
-// Create the RunRecorder's tables in an empty local database
+// Apply the retention policy of all the projects. The expired measures
+// are deleted by batches, each in its own transaction, to keep the
+// database available to writers.
 // Input:
-//   that: The struct RunRecorder
+//   that: the struct RunRecorder
+// Output:
+//   Return the number of deleted measures
 // Raise:
-//   RunRecorderExc_CreateTableFailed
-static void CreateDbLocal(
+//   RunRecorderExc_RetentionFailed
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+long RunRecorderApplyRetention(
   struct RunRecorder* const that) {
 
   // Ensure the error messages are freed to avoid confusion with
   // eventual previous messages
   FreeErrMsg(that);
 
-  // List of commands to create the tables
-  char* sqlCmd[NB_TABLE + 1] = {
+  // Variable to memorise the number of deleted measures
+  long nbDeleted = 0;
 
-    "CREATE TABLE _Version ("
-    "  Ref INTEGER PRIMARY KEY,"
-    "  Label TEXT NOT NULL)",
-    "CREATE TABLE _Project ("
-    "  Ref INTEGER PRIMARY KEY,"
-    "  Label TEXT UNIQUE NOT NULL)",
-    "CREATE TABLE _Measure ("
-    "  Ref INTEGER PRIMARY KEY,"
-    "  RefProject INTEGER NOT NULL,"
-    "  DateMeasure DATETIME NOT NULL)",
-    "CREATE TABLE _Value ("
-    "  Ref INTEGER PRIMARY KEY,"
-    "  RefMeasure INTEGER NOT NULL,"
-    "  RefMetric INTEGER NOT NULL,"
-    "  Value TEXT NOT NULL)",
-    "CREATE TABLE _Metric ("
-    "  Ref INTEGER PRIMARY KEY,"
-    "  RefProject INTEGER NOT NULL,"
-    "  Label TEXT NOT NULL,"
-    "  DefaultValue TEXT NOT NULL)",
-    "INSERT INTO _Version (Ref, Label) "
-    "VALUES (NULL, '" VERSION_DB "')"
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-  };
+    nbDeleted = ApplyRetentionLocal(that);
 
-  // Loop on the commands
-  ForZeroTo(iCmd, NB_TABLE + 1) {
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-    // Execute the command
-    int retExec =
-      sqlite3_exec(
-        that->db,
-        sqlCmd[iCmd],
-        NULL,
-        NULL,
-        &(that->sqliteErrMsg));
-    if (retExec != SQLITE_OK) Raise(RunRecorderExc_CreateTableFailed);
+    nbDeleted = ApplyRetentionAPI(that);
 
   }
 
-}
-
-// Upgrade the database
-// Input:
-//   that: The struct RunRecorder
-static void UpgradeDb(
-  struct RunRecorder* const that) {
-
-  // Unused argument
-  (void)that;
-
-  // Just a placeholder, nothing to do yet as there is currently only
-  // one version of the database
+  // Return the number of deleted measures
+  return nbDeleted;
 
 }
 
-// Callback for GetVersionLocal
-// Input:
-//      data: The version
-//     nbCol: Number of columns in the returned rows
-//    colVal: Row values
-//   colName: Columns name
+// Get the measures of a project
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project's name
 // Output:
-//   Return 0 if successfull, else 1
-static int GetVersionLocalCb(
-   void* data,
-     int nbCol,
-  char** colVal,
-  char** colName) {
-
-  // Unused argument
-  (void)colName;
-
-  // If the arguments are invalid
-  // Return non zero to trigger SQLITE_ABORT in the calling function
-  if (nbCol != 1 || colVal == NULL || *colVal == NULL) return 1;
-
-  // Cast the data
-  char** ptrVersion = (char**)data;
+//   Return the measures as a new struct RunRecorderMeasures
+struct RunRecorderMeasures* RunRecorderGetMeasures(
+  struct RunRecorder* const that,
+          char const* const project) {
 
-  // Memorise the returned value
-  Try {
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-    SafeStrDup(
-      *ptrVersion,
-      *colVal);
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-  } CatchDefault {
+    return
+      GetMeasuresLocal(
+        that,
+        project);
 
-    // Return non zero to trigger SQLITE_ABORT in the calling function
-    return 1;
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-  } EndCatch;
+    return
+      GetMeasuresAPI(
+        that,
+        project);
 
-  // Return success code
-  return 0;
+  }
 
 }
 
-// Get the version of the local database
-// Input:
-//   that: The struct RunRecorder
+// Get the most recent measures of a project
+// Inputs:
+//        that: the struct RunRecorder
+//     project: the project's name
+//   nbMeasure: the number of measures to be returned
 // Output:
-//   Return a new string
-// Raise:
-//   RunRecorderExc_SQLRequestFailed
-static char* GetVersionLocal(
-  struct RunRecorder* const that) {
+//   Return the measures as a new struct RunRecorderMeasures, ordered
+//   from the most recent to the oldest
+struct RunRecorderMeasures* RunRecorderGetLastMeasures(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const nbMeasure) {
 
-  // Declare a variable to memorise the version
-  char* version = NULL;
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-  // Execute the command to get the version
-  char* sqlCmd = "SELECT Label FROM _Version LIMIT 1";
-  int retExec =
-    sqlite3_exec(
-      that->db,
-      sqlCmd,
-      GetVersionLocalCb,
-      &version,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_SQLRequestFailed);
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-  // Return the version
-  return version;
+    return
+      GetLastMeasuresLocal(
+        that,
+        project,
+        nbMeasure);
 
-}
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-// Callback to memorise the incoming data from the Web API
-// Input:
-//   data: incoming data
-//   size: always 1
-//   nmemb: number of incoming byte
-//   reply: pointer to where to store the incoming data
-// Output:
-//   Return the number of received byte
-static size_t GetReplyAPI(
-   char* data,
-  size_t size,
-  size_t nmemb,
-   void* ptr) {
+    return
+      GetLastMeasuresAPI(
+        that,
+        project,
+        nbMeasure);
 
-  // Get the size in byte of the received data
-  size_t dataSize = size * nmemb;
+  }
 
-  // If there is received data
-  if (dataSize != 0) {
+}
 
-    // Cast the data
-    char** reply = (char**)ptr;
+// Get the measures of a project in a period of time
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a new struct RunRecorderMeasures, ordered
+//   from the oldest to the most recent
+struct RunRecorderMeasures* RunRecorderGetMeasuresInRange(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit) {
 
-    // Variable to memorise the current length of the buffer for the reply
-    size_t replyLength = 0;
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-    // If the current buffer for the reply is not empty, get the current
-    // length of the reply
-    if (*reply != NULL) replyLength = strlen(*reply);
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-    // Allocate memory for current data, the incoming data and the
-    // terminating '\0'
-    SafeRealloc(
-      *reply,
-      replyLength + dataSize + 1);
+    return
+      GetMeasuresInRangeLocal(
+        that,
+        project,
+        fromDate,
+        toDate,
+        limit);
 
-    // Copy the incoming data at the end of the current buffer
-    memcpy(
-      *reply + replyLength,
-      data,
-      dataSize);
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-    // Set the terminating NULL character
-    (*reply)[replyLength + dataSize] = '\0';
+    return
+      GetMeasuresInRangeAPI(
+        that,
+        project,
+        fromDate,
+        toDate,
+        limit);
 
   }
 
-  // Return the number of byte received;
-  return dataSize;
-
 }
 
-// Get the value of a key in a JSON encoded string
-// Input:
-//   json: the json encoded string
-//    key: the key
+// Get the measures of a project added after a given measure, to poll
+// the new measures at a cost independent of the size of the project
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+//   refLast: the reference of the last measure already read (0 to read
+//            all the measures), updated to the reference of the last
+//            returned measure, unchanged if there is no new measure
 // Output:
-//   Return a new string, or NULL if the key doesn't exist
-// Raise:
-//   RunRecorderExc_ApiRequestFailed
-static char* GetJSONValOfKey(
-  char const* const json,
-  char const* const key) {
+//   Return the measures as a new struct RunRecorderMeasures, ordered
+//   from the oldest to the most recent added
+struct RunRecorderMeasures* RunRecorderGetMeasuresSince(
+  struct RunRecorder* const that,
+          char const* const project,
+                long* const refLast) {
 
-  // If the json or key is null or empty
-  // Nothing to do
-  if (json == NULL || key == NULL ||
-      *json == '\0' || *key == '\0') return NULL;
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-  // Variable to memorise the value
-  char* val = NULL;
+  // Declare the struct RunRecorderMeasures to memorise the measures
+  struct RunRecorderMeasures* measures = NULL;
 
-  // Variable to memorise the key decorated with it's syntax
-  char* keyDecorated = NULL;
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-  Try {
+    measures =
+      GetMeasuresSinceLocal(
+        that,
+        project,
+        *refLast);
 
-    // Create the key decorated with it's syntax
-    StringCreate(
-      &keyDecorated,
-      "\"%s\":",
-      key);
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-    // If the key can be find in the JSON encoded string
-    char const* ptrKey =
-      strstr(
-        json,
-        keyDecorated);
-    if (ptrKey != NULL) {
+    measures =
+      GetMeasuresSinceAPI(
+        that,
+        project,
+        *refLast);
 
-      // Variable to memorise the start of the value
-      char const* ptrVal = ptrKey + strlen(keyDecorated) + 1;
+  }
 
-      // Declare a pointer to loop on the string until the end of the value
-      char const* ptr = ptrVal;
+  // Update the reference of the last read measure, the first column of
+  // the measures is their reference
+  if (measures->nbMeasure > 0)
+    *refLast =
+      RunRecorderMeasuresGetLong(
+        measures,
+        measures->nbMeasure - 1,
+        0);
 
-      // If the value is a string
-      if (ptrKey[strlen(keyDecorated)] == '"') {
+  // Return the measures
+  return measures;
 
-        // Loop on the characters of the value until the next double quote
-        // or end of string
-        while (*ptr != '\0' && *ptr != '"') {
+}
 
-          // Move to the next character
-          ++ptr;
+// Free a struct RunRecorderMeasures
+// Input:
+//   that: the struct RunRecorderMeasures
+void RunRecorderMeasuresFree(
+  struct RunRecorderMeasures** that) {
 
-          // Skip the escaped character
-          if (*ptr == '\\') ++ptr;
+  // If it's already freed, nothing to do
+  if (that == NULL || *that == NULL) return;
 
-        }
+  // Free the blocks of memory storing the labels and values
+  ArenaFree(&((*that)->arena));
 
-      // Else, if the value is an object
-      } else if (ptrKey[strlen(keyDecorated)] == '{') {
+  // Free memory
+  free((*that)->metrics);
+  free((*that)->values);
+  free((*that)->cells);
+  free((*that)->types);
+  free((*that)->nums);
+  free(*that);
+  *that = NULL;
 
-        // Loop on the characters of the value until the closing curly
-        // brace or end of string
-        int curlyLvl = 1;
-        while (*ptr != '\0' && (curlyLvl > 0 || *ptr != '}')) {
+}
 
-          // Update the curly brace level
-          if (*ptr == '{') curlyLvl++;
+// Print a struct RunRecorderMeasures on a stream in CSV format as:
+// Metric1&Metric2&...
+// Value1_1&Value1_2&...
+// Value2_1&Value2_2&...
+// ...
+// Inputs:
+//     that: the struct RunRecorderMeasures
+//   stream: the stream to write on
+void RunRecorderMeasuresPrintCSV(
+  struct RunRecorderMeasures const* const that,
+                              FILE* const stream) {
 
-          // If the character is a double quote, move to the end of the
-          // string
-          if (*ptr == '"') {
+  // If there are metrics
+  if (that->metrics != NULL) {
 
-            ++ptr;
-            while (*ptr != '\0' && *ptr != '"') {
+    // Declare a variable to memorise the separator after the column
+    char sep = CSV_SEP;
 
-              ++ptr;
-              if (*ptr == '\\') ++ptr;
+    // Loop on the metrics
+    ForZeroTo(iMetric, that->nbMetric) {
 
-            }
+      // If it's the last column, change the separator to line return
+      if (iMetric == that->nbMetric - 1) sep = '\n';
 
-          }
+      // Print the column value and its separator
+      fprintf(
+        stream,
+        "%s%c",
+        that->metrics[iMetric],
+        sep);
 
-          // Move to the next character
-          ++ptr;
+    }
 
-          // Update the curly brace level
-          if (*ptr == '}') curlyLvl--;
+  }
 
-        }
+  // If there are measures
+  if (that->values != NULL) {
 
-      // Else, if the value is an array
-      } else if (ptrKey[strlen(keyDecorated)] == '[') {
+    // Loop on the measures
+    ForZeroTo(iMeasure, that->nbMeasure) {
 
-        // Loop on the characters of the value until the closing bracket
-        // or end of string
-        // Presume the data are well formatted here, if there are brackets
-        // in string in the object definition, or sub-array
-        // definition, or any other special case, it means the data
-        // returned by the API are invalid and it will be catched later.
-        while (*ptr != '\0' && *ptr != ']') ++ptr;
+      // Declare a variable to memorise the separator after the column
+      char sep = CSV_SEP;
 
-      // Else, this JSON encoded string is not supported, the API request
-      // has returned invalid data
-      } else {
+      // Loop on the metrics
+      ForZeroTo(iMetric, that->nbMetric) {
 
-        Raise(RunRecorderExc_ApiRequestFailed);
+        // If it's the last column, change the separator to line return
+        if (iMetric == that->nbMetric - 1) sep = '\n';
+
+        // Print the column value and its separator
+        fprintf(
+          stream,
+          "%s%c",
+          that->values[iMeasure][iMetric],
+          sep);
 
       }
 
-      // If we have found the end of the value
-      if (*ptr != '\0') {
+    }
 
-        // Get the length of the value
-        size_t lenVal = ptr - ptrVal;
+  }
 
-        // Allocate memory for the value
-        SafeMalloc(
-          val,
-          lenVal + 1);
+}
 
-        // Copy the value
-        memcpy(
-          val,
-          ptrVal,
-          lenVal);
-        val[lenVal] = '\0';
+// Enable or disable the materialized table of a project. When enabled,
+// the measures of the project are also stored in a table with one row per
+// measure and one column per metric, maintained each time a measure or
+// a metric is added or deleted. Reading the measures is then a simple
+// scan of that table instead of the resolution of the values of each
+// measure. Enabling populates the table with the existing measures.
+// Inputs:
+//             that: the struct RunRecorder
+//          project: the project's name
+//   isMaterialized: true to enable, false to disable
+// Raise:
+//   RunRecorderExc_MaterializeFailed
+//   RunRecorderExc_SessionFailed
+void RunRecorderSetMaterialized(
+  struct RunRecorder* const that,
+          char const* const project,
+                 bool const isMaterialized) {
 
-      // Else, this JSON encoded string is not supported, the API request
-      // has returned invalid data
-      } else {
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-        Raise(RunRecorderExc_ApiRequestFailed);
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-      }
+    SetMaterializedLocal(
+      that,
+      project,
+      isMaterialized);
 
-    }
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-    // Free memory
-    free(keyDecorated);
+    SetMaterializedAPI(
+      that,
+      project,
+      isMaterialized);
 
-  } CatchDefault {
+  }
 
-    free(keyDecorated);
-    free(val);
-    Raise(TryCatchGetLastExc());
+}
 
-  } EndCatch;
+// Remove a project
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project's name
+void RunRecorderFlushProject(
+  struct RunRecorder* const that,
+          char const* const project) {
 
-  // Return the value
-  return val;
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-}
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-// Set the POST data in the Web API request of a struct RunRecorder
-// Input:
-//   that: the struct RunRecorder
-//   data: the POST data
-// Raise:
-//   RunRecorderExc_CurlSetOptFailed
-static void SetAPIReqPostVal(
-  struct RunRecorder* const that,
-          char const* const data) {
+    FlushProjectLocal(
+      that,
+      project);
 
-  // Set the data in the Curl fields
-  CURLcode res =
-    curl_easy_setopt(
-      that->curl,
-      CURLOPT_POSTFIELDS,
-      data);
-  if (res != CURLE_OK) {
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-    SafeStrDup(
-      that->errMsg,
-      curl_easy_strerror(res));
-    Raise(RunRecorderExc_CurlSetOptFailed);
+    FlushProjectAPI(
+      that,
+      project);
 
   }
 
 }
 
-// Get the ret code in the current JSON reply of a struct RunRecorder
-// Input:
-//   that: the struct RunRecorder
+// Reclaim the space freed by deleted measures and projects. Deletions
+// don't shrink the database file, the freed pages are kept for reuse.
+// This function releases them in bounded steps to keep the database
+// available to writers, and can be called repeatedly until it returns 0.
+// Inputs:
+//     that: the struct RunRecorder
+//   budget: the maximum number of pages to release, if <= 0 all the
+//           free pages are released
 // Output:
-//   Return a new string
+//   Return the number of free pages remaining after the call
 // Raise:
-//   RunRecorderExc_ApiRequestFailed
-static char* GetAPIRetCode(
-  struct RunRecorder* const that) {
+//   RunRecorderExc_CompactFailed
+long RunRecorderCompact(
+  struct RunRecorder* const that,
+                 long const budget) {
 
-  // Extract the return code from the JSON reply
-  char* retCode =
-    GetJSONValOfKey(
-      that->curlReply,
-      "ret");
-  if (retCode == NULL) {
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-    SafeStrDup(
-      that->errMsg,
-      "'ret' key missing in API reply");
-    Raise(RunRecorderExc_ApiRequestFailed);
+  // Variable to memorise the number of remaining free pages
+  long nbFreePage = 0;
+
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
+
+    nbFreePage =
+      CompactLocal(
+        that,
+        budget);
+
+  // Else, the RunRecorder uses the Web API
+  } else {
+
+    nbFreePage =
+      CompactAPI(
+        that,
+        budget);
 
   }
 
-  // Return the code
-  return retCode;
+  // Return the number of remaining free pages
+  return nbFreePage;
 
 }
 
-// Send the current request of a struct RunRecorder
+// Free a struct RunRecorderRefVal
 // Input:
-//        that: the struct RunRecorder
-//   isJsonReq: flag to indicate that the request returns JSON encoded
-//              data
-// Raise:
-//   RunRecorderExc_CurlRequestFailed
-//   RunRecorderExc_ApiRequestFailed
-static void SendAPIReq(
-  struct RunRecorder* const that,
-                 bool const isJsonReq) {
+//   that: the struct RunRecorderRefVal
+void RunRecorderRefValFree(
+  struct RunRecorderRefVal** const that) {
 
-  // Reset the Curl reply or the reply of this request will get appended
-  // to the one of the previous request
-  ResetCurlReply(that);
+  // If it's already freed, nothing to do
+  if (that == NULL || *that == NULL) return;
 
-  // Send the request
-  CURLcode res = curl_easy_perform(that->curl);
-  if (res != CURLE_OK) {
+  // If there are values, free the values
+  if ((*that)->values != NULL)
+    ForZeroTo(iPair, (*that)->nb) free((*that)->values[iPair]);
 
-    SafeStrDup(
-      that->errMsg,
-      curl_easy_strerror(res));
-    Raise(RunRecorderExc_CurlRequestFailed);
+  // Free memory
+  free((*that)->values);
+  free((*that)->refs);
+  free(*that);
+  *that = NULL;
 
-  }
+}
 
-  // If the request returns JSON encoded data
-  if (isJsonReq == true) {
+// Free a struct RunRecorderRefValDef
+// Input:
+//   that: the struct RunRecorderRefValDef
+void RunRecorderRefValDefFree(
+  struct RunRecorderRefValDef** const that) {
 
-    // If the returned code is not '0'
-    char* retCode = GetAPIRetCode(that);
-    int cmpRet =
-      strcmp(
-        retCode,
-        "0");
-    free(retCode);
-    if (cmpRet != 0) {
+  // If it's already freed, nothing to do
+  if (that == NULL || *that == NULL) return;
 
-      free(that->errMsg);
-      that->errMsg =
-        GetJSONValOfKey(
-          that->curlReply,
-          "errMsg");
-      Raise(RunRecorderExc_ApiRequestFailed);
+  // If there are values, free the values
+  if ((*that)->values != NULL)
+    ForZeroTo(iPair, (*that)->nb) free((*that)->values[iPair]);
+
+  // If there are default values, free the default values
+  if ((*that)->defaultValues != NULL)
+    ForZeroTo(iPair, (*that)->nb) free((*that)->defaultValues[iPair]);
+
+  // Free memory
+  free((*that)->types);
+  free((*that)->defaultValues);
+  free((*that)->values);
+  free((*that)->refs);
+  free(*that);
+  *that = NULL;
+
+}
+
+// Get the index of a metric in a RunRecorderMeasures
+// Inputs:
+//     that: the struct RunRecorderMeasures
+//   metric: the metric's label
+// Output:
+//   Return the index of the metric
+int RunRecorderMeasuresGetIdxMetric(
+  struct RunRecorderMeasures const* const that,
+                        char const* const metric) {
+
+  // Variables to memorise the index of the metric
+  int idx = -1;
+
+  Try {
+
+    // Loop on the metrics
+    ForZeroTo(iMetric, that->nbMetric) {
+
+      // If it's the metric, memorise the index
+      int retStrCmp =
+        strcmp(
+          that->metrics[iMetric],
+          metric);
+      if (retStrCmp == 0) idx = iMetric;
 
     }
 
+    // If we couldn't find the indices, raise an exception
+    if (idx == -1 ) Raise(RunRecorderExc_InvalidMetricLabel);
+
+  } CatchDefault {
+
+    // Forward the exception
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  return idx;
+
+}
+
+// Get a value of a struct RunRecorderMeasures as an integer. Values read
+// from a numeric column of a local database are returned without parsing,
+// others are parsed from their string.
+// Inputs:
+//       that: the struct RunRecorderMeasures
+//   iMeasure: the index of the measure
+//    iMetric: the index of the metric
+// Output:
+//   Return the value, or 0 if it is not a number
+long RunRecorderMeasuresGetLong(
+  struct RunRecorderMeasures const* const that,
+                               long const iMeasure,
+                               long const iMetric) {
+
+  // Index of the value in the cells
+  long const iCell = iMeasure * that->nbMetric + iMetric;
+
+  // If the value is numeric, return it
+  if (that->types[iCell] == RunRecorderMetricType_int)
+    return that->nums[iCell].i;
+  if (that->types[iCell] == RunRecorderMetricType_double)
+    return (long)(that->nums[iCell].d);
+
+  // Else, parse the string, truncating the decimals if any
+  long val = 0;
+  bool isLong =
+    StrToLong(
+      that->values[iMeasure][iMetric],
+      &val);
+  if (isLong == false) {
+
+    double valDouble = 0.0;
+    bool isNum =
+      StrToDouble(
+        that->values[iMeasure][iMetric],
+        &valDouble);
+    if (isNum == true) val = (long)valDouble;
+
   }
 
+  // Return the value
+  return val;
+
 }
 
-// Get the version of the database via the Web API
-// Input:
-//   The struct RunRecorder
+// Get a value of a struct RunRecorderMeasures as a double. Values read
+// from a numeric column of a local database are returned without parsing,
+// exactly as they were added, others are parsed from their string.
+// Inputs:
+//       that: the struct RunRecorderMeasures
+//   iMeasure: the index of the measure
+//    iMetric: the index of the metric
 // Output:
-//   Return a new string
-static char* GetVersionAPI(
-  struct RunRecorder* const that) {
+//   Return the value, or 0 if it is not a number
+double RunRecorderMeasuresGetDouble(
+  struct RunRecorderMeasures const* const that,
+                               long const iMeasure,
+                               long const iMetric) {
 
-  // Create the request to the Web API
-  SetAPIReqPostVal(
-    that,
-    "action=version");
+  // Index of the value in the cells
+  long const iCell = iMeasure * that->nbMetric + iMetric;
 
-  // Send the request to the API
-  bool isJsonReq = true;
-  SendAPIReq(
-    that,
-    isJsonReq);
+  // If the value is numeric, return it
+  if (that->types[iCell] == RunRecorderMetricType_double)
+    return that->nums[iCell].d;
+  if (that->types[iCell] == RunRecorderMetricType_int)
+    return (double)(that->nums[iCell].i);
 
-  // Extract the version number from the JSON reply
-  char* version =
-    GetJSONValOfKey(
-      that->curlReply,
-      "version");
+  // Else, parse the string
+  double val = 0.0;
+  StrToDouble(
+    that->values[iMeasure][iMetric],
+    &val);
 
-  // Return the version
-  return version;
+  // Return the value
+  return val;
 
 }
 
-// Add a new project in a local database
-// Input:
-//   that: the struct RunRecorder
-//   name: the name of the new project, it must respect the following
-//         pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
+// Get the measures of a project by column. The numeric values are
+// stored in arrays of the type of their metric, and the values of text
+// metrics as indices in a dictionary of their distinct values.
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+// Output:
+//   Return the measures as a new struct RunRecorderColumns
 // Raise:
-//   RunRecorderExc_InvalidProjectName
-//   RunRecorderExc_ProjectNameAlreadyUsed
-static void AddProjectLocal(
+//   RunRecorderExc_SQLRequestFailed
+struct RunRecorderColumns* RunRecorderGetColumns(
   struct RunRecorder* const that,
-          char const* const name) {
+          char const* const project) {
 
-  // Create the SQL command
-  StringCreate(
-    &(that->cmd),
-    "INSERT INTO _Project (Ref, Label) VALUES (NULL, \"%s\")",
-    name);
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-  // Execute the command to add the project
-  int retExec =
-    sqlite3_exec(
-      that->db,
-      that->cmd,
-      NULL,
-      NULL,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_AddProjectFailed);
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
+
+    return
+      GetColumnsLocal(
+        that,
+        project);
+
+  // Else, the RunRecorder uses the Web API
+  } else {
+
+    return
+      GetColumnsAPI(
+        that,
+        project);
+
+  }
 
 }
 
-// Add a new project through the Web API
-// Input:
-//   that: the struct RunRecorder
-//   name: the name of the new project, it must respect the following
-//         pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
+// Get the measures of a project in a period of time by column
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a new struct RunRecorderColumns, ordered
+//   from the oldest to the most recent
 // Raise:
-//   RunRecorderExc_InvalidProjectName
-//   RunRecorderExc_ProjectNameAlreadyUsed
-static void AddProjectAPI(
+//   RunRecorderExc_SQLRequestFailed
+struct RunRecorderColumns* RunRecorderGetColumnsInRange(
   struct RunRecorder* const that,
-          char const* const name) {
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit) {
 
-  // Create the request to the Web API
-  StringCreate(
-    &(that->cmd),
-    "action=add_project&label=%s",
-    name);
-  SetAPIReqPostVal(
-    that,
-    that->cmd);
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-  // Send the request to the API
-  bool isJsonReq = true;
-  SendAPIReq(
-    that,
-    isJsonReq);
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
+
+    return
+      GetColumnsInRangeLocal(
+        that,
+        project,
+        fromDate,
+        toDate,
+        limit);
+
+  // Else, the RunRecorder uses the Web API
+  } else {
+
+    return
+      GetColumnsInRangeAPI(
+        that,
+        project,
+        fromDate,
+        toDate,
+        limit);
+
+  }
 
 }
 
-// Check if a value is present in pairs ref/val
-// Inputs:
-//   that: the struct RunRecorderRefVal
-//    val: the value to check
-// Output:
-//   Return true if the value is present in the pairs, else false
-static bool PairsRefValContainsVal(
-  struct RunRecorderRefVal const* const that,
-                      char const* const val) {
+// Free a struct RunRecorderColumns
+// Input:
+//   that: the struct RunRecorderColumns
+void RunRecorderColumnsFree(
+  struct RunRecorderColumns** const that) {
 
-  // Loop on the pairs
-  ForZeroTo(iPair, that->nb) {
+  // If it's already freed, nothing to do
+  if (that == NULL || *that == NULL) return;
 
-    // If the pair's value is the checked value, return true
-    int retCmp =
-      strcmp(
-        val,
-        that->values[iPair]);
-    if (retCmp == 0) return true;
+  // Free the arrays of the columns
+  ForZeroTo(iMetric, (*that)->nbMetric) {
+
+    struct RunRecorderColumn* column = (*that)->columns + iMetric;
+    free(column->ints);
+    free(column->doubles);
+    free(column->codes);
+    free(column->validity);
+    free(column->dict);
+    free(column->hash);
 
   }
 
-  // If we reach here, we haven't found the checked value, return false
-  return false;
+  // Free the blocks of memory storing the labels and dictionaries
+  ArenaFree(&((*that)->arena));
+
+  // Free memory
+  free((*that)->columns);
+  free(*that);
+  *that = NULL;
 
 }
 
-// Check if a value is present in pairs ref/val with default value
+// Get the index of a metric in a struct RunRecorderColumns
 // Inputs:
-//   that: the struct RunRecorderRefValDef
-//    val: the value to check
+//     that: the struct RunRecorderColumns
+//   metric: the metric's label
 // Output:
-//   Return true if the value is present in the pairs, else false
-static bool PairsRefValDefContainsVal(
-  struct RunRecorderRefValDef const* const that,
-                         char const* const val) {
+//   Return the index of the metric
+// Raise:
+//   RunRecorderExc_InvalidMetricLabel
+long RunRecorderColumnsGetIdxMetric(
+  struct RunRecorderColumns const* const that,
+                        char const* const metric) {
 
-  // Loop on the pairs
-  ForZeroTo(iPair, that->nb) {
+  // Loop on the columns
+  ForZeroTo(iMetric, that->nbMetric) {
 
-    // If the pair's value is the checked value, return true
+    // If it's the metric, return its index
     int retCmp =
       strcmp(
-        val,
-        that->values[iPair]);
-    if (retCmp == 0) return true;
+        that->columns[iMetric].label,
+        metric);
+    if (retCmp == 0) return iMetric;
 
   }
 
-  // If we reach here, we haven't found the checked value, return false
-  return false;
+  // The metric couldn't be found
+  Raise(RunRecorderExc_InvalidMetricLabel);
+  return -1;
 
 }
 
-// Add a new pair in a struct RunRecorderRefVal
+// Check if a value of a struct RunRecorderColumn is valid
 // Inputs:
-//   pairs: the struct RunRecorderRefVal
-//     ref: the reference of the pair
-//     val: the val of the pair
-static void PairsRefValAdd(
-  struct RunRecorderRefVal* const pairs,
-                       long const ref,
-                char const* const val) {
-
-  // Allocate memory for the new value
-  SafeRealloc(
-    pairs->refs,
-    sizeof(long) * (pairs->nb + 1));
-  SafeRealloc(
-    pairs->values,
-    sizeof(char*) * (pairs->nb + 1));
-  pairs->values[pairs->nb] = NULL;
-
-  // Update the number of pairs
-  ++(pairs->nb);
+//       that: the struct RunRecorderColumn
+//   iMeasure: the index of the measure
+// Output:
+//   Return true if the value is valid, else false
+bool RunRecorderColumnIsValid(
+  struct RunRecorderColumn const* const that,
+                             long const iMeasure) {
 
-  // Set the reference and value of the pair
-  pairs->refs[pairs->nb - 1] = ref;
-  SafeStrDup(
-    pairs->values[pairs->nb - 1],
-    val);
+  return ((that->validity[iMeasure / 8] >> (iMeasure % 8)) & 1) != 0;
 
 }
 
-// Add a new pair in a struct RunRecorderRefValDef
+// Aggregate the values of a metric of a project in a period of time. The
+// aggregation is executed by the database, only its result is returned.
 // Inputs:
-//        pairs: the struct RunRecorderRefValDef
-//          ref: the reference of the pair
-//          val: the value of the pair
-//   defaultVal: the default value of the pair
-static void PairsRefValDefAdd(
-  struct RunRecorderRefValDef* const pairs,
-                          long const ref,
-                   char const* const val,
-                   char const* const defaultVal) {
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+// Output:
+//   Return the aggregated value, or NAN if there is no measure in the
+//   period (except for RunRecorderAggregateFn_count) or the result is not
+//   a number (e.g. the minimum of a text metric)
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_InvalidAggregate
+//   RunRecorderExc_SQLRequestFailed
+double RunRecorderAggregate(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate) {
 
-  // Allocate memory for the new value
-  SafeRealloc(
-    pairs->refs,
-    sizeof(long) * (pairs->nb + 1));
-  SafeRealloc(
-    pairs->values,
-    sizeof(char*) * (pairs->nb + 1));
-  pairs->values[pairs->nb] = NULL;
-  SafeRealloc(
-    pairs->defaultValues,
-    sizeof(char*) * (pairs->nb + 1));
-  pairs->defaultValues[pairs->nb] = NULL;
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-  // Update the number of pairs
-  ++(pairs->nb);
+  // Check the arguments, the labels are inserted in the request
+  bool isValidProject = RunRecorderIsValidLabel(project);
+  if (isValidProject == false) Raise(RunRecorderExc_InvalidProjectName);
+  bool isValidMetric = RunRecorderIsValidLabel(metric);
+  if (isValidMetric == false) Raise(RunRecorderExc_InvalidMetricLabel);
+  if (fn < 0 || fn >= RunRecorderAggregateFn_nb)
+    Raise(RunRecorderExc_InvalidAggregate);
 
-  // Set the reference, value and default value of the pair
-  pairs->refs[pairs->nb - 1] = ref;
-  SafeStrDup(
-    pairs->values[pairs->nb - 1],
-    val);
-  SafeStrDup(
-    pairs->defaultValues[pairs->nb - 1],
-    defaultVal);
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
+
+    return
+      AggregateLocal(
+        that,
+        project,
+        metric,
+        fn,
+        fromDate,
+        toDate);
+
+  // Else, the RunRecorder uses the Web API
+  } else {
+
+    return
+      AggregateAPI(
+        that,
+        project,
+        metric,
+        fn,
+        fromDate,
+        toDate);
+
+  }
 
 }
 
-// Callback to receive pairs of ref/value from sqlite3
-// Input:
-//      data: The pairs
-//     nbCol: Number of columns in the returned rows
-//    colVal: Row values, the reference is expected to be in the first
-//            column and the value in the second column
-//   colName: Columns name
+// Aggregate the values of a metric of a project in a period of time, per
+// interval of time. The intervals are aligned on the Epoch, so an interval
+// of 86400 seconds gives one value per day (UTC).
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//   interval: the duration of the intervals in seconds, must be > 0
 // Output:
-//   Return 0 if successful, else 1
-static int GetPairsLocalCb(
-   void* data,
-     int nbCol,
-  char** colVal,
-  char** colName) {
+//   Return the aggregated values as a new struct RunRecorderAggregates,
+//   ordered from the oldest to the most recent interval
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_InvalidAggregate
+//   RunRecorderExc_SQLRequestFailed
+struct RunRecorderAggregates* RunRecorderAggregateByInterval(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate,
+                         long const interval) {
 
-  // Unused argument
-  (void)colName;
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-  // If the arguments are invalid
-  // Return non zero to trigger SQLITE_ABORT in the calling function
-  if (nbCol != 2 || colVal == NULL ||
-      colVal[0] == NULL || colVal[1] == NULL) return 1;
+  // Check the arguments, the labels are inserted in the request
+  bool isValidProject = RunRecorderIsValidLabel(project);
+  if (isValidProject == false) Raise(RunRecorderExc_InvalidProjectName);
+  bool isValidMetric = RunRecorderIsValidLabel(metric);
+  if (isValidMetric == false) Raise(RunRecorderExc_InvalidMetricLabel);
+  if (fn < 0 || fn >= RunRecorderAggregateFn_nb || interval <= 0)
+    Raise(RunRecorderExc_InvalidAggregate);
 
-  // Cast the data
-  struct RunRecorderRefVal* pairs =
-    (struct RunRecorderRefVal*)data;
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
 
-  // Convert the reference contained in the first column from char* to long
-  errno = 0;
-  long ref =
-    strtol(
-      colVal[0],
-      NULL,
-      10);
+    return
+      AggregateByIntervalLocal(
+        that,
+        project,
+        metric,
+        fn,
+        fromDate,
+        toDate,
+        interval);
 
-  // If the conversion failed, return non zero to trigger SQLITE_ABORT
-  // in the calling function
-  if (errno != 0) return 1;
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-  // Add the pair ref/value to the pairs
-  Try {
+    return
+      AggregateByIntervalAPI(
+        that,
+        project,
+        metric,
+        fn,
+        fromDate,
+        toDate,
+        interval);
 
-    PairsRefValAdd(
-      pairs,
-      ref,
-      colVal[1]);
+  }
 
-  } CatchDefault {
+}
 
-    return 1;
+// Free a struct RunRecorderAggregates
+// Input:
+//   that: the struct RunRecorderAggregates
+void RunRecorderAggregatesFree(
+  struct RunRecorderAggregates** const that) {
 
-  } EndCatch;
+  // If it's already freed, nothing to do
+  if (that == NULL || *that == NULL) return;
 
-  // Return success code
-  return 0;
+  // Free memory
+  free((*that)->dates);
+  free((*that)->values);
+  free(*that);
+  *that = NULL;
 
 }
 
-// Callback to receive pairs of ref/value and their default value
-// from sqlite3
-// Input:
-//      data: The pairs
-//     nbCol: Number of columns in the returned rows
-//    colVal: Row values, the reference is expected to be in the first
-//            column and the value in the second column
-//   colName: Columns name
+// Open a handle on a project
+// Inputs:
+//   that: the struct RunRecorder
+//   name: the project's name
 // Output:
-//   Return 0 if successful, else 1
-static int GetPairsWithDefaultLocalCb(
-   void* data,
-     int nbCol,
-  char** colVal,
-  char** colName) {
+//   Return a new struct RunRecorderProject
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+struct RunRecorderProject* RunRecorderOpenProject(
+  struct RunRecorder* const that,
+          char const* const name) {
 
-  // Unused argument
-  (void)colName;
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-  // If the arguments are invalid
-  // Return non zero to trigger SQLITE_ABORT in the calling function
-  if (
-    nbCol != 3 || colVal == NULL || colVal[0] == NULL ||
-    colVal[1] == NULL || colVal[2] == NULL) return 1;
+  // Allocate memory for the handle
+  struct RunRecorderProject* project = NULL;
+  SafeMalloc(
+    project,
+    sizeof(struct RunRecorderProject));
+  project->recorder = that;
+  project->label = NULL;
+  project->ref = 0;
+  project->metrics = NULL;
+  project->isMaterialized = false;
+  project->insertMaterialized = NULL;
 
-  // Cast the data
-  struct RunRecorderRefValDef* pairs =
-    (struct RunRecorderRefValDef*)data;
+  Try {
 
-  // Convert the reference contained in the first column from char* to long
-  errno = 0;
-  long ref =
-    strtol(
-      colVal[0],
-      NULL,
-      10);
+    // Copy the project's name
+    SafeStrDup(
+      project->label,
+      name);
 
-  // If the conversion failed, return non zero to trigger SQLITE_ABORT
-  // in the calling function
-  if (errno != 0) return 1;
+    // If the RunRecorder uses a local database
+    if (UsesAPI(that) == false) {
+
+      // Get the reference of the project and its metrics
+      project->ref =
+        GetProjectRefLocal(
+          that,
+          name);
+      if (project->ref != 0) {
+
+        project->metrics =
+          GetMetricsLocal(
+            that,
+            name);
+        project->isMaterialized =
+          IsMaterializedLocal(
+            that,
+            name);
 
-  // Add the pair ref/value and default value to the pairs
-  Try {
+      }
 
-    PairsRefValDefAdd(
-      pairs,
-      ref,
-      colVal[1],
-      colVal[2]);
+    // Else, the RunRecorder uses the Web API
+    } else {
 
-  } CatchDefault {
+      // Get the reference of the project among the list of projects,
+      // the metrics are resolved by the Web API
+      struct RunRecorderRefVal* projects = GetProjectsAPI(that);
+      ForZeroTo(iProject, projects->nb) {
 
-    return 1;
+        int retCmp =
+          strcmp(
+            projects->values[iProject],
+            name);
+        if (retCmp == 0) project->ref = projects->refs[iProject];
 
-  } EndCatch;
+      }
+      PolyFree(&projects);
 
-  // Return success code
-  return 0;
+    }
 
-}
+    // If the project doesn't exist, raise an exception
+    if (project->ref == 0) {
 
-// Get the list of projects in the local database
-// Input:
-//   that: the struct RunRecorder
-// Output:
-//   Return the projects' reference/label
-// Raise:
-//   RunRecorderExc_SQLRequestFailed
-static struct RunRecorderRefVal* GetProjectsLocal(
-  struct RunRecorder* const that) {
+      SafeStrDup(
+        that->errMsg,
+        "The project doesn't exist.");
+      Raise(RunRecorderExc_InvalidProjectName);
 
-  // Declare a variable to memorise the projects
-  struct RunRecorderRefVal* projects = RunRecorderRefValCreate();
+    }
 
-  // Execute the command to get the version
-  char* sqlCmd = "SELECT Ref, Label FROM _Project";
-  int retExec =
-    sqlite3_exec(
-      that->db,
-      sqlCmd,
-      GetPairsLocalCb,
-      projects,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) {
+  } CatchDefault {
 
-    PolyFree(&projects);
-    Raise(RunRecorderExc_SQLRequestFailed);
+    PolyFree(&project);
+    Raise(TryCatchGetLastExc());
 
-  }
+  } EndCatch;
 
-  // Return the projects
-  return projects;
+  // Return the handle
+  return project;
 
 }
 
-// Extract a struct RunRecorderRefVal from a JSON string
+// Free a handle on a project. The struct RunRecorder it refers to is not
+// freed.
 // Input:
-//   json: the JSON string, expected to be formatted as "1":"A","2":"B",...
-// Output:
-//   Return a new struct RunRecorderRefVal
-// Raise:
-//   RunRecorderExc_InvalidJSON
-static struct RunRecorderRefVal* GetPairsRefValFromJSON(
-  char const* const json) {
-
-  // Create the pairs
-  struct RunRecorderRefVal* pairs = RunRecorderRefValCreate();
+//   that: the struct RunRecorderProject
+void RunRecorderProjectFree(
+  struct RunRecorderProject** const that) {
 
-  // Declare a pointer to loop on the json string
-  char const* ptr = json;
+  // If it's already freed, nothing to do
+  if (that == NULL || *that == NULL) return;
 
-  // Loop until the end of the json string
-  while (*ptr != '\0') {
+  // Free memory
+  sqlite3_finalize((*that)->insertMaterialized);
+  PolyFree(&((*that)->label));
+  PolyFree(&((*that)->metrics));
+  free(*that);
+  *that = NULL;
 
-    // Go to the next double quote or end of string
-    while (*ptr != '\0' && *ptr != '"') ++ptr;
+}
 
-    // If we have found the double quote
-    if (*ptr == '"') {
+// Add a measure to a project through its handle
+// Inputs:
+//      that: the handle on the project
+//   measure: the measure to add
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SessionFailed
+//   RunRecorderExc_AsyncQueueFull
+//   RunRecorderExc_SpoolFailed
+void RunRecorderProjectAddMeasure(
+         struct RunRecorderProject* const that,
+  struct RunRecorderMeasure const* const measure) {
 
-      // Skip the opening double quote of the reference
-      ++ptr;
+  // Add the measure as a batch of one measure to get it written in
+  // one single transaction
+  long const nbMeasure = 1;
+  RunRecorderProjectAddMeasures(
+    that,
+    (struct RunRecorderMeasure* const*)&measure,
+    nbMeasure);
 
-      // Get the reference
-      char* ptrEnd = NULL;
-      errno = 0;
-      long ref =
-        strtol(
-          ptr,
-          &ptrEnd,
-          10);
-      if (errno != 0 || *ptrEnd != '"') Raise(RunRecorderExc_InvalidJSON);
+}
 
-      // Move to the character after the closing double quote
-      ptr = ptrEnd + 1;
+// Add several measures to a project through its handle, in one single
+// transaction (or in the current session if there is one). Same policy
+// as RunRecorderAddMeasures.
+// Inputs:
+//        that: the handle on the project
+//    measures: the measures to add
+//   nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SessionFailed
+//   RunRecorderExc_AsyncQueueFull
+//   RunRecorderExc_SpoolFailed
+void RunRecorderProjectAddMeasures(
+        struct RunRecorderProject* const that,
+  struct RunRecorderMeasure* const* const measures,
+                              long const nbMeasure) {
 
-      // Go to the opening double quote for the value
-      while (*ptr != '\0' && *ptr != '"') ++ptr;
+  // Reset the reference of the last added measure
+  that->recorder->refLastAddedMeasure = 0;
 
-      // If we couldn't find the opening double quote for the value
-      if (*ptr == '\0') Raise(RunRecorderExc_InvalidJSON);
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that->recorder);
 
-      // Skip the opening double quote for the value
-      ++ptr;
+  // If the asynchronous writing is started, queue the measures
+  if (that->recorder->async != NULL) {
 
-      // Search the closing double quote for the value
-      char const* ptrEndVal = ptr;
-      while (*ptrEndVal != '\0' && *ptrEndVal != '"') ++ptrEndVal;
+    AddMeasuresAsync(
+      that->recorder,
+      that->label,
+      (struct RunRecorderMeasure const* const*)measures,
+      nbMeasure);
 
-      // If we couldn't find the closing double quote for the value
-      // or the value is null
-      if (*ptrEndVal == '\0' || ptrEndVal == ptr)
-        Raise(RunRecorderExc_InvalidJSON);
+  // Else, if the measures are spooled, send or spool the measures
+  } else if (that->recorder->spool != NULL) {
 
-      // Variable to memorise the value
-      char* val = NULL;
+    AddMeasuresSpool(
+      that->recorder,
+      that->label,
+      (struct RunRecorderMeasure const* const*)measures,
+      nbMeasure);
 
-      Try {
+  // Else, if the RunRecorder uses a local database, the measures are
+  // dated when they're added
+  } else if (UsesAPI(that->recorder) == false) {
 
-        // Get the value
-        size_t lenVal = ptrEndVal - ptr;
-        SafeMalloc(
-          val,
-          lenVal + 1);
-        memcpy(
-          val,
-          ptr,
-          lenVal);
-        val[lenVal] = '\0';
+    long const* const dates = NULL;
+    AddMeasuresLocal(
+      that,
+      (struct RunRecorderMeasure const* const*)measures,
+      nbMeasure,
+      dates);
 
-        // Move to the character after the closing double quote of the value
-        ptr = ptrEndVal + 1;
+  // Else, the RunRecorder uses the Web API, which dates the measures
+  } else {
 
-        // Add the pair
-        PairsRefValAdd(
-          pairs,
-          ref,
-          val);
+    long const* const dates = NULL;
+    AddMeasuresAPI(
+      that->recorder,
+      that->label,
+      (struct RunRecorderMeasure const* const*)measures,
+      nbMeasure,
+      dates);
 
-        // Free the temporary copy of the value
-        free(val);
+  }
 
-      } CatchDefault {
+}
 
-        free(val);
-        Raise(TryCatchGetLastExc());
+// Get the measures of a project through its handle
+// Input:
+//   that: the handle on the project
+// Output:
+//   Return the measures as a new struct RunRecorderMeasures
+struct RunRecorderMeasures* RunRecorderProjectGetMeasures(
+  struct RunRecorderProject* const that) {
 
-      } EndCatch;
+  return
+    RunRecorderGetMeasures(
+      that->recorder,
+      that->label);
 
-    }
+}
 
-  }
+// Get the most recent measures of a project through its handle
+// Inputs:
+//        that: the handle on the project
+//   nbMeasure: the number of measures to be returned
+// Output:
+//   Return the measures as a new struct RunRecorderMeasures, ordered
+//   from the most recent to the oldest
+struct RunRecorderMeasures* RunRecorderProjectGetLastMeasures(
+  struct RunRecorderProject* const that,
+                        long const nbMeasure) {
 
-  // Return the pairs
-  return pairs;
+  return
+    RunRecorderGetLastMeasures(
+      that->recorder,
+      that->label,
+      nbMeasure);
 
 }
 
-// Extract a struct RunRecorderRefValDef from a JSON string
-// Input:
-//   json: the JSON string for the metricss, expected to be formatted
-//         as "1":["Label":"A","DefaultValue":"B"],...
+// Get the measures of a project in a period of time through its handle
+// Inputs:
+//       that: the handle on the project
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
 // Output:
-//   Return a new struct RunRecorderRefValDef
-// Raise:
-//   RunRecorderExc_InvalidJSON
-static struct RunRecorderRefValDef* GetPairsRefValDefFromJSON(
-  char const* const json) {
+//   Return the measures as a new struct RunRecorderMeasures, ordered
+//   from the oldest to the most recent
+struct RunRecorderMeasures* RunRecorderProjectGetMeasuresInRange(
+  struct RunRecorderProject* const that,
+                      time_t const fromDate,
+                      time_t const toDate,
+                        long const limit) {
+
+  return
+    RunRecorderGetMeasuresInRange(
+      that->recorder,
+      that->label,
+      fromDate,
+      toDate,
+      limit);
 
-  // Create the pairs
-  struct RunRecorderRefValDef* pairs =
-    RunRecorderRefValDefCreate();
+}
 
-  // Declare a pointer to loop on the json string
-  char const* ptr = json;
+// Get the measures of a project added after a given measure through its
+// handle
+// Inputs:
+//      that: the handle on the project
+//   refLast: the reference of the last measure already read (0 to read
+//            all the measures), updated to the reference of the last
+//            returned measure, unchanged if there is no new measure
+// Output:
+//   Return the measures as a new struct RunRecorderMeasures, ordered
+//   from the oldest to the most recent added
+struct RunRecorderMeasures* RunRecorderProjectGetMeasuresSince(
+  struct RunRecorderProject* const that,
+                       long* const refLast) {
 
-  // Loop until the end of the json string
-  while (*ptr != '\0') {
+  return
+    RunRecorderGetMeasuresSince(
+      that->recorder,
+      that->label,
+      refLast);
 
-    // Go to the next double quote or end of string
-    while (*ptr != '\0' && *ptr != '"') ++ptr;
+}
 
-    // If we have found the double quote
-    if (*ptr == '"') {
+// Open a cursor on the measures of a project. The measures are then read
+// one at a time with RunRecorderMeasuresCursorNext, in the same order as
+// RunRecorderGetMeasures, without loading all of them in memory
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+// Output:
+//   Return a new struct RunRecorderMeasuresCursor
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+//   RunRecorderExc_CurlSetOptFailed
+//   RunRecorderExc_CurlRequestFailed
+//   RunRecorderExc_ApiRequestFailed
+struct RunRecorderMeasuresCursor* RunRecorderMeasuresCursorOpen(
+  struct RunRecorder* const that,
+          char const* const project) {
 
-      // Skip the opening double quote of the reference
-      ++ptr;
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
 
-      // Get the reference
-      char* ptrEnd = NULL;
-      errno = 0;
-      long ref =
-        strtol(
-          ptr,
-          &ptrEnd,
-          10);
-      if (errno != 0 || *ptrEnd != '"') Raise(RunRecorderExc_InvalidJSON);
+  // Allocate memory for the cursor
+  struct RunRecorderMeasuresCursor* cursor = NULL;
+  SafeMalloc(
+    cursor,
+    sizeof(struct RunRecorderMeasuresCursor));
+  cursor->recorder = that;
+  cursor->nbMetric = 0;
+  cursor->metrics = NULL;
+  cursor->values = NULL;
+  cursor->stmt = NULL;
+  cursor->curlMulti = NULL;
+  cursor->buffer = NULL;
+  cursor->sizeBuffer = 0;
+  cursor->lenBuffer = 0;
+  cursor->posBuffer = 0;
+  cursor->isPaused = false;
+  cursor->isTransferDone = false;
 
-      // Move to the character after the closing double quote
-      ptr = ptrEnd + 1;
+  Try {
 
-      // Check it is the expected ':'
-      if (*ptr != ':') Raise(RunRecorderExc_InvalidJSON);
+    // If the RunRecorder uses a local database
+    if (UsesAPI(that) == false) {
 
-      // Move to the next character
-      ++ptr;
+      OpenCursorLocal(
+        cursor,
+        project);
 
-      // Check it is the expected '{'
-      if (*ptr != '{') Raise(RunRecorderExc_InvalidJSON);
+    // Else, the RunRecorder uses the Web API
+    } else {
 
-      // Move to the next character
-      ++ptr;
+      OpenCursorAPI(
+        cursor,
+        project);
 
-      // Declare two variables to extract the value of the label and
-      // default value
-      char* label = NULL;
-      char* defaultVal = NULL;
+    }
 
-      Try {
+  } CatchDefault {
 
-        // Get the value of the key 'Label'
-        label =
-          GetJSONValOfKey(
-            ptr,
-            "Label");
+    RunRecorderMeasuresCursorClose(&cursor);
+    Raise(TryCatchGetLastExc());
 
-        // Get the value of the key 'DefaultValue'
-        defaultVal =
-          GetJSONValOfKey(
-            ptr,
-            "DefaultValue");
+  } EndCatch;
 
-        // Add the pair
-        PairsRefValDefAdd(
-          pairs,
-          ref,
-          label,
-          defaultVal);
+  // Return the cursor
+  return cursor;
 
-        // Free memory
-        free(label);
-        free(defaultVal);
+}
 
-      } CatchDefault {
+// Move a cursor to the next measure
+// Input:
+//   that: the struct RunRecorderMeasuresCursor
+// Output:
+//   Return true and set that->values to the values of the measure if
+//   there is a next measure, else return false
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+//   RunRecorderExc_CurlRequestFailed
+//   RunRecorderExc_ApiRequestFailed
+bool RunRecorderMeasuresCursorNext(
+  struct RunRecorderMeasuresCursor* const that) {
 
-        free(label);
-        free(defaultVal);
-        Raise(TryCatchGetLastExc());
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that->recorder);
 
-      } EndCatch;
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that->recorder) == false) {
 
-      // Go to the closing curly brace for the metric
-      while (*ptr != '\0' && *ptr != '}') ++ptr;
+    return NextCursorLocal(that);
 
-      // If we couldn't find the closing curly brace for the metric
-      if (*ptr == '\0') Raise(RunRecorderExc_InvalidJSON);
+  // Else, the RunRecorder uses the Web API
+  } else {
 
-    }
+    return NextCursorAPI(that);
 
   }
 
-  // Return the pairs
-  return pairs;
-
 }
 
-// Get the list of projects through the Web API
+// Close a cursor and free the memory it uses
 // Input:
-//   that: the struct RunRecorder
-// Output:
-//   Return the projects' reference/label
-static struct RunRecorderRefVal* GetProjectsAPI(
-  struct RunRecorder* const that) {
+//   that: the struct RunRecorderMeasuresCursor
+void RunRecorderMeasuresCursorClose(
+  struct RunRecorderMeasuresCursor** const that) {
 
-  // Create the request to the Web API
-  SetAPIReqPostVal(
-    that,
-    "action=projects");
+  // If it's already freed, nothing to do
+  if (that == NULL || *that == NULL) return;
 
-  // Send the request to the API
-  bool isJsonReq = true;
-  SendAPIReq(
-    that,
-    isJsonReq);
+  // Finalize the request on the local database
+  sqlite3_finalize((*that)->stmt);
 
-  // Variable to memorise the value of the 'projects' key
-  char* json = NULL;
+  // If the cursor uses the Web API
+  struct RunRecorder* const recorder = (*that)->recorder;
+  if (UsesAPI(recorder) == true) {
 
-  // Variable to memorise the projects
-  struct RunRecorderRefVal* projects = NULL;
-  Try {
+    // Stop the transfer
+    if ((*that)->curlMulti != NULL) {
 
-    // Get the projects list in the JSON reply
-    char* json =
-      GetJSONValOfKey(
-        that->curlReply,
-        "projects");
-    if (json == NULL) Raise(RunRecorderExc_ApiRequestFailed);
+      curl_multi_remove_handle(
+        (*that)->curlMulti,
+        recorder->curl);
+      curl_multi_cleanup((*that)->curlMulti);
 
-    // Extract the projects
-    projects = GetPairsRefValFromJSON(json);
+    }
 
-    // Free memory
-    free(json);
+    // Restore the reception of the incoming data in the struct RunRecorder
+    curl_easy_setopt(
+      recorder->curl,
+      CURLOPT_WRITEDATA,
+      &(recorder->curlReply));
+    curl_easy_setopt(
+      recorder->curl,
+      CURLOPT_WRITEFUNCTION,
+      GetReplyAPI);
 
-  } CatchDefault {
+  }
 
-    free(json);
-    Raise(TryCatchGetLastExc());
+  // Free memory
+  if ((*that)->metrics != NULL)
+    ForZeroTo(iMetric, (*that)->nbMetric) free((*that)->metrics[iMetric]);
+  PolyFree(&((*that)->metrics));
+  PolyFree(&((*that)->values));
+  PolyFree(&((*that)->buffer));
+  free(*that);
+  *that = NULL;
 
-  } EndCatch;
+}
 
-  // Return the projects
-  return projects;
+// ================== Private functions definition =========================
 
-}
+// Clone of asprintf
+// Inputs:
+//   str: pointer to the string to be created
+//   fmt: format as in sprintf
+//   ...: arguments as in sprintf
+static void StringCreate(
+  char** str,
+   char* fmt,
+         ...) {
 
-// Create a struct RunRecorderRefVal
-// Output:
-//   Return the new struct RunRecorderRefVal
-static struct RunRecorderRefVal* RunRecorderRefValCreate(
-  void) {
+  // Get the length of the string
+  char c[1];
+  va_list argp;
+  va_start(
+    argp,
+    fmt);
+  int len =
+    vsnprintf(
+      c,
+      1,
+      fmt,
+      argp) + 1;
+  va_end(argp);
 
-  // Declare the new struct RunRecorderRefVal
-  struct RunRecorderRefVal* pairs = NULL;
+  // Allocate memory
   SafeMalloc(
-    pairs,
-    sizeof(struct RunRecorderRefVal));
-
-  // Initialise properties
-  pairs->nb = 0;
-  pairs->refs = NULL;
-  pairs->values = NULL;
+    *str,
+    len);
 
-  // Return the new struct RunRecorderRefVal
-  return pairs;
+  // Create the string
+  va_start(
+    argp,
+    fmt);
+  vsnprintf(
+    *str,
+    len,
+    fmt,
+    argp);
+  va_end(argp);
 
 }
 
-// Create a struct RunRecorderRefValDef
+// Convert a string to an integer
+// Inputs:
+//   str: the string
+//   val: where to memorise the integer
 // Output:
-//   Return the new struct RunRecorderRefValDef
-static struct RunRecorderRefValDef* RunRecorderRefValDefCreate(
-  void) {
+//   Return true if the whole string is an integer, else false and val is
+//   left unchanged
+static bool StrToLong(
+  char const* const str,
+         long* const val) {
 
-  // Declare the new struct RunRecorderRefValDef
-  struct RunRecorderRefValDef* pairs = NULL;
-  SafeMalloc(
-    pairs,
-    sizeof(struct RunRecorderRefValDef));
+  // If there is no string, it's not an integer
+  if (str == NULL || *str == '\0') return false;
 
-  // Initialise properties
-  pairs->nb = 0;
-  pairs->refs = NULL;
-  pairs->values = NULL;
-  pairs->defaultValues = NULL;
+  // Convert the string and check the whole string has been converted
+  char* end = NULL;
+  errno = 0;
+  long conv =
+    strtol(
+      str,
+      &end,
+      10);
+  if (errno != 0 || *end != '\0') return false;
 
-  // Return the new struct RunRecorderRefValDef
-  return pairs;
+  // Memorise the integer
+  *val = conv;
+  return true;
 
 }
 
-// Get the list of metrics for a project from a local database
-// Input:
-//      that: the struct RunRecorder
-//   project: the project
+// Convert a string to a double
+// Inputs:
+//   str: the string
+//   val: where to memorise the double
 // Output:
-//   Return the metrics' reference/label/default value
-// Raise:
-//   RunRecorderExc_SQLRequestFailed
-static struct RunRecorderRefValDef* GetMetricsLocal(
-  struct RunRecorder* const that,
-          char const* const project) {
+//   Return true if the whole string is a number, else false and val is
+//   left unchanged
+static bool StrToDouble(
+  char const* const str,
+       double* const val) {
 
-  // Create the request
-  StringCreate(
-    &(that->cmd),
-    "SELECT _Metric.Ref, _Metric.Label, _Metric.DefaultValue "
-    "FROM _Metric, _Project "
-    "WHERE _Metric.RefProject = _Project.Ref AND "
-    "_Project.Label = \"%s\" ORDER BY _Metric.Label",
-    project);
+  // If there is no string, it's not a number
+  if (str == NULL || *str == '\0') return false;
 
-  // Declare a variable to memorise the metrics
-  struct RunRecorderRefValDef* metrics = NULL;
-  Try {
+  // Convert the string and check the whole string has been converted
+  char* end = NULL;
+  errno = 0;
+  double conv =
+    strtod(
+      str,
+      &end);
+  if (errno != 0 || *end != '\0') return false;
+
+  // Memorise the double
+  *val = conv;
+  return true;
 
-    // Create the struct RunRecorderRefValDef to memorise the metrics
-    metrics = RunRecorderRefValDefCreate();
+}
 
-    // Execute the request
-    int retExec =
-      sqlite3_exec(
-        that->db,
-        that->cmd,
-        GetPairsWithDefaultLocalCb,
-        metrics,
-        &(that->sqliteErrMsg));
-    if (retExec != SQLITE_OK) Raise(RunRecorderExc_SQLRequestFailed);
+// Convert a double to the shortest string, among 15 and 17 significant
+// digits, which converts back exactly to the same double
+// Inputs:
+//   val: the double
+//   str: the buffer where to write the string, of size LENGTH_NUM_STR
+static void FormatDouble(
+  double const val,
+   char* const str) {
+
+  // Try first with 15 digits, which avoids the noise of the last digits
+  // for most values (0.1 instead of 0.10000000000000001)
+  snprintf(
+    str,
+    LENGTH_NUM_STR,
+    "%.15g",
+    val);
 
-  } CatchDefault {
+  // If the conversion back is not exact, use 17 digits which always is
+  double conv =
+    strtod(
+      str,
+      NULL);
+  if (conv != val)
+    snprintf(
+      str,
+      LENGTH_NUM_STR,
+      "%.17g",
+      val);
 
-      PolyFree(&metrics);
-      Raise(TryCatchGetLastExc());
+}
 
-  } EndCatch;
+// Init the connection of a struct RunRecorder to the local database or
+// Web API
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_OpenDbFailed
+//   RunRecorderExc_CreateCurlFailed
+//   RunRecorderExc_CurlSetOptFailed
+static void InitConnection(
+  struct RunRecorder* const that) {
 
-  // Return the metrics
-  return metrics;
+  // If the recorder doesn't use the API
+  if (UsesAPI(that) == false) {
+
+    // Init the local connection to the database
+    InitLocal(that);
+
+  // Else, the recorder uses the API
+  } else {
+
+    // Init the Web API
+    InitWebAPI(that);
+
+  }
 
 }
 
-// Get the list of metrics for a project through the Web API
+// Init a struct RunRecorder using a local SQLite database
 // Input:
-//      that: the struct RunRecorder
-//   project: the project
-// Output:
-//   Return the metrics' reference/label/default value
+//   that: the struct RunRecorder
 // Raise:
-//   RunRecorderExc_ApiRequestFailed
-static struct RunRecorderRefValDef* GetMetricsAPI(
-  struct RunRecorder* const that,
-          char const* const project) {
+//   RunRecorderExc_OpenDbFailed
+static void InitLocal(
+  struct RunRecorder* const that) {
 
-  // Create the request to the Web API
-  StringCreate(
-    &(that->cmd),
-    "action=metrics&project=%s",
-    project);
-  SetAPIReqPostVal(
-    that,
-    that->cmd);
+  // Try to open the file in reading mode to check if it exists
+  FILE* fp =
+    fopen(
+      that->url,
+      "r");
 
-  // Send the request to the API
-  bool isJsonReq = true;
-  SendAPIReq(
-    that,
-    isJsonReq);
+  // Open the connection to the local database, if the database doesn't
+  // exist an empty one will be created automatically by SQLite3
+  int ret =
+    sqlite3_open(
+      that->url,
+      &(that->db));
 
-  // Variable to memorise the value of the 'metrics' key
-  char* json = NULL;
+  // If the database couldn't be opened/created
+  if (ret != SQLITE_OK) {
 
-  // Variable to memorise the metrics
-  struct RunRecorderRefValDef* metrics = NULL;
-  Try {
+    // If it could be opend through fopen, close it
+    if (fp != NULL) fclose(fp);
 
-    // Get the labels and default values in the JSON reply
-    json =
-      GetJSONValOfKey(
-        that->curlReply,
-        "metrics");
-    if (json == NULL) Raise(RunRecorderExc_ApiRequestFailed);
+    // Copy the error message and raise an exception
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(that->db));
+    Raise(RunRecorderExc_OpenDbFailed);
 
-    // Extract the metrics
-    metrics = GetPairsRefValDefFromJSON(json);
+  // Else, the database could be opened/created
+  } else {
 
-    // Free memory
-    free(json);
+    // Wait for the locks held by other connections instead of failing
+    sqlite3_busy_handler(
+      that->db,
+      BusyHandler,
+      that);
 
-  } CatchDefault {
+    // If we couldn't open it with fopen before opening it with
+    // sqlite3_open it means the database has just been created by
+    // SQLite3
+    if (fp == NULL) {
 
-    free(json);
-    PolyFree(&metrics);
-    Raise(TryCatchGetLastExc());
+      // Create the RunRecorder's tables in the database, and set the
+      // options of the connection
+      CreateDb(that);
+      bool const isNew = true;
+      SetOptionsLocal(
+        that,
+        isNew);
 
-  } EndCatch;
+    // Else, the database could be opened and is ready to use by RunRecorder
+    } else {
 
-  // Return the metrics
-  return metrics;
+      // Close the FILE*
+      fclose(fp);
+
+      // Set the options of the connection
+      bool const isNew = false;
+      SetOptionsLocal(
+        that,
+        isNew);
+
+    }
+
+  }
 
 }
 
-// Update the view for a project
-// Input:
-//         that: the struct RunRecorder
-//      project: the name of the project
+// Set the options of the connection to a local database
+// Inputs:
+//    that: the struct RunRecorder
+//   isNew: flag to memorise if the database has just been created, the
+//          page size is only set in that case
 // Raise:
-//   RunRecorderExc_UpdateViewFailed
-static void UpdateViewProject(
+//   RunRecorderExc_OpenDbFailed
+static void SetOptionsLocal(
   struct RunRecorder* const that,
-          char const* const project) {
+                 bool const isNew) {
 
-  // Create the SQL command to delete the view
-  sprintf(
-    that->cmd,
-    "DROP VIEW IF EXISTS \"%s\"",
-    project);
+  // Create the PRAGMA commands of the options which are not left to the
+  // default of SQLite. Once the tables are created, the page size is
+  // changed by a VACUUM (quick on a new database), which must be done
+  // before switching to the WAL mode.
+  struct RunRecorderOptions const* options = &(that->options);
+  if (
+    options->journalMode < 0 ||
+    options->journalMode >= RunRecorderJournalMode_nb ||
+    options->synchronous < 0 ||
+    options->synchronous >= RunRecorderSynchronous_nb ||
+    options->busyTimeout < 0 ||
+    options->busyBackoff < 0) {
 
-  // Execute the command to delete the view
+    SafeStrDup(
+      that->errMsg,
+      "Invalid options");
+    Raise(RunRecorderExc_OpenDbFailed);
+
+  }
+
+  StringCreate(
+    &(that->cmd),
+    "%s",
+    "");
+  if (isNew == true && options->pageSize > 0)
+    StringAppend(
+      &(that->cmd),
+      "PRAGMA page_size = %ld;VACUUM;",
+      options->pageSize);
+  if (journalModeSql[options->journalMode] != NULL)
+    StringAppend(
+      &(that->cmd),
+      "PRAGMA journal_mode = %s;",
+      journalModeSql[options->journalMode]);
+  if (synchronousSql[options->synchronous] != NULL)
+    StringAppend(
+      &(that->cmd),
+      "PRAGMA synchronous = %s;",
+      synchronousSql[options->synchronous]);
+  if (options->cacheSize > 0)
+    StringAppend(
+      &(that->cmd),
+      "PRAGMA cache_size = -%ld;",
+      options->cacheSize);
+  if (options->mmapSize > 0)
+    StringAppend(
+      &(that->cmd),
+      "PRAGMA mmap_size = %ld;",
+      options->mmapSize);
+
+  // Execute the commands
   int retExec =
     sqlite3_exec(
       that->db,
@@ -3160,900 +5821,8532 @@ static void UpdateViewProject(
       NULL,
       NULL,
       &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_UpdateViewFailed);
+  if (retExec != SQLITE_OK) Raise(RunRecorderExc_OpenDbFailed);
 
-  // Get the list of metrics for the project
-  struct RunRecorderRefValDef* metrics =
-    RunRecorderGetMetrics(
-      that,
-      project);
-  Try {
+}
 
-    // Create the head of the command
-    StringCreate(
-      &(that->cmd),
-      "CREATE VIEW \"%s\" (Ref",
-      project);
+// Busy handler of the connection to a local database, called by SQLite
+// when a lock is held by another connection. Waits before the next
+// attempt for a delay doubling from 1ms up to the backoff, with a random
+// jitter, until the busy timeout is reached.
+// Inputs:
+//      arg: the struct RunRecorder
+//   nbCall: the number of previous calls for the same lock
+// Output:
+//   Return 1 to make another attempt, 0 to fail with SQLITE_BUSY
+static int BusyHandler(
+  void* const arg,
+    int const nbCall) {
+
+  // Shortcut to the struct RunRecorder
+  struct RunRecorder* const that = arg;
+
+  // Memorise the time of the first attempt and give up if the timeout
+  // is reached. The monotonic clock is used so that a change of the
+  // system date doesn't shorten or extend the wait.
+  long const now = GetMonotonicNow();
+  if (nbCall == 0) that->dateBusy = now;
+  long const remaining =
+    that->options.busyTimeout - (now - that->dateBusy) / 1000L;
+  if (remaining <= 0) return 0;
+
+  // Get the delay, doubling from 1ms, in the upper half of which a
+  // random one is chosen to avoid the connections waiting for the same
+  // lock to retry all at the same time
+  long delay = that->options.busyBackoff;
+  if (nbCall < 16 && (1L << nbCall) < delay) delay = 1L << nbCall;
+  unsigned int rnd = 0;
+  sqlite3_randomness(
+    sizeof(rnd),
+    &rnd);
+  delay = delay - (long)(rnd % (unsigned int)(delay / 2 + 1));
+  if (delay < 1) delay = 1;
+  if (delay > remaining) delay = remaining;
+
+  // Wait and make another attempt
+  ++(that->nbBusyRetry);
+  sqlite3_sleep((int)delay);
+  return 1;
 
-    // For each metrics, extend the command with the metric label
-    ForZeroTo(iMetric, metrics->nb)
-      StringAppend(
-        &(that->cmd),
-        ",\"%s\"",
-        metrics->values[iMetric]);
+}
 
-    // Extend the command with the body
-    StringAppend(
-      &(that->cmd),
-      "%s",
-      ") AS SELECT _Measure.Ref ");
+// Init a struct RunRecorder using the Web API
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_CreateCurlFailed
+//   RunRecorderExc_CurlSetOptFailed
+static void InitWebAPI(
+  struct RunRecorder* const that) {
 
-    // For each metrics, extend the command with the metric related
-    // body part
-    ForZeroTo(iMetric, metrics->nb)
-      StringAppend(
-        &(that->cmd),
-        ",IFNULL((SELECT Value FROM _Value "
-        "WHERE RefMeasure=_Measure.Ref AND RefMetric=%ld),"
-        "(SELECT DefaultValue FROM _Metric WHERE Ref=%ld)) ",
-        metrics->refs[iMetric],
-        metrics->refs[iMetric]);
+  // Initialise Curl, once per process
+  pthread_once(
+    &curlInitOnce,
+    InitCurlOnce);
+  if (curlInitRes != CURLE_OK) Raise(RunRecorderExc_CreateCurlFailed);
 
-    // Free memory
-    PolyFree(&metrics);
+  // Get a Curl instance
+  that->curl = AcquireCurl();
+  if (that->curl == NULL) Raise(RunRecorderExc_CreateCurlFailed);
+
+  Try {
+
+    // Set the url of the Web API in the Curl instance
+    CURLcode res =
+      curl_easy_setopt(
+        that->curl,
+        CURLOPT_URL,
+        that->url);
+
+    // Set the pointer where to memorise received data
+    if (res == CURLE_OK)
+      res =
+        curl_easy_setopt(
+          that->curl,
+          CURLOPT_WRITEDATA,
+          &(that->curlReply));
+
+    // Set the callback to receive data
+    if (res == CURLE_OK)
+      res =
+        curl_easy_setopt(
+          that->curl,
+          CURLOPT_WRITEFUNCTION,
+          GetReplyAPI);
+
+    // Share the DNS resolutions and TLS sessions with the other struct
+    // RunRecorder
+    if (res == CURLE_OK && curlShare != NULL)
+      res =
+        curl_easy_setopt(
+          that->curl,
+          CURLOPT_SHARE,
+          curlShare);
+    if (res != CURLE_OK) {
+
+      SafeStrDup(
+        that->errMsg,
+        curl_easy_strerror(res));
+      Raise(RunRecorderExc_CurlSetOptFailed);
+
+    }
+
+    // Keep the connection alive between requests
+    SetCurlKeepAlive(that);
 
   } CatchDefault {
 
-    PolyFree(&metrics);
+    ReleaseCurl(that->curl);
+    that->curl = NULL;
     Raise(TryCatchGetLastExc());
 
   } EndCatch;
 
-  // Extend the command with the tail
-  StringAppend(
-    &(that->cmd),
-    "FROM _Measure, _Project WHERE _Measure.RefProject = _Project.Ref AND "
-    "_Project.Label = \"%s\" ORDER BY _Measure.DateMeasure, _Measure.Ref",
-    project);
+}
 
-  // Execute the command to add the view
-  retExec =
-    sqlite3_exec(
-      that->db,
-      that->cmd,
-      NULL,
-      NULL,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_UpdateViewFailed);
+// Initialise Curl for the process and create the share object, called
+// once with pthread_once. If the share object can't be created the
+// struct RunRecorder work without it.
+static void InitCurlOnce(
+  void) {
+
+  // Initialise Curl
+  curlInitRes = curl_global_init(CURL_GLOBAL_ALL);
+  if (curlInitRes != CURLE_OK) return;
+
+  // Release the Curl resources at the end of the process
+  atexit(CleanupCurl);
+
+  // Create the share object and its locks
+  curlShare = curl_share_init();
+  if (curlShare == NULL) return;
+  ForZeroTo(iLock, CURL_LOCK_DATA_LAST)
+    pthread_mutex_init(
+      curlShareLocks + iLock,
+      NULL);
+
+  // Set the lock functions and the shared data
+  CURLSHcode res =
+    curl_share_setopt(
+      curlShare,
+      CURLSHOPT_LOCKFUNC,
+      LockCurlShare);
+  if (res == CURLSHE_OK)
+    res =
+      curl_share_setopt(
+        curlShare,
+        CURLSHOPT_UNLOCKFUNC,
+        UnlockCurlShare);
+  if (res == CURLSHE_OK)
+    res =
+      curl_share_setopt(
+        curlShare,
+        CURLSHOPT_SHARE,
+        CURL_LOCK_DATA_DNS);
+  if (res == CURLSHE_OK)
+    res =
+      curl_share_setopt(
+        curlShare,
+        CURLSHOPT_SHARE,
+        CURL_LOCK_DATA_SSL_SESSION);
+  if (res != CURLSHE_OK) {
+
+    curl_share_cleanup(curlShare);
+    curlShare = NULL;
+
+  }
 
 }
 
-// Add a metric to a project to a local database
-// Input:
-//         that: the struct RunRecorder
-//      project: the name of the project to which add to the metric
-//        label: the label of the metric, it must respect the following
-//               pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
-//               There cannot be two metrics with the same label for the
-//               same project. A metric label can't be 'action' or 'project'
-//               (case sensitive, so 'Action' is fine).
-//   defaultVal: the default value of the metric, it must respect the
-//               following pattern: /^[^"=&]+$*/
-// Raise:
-//   RunRecorderExc_InvalidMetricLabel
-//   RunRecorderExc_MetricNameAlreadyUsed
-static void AddMetricLocal(
-  struct RunRecorder* const that,
-          char const* const project,
-          char const* const label,
-          char const* const defaultVal) {
+// Release the Curl resources of the process, registered with atexit
+static void CleanupCurl(
+  void) {
 
-  // Create the SQL command
-  StringCreate(
-    &(that->cmd),
-    "INSERT INTO _Metric (Ref, RefProject, Label, DefaultValue) "
-    "SELECT NULL, _Project.Ref, \"%s\", \"%s\" FROM _Project "
-    "WHERE _Project.Label = \"%s\"",
-    label,
-    defaultVal,
-    project);
+  // Free the idle Curl instances
+  ForZeroTo(iCurl, nbIdleCurl) curl_easy_cleanup(idleCurls[iCurl]);
+  nbIdleCurl = 0;
 
-  // Execute the command to add the metric
-  int retExec =
-    sqlite3_exec(
-      that->db,
+  // Free the share object
+  if (curlShare != NULL) {
+
+    curl_share_cleanup(curlShare);
+    curlShare = NULL;
+
+  }
+
+  // Release Curl
+  curl_global_cleanup();
+
+}
+
+// Lock function of the Curl share object
+// Inputs:
+//     curl: the Curl instance (unused)
+//     data: the type of shared data to lock
+//   access: the type of access (unused)
+//      ptr: the user pointer (unused)
+static void LockCurlShare(
+               CURL* const curl,
+    curl_lock_data const data,
+  curl_lock_access const access,
+               void* const ptr) {
+
+  // Unused parameters
+  (void)curl; (void)access; (void)ptr;
+
+  // Lock the data
+  pthread_mutex_lock(curlShareLocks + data);
+
+}
+
+// Unlock function of the Curl share object
+// Inputs:
+//   curl: the Curl instance (unused)
+//   data: the type of shared data to unlock
+//    ptr: the user pointer (unused)
+static void UnlockCurlShare(
+           CURL* const curl,
+  curl_lock_data const data,
+           void* const ptr) {
+
+  // Unused parameters
+  (void)curl; (void)ptr;
+
+  // Unlock the data
+  pthread_mutex_unlock(curlShareLocks + data);
+
+}
+
+// Get a Curl instance, an idle one with its open connections if there is
+// one, else a new one
+// Output:
+//   Return the Curl instance, with its default options, or NULL if it
+//   couldn't be created
+static CURL* AcquireCurl(
+  void) {
+
+  // Get an idle Curl instance if there is one
+  CURL* curl = NULL;
+  pthread_mutex_lock(&idleCurlsLock);
+  if (nbIdleCurl > 0) curl = idleCurls[--nbIdleCurl];
+  pthread_mutex_unlock(&idleCurlsLock);
+
+  // If there was one, reset its options, the open connections are kept
+  if (curl != NULL) {
+
+    curl_easy_reset(curl);
+
+  // Else, create a new one
+  } else {
+
+    curl = curl_easy_init();
+
+  }
+
+  // Return the Curl instance
+  return curl;
+
+}
+
+// Release a Curl instance, it is kept with its open connections to be
+// reused if there are less than NB_MAX_IDLE_CURL idle instances, else it
+// is freed
+// Input:
+//   curl: the Curl instance
+static void ReleaseCurl(
+  CURL* const curl) {
+
+  // Keep the Curl instance if possible
+  bool isKept = false;
+  pthread_mutex_lock(&idleCurlsLock);
+  if (nbIdleCurl < NB_MAX_IDLE_CURL) {
+
+    idleCurls[nbIdleCurl++] = curl;
+    isKept = true;
+
+  }
+  pthread_mutex_unlock(&idleCurlsLock);
+
+  // Else, free it
+  if (isKept == false) curl_easy_cleanup(curl);
+
+}
+
+// Set the TCP keep-alive options of the Curl instance of a struct
+// RunRecorder
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_CurlSetOptFailed
+static void SetCurlKeepAlive(
+  struct RunRecorder* const that) {
+
+  // Set the options, the probes are disabled if the idle delay is 0
+  CURLcode res =
+    curl_easy_setopt(
+      that->curl,
+      CURLOPT_TCP_KEEPALIVE,
+      (that->keepAliveIdle > 0 ? 1L : 0L));
+  if (res == CURLE_OK && that->keepAliveIdle > 0)
+    res =
+      curl_easy_setopt(
+        that->curl,
+        CURLOPT_TCP_KEEPIDLE,
+        that->keepAliveIdle);
+  if (res == CURLE_OK && that->keepAliveIdle > 0)
+    res =
+      curl_easy_setopt(
+        that->curl,
+        CURLOPT_TCP_KEEPINTVL,
+        that->keepAliveInterval);
+  if (res != CURLE_OK) {
+
+    SafeStrDup(
+      that->errMsg,
+      curl_easy_strerror(res));
+    Raise(RunRecorderExc_CurlSetOptFailed);
+
+  }
+
+}
+
+// Free the error messages of a struct RunRecorder
+// Input:
+//   that: The struct RunRecorder to be freed
+static void FreeErrMsg(
+  struct RunRecorder* const that) {
+
+  // Free the error messages
+  // SQLite3 error message needs to be freed its own way
+  free(that->errMsg);
+  that->errMsg = NULL;
+  sqlite3_free(that->sqliteErrMsg);
+  that->sqliteErrMsg = NULL;
+
+}
+
+// Check if a struct RunRecorder uses a local SQLite database or the
+// Web API
+// Input:
+//   that: The struct RunRecorder
+// Return:
+//   Return true if the struct RunRecorder uses the Web API, else false
+static bool UsesAPI(
+  struct RunRecorder const* const that) {
+
+  // If the url starts with http the struct RunRecorder uses the Web API
+  char const* http =
+    strstr(
+      that->url,
+      "http");
+  return (http == that->url);
+
+}
+
+// Reset the Curl reply, to be called before sending a new curl request
+// or the result of the new request will be appended to the eventual
+// one of the previous request
+// Input:
+//   The struct RunRecorder
+static void ResetCurlReply(
+  struct RunRecorder* const that) {
+
+  // Free the Curl reply
+  free(that->curlReply);
+  that->curlReply = NULL;
+
+}
+
+// Get a prepared statement from the cache of a struct RunRecorder, ready
+// to be bound and executed. The statement is prepared at its first use.
+// Inputs:
+//   that: the struct RunRecorder
+//     id: the identifier of the statement
+// Output:
+//   Return the statement
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static sqlite3_stmt* GetStmt(
+  struct RunRecorder* const that,
+  enum RunRecorderStmt const id) {
+
+  // If the statement hasn't been prepared yet
+  if (that->stmts[id] == NULL) {
+
+    // Prepare the statement
+    int retPrepare =
+      sqlite3_prepare_v2(
+        that->db,
+        stmtSql[id],
+        -1,
+        that->stmts + id,
+        NULL);
+    if (retPrepare != SQLITE_OK) {
+
+      SafeStrDup(
+        that->errMsg,
+        sqlite3_errmsg(that->db));
+      Raise(RunRecorderExc_SQLRequestFailed);
+
+    }
+
+  // Else, the statement has already been used
+  } else {
+
+    // Reset the statement and its bindings from the previous use
+    sqlite3_reset(that->stmts[id]);
+    sqlite3_clear_bindings(that->stmts[id]);
+
+  }
+
+  // Return the statement
+  return that->stmts[id];
+
+}
+
+// Bind a string to a parameter of a prepared statement
+// Inputs:
+//     that: the struct RunRecorder
+//     stmt: the statement
+//   iParam: the index of the parameter (starting at 1)
+//      val: the string, must stay valid until the statement is executed
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static void BindStmtText(
+  struct RunRecorder* const that,
+        sqlite3_stmt* const stmt,
+                  int const iParam,
+          char const* const val) {
+
+  // Bind the string, without copy
+  int retBind =
+    sqlite3_bind_text(
+      stmt,
+      iParam,
+      val,
+      -1,
+      SQLITE_STATIC);
+  if (retBind != SQLITE_OK) {
+
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(that->db));
+    Raise(RunRecorderExc_SQLRequestFailed);
+
+  }
+
+}
+
+// Bind an integer to a parameter of a prepared statement
+// Inputs:
+//     that: the struct RunRecorder
+//     stmt: the statement
+//   iParam: the index of the parameter (starting at 1)
+//      val: the integer
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static void BindStmtLong(
+  struct RunRecorder* const that,
+        sqlite3_stmt* const stmt,
+                  int const iParam,
+                 long const val) {
+
+  // Bind the integer
+  int retBind =
+    sqlite3_bind_int64(
+      stmt,
+      iParam,
+      val);
+  if (retBind != SQLITE_OK) {
+
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(that->db));
+    Raise(RunRecorderExc_SQLRequestFailed);
+
+  }
+
+}
+
+// Bind a double to a parameter of a prepared statement
+// Inputs:
+//     that: the struct RunRecorder
+//     stmt: the statement
+//   iParam: the index of the parameter (starting at 1)
+//      val: the double
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static void BindStmtDouble(
+  struct RunRecorder* const that,
+        sqlite3_stmt* const stmt,
+                  int const iParam,
+               double const val) {
+
+  // Bind the double
+  int retBind =
+    sqlite3_bind_double(
+      stmt,
+      iParam,
+      val);
+  if (retBind != SQLITE_OK) {
+
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(that->db));
+    Raise(RunRecorderExc_SQLRequestFailed);
+
+  }
+
+}
+
+// Bind a value of a measure to a parameter of a prepared statement,
+// converted to the type of its metric. Numeric values are bound as
+// native INTEGER or REAL, strings are parsed for numeric metrics. A value
+// which is not a number, or not an integer for an integer metric, is
+// invalid and left unbound.
+// Inputs:
+//      that: the struct RunRecorder
+//      stmt: the statement
+//    iParam: the index of the parameter (starting at 1)
+//   measure: the measure
+//      iVal: the index of the value in the measure
+//      type: the type of the metric of the value
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+//   RunRecorderExc_InvalidValue
+static void BindStmtValue(
+               struct RunRecorder* const that,
+                     sqlite3_stmt* const stmt,
+                               int const iParam,
+  struct RunRecorderMeasure const* const measure,
+                              long const iVal,
+        enum RunRecorderMetricType const type) {
+
+  // Shortcuts to the value
+  enum RunRecorderMetricType const typeVal = measure->types[iVal];
+  union RunRecorderNumVal const num = measure->nums[iVal];
+  char const* const str = measure->values[iVal];
+
+  // If the metric is an integer
+  if (type == RunRecorderMetricType_int) {
+
+    // Get the value as an integer, a double is accepted only if it's an
+    // integer in the range of long
+    long val = 0;
+    bool isNum = true;
+    if (typeVal == RunRecorderMetricType_int) {
+
+      val = num.i;
+
+    } else if (typeVal == RunRecorderMetricType_double) {
+
+      isNum =
+        isfinite(num.d) &&
+        num.d == trunc(num.d) &&
+        num.d >= -LONG_LIMIT_DOUBLE &&
+        num.d < LONG_LIMIT_DOUBLE;
+      if (isNum == true) val = (long)(num.d);
+
+    } else {
+
+      isNum =
+        StrToLong(
+          str,
+          &val);
+
+    }
+
+    // Bind the value
+    if (isNum == false) {
+
+      StringCreate(
+        &(that->errMsg),
+        "The value %s is invalid for an integer metric.",
+        str);
+      Raise(RunRecorderExc_InvalidValue);
+
+    }
+    BindStmtLong(
+      that,
+      stmt,
+      iParam,
+      val);
+
+  // Else, if the metric is a double
+  } else if (type == RunRecorderMetricType_double) {
+
+    // Get the value as a double
+    double val = 0.0;
+    bool isNum = true;
+    if (typeVal == RunRecorderMetricType_int) val = (double)(num.i);
+    else if (typeVal == RunRecorderMetricType_double) val = num.d;
+    else
+      isNum =
+        StrToDouble(
+          str,
+          &val);
+
+    // Bind the value
+    if (isNum == false || isfinite(val) == false) {
+
+      StringCreate(
+        &(that->errMsg),
+        "The value %s is invalid for a double metric.",
+        str);
+      Raise(RunRecorderExc_InvalidValue);
+
+    }
+    BindStmtDouble(
+      that,
+      stmt,
+      iParam,
+      val);
+
+  // Else, the metric is a text, bind the string
+  } else {
+
+    BindStmtText(
+      that,
+      stmt,
+      iParam,
+      str);
+
+  }
+
+}
+
+// Execute one step of a prepared statement
+// Inputs:
+//   that: the struct RunRecorder
+//   stmt: the statement
+// Output:
+//   Return SQLITE_ROW or SQLITE_DONE if successful, else the error code,
+//   in which case the error message is memorised in that->errMsg
+static int StepStmt(
+  struct RunRecorder* const that,
+        sqlite3_stmt* const stmt) {
+
+  // Execute the step
+  int retStep = sqlite3_step(stmt);
+
+  // If the step failed
+  if (retStep != SQLITE_ROW && retStep != SQLITE_DONE) {
+
+    // Memorise the error message
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(that->db));
+
+    // Reset the statement to release the eventual lock on the database
+    sqlite3_reset(stmt);
+
+  }
+
+  // Return the result of the step
+  return retStep;
+
+}
+
+// Create the RunRecorder's tables in an empty database
+// Input:
+//   that: The struct RunRecorder
+static void CreateDb(
+  struct RunRecorder* const that) {
+
+  // If the RunRecorder uses a local database, create the local database
+  if (UsesAPI(that) == false) CreateDbLocal(that);
+
+  // If the RunRecorder uses the Web API there is nothing to do as the
+  // remote API will take care of creating the  database as necessary
+
+}
+
+// Create the RunRecorder's tables in an empty local database
+// Input:
+//   that: The struct RunRecorder
+// Raise:
+//   RunRecorderExc_CreateTableFailed
+static void CreateDbLocal(
+  struct RunRecorder* const that) {
+
+  // Ensure the error messages are freed to avoid confusion with
+  // eventual previous messages
+  FreeErrMsg(that);
+
+  // List of commands to set the vacuum mode, which must be done before
+  // the creation of the tables, and to create the tables and their indexes
+  char* sqlCmd[NB_TABLE + 3] = {
+
+    SQL_AUTO_VACUUM,
+    "CREATE TABLE _Version ("
+    "  Ref INTEGER PRIMARY KEY,"
+    "  Label TEXT NOT NULL)",
+    "CREATE TABLE _Project ("
+    "  Ref INTEGER PRIMARY KEY,"
+    "  Label TEXT UNIQUE NOT NULL,"
+    "  Materialized INTEGER NOT NULL DEFAULT 0,"
+    "  RetentionAge INTEGER NOT NULL DEFAULT 0,"
+    "  RetentionCount INTEGER NOT NULL DEFAULT 0)",
+    "CREATE TABLE _Measure ("
+    "  Ref INTEGER PRIMARY KEY,"
+    "  RefProject INTEGER NOT NULL,"
+    "  DateMeasure INTEGER NOT NULL)",
+    "CREATE TABLE _Value ("
+    "  Ref INTEGER PRIMARY KEY,"
+    "  RefMeasure INTEGER NOT NULL,"
+    "  RefMetric INTEGER NOT NULL,"
+    "  Value NOT NULL)",
+    "CREATE TABLE _Metric ("
+    "  Ref INTEGER PRIMARY KEY,"
+    "  RefProject INTEGER NOT NULL,"
+    "  Label TEXT NOT NULL,"
+    "  DefaultValue TEXT NOT NULL,"
+    "  Type INTEGER NOT NULL DEFAULT 0)",
+    SQL_CREATE_INDEXES,
+    "INSERT INTO _Version (Ref, Label) "
+    "VALUES (NULL, '" VERSION_DB "')"
+
+  };
+
+  // Loop on the commands
+  ForZeroTo(iCmd, NB_TABLE + 3) {
+
+    // Execute the command
+    int retExec =
+      sqlite3_exec(
+        that->db,
+        sqlCmd[iCmd],
+        NULL,
+        NULL,
+        &(that->sqliteErrMsg));
+    if (retExec != SQLITE_OK) Raise(RunRecorderExc_CreateTableFailed);
+
+  }
+
+}
+
+// Upgrade the database to the last version by applying the migration
+// steps in sequence, then recreate the views of the projects and update
+// the dates in their materialized tables if at least one step was applied
+// Input:
+//   that: The struct RunRecorder
+// Raise:
+//   RunRecorderExc_UpgradeDbFailed
+static void UpgradeDb(
+  struct RunRecorder* const that) {
+
+  // If the RunRecorder uses the Web API there is nothing to do as the
+  // remote API takes care of upgrading its database
+  if (UsesAPI(that) == true) return;
+
+  // Get the current version of the database
+  char* version = GetVersionLocal(that);
+
+  // Flag to memorise if at least one migration step has been applied
+  bool isUpgraded = false;
+
+  Try {
+
+    // Loop until the database is up to date
+    while (strcmp(version, VERSION_DB) != 0) {
+
+      // Search the migration step for the current version
+      struct MigrationStep const* step = NULL;
+      ForZeroTo(iStep, NB_MIGRATION) {
+
+        int retCmp =
+          strcmp(
+            migrations[iStep].from,
+            version);
+        if (retCmp == 0) step = migrations + iStep;
+
+      }
+
+      // If there is no migration step for this version, raise an exception
+      if (step == NULL) {
+
+        StringCreate(
+          &(that->errMsg),
+          "No migration available from version %s",
+          version);
+        Raise(RunRecorderExc_UpgradeDbFailed);
+
+      }
+
+      // Execute the commands of the step which can't be executed in
+      // a transaction
+      if (step->sqlNoTransaction != NULL) {
+
+        int retExec =
+          sqlite3_exec(
+            that->db,
+            step->sqlNoTransaction,
+            NULL,
+            NULL,
+            &(that->sqliteErrMsg));
+        if (retExec != SQLITE_OK) Raise(RunRecorderExc_UpgradeDbFailed);
+
+      }
+
+      // Apply the step and update the version in one single transaction
+      Try {
+
+        // Create the SQL command of the step
+        StringCreate(
+          &(that->cmd),
+          "BEGIN IMMEDIATE;%s;UPDATE _Version SET Label = '%s'",
+          step->sql,
+          step->to);
+
+        // Execute the command
+        int retExec =
+          sqlite3_exec(
+            that->db,
+            that->cmd,
+            NULL,
+            NULL,
+            &(that->sqliteErrMsg));
+        if (retExec != SQLITE_OK) Raise(RunRecorderExc_UpgradeDbFailed);
+
+        // Commit the transaction
+        retExec =
+          sqlite3_exec(
+            that->db,
+            "COMMIT",
+            NULL,
+            NULL,
+            &(that->sqliteErrMsg));
+        if (retExec != SQLITE_OK) Raise(RunRecorderExc_UpgradeDbFailed);
+
+      } CatchDefault {
+
+        // Rollback the transaction to leave the database in its
+        // previous version
+        sqlite3_exec(
+          that->db,
+          "ROLLBACK",
+          NULL,
+          NULL,
+          NULL);
+        Raise(RunRecorderExc_UpgradeDbFailed);
+
+      } EndCatch;
+
+      // Update the current version
+      SafeStrDup(
+        version,
+        step->to);
+      isUpgraded = true;
+
+    }
+
+  } CatchDefault {
+
+    free(version);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  free(version);
+
+  // If the database was already up to date, nothing else to do
+  if (isUpgraded == false) return;
+
+  // Recreate the views of the projects and update the dates in the
+  // materialized tables in one single transaction
+  Try {
+
+    BeginSessionLocal(that);
+    UpdateViewAllProjects(that);
+    SyncMaterializedDatesLocal(that);
+    CommitSessionLocal(that);
+
+  } CatchDefault {
+
+    RollbackSessionLocal(that);
+    Raise(RunRecorderExc_UpgradeDbFailed);
+
+  } EndCatch;
+
+}
+
+// Get the version of the local database
+// Input:
+//   that: The struct RunRecorder
+// Output:
+//   Return a new string
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static char* GetVersionLocal(
+  struct RunRecorder* const that) {
+
+  // Declare a variable to memorise the version
+  char* version = NULL;
+
+  // Execute the command to get the version
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_getVersion);
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_ROW) Raise(RunRecorderExc_SQLRequestFailed);
+
+  // Copy the version
+  SafeStrDup(
+    version,
+    (char const*)sqlite3_column_text(stmt, 0));
+
+  // Release the statement
+  sqlite3_reset(stmt);
+
+  // Return the version
+  return version;
+
+}
+
+// Callback to memorise the incoming data from the Web API
+// Input:
+//   data: incoming data
+//   size: always 1
+//   nmemb: number of incoming byte
+//   reply: pointer to where to store the incoming data
+// Output:
+//   Return the number of received byte
+static size_t GetReplyAPI(
+   char* data,
+  size_t size,
+  size_t nmemb,
+   void* ptr) {
+
+  // Get the size in byte of the received data
+  size_t dataSize = size * nmemb;
+
+  // If there is received data
+  if (dataSize != 0) {
+
+    // Cast the data
+    char** reply = (char**)ptr;
+
+    // Variable to memorise the current length of the buffer for the reply
+    size_t replyLength = 0;
+
+    // If the current buffer for the reply is not empty, get the current
+    // length of the reply
+    if (*reply != NULL) replyLength = strlen(*reply);
+
+    // Allocate memory for current data, the incoming data and the
+    // terminating '\0'
+    SafeRealloc(
+      *reply,
+      replyLength + dataSize + 1);
+
+    // Copy the incoming data at the end of the current buffer
+    memcpy(
+      *reply + replyLength,
+      data,
+      dataSize);
+
+    // Set the terminating NULL character
+    (*reply)[replyLength + dataSize] = '\0';
+
+  }
+
+  // Return the number of byte received;
+  return dataSize;
+
+}
+
+// Get the value of a key in a JSON encoded string
+// Input:
+//   json: the json encoded string
+//    key: the key
+// Output:
+//   Return a new string, or NULL if the key doesn't exist
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static char* GetJSONValOfKey(
+  char const* const json,
+  char const* const key) {
+
+  // If the json or key is null or empty
+  // Nothing to do
+  if (json == NULL || key == NULL ||
+      *json == '\0' || *key == '\0') return NULL;
+
+  // Variable to memorise the value
+  char* val = NULL;
+
+  // Variable to memorise the key decorated with it's syntax
+  char* keyDecorated = NULL;
+
+  Try {
+
+    // Create the key decorated with it's syntax
+    StringCreate(
+      &keyDecorated,
+      "\"%s\":",
+      key);
+
+    // If the key can be find in the JSON encoded string
+    char const* ptrKey =
+      strstr(
+        json,
+        keyDecorated);
+    if (ptrKey != NULL) {
+
+      // Variable to memorise the start of the value
+      char const* ptrVal = ptrKey + strlen(keyDecorated) + 1;
+
+      // Declare a pointer to loop on the string until the end of the value
+      char const* ptr = ptrVal;
+
+      // If the value is a string
+      if (ptrKey[strlen(keyDecorated)] == '"') {
+
+        // Loop on the characters of the value until the next double quote
+        // or end of string
+        while (*ptr != '\0' && *ptr != '"') {
+
+          // Move to the next character
+          ++ptr;
+
+          // Skip the escaped character
+          if (*ptr == '\\') ++ptr;
+
+        }
+
+      // Else, if the value is an object
+      } else if (ptrKey[strlen(keyDecorated)] == '{') {
+
+        // Loop on the characters of the value until the closing curly
+        // brace or end of string
+        int curlyLvl = 1;
+        while (*ptr != '\0' && (curlyLvl > 0 || *ptr != '}')) {
+
+          // Update the curly brace level
+          if (*ptr == '{') curlyLvl++;
+
+          // If the character is a double quote, move to the end of the
+          // string
+          if (*ptr == '"') {
+
+            ++ptr;
+            while (*ptr != '\0' && *ptr != '"') {
+
+              ++ptr;
+              if (*ptr == '\\') ++ptr;
+
+            }
+
+          }
+
+          // Move to the next character
+          ++ptr;
+
+          // Update the curly brace level
+          if (*ptr == '}') curlyLvl--;
+
+        }
+
+      // Else, if the value is an array
+      } else if (ptrKey[strlen(keyDecorated)] == '[') {
+
+        // Loop on the characters of the value until the closing bracket
+        // or end of string
+        // Presume the data are well formatted here, if there are brackets
+        // in string in the object definition, or sub-array
+        // definition, or any other special case, it means the data
+        // returned by the API are invalid and it will be catched later.
+        while (*ptr != '\0' && *ptr != ']') ++ptr;
+
+      // Else, this JSON encoded string is not supported, the API request
+      // has returned invalid data
+      } else {
+
+        Raise(RunRecorderExc_ApiRequestFailed);
+
+      }
+
+      // If we have found the end of the value
+      if (*ptr != '\0') {
+
+        // Get the length of the value
+        size_t lenVal = ptr - ptrVal;
+
+        // Allocate memory for the value
+        SafeMalloc(
+          val,
+          lenVal + 1);
+
+        // Copy the value
+        memcpy(
+          val,
+          ptrVal,
+          lenVal);
+        val[lenVal] = '\0';
+
+      // Else, this JSON encoded string is not supported, the API request
+      // has returned invalid data
+      } else {
+
+        Raise(RunRecorderExc_ApiRequestFailed);
+
+      }
+
+    }
+
+    // Free memory
+    free(keyDecorated);
+
+  } CatchDefault {
+
+    free(keyDecorated);
+    free(val);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Return the value
+  return val;
+
+}
+
+// Set the POST data in the Web API request of a struct RunRecorder
+// Input:
+//   that: the struct RunRecorder
+//   data: the POST data
+// Raise:
+//   RunRecorderExc_CurlSetOptFailed
+static void SetAPIReqPostVal(
+  struct RunRecorder* const that,
+          char const* const data) {
+
+  // Set the data in the Curl fields
+  CURLcode res =
+    curl_easy_setopt(
+      that->curl,
+      CURLOPT_POSTFIELDS,
+      data);
+  if (res != CURLE_OK) {
+
+    SafeStrDup(
+      that->errMsg,
+      curl_easy_strerror(res));
+    Raise(RunRecorderExc_CurlSetOptFailed);
+
+  }
+
+}
+
+// Get the ret code in the current JSON reply of a struct RunRecorder
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return a new string
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static char* GetAPIRetCode(
+  struct RunRecorder* const that) {
+
+  // Extract the return code from the JSON reply
+  char* retCode =
+    GetJSONValOfKey(
+      that->curlReply,
+      "ret");
+  if (retCode == NULL) {
+
+    SafeStrDup(
+      that->errMsg,
+      "'ret' key missing in API reply");
+    Raise(RunRecorderExc_ApiRequestFailed);
+
+  }
+
+  // Return the code
+  return retCode;
+
+}
+
+// Send the current request of a struct RunRecorder
+// Input:
+//        that: the struct RunRecorder
+//   isJsonReq: flag to indicate that the request returns JSON encoded
+//              data
+// Raise:
+//   RunRecorderExc_CurlRequestFailed
+//   RunRecorderExc_ApiRequestFailed
+static void SendAPIReq(
+  struct RunRecorder* const that,
+                 bool const isJsonReq) {
+
+  // Reset the Curl reply or the reply of this request will get appended
+  // to the one of the previous request
+  ResetCurlReply(that);
+
+  // Send the request
+  CURLcode res = curl_easy_perform(that->curl);
+  if (res != CURLE_OK) {
+
+    SafeStrDup(
+      that->errMsg,
+      curl_easy_strerror(res));
+    Raise(RunRecorderExc_CurlRequestFailed);
+
+  }
+
+  // If the request returns JSON encoded data
+  if (isJsonReq == true) {
+
+    // If the returned code is not '0'
+    char* retCode = GetAPIRetCode(that);
+    int cmpRet =
+      strcmp(
+        retCode,
+        "0");
+    free(retCode);
+    if (cmpRet != 0) {
+
+      free(that->errMsg);
+      that->errMsg =
+        GetJSONValOfKey(
+          that->curlReply,
+          "errMsg");
+      Raise(RunRecorderExc_ApiRequestFailed);
+
+    }
+
+  }
+
+}
+
+// Get the version of the database via the Web API
+// Input:
+//   The struct RunRecorder
+// Output:
+//   Return a new string
+static char* GetVersionAPI(
+  struct RunRecorder* const that) {
+
+  // Create the request to the Web API
+  SetAPIReqPostVal(
+    that,
+    "action=version");
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+  // Extract the version number from the JSON reply
+  char* version =
+    GetJSONValOfKey(
+      that->curlReply,
+      "version");
+
+  // Return the version
+  return version;
+
+}
+
+// Add a new project in a local database
+// Input:
+//   that: the struct RunRecorder
+//   name: the name of the new project, it must respect the following
+//         pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+//   RunRecorderExc_ProjectNameAlreadyUsed
+static void AddProjectLocal(
+  struct RunRecorder* const that,
+          char const* const name) {
+
+  // Prepare the SQL command
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_addProject);
+  BindStmtText(
+    that,
+    stmt,
+    1,
+    name);
+
+  // Execute the command to add the project
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_DONE) Raise(RunRecorderExc_AddProjectFailed);
+
+}
+
+// Add a new project through the Web API
+// Input:
+//   that: the struct RunRecorder
+//   name: the name of the new project, it must respect the following
+//         pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+//   RunRecorderExc_ProjectNameAlreadyUsed
+static void AddProjectAPI(
+  struct RunRecorder* const that,
+          char const* const name) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=add_project&label=%s",
+    name);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+}
+
+// Check if a value is present in pairs ref/val
+// Inputs:
+//   that: the struct RunRecorderRefVal
+//    val: the value to check
+// Output:
+//   Return true if the value is present in the pairs, else false
+static bool PairsRefValContainsVal(
+  struct RunRecorderRefVal const* const that,
+                      char const* const val) {
+
+  // Loop on the pairs
+  ForZeroTo(iPair, that->nb) {
+
+    // If the pair's value is the checked value, return true
+    int retCmp =
+      strcmp(
+        val,
+        that->values[iPair]);
+    if (retCmp == 0) return true;
+
+  }
+
+  // If we reach here, we haven't found the checked value, return false
+  return false;
+
+}
+
+// Check if a value is present in pairs ref/val with default value
+// Inputs:
+//   that: the struct RunRecorderRefValDef
+//    val: the value to check
+// Output:
+//   Return true if the value is present in the pairs, else false
+static bool PairsRefValDefContainsVal(
+  struct RunRecorderRefValDef const* const that,
+                         char const* const val) {
+
+  // Loop on the pairs
+  ForZeroTo(iPair, that->nb) {
+
+    // If the pair's value is the checked value, return true
+    int retCmp =
+      strcmp(
+        val,
+        that->values[iPair]);
+    if (retCmp == 0) return true;
+
+  }
+
+  // If we reach here, we haven't found the checked value, return false
+  return false;
+
+}
+
+// Add a new pair in a struct RunRecorderRefVal
+// Inputs:
+//   pairs: the struct RunRecorderRefVal
+//     ref: the reference of the pair
+//     val: the val of the pair
+static void PairsRefValAdd(
+  struct RunRecorderRefVal* const pairs,
+                       long const ref,
+                char const* const val) {
+
+  // Allocate memory for the new value
+  SafeRealloc(
+    pairs->refs,
+    sizeof(long) * (pairs->nb + 1));
+  SafeRealloc(
+    pairs->values,
+    sizeof(char*) * (pairs->nb + 1));
+  pairs->values[pairs->nb] = NULL;
+
+  // Update the number of pairs
+  ++(pairs->nb);
+
+  // Set the reference and value of the pair
+  pairs->refs[pairs->nb - 1] = ref;
+  SafeStrDup(
+    pairs->values[pairs->nb - 1],
+    val);
+
+}
+
+// Add a new pair in a struct RunRecorderRefValDef
+// Inputs:
+//        pairs: the struct RunRecorderRefValDef
+//          ref: the reference of the pair
+//          val: the value of the pair
+//   defaultVal: the default value of the pair
+//         type: the type of the pair
+static void PairsRefValDefAdd(
+  struct RunRecorderRefValDef* const pairs,
+                          long const ref,
+                   char const* const val,
+                   char const* const defaultVal,
+    enum RunRecorderMetricType const type) {
+
+  // Allocate memory for the new value
+  SafeRealloc(
+    pairs->refs,
+    sizeof(long) * (pairs->nb + 1));
+  SafeRealloc(
+    pairs->values,
+    sizeof(char*) * (pairs->nb + 1));
+  pairs->values[pairs->nb] = NULL;
+  SafeRealloc(
+    pairs->defaultValues,
+    sizeof(char*) * (pairs->nb + 1));
+  pairs->defaultValues[pairs->nb] = NULL;
+  SafeRealloc(
+    pairs->types,
+    sizeof(enum RunRecorderMetricType) * (pairs->nb + 1));
+
+  // Update the number of pairs
+  ++(pairs->nb);
+
+  // Set the reference, value and default value of the pair
+  pairs->refs[pairs->nb - 1] = ref;
+  SafeStrDup(
+    pairs->values[pairs->nb - 1],
+    val);
+  SafeStrDup(
+    pairs->defaultValues[pairs->nb - 1],
+    defaultVal);
+  pairs->types[pairs->nb - 1] = type;
+
+}
+
+
+
+// Get a list of projects in the local database with a cached statement
+// returning their reference and label
+// Inputs:
+//     that: the struct RunRecorder
+//   idStmt: the statement
+// Output:
+//   Return the projects' reference/label
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderRefVal* GetProjectsOfStmtLocal(
+       struct RunRecorder* const that,
+  enum RunRecorderStmt const idStmt) {
+
+  // Declare a variable to memorise the projects
+  struct RunRecorderRefVal* projects = RunRecorderRefValCreate();
+
+  Try {
+
+    // Execute the command to get the projects
+    sqlite3_stmt* stmt =
+      GetStmt(
+        that,
+        idStmt);
+    int retStep =
+      StepStmt(
+        that,
+        stmt);
+
+    // Loop on the returned rows
+    while (retStep == SQLITE_ROW) {
+
+      // Add the pair ref/value to the projects
+      PairsRefValAdd(
+        projects,
+        sqlite3_column_int64(stmt, 0),
+        (char const*)sqlite3_column_text(stmt, 1));
+
+      // Move to the next row
+      retStep =
+        StepStmt(
+          that,
+          stmt);
+
+    }
+    if (retStep != SQLITE_DONE) Raise(RunRecorderExc_SQLRequestFailed);
+
+  } CatchDefault {
+
+    PolyFree(&projects);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Return the projects
+  return projects;
+
+}
+
+// Get the list of projects in the local database
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the projects' reference/label
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderRefVal* GetProjectsLocal(
+  struct RunRecorder* const that) {
+
+  // Get the projects
+  struct RunRecorderRefVal* projects =
+    GetProjectsOfStmtLocal(
+      that,
+      RunRecorderStmt_getProjects);
+
+  // Return the projects
+  return projects;
+
+}
+
+// Extract a struct RunRecorderRefVal from a JSON string
+// Input:
+//   json: the JSON string, expected to be formatted as "1":"A","2":"B",...
+// Output:
+//   Return a new struct RunRecorderRefVal
+// Raise:
+//   RunRecorderExc_InvalidJSON
+static struct RunRecorderRefVal* GetPairsRefValFromJSON(
+  char const* const json) {
+
+  // Create the pairs
+  struct RunRecorderRefVal* pairs = RunRecorderRefValCreate();
+
+  // Declare a pointer to loop on the json string
+  char const* ptr = json;
+
+  // Loop until the end of the json string
+  while (*ptr != '\0') {
+
+    // Go to the next double quote or end of string
+    while (*ptr != '\0' && *ptr != '"') ++ptr;
+
+    // If we have found the double quote
+    if (*ptr == '"') {
+
+      // Skip the opening double quote of the reference
+      ++ptr;
+
+      // Get the reference
+      char* ptrEnd = NULL;
+      errno = 0;
+      long ref =
+        strtol(
+          ptr,
+          &ptrEnd,
+          10);
+      if (errno != 0 || *ptrEnd != '"') Raise(RunRecorderExc_InvalidJSON);
+
+      // Move to the character after the closing double quote
+      ptr = ptrEnd + 1;
+
+      // Go to the opening double quote for the value
+      while (*ptr != '\0' && *ptr != '"') ++ptr;
+
+      // If we couldn't find the opening double quote for the value
+      if (*ptr == '\0') Raise(RunRecorderExc_InvalidJSON);
+
+      // Skip the opening double quote for the value
+      ++ptr;
+
+      // Search the closing double quote for the value
+      char const* ptrEndVal = ptr;
+      while (*ptrEndVal != '\0' && *ptrEndVal != '"') ++ptrEndVal;
+
+      // If we couldn't find the closing double quote for the value
+      // or the value is null
+      if (*ptrEndVal == '\0' || ptrEndVal == ptr)
+        Raise(RunRecorderExc_InvalidJSON);
+
+      // Variable to memorise the value
+      char* val = NULL;
+
+      Try {
+
+        // Get the value
+        size_t lenVal = ptrEndVal - ptr;
+        SafeMalloc(
+          val,
+          lenVal + 1);
+        memcpy(
+          val,
+          ptr,
+          lenVal);
+        val[lenVal] = '\0';
+
+        // Move to the character after the closing double quote of the value
+        ptr = ptrEndVal + 1;
+
+        // Add the pair
+        PairsRefValAdd(
+          pairs,
+          ref,
+          val);
+
+        // Free the temporary copy of the value
+        free(val);
+
+      } CatchDefault {
+
+        free(val);
+        Raise(TryCatchGetLastExc());
+
+      } EndCatch;
+
+    }
+
+  }
+
+  // Return the pairs
+  return pairs;
+
+}
+
+// Extract a struct RunRecorderRefValDef from a JSON string
+// Input:
+//   json: the JSON string for the metricss, expected to be formatted
+//         as "1":["Label":"A","DefaultValue":"B","Type":"0"],...
+// Output:
+//   Return a new struct RunRecorderRefValDef
+// Raise:
+//   RunRecorderExc_InvalidJSON
+static struct RunRecorderRefValDef* GetPairsRefValDefFromJSON(
+  char const* const json) {
+
+  // Create the pairs
+  struct RunRecorderRefValDef* pairs =
+    RunRecorderRefValDefCreate();
+
+  // Declare a pointer to loop on the json string
+  char const* ptr = json;
+
+  // Loop until the end of the json string
+  while (*ptr != '\0') {
+
+    // Go to the next double quote or end of string
+    while (*ptr != '\0' && *ptr != '"') ++ptr;
+
+    // If we have found the double quote
+    if (*ptr == '"') {
+
+      // Skip the opening double quote of the reference
+      ++ptr;
+
+      // Get the reference
+      char* ptrEnd = NULL;
+      errno = 0;
+      long ref =
+        strtol(
+          ptr,
+          &ptrEnd,
+          10);
+      if (errno != 0 || *ptrEnd != '"') Raise(RunRecorderExc_InvalidJSON);
+
+      // Move to the character after the closing double quote
+      ptr = ptrEnd + 1;
+
+      // Check it is the expected ':'
+      if (*ptr != ':') Raise(RunRecorderExc_InvalidJSON);
+
+      // Move to the next character
+      ++ptr;
+
+      // Check it is the expected '{'
+      if (*ptr != '{') Raise(RunRecorderExc_InvalidJSON);
+
+      // Move to the next character
+      ++ptr;
+
+      // Declare variables to extract the value of the label, default
+      // value and type
+      char* label = NULL;
+      char* defaultVal = NULL;
+      char* type = NULL;
+
+      Try {
+
+        // Get the value of the key 'Label'
+        label =
+          GetJSONValOfKey(
+            ptr,
+            "Label");
+
+        // Get the value of the key 'DefaultValue'
+        defaultVal =
+          GetJSONValOfKey(
+            ptr,
+            "DefaultValue");
+
+        // Get the value of the key 'Type', absent from the replies of
+        // Web API older than the metric types, whose metrics are text
+        type =
+          GetJSONValOfKey(
+            ptr,
+            "Type");
+        long typeVal = RunRecorderMetricType_text;
+        if (type != NULL) {
+
+          bool isValidType =
+            StrToLong(
+              type,
+              &typeVal);
+          if (
+            isValidType == false ||
+            typeVal < 0 ||
+            typeVal >= RunRecorderMetricType_nb)
+            Raise(RunRecorderExc_InvalidJSON);
+
+        }
+
+        // Add the pair
+        PairsRefValDefAdd(
+          pairs,
+          ref,
+          label,
+          defaultVal,
+          typeVal);
+
+        // Free memory
+        free(label);
+        free(defaultVal);
+        free(type);
+
+      } CatchDefault {
+
+        free(label);
+        free(defaultVal);
+        free(type);
+        Raise(TryCatchGetLastExc());
+
+      } EndCatch;
+
+      // Go to the closing curly brace for the metric
+      while (*ptr != '\0' && *ptr != '}') ++ptr;
+
+      // If we couldn't find the closing curly brace for the metric
+      if (*ptr == '\0') Raise(RunRecorderExc_InvalidJSON);
+
+    }
+
+  }
+
+  // Return the pairs
+  return pairs;
+
+}
+
+// Get the list of projects through the Web API
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the projects' reference/label
+static struct RunRecorderRefVal* GetProjectsAPI(
+  struct RunRecorder* const that) {
+
+  // Create the request to the Web API
+  SetAPIReqPostVal(
+    that,
+    "action=projects");
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+  // Variable to memorise the value of the 'projects' key
+  char* json = NULL;
+
+  // Variable to memorise the projects
+  struct RunRecorderRefVal* projects = NULL;
+  Try {
+
+    // Get the projects list in the JSON reply
+    char* json =
+      GetJSONValOfKey(
+        that->curlReply,
+        "projects");
+    if (json == NULL) Raise(RunRecorderExc_ApiRequestFailed);
+
+    // Extract the projects
+    projects = GetPairsRefValFromJSON(json);
+
+    // Free memory
+    free(json);
+
+  } CatchDefault {
+
+    free(json);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Return the projects
+  return projects;
+
+}
+
+// Create a struct RunRecorderRefVal
+// Output:
+//   Return the new struct RunRecorderRefVal
+static struct RunRecorderRefVal* RunRecorderRefValCreate(
+  void) {
+
+  // Declare the new struct RunRecorderRefVal
+  struct RunRecorderRefVal* pairs = NULL;
+  SafeMalloc(
+    pairs,
+    sizeof(struct RunRecorderRefVal));
+
+  // Initialise properties
+  pairs->nb = 0;
+  pairs->refs = NULL;
+  pairs->values = NULL;
+
+  // Return the new struct RunRecorderRefVal
+  return pairs;
+
+}
+
+// Create a struct RunRecorderRefValDef
+// Output:
+//   Return the new struct RunRecorderRefValDef
+static struct RunRecorderRefValDef* RunRecorderRefValDefCreate(
+  void) {
+
+  // Declare the new struct RunRecorderRefValDef
+  struct RunRecorderRefValDef* pairs = NULL;
+  SafeMalloc(
+    pairs,
+    sizeof(struct RunRecorderRefValDef));
+
+  // Initialise properties
+  pairs->nb = 0;
+  pairs->refs = NULL;
+  pairs->values = NULL;
+  pairs->defaultValues = NULL;
+  pairs->types = NULL;
+
+  // Return the new struct RunRecorderRefValDef
+  return pairs;
+
+}
+
+// Get the list of metrics for a project from a local database
+// Input:
+//      that: the struct RunRecorder
+//   project: the project
+// Output:
+//   Return the metrics' reference/label/default value
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderRefValDef* GetMetricsLocal(
+  struct RunRecorder* const that,
+          char const* const project) {
+
+  // Declare a variable to memorise the metrics
+  struct RunRecorderRefValDef* metrics = NULL;
+
+  // Declare a variable to memorise the request
+  sqlite3_stmt* stmt = NULL;
+  Try {
+
+    // Create the struct RunRecorderRefValDef to memorise the metrics
+    metrics = RunRecorderRefValDefCreate();
+
+    // Prepare the request
+    stmt =
+      GetStmt(
+        that,
+        RunRecorderStmt_getMetrics);
+    BindStmtText(
+      that,
+      stmt,
+      1,
+      project);
+
+    // Execute the request and loop on the returned rows
+    int retStep =
+      StepStmt(
+        that,
+        stmt);
+    while (retStep == SQLITE_ROW) {
+
+      // Add the pair ref/value, default value and type to the metrics
+      PairsRefValDefAdd(
+        metrics,
+        sqlite3_column_int64(stmt, 0),
+        (char const*)sqlite3_column_text(stmt, 1),
+        (char const*)sqlite3_column_text(stmt, 2),
+        sqlite3_column_int(stmt, 3));
+
+      // Move to the next row
+      retStep =
+        StepStmt(
+          that,
+          stmt);
+
+    }
+    if (retStep != SQLITE_DONE) Raise(RunRecorderExc_SQLRequestFailed);
+
+  } CatchDefault {
+
+      if (stmt != NULL) sqlite3_reset(stmt);
+      PolyFree(&metrics);
+      Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Return the metrics
+  return metrics;
+
+}
+
+// Get the list of metrics for a project through the Web API
+// Input:
+//      that: the struct RunRecorder
+//   project: the project
+// Output:
+//   Return the metrics' reference/label/default value
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static struct RunRecorderRefValDef* GetMetricsAPI(
+  struct RunRecorder* const that,
+          char const* const project) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=metrics&project=%s",
+    project);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+  // Variable to memorise the value of the 'metrics' key
+  char* json = NULL;
+
+  // Variable to memorise the metrics
+  struct RunRecorderRefValDef* metrics = NULL;
+  Try {
+
+    // Get the labels and default values in the JSON reply
+    json =
+      GetJSONValOfKey(
+        that->curlReply,
+        "metrics");
+    if (json == NULL) Raise(RunRecorderExc_ApiRequestFailed);
+
+    // Extract the metrics
+    metrics = GetPairsRefValDefFromJSON(json);
+
+    // Free memory
+    free(json);
+
+  } CatchDefault {
+
+    free(json);
+    PolyFree(&metrics);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Return the metrics
+  return metrics;
+
+}
+
+// Append to that->cmd the columns of the measures of a project, in the
+// order of the metrics: for each metric its value for the measure
+// _Measure.Ref, found through the covering index on _Value, or its
+// default value if the measure has no value for it. The default values
+// are inlined in the command to be resolved once instead of once per row.
+// Inputs:
+//      that: the struct RunRecorder
+//   metrics: the metrics of the project
+// Raise:
+//   TryCatchExc_MallocFailed
+static void AppendCmdColumnsMeasure(
+            struct RunRecorder* const that,
+  struct RunRecorderRefValDef const* const metrics) {
+
+  // For each metrics
+  ForZeroTo(iMetric, metrics->nb) {
+
+    // Escape the default value as a SQL string literal, converted to the
+    // type of the metric
+    char* defaultVal =
+      sqlite3_mprintf(
+        "CAST(%Q AS %s)",
+        metrics->defaultValues[iMetric],
+        metricTypeSql[metrics->types[iMetric]]);
+    if (defaultVal == NULL) Raise(TryCatchExc_MallocFailed);
+
+    // Extend the command
+    StringAppend(
+      &(that->cmd),
+      ",IFNULL((SELECT Value FROM _Value "
+      "WHERE RefMeasure=_Measure.Ref AND RefMetric=%ld),%s)",
+      metrics->refs[iMetric],
+      defaultVal);
+    sqlite3_free(defaultVal);
+
+  }
+
+}
+
+// Update the view for a project. If the project has a materialized
+// table the view reads it, else it resolves the values of each measure.
+// Input:
+//         that: the struct RunRecorder
+//      project: the name of the project
+// Raise:
+//   RunRecorderExc_UpdateViewFailed
+static void UpdateViewProject(
+  struct RunRecorder* const that,
+          char const* const project) {
+
+  // Create the SQL command to delete the view
+  StringCreate(
+    &(that->cmd),
+    "DROP VIEW IF EXISTS \"%s\"",
+    project);
+
+  // Execute the command to delete the view
+  int retExec =
+    sqlite3_exec(
+      that->db,
+      that->cmd,
+      NULL,
+      NULL,
+      &(that->sqliteErrMsg));
+  if (retExec != SQLITE_OK) Raise(RunRecorderExc_UpdateViewFailed);
+
+  // Check if the project has a materialized table
+  bool isMaterialized =
+    IsMaterializedLocal(
+      that,
+      project);
+
+  // Get the list of metrics for the project
+  struct RunRecorderRefValDef* metrics =
+    RunRecorderGetMetrics(
+      that,
+      project);
+  Try {
+
+    // Create the head of the command
+    StringCreate(
+      &(that->cmd),
+      "CREATE VIEW \"%s\" (Ref,DateMeasure",
+      project);
+
+    // For each metrics, extend the command with the metric label
+    ForZeroTo(iMetric, metrics->nb)
+      StringAppend(
+        &(that->cmd),
+        ",\"%s\"",
+        metrics->values[iMetric]);
+
+    // If the project has a materialized table
+    if (isMaterialized == true) {
+
+      // Extend the command with the columns of the table
+      StringAppend(
+        &(that->cmd),
+        "%s",
+        ") AS SELECT Ref,DateMeasure");
+      ForZeroTo(iMetric, metrics->nb)
+        StringAppend(
+          &(that->cmd),
+          ",\"%s\"",
+          metrics->values[iMetric]);
+
+      // Extend the command with the tail, the table is read in the order
+      // of its index on the date
+      StringAppend(
+        &(that->cmd),
+        " FROM \"" MATERIALIZED_PREFIX "%s\" ORDER BY DateMeasure, Ref",
+        project);
+
+    // Else, the values of each measure are resolved by the view
+    } else {
+
+      // Extend the command with the columns
+      StringAppend(
+        &(that->cmd),
+        "%s",
+        ") AS SELECT _Measure.Ref,_Measure.DateMeasure");
+      AppendCmdColumnsMeasure(
+        that,
+        metrics);
+
+      // Extend the command with the tail. The measures are read in the
+      // order of the index on the measures, which avoids sorting them
+      StringAppend(
+        &(that->cmd),
+        " FROM _Measure WHERE _Measure.RefProject = "
+        "(SELECT Ref FROM _Project WHERE Label = \"%s\") "
+        "ORDER BY _Measure.DateMeasure, _Measure.Ref",
+        project);
+
+    }
+
+    // Free memory
+    PolyFree(&metrics);
+
+  } CatchDefault {
+
+    PolyFree(&metrics);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Execute the command to add the view
+  retExec =
+    sqlite3_exec(
+      that->db,
+      that->cmd,
+      NULL,
+      NULL,
+      &(that->sqliteErrMsg));
+  if (retExec != SQLITE_OK) Raise(RunRecorderExc_UpdateViewFailed);
+
+}
+
+// Update the views of all the projects in a local database
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_UpdateViewFailed
+static void UpdateViewAllProjects(
+  struct RunRecorder* const that) {
+
+  // Get the list of projects
+  struct RunRecorderRefVal* projects = GetProjectsLocal(that);
+
+  Try {
+
+    // Loop on the projects and update their view
+    ForZeroTo(iProject, projects->nb)
+      UpdateViewProject(
+        that,
+        projects->values[iProject]);
+
+  } CatchDefault {
+
+    PolyFree(&projects);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  PolyFree(&projects);
+
+}
+
+// Add a metric to a project to a local database
+// Input:
+//         that: the struct RunRecorder
+//      project: the name of the project to which add to the metric
+//        label: the label of the metric, it must respect the following
+//               pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
+//               There cannot be two metrics with the same label for the
+//               same project. A metric label can't be 'action',
+//               'project' or 'DateMeasure' (case sensitive, so 'Action' is
+//               fine).
+//   defaultVal: the default value of the metric, it must respect the
+//               following pattern: /^[^"=&]+$*/
+//         type: the type of the values of the metric
+// Raise:
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_MetricNameAlreadyUsed
+static void AddMetricLocal(
+             struct RunRecorder* const that,
+                     char const* const project,
+                     char const* const label,
+                     char const* const defaultVal,
+  enum RunRecorderMetricType const type) {
+
+  // Prepare the SQL command
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_addMetric);
+  BindStmtText(
+    that,
+    stmt,
+    1,
+    label);
+  BindStmtText(
+    that,
+    stmt,
+    2,
+    defaultVal);
+  BindStmtText(
+    that,
+    stmt,
+    3,
+    project);
+  BindStmtLong(
+    that,
+    stmt,
+    4,
+    type);
+
+  // Execute the command to add the metric
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_DONE) Raise(RunRecorderExc_AddMetricFailed);
+
+  // If the project has a materialized table
+  bool isMaterialized =
+    IsMaterializedLocal(
+      that,
+      project);
+  if (isMaterialized == true) {
+
+    // Create the command to add the column of the metric, the existing
+    // measures get the default value
+    char* cmd =
+      sqlite3_mprintf(
+        "ALTER TABLE \"" MATERIALIZED_PREFIX "%s\" "
+        "ADD COLUMN \"%s\" %s NOT NULL DEFAULT %Q",
+        project,
+        label,
+        metricTypeSql[type],
+        defaultVal);
+    if (cmd == NULL) Raise(TryCatchExc_MallocFailed);
+
+    // Execute the command
+    int retExec =
+      sqlite3_exec(
+        that->db,
+        cmd,
+        NULL,
+        NULL,
+        &(that->sqliteErrMsg));
+    sqlite3_free(cmd);
+    if (retExec != SQLITE_OK) Raise(RunRecorderExc_AddMetricFailed);
+
+  }
+
+  // Update the view for this project
+  UpdateViewProject(
+    that,
+    project);
+
+}
+
+// Add a metric to a project through the Web API
+// Input:
+//         that: the struct RunRecorder
+//      project: the name of the project to which add to the metric
+//        label: the label of the metric, it must respect the following
+//               pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
+//               There cannot be two metrics with the same label for the
+//               same project. A metric label can't be 'action',
+//               'project' or 'DateMeasure' (case sensitive, so 'Action' is
+//               fine).
+//   defaultVal: the default value of the metric, it must respect the
+//               following pattern: /^[^"=&]+$*/
+//         type: the type of the values of the metric
+// Raise:
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_MetricNameAlreadyUsed
+static void AddMetricAPI(
+             struct RunRecorder* const that,
+                     char const* const project,
+                     char const* const label,
+                     char const* const defaultVal,
+  enum RunRecorderMetricType const type) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=add_metric&project=%s&label=%s&default=%s&type=%d",
+    project,
+    label,
+    defaultVal,
+    type);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+}
+
+// Get the reference of a project in a local database
+// Inputs:
+//   that: the struct RunRecorder
+//   name: the project's name
+// Output:
+//   Return the reference of the project, or 0 if it doesn't exist
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static long GetProjectRefLocal(
+  struct RunRecorder* const that,
+          char const* const name) {
+
+  // Prepare the SQL command
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_getProjectRef);
+  BindStmtText(
+    that,
+    stmt,
+    1,
+    name);
+
+  // Execute the command to get the reference
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_ROW && retStep != SQLITE_DONE)
+    Raise(RunRecorderExc_SQLRequestFailed);
+
+  // Get the reference if the project exists
+  long ref = 0;
+  if (retStep == SQLITE_ROW) ref = sqlite3_column_int64(stmt, 0);
+
+  // Release the statement
+  sqlite3_reset(stmt);
+
+  // Return the reference
+  return ref;
+
+}
+
+// Get the index of a metric in the metrics of a project, sorted by
+// label
+// Inputs:
+//   metrics: the metrics
+//     label: the metric's label
+// Output:
+//   Return the index of the metric, or -1 if it doesn't exist
+static long SearchIdxMetric(
+  struct RunRecorderRefValDef const* const metrics,
+                         char const* const label) {
+
+  // Binary search of the label, the metrics are sorted by the database
+  // with the BINARY collation which gives the same order as strcmp
+  long iFirst = 0;
+  long iLast = metrics->nb - 1;
+  while (iFirst <= iLast) {
+
+    long iMid = iFirst + (iLast - iFirst) / 2;
+    int retCmp =
+      strcmp(
+        metrics->values[iMid],
+        label);
+    if (retCmp == 0) return iMid;
+    else if (retCmp < 0) iFirst = iMid + 1;
+    else iLast = iMid - 1;
+
+  }
+
+  // The metric wasn't found
+  return -1;
+
+}
+
+// Get the index of a metric in the metrics of a project from its handle.
+// If the metric is not in the cache, the cache is reloaded once from the
+// database in case the metric has been added since the project was
+// opened.
+// Inputs:
+//   that: the handle on the project
+//  label: the metric's label
+// Output:
+//   Return the index of the metric in that->metrics, or -1 if it doesn't
+//   exist
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static long ProjectGetIdxMetric(
+  struct RunRecorderProject* const that,
+                 char const* const label) {
+
+  // Search the metric in the cache
+  long idx =
+    SearchIdxMetric(
+      that->metrics,
+      label);
+
+  // If the metric is not in the cache
+  if (idx == -1) {
+
+    // Reload the metrics
+    struct RunRecorderRefValDef* metrics =
+      GetMetricsLocal(
+        that->recorder,
+        that->label);
+    PolyFree(&(that->metrics));
+    that->metrics = metrics;
+
+    // The columns of the materialized table may have changed, its
+    // insertion statement needs to be prepared again
+    sqlite3_finalize(that->insertMaterialized);
+    that->insertMaterialized = NULL;
+
+    // Search again the metric
+    idx =
+      SearchIdxMetric(
+        that->metrics,
+        label);
+
+  }
+
+  // Return the index of the metric
+  return idx;
+
+}
+
+// Add a measure to the materialized table of a project in a local
+// database. The metrics without value in the measure get their default
+// value.
+// Inputs:
+//   project: the handle on the project
+//   measure: the measure to add, already added to _Measure and _Value
+//      date: the date of the measure, in microseconds since the Epoch
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+static void AddMeasureMaterialized(
+         struct RunRecorderProject* const project,
+  struct RunRecorderMeasure const* const measure,
+                              long const date) {
+
+  // Shortcut to the struct RunRecorder
+  struct RunRecorder* const that = project->recorder;
+
+  // If the statement to insert in the materialized table hasn't been
+  // prepared yet
+  if (project->insertMaterialized == NULL) {
+
+    // Create the command, with one parameter per metric in the order
+    // of the metrics in the handle
+    StringCreate(
+      &(that->cmd),
+      "INSERT INTO \"" MATERIALIZED_PREFIX "%s\" (Ref,DateMeasure",
+      project->label);
+    ForZeroTo(iMetric, project->metrics->nb)
+      StringAppend(
+        &(that->cmd),
+        ",\"%s\"",
+        project->metrics->values[iMetric]);
+    StringAppend(
+      &(that->cmd),
+      "%s",
+      ") VALUES (?,?");
+    ForZeroTo(iMetric, project->metrics->nb)
+      StringAppend(
+        &(that->cmd),
+        "%s",
+        ",?");
+    StringAppend(
+      &(that->cmd),
+      "%s",
+      ")");
+
+    // Prepare the statement
+    int retPrepare =
+      sqlite3_prepare_v2(
+        that->db,
+        that->cmd,
+        -1,
+        &(project->insertMaterialized),
+        NULL);
+    if (retPrepare != SQLITE_OK) {
+
+      SafeStrDup(
+        that->errMsg,
+        sqlite3_errmsg(that->db));
+      Raise(RunRecorderExc_AddMeasureFailed);
+
+    }
+
+  }
+
+  // Bind the reference and date of the measure, and the default values
+  sqlite3_stmt* stmt = project->insertMaterialized;
+  sqlite3_reset(stmt);
+  BindStmtLong(
+    that,
+    stmt,
+    1,
+    that->refLastAddedMeasure);
+  BindStmtLong(
+    that,
+    stmt,
+    2,
+    date);
+  ForZeroTo(iMetric, project->metrics->nb)
+    BindStmtText(
+      that,
+      stmt,
+      3 + iMetric,
+      project->metrics->defaultValues[iMetric]);
+
+  // Bind the values of the measure over the default values. The metrics
+  // have already been resolved when adding the values, so there is no
+  // reload of the metrics here.
+  ForZeroTo(iVal, measure->nbMetric) {
+
+    long idxMetric =
+      SearchIdxMetric(
+        project->metrics,
+        measure->metrics[iVal]);
+    if (idxMetric != -1) {
+
+      // If the value is invalid its default value stays bound, the
+      // failure is reported by the insertion of the value in _Value
+      Try {
+
+        BindStmtValue(
+          that,
+          stmt,
+          3 + idxMetric,
+          measure,
+          iVal,
+          project->metrics->types[idxMetric]);
+
+      } CatchDefault {
+
+        int exc = TryCatchGetLastExc();
+        if (exc != RunRecorderExc_InvalidValue) Raise(exc);
+
+      } EndCatch;
+
+    }
+
+  }
+
+  // Execute the command
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_DONE) Raise(RunRecorderExc_AddMeasureFailed);
+
+}
+
+// Check if a project has a materialized table in a local database
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+// Output:
+//   Return true if the project has a materialized table, else false
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static bool IsMaterializedLocal(
+  struct RunRecorder* const that,
+          char const* const project) {
+
+  // Prepare the SQL command
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_isMaterialized);
+  BindStmtText(
+    that,
+    stmt,
+    1,
+    project);
+
+  // Execute the command to get the flag
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_ROW && retStep != SQLITE_DONE)
+    Raise(RunRecorderExc_SQLRequestFailed);
+
+  // Get the flag if the project exists
+  bool isMaterialized = false;
+  if (retStep == SQLITE_ROW)
+    isMaterialized = (sqlite3_column_int(stmt, 0) != 0);
+
+  // Release the statement
+  sqlite3_reset(stmt);
+
+  // Return the flag
+  return isMaterialized;
+
+}
+
+// Get the projects having a materialized table in a local database
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the projects' reference/label
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderRefVal* GetMaterializedProjectsLocal(
+  struct RunRecorder* const that) {
+
+  // Get the projects
+  struct RunRecorderRefVal* projects =
+    GetProjectsOfStmtLocal(
+      that,
+      RunRecorderStmt_getMaterializedProjects);
+
+  // Return the projects
+  return projects;
+
+}
+
+// Copy the dates of the measures into the materialized tables of all the
+// projects in a local database, after a migration which changed them
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static void SyncMaterializedDatesLocal(
+  struct RunRecorder* const that) {
+
+  // Get the materialized projects
+  struct RunRecorderRefVal* projects = GetMaterializedProjectsLocal(that);
+
+  Try {
+
+    // Loop on the materialized projects
+    ForZeroTo(iProject, projects->nb) {
+
+      // Copy the dates of the measures
+      StringCreate(
+        &(that->cmd),
+        "UPDATE \"" MATERIALIZED_PREFIX "%s\" SET DateMeasure = "
+        "(SELECT DateMeasure FROM _Measure "
+        "WHERE _Measure.Ref = \"" MATERIALIZED_PREFIX "%s\".Ref)",
+        projects->values[iProject],
+        projects->values[iProject]);
+      int retExec =
+        sqlite3_exec(
+          that->db,
+          that->cmd,
+          NULL,
+          NULL,
+          &(that->sqliteErrMsg));
+      if (retExec != SQLITE_OK) Raise(RunRecorderExc_SQLRequestFailed);
+
+    }
+
+  } CatchDefault {
+
+    PolyFree(&projects);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  PolyFree(&projects);
+
+}
+
+// Enable or disable the materialized table of a project in a local
+// database
+// Inputs:
+//             that: the struct RunRecorder
+//          project: the project's name
+//   isMaterialized: true to enable, false to disable
+// Raise:
+//   RunRecorderExc_MaterializeFailed
+//   RunRecorderExc_SessionFailed
+static void SetMaterializedLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+                 bool const isMaterialized) {
+
+  // If the project is already in the requested state, nothing to do
+  bool wasMaterialized =
+    IsMaterializedLocal(
+      that,
+      project);
+  if (wasMaterialized == isMaterialized) return;
+
+  // Get the metrics of the project
+  struct RunRecorderRefValDef* metrics =
+    GetMetricsLocal(
+      that,
+      project);
+
+  // If there is no opened session, make the change in a transaction of
+  // its own, else it'll be committed with the session
+  bool const hasOwnTransaction = (that->isInSession == false);
+  Try {
+
+    if (hasOwnTransaction == true) BeginSessionLocal(that);
+
+    // If the materialized table is enabled
+    if (isMaterialized == true) {
+
+      // Create the command to create the table, with one column per
+      // metric, of the type of the metric, and their default value
+      StringCreate(
+        &(that->cmd),
+        "CREATE TABLE \"" MATERIALIZED_PREFIX "%s\" ("
+        "Ref INTEGER PRIMARY KEY,DateMeasure INTEGER NOT NULL",
+        project);
+      ForZeroTo(iMetric, metrics->nb) {
+
+        char* defaultVal =
+          sqlite3_mprintf(
+            "%Q",
+            metrics->defaultValues[iMetric]);
+        if (defaultVal == NULL) Raise(TryCatchExc_MallocFailed);
+        StringAppend(
+          &(that->cmd),
+          ",\"%s\" %s NOT NULL DEFAULT %s",
+          metrics->values[iMetric],
+          metricTypeSql[metrics->types[iMetric]],
+          defaultVal);
+        sqlite3_free(defaultVal);
+
+      }
+
+      // Extend the command to index the table on the date
+      StringAppend(
+        &(that->cmd),
+        ");CREATE INDEX \"" MATERIALIZED_PREFIX "%s_ByDate\" "
+        "ON \"" MATERIALIZED_PREFIX "%s\" (DateMeasure)",
+        project,
+        project);
+
+      // Extend the command to populate the table with the existing
+      // measures
+      StringAppend(
+        &(that->cmd),
+        ";INSERT INTO \"" MATERIALIZED_PREFIX "%s\" "
+        "SELECT _Measure.Ref,_Measure.DateMeasure",
+        project);
+      AppendCmdColumnsMeasure(
+        that,
+        metrics);
+      StringAppend(
+        &(that->cmd),
+        " FROM _Measure WHERE _Measure.RefProject = "
+        "(SELECT Ref FROM _Project WHERE Label = \"%s\")",
+        project);
+
+    // Else, the materialized table is disabled
+    } else {
+
+      // Create the command to delete the table
+      StringCreate(
+        &(that->cmd),
+        "DROP TABLE \"" MATERIALIZED_PREFIX "%s\"",
+        project);
+
+    }
+
+    // Execute the command
+    int retExec =
+      sqlite3_exec(
+        that->db,
+        that->cmd,
+        NULL,
+        NULL,
+        &(that->sqliteErrMsg));
+    if (retExec != SQLITE_OK) Raise(RunRecorderExc_MaterializeFailed);
+
+    // Update the flag of the project
+    sqlite3_stmt* stmt =
+      GetStmt(
+        that,
+        RunRecorderStmt_setMaterialized);
+    BindStmtLong(
+      that,
+      stmt,
+      1,
+      isMaterialized);
+    BindStmtText(
+      that,
+      stmt,
+      2,
+      project);
+    int retStep =
+      StepStmt(
+        that,
+        stmt);
+    if (retStep != SQLITE_DONE) Raise(RunRecorderExc_MaterializeFailed);
+
+    // Update the view of the project to read from the appropriate source
+    UpdateViewProject(
+      that,
+      project);
+
+    // Commit the transaction
+    if (hasOwnTransaction == true) CommitSessionLocal(that);
+
+  } CatchDefault {
+
+    // Cancel the changes if the transaction is owned here
+    if (hasOwnTransaction == true) RollbackSessionLocal(that);
+    PolyFree(&metrics);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  PolyFree(&metrics);
+
+}
+
+// Enable or disable the materialized table of a project through the Web
+// API
+// Inputs:
+//             that: the struct RunRecorder
+//          project: the project's name
+//   isMaterialized: true to enable, false to disable
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static void SetMaterializedAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+                 bool const isMaterialized) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=materialize&project=%s&enable=%d",
+    project,
+    (isMaterialized == true ? 1 : 0));
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+}
+
+// Get the current date in the format of _Measure.DateMeasure, the number
+// of microseconds since the Epoch (UTC)
+// Output:
+//   Return the date
+static long GetDateMeasureNow(
+  void) {
+
+  // Get the current date
+  struct timespec ts;
+  timespec_get(
+    &ts,
+    TIME_UTC);
+
+  // Return the date converted to microseconds
+  return (long)ts.tv_sec * USEC_PER_SEC + (long)ts.tv_nsec / 1000L;
+
+}
+
+// Get the current time of the monotonic clock, in microseconds since an
+// unspecified point, unaffected by the changes of the system date
+// Output:
+//   Return the time
+static long GetMonotonicNow(
+  void) {
+
+  // Get the current time
+  struct timespec ts;
+  clock_gettime(
+    CLOCK_MONOTONIC,
+    &ts);
+
+  // Return the time converted to microseconds
+  return (long)ts.tv_sec * USEC_PER_SEC + (long)ts.tv_nsec / 1000L;
+
+}
+
+// Add a measure to a project in a local database
+// Inputs:
+//      project: the handle on the project to add the measure to
+//      measure: the measure to add
+//         date: the date of the measure, in microseconds since the Epoch
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+static void AddMeasureLocal(
+         struct RunRecorderProject* const project,
+  struct RunRecorderMeasure const* const measure,
+                              long const date) {
+
+  // Shortcut to the struct RunRecorder
+  struct RunRecorder* const that = project->recorder;
+
+  // Reset the reference of the last added measure
+  that->refLastAddedMeasure = 0;
+
+  // Prepare the SQL command
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_addMeasure);
+  BindStmtLong(
+    that,
+    stmt,
+    1,
+    project->ref);
+  BindStmtLong(
+    that,
+    stmt,
+    2,
+    date);
+
+  // Execute the command to add the measure
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_DONE) Raise(RunRecorderExc_AddMeasureFailed);
+
+  // Get the reference of the measure
+  that->refLastAddedMeasure = sqlite3_last_insert_rowid(that->db);
+
+  // Declare a variable to memorise an eventual failure
+  // The policy here is to try to save has much data has possible
+  // even if some fails, inform the user and let him/her take
+  // appropriate action
+  bool hasFailed = false;
+
+  // Loop on the values in the measure
+  ForZeroTo(iVal, measure->nbMetric) {
+
+    Try {
+
+      // Get the reference of the metric
+      long idxMetric =
+        ProjectGetIdxMetric(
+          project,
+          measure->metrics[iVal]);
+      if (idxMetric == -1) {
+
+        StringCreate(
+          &(that->errMsg),
+          "The metric %s doesn't exist in the project %s.",
+          measure->metrics[iVal],
+          project->label);
+        Raise(RunRecorderExc_AddMeasureFailed);
+
+      }
+
+      // Prepare the SQL command
+      stmt =
+        GetStmt(
+          that,
+          RunRecorderStmt_addValue);
+      BindStmtLong(
+        that,
+        stmt,
+        1,
+        that->refLastAddedMeasure);
+      BindStmtLong(
+        that,
+        stmt,
+        2,
+        project->metrics->refs[idxMetric]);
+      BindStmtValue(
+        that,
+        stmt,
+        3,
+        measure,
+        iVal,
+        project->metrics->types[idxMetric]);
+
+      // Execute the command to add the value
+      retStep =
+        StepStmt(
+          that,
+          stmt);
+      if (retStep != SQLITE_DONE) hasFailed = true;
+
+    } CatchDefault {
+
+      hasFailed = true;
+
+    } EndCatch;
+
+  }
+
+  // If the project has a materialized table, add the measure to it
+  if (project->isMaterialized == true) {
+
+    Try {
+
+      AddMeasureMaterialized(
+        project,
+        measure,
+        date);
+
+    } CatchDefault {
+
+      hasFailed = true;
+
+    } EndCatch;
+
+  }
+
+  // If there has been a failure, raise an exception
+  if (hasFailed == true) Raise(RunRecorderExc_AddMeasureFailed);
+
+}
+
+// Add a measure to a project through the WebAPI
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measure to
+//      measure: the measure to add
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static void AddMeasureAPI(
+               struct RunRecorder* const that,
+                       char const* const project,
+  struct RunRecorderMeasure const* const measure) {
+
+  // Reset the reference of the last added measure
+  that->refLastAddedMeasure = 0;
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=add_measure&project=%s",
+    project);
+  ForZeroTo(iVal, measure->nbMetric)
+    StringAppend(
+      &(that->cmd),
+      "&%s=%s",
+      measure->metrics[iVal],
+      measure->values[iVal]);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+  // Extract the reference of the measure from the JSON reply
+  char* version =
+    GetJSONValOfKey(
+      that->curlReply,
+      "refMeasure");
+  if (version == NULL) Raise(RunRecorderExc_ApiRequestFailed);
+  errno = 0;
+  that->refLastAddedMeasure =
+    strtol(
+      version,
+      NULL,
+      10);
+  free(version);
+  if (errno != 0) Raise(RunRecorderExc_ApiRequestFailed);
+
+}
+
+// Add several measures to a project in a local database, in one single
+// transaction if there is no opened session
+// Inputs:
+//      project: the handle on the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+//        dates: the dates of the measures, in microseconds since the
+//               Epoch, or NULL to date them when they're added
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SessionFailed
+static void AddMeasuresLocal(
+              struct RunRecorderProject* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure,
+                              long const* const dates) {
+
+  // Shortcut to the struct RunRecorder
+  struct RunRecorder* const that = project->recorder;
+
+  // If there is no opened session, group the measures in a transaction
+  // of their own, else they'll be committed with the session
+  bool const hasOwnTransaction = (that->isInSession == false);
+  if (hasOwnTransaction == true) BeginSessionLocal(that);
+
+  // Declare a variable to memorise an eventual failure
+  // The policy here is to try to save has much data has possible
+  // even if some fails, inform the user and let him/her take
+  // appropriate action. A failed statement doesn't rollback the
+  // transaction, so the other measures are still committed.
+  bool hasFailed = false;
+
+  // Variable to memorise the reference of the last successfully added
+  // measure
+  long refLastAddedMeasure = 0;
+
+  // Loop on the measures
+  ForZeroTo(iMeasure, nbMeasure) {
+
+    Try {
+
+      AddMeasureLocal(
+        project,
+        measures[iMeasure],
+        (dates != NULL ? dates[iMeasure] : GetDateMeasureNow()));
+
+    } CatchDefault {
+
+      hasFailed = true;
+
+    } EndCatch;
+
+    // If the measure could be added, even partially, memorise its
+    // reference
+    if (that->refLastAddedMeasure != 0)
+      refLastAddedMeasure = that->refLastAddedMeasure;
+
+  }
+
+  // Set the reference of the last added measure
+  that->refLastAddedMeasure = refLastAddedMeasure;
+
+  // Commit the transaction
+  if (hasOwnTransaction == true) CommitSessionLocal(that);
+
+  // If there has been a failure, raise an exception
+  if (hasFailed == true) Raise(RunRecorderExc_AddMeasureFailed);
+
+}
+
+// Add several measures to a project through the Web API, by batches of
+// SIZE_BATCH_ADD_MEASURES_API measures per request. If the Web API can't
+// be reached and the struct RunRecorder has a spool, the measures not yet
+// sent are spooled
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+//        dates: the dates of the measures, in microseconds since the
+//               Epoch, or NULL to let the Web API date them. The spooled
+//               measures are dated when they're spooled.
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SpoolFailed
+static void AddMeasuresAPI(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure,
+                              long const* const dates) {
+
+  // Declare a variable to memorise an eventual failure, same policy as
+  // for the local database
+  bool hasFailed = false;
+
+  // Variable to memorise the reference of the last successfully added
+  // measure
+  long refLastAddedMeasure = 0;
+
+  // Flag to memorise if the Web API can't be reached and the measures
+  // must be spooled
+  bool isSpooled = false;
+
+  // Loop on the batches of measures
+  long iMeasure = 0;
+  while (iMeasure < nbMeasure && isSpooled == false) {
+
+    // Send the batch in one request
+    long nbMeasureBatch = nbMeasure - iMeasure;
+    if (nbMeasureBatch > SIZE_BATCH_ADD_MEASURES_API)
+      nbMeasureBatch = SIZE_BATCH_ADD_MEASURES_API;
+    Try {
+
+      AddMeasuresOfReqAPI(
+        that,
+        project,
+        measures + iMeasure,
+        nbMeasureBatch,
+        (dates != NULL ? dates + iMeasure : NULL));
+
+    } CatchDefault {
+
+      // If the Web API can't be reached and there is a spool, this batch
+      // and the following ones are spooled instead
+      if (
+        TryCatchGetLastExc() == RunRecorderExc_CurlRequestFailed &&
+        that->spool != NULL) isSpooled = true;
+      else hasFailed = true;
+
+    } EndCatch;
+
+    // If measures could be added, memorise the reference of the last one
+    if (that->refLastAddedMeasure != 0)
+      refLastAddedMeasure = that->refLastAddedMeasure;
+    if (isSpooled == false) iMeasure += nbMeasureBatch;
+
+  }
+
+  // Set the reference of the last added measure
+  that->refLastAddedMeasure = refLastAddedMeasure;
+
+  // Spool the measures which couldn't be sent
+  if (isSpooled == true) {
+
+    FreeErrMsg(that);
+    SpoolMeasures(
+      that,
+      project,
+      measures + iMeasure,
+      nbMeasure - iMeasure);
+
+  }
+
+  // If there has been a failure, raise an exception
+  if (hasFailed == true) Raise(RunRecorderExc_AddMeasureFailed);
+
+}
+
+// Add several measures to a project through the Web API in one single
+// request, the measures are sent as a JSON array
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+//        dates: the dates of the measures, in microseconds since the
+//               Epoch, or NULL to let the Web API date them
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+//   RunRecorderExc_AddMeasureFailed
+static void AddMeasuresOfReqAPI(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure,
+                              long const* const dates) {
+
+  // Calculate the length of the JSON array of measures, to create it in
+  // one single allocation
+  size_t length = 3;
+  ForZeroTo(iMeasure, nbMeasure)
+    length +=
+      1 +
+      MeasureJSONLen(
+        measures[iMeasure],
+        (dates != NULL ? dates[iMeasure] : 0));
+
+  // Create the JSON array as [{"metric":"value",...},...]
+  char* json = NULL;
+  SafeMalloc(
+    json,
+    length);
+  char* ptr = json;
+  *(ptr++) = '[';
+  ForZeroTo(iMeasure, nbMeasure) {
+
+    if (iMeasure > 0) *(ptr++) = ',';
+    ptr =
+      MeasureJSONCpy(
+        ptr,
+        measures[iMeasure],
+        (dates != NULL ? dates[iMeasure] : 0));
+
+  }
+  *(ptr++) = ']';
+  *ptr = '\0';
+
+  // Send the measures
+  long nbFailedMeasure = 0;
+  Try {
+
+    nbFailedMeasure =
+      SendMeasuresJSONAPI(
+        that,
+        project,
+        json);
+
+  } CatchDefault {
+
+    free(json);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  free(json);
+
+  // If some measures couldn't be added, raise an exception
+  if (nbFailedMeasure > 0) Raise(RunRecorderExc_AddMeasureFailed);
+
+}
+
+// Get the length of a string once escaped in a JSON string
+// Input:
+//   str: the string
+// Output:
+//   Return the length, without the terminating '\0'
+static size_t JSONStrLen(
+  char const* const str) {
+
+  // Loop on the characters, the double quotes and backslashes are
+  // preceded by a backslash, and the control characters are replaced
+  // with their code as \uXXXX
+  size_t length = 0;
+  for (
+    unsigned char const* ptr = (unsigned char const*)str;
+    *ptr != '\0';
+    ++ptr) {
+
+    if (*ptr == '"' || *ptr == '\\') length += 2;
+    else if (*ptr < 0x20) length += 6;
+    else length += 1;
+
+  }
+
+  // Return the length
+  return length;
+
+}
+
+// Copy a string escaped as in a JSON string
+// Inputs:
+//   dest: where to copy the string, must be at least of size
+//         JSONStrLen(str)
+//    str: the string
+// Output:
+//   Return a pointer to the character after the copied string in dest,
+//   the copied string is not terminated by '\0'
+static char* JSONStrCpy(
+         char* const dest,
+  char const* const str) {
+
+  // Loop on the characters
+  char* ptrDest = dest;
+  for (
+    unsigned char const* ptr = (unsigned char const*)str;
+    *ptr != '\0';
+    ++ptr) {
+
+    // Copy the character, escaped if necessary
+    if (*ptr == '"' || *ptr == '\\') {
+
+      *(ptrDest++) = '\\';
+      *(ptrDest++) = (char)*ptr;
+
+    } else if (*ptr < 0x20) {
+
+      snprintf(
+        ptrDest,
+        7,
+        "\\u%04x",
+        *ptr);
+      ptrDest += 6;
+
+    } else {
+
+      *(ptrDest++) = (char)*ptr;
+
+    }
+
+  }
+
+  // Return the pointer after the copied string
+  return ptrDest;
+
+}
+
+// Create the asynchronous writer of a struct RunRecorder, with its own
+// connection to the database or Web API. The writer thread is not
+// started.
+// Inputs:
+//       that: the struct RunRecorder
+//   capacity: the maximum number of measures in the queue
+//     policy: the policy when the queue is full
+// Output:
+//   Return the new struct RunRecorderAsync
+// Raise:
+//   RunRecorderExc_AsyncFailed
+static struct RunRecorderAsync* RunRecorderAsyncCreate(
+            struct RunRecorder* const that,
+                           long const capacity,
+  enum RunRecorderAsyncPolicy const policy) {
+
+  // Allocate the struct RunRecorderAsync
+  struct RunRecorderAsync* async = NULL;
+  SafeRealloc(
+    async,
+    sizeof(struct RunRecorderAsync));
+  async->writer = NULL;
+  async->policy = policy;
+  async->capacity = capacity;
+  async->head = 0;
+  async->nb = 0;
+  async->nbWriting = 0;
+  async->nbDropped = 0;
+  async->refLastAddedMeasure = 0;
+  async->hasFailed = false;
+  async->errMsg = NULL;
+  async->isStopping = false;
+  async->isRunning = false;
+  async->projects = NULL;
+  async->measures = NULL;
+  async->dates = NULL;
+  pthread_mutex_init(
+    &(async->lock),
+    NULL);
+  pthread_cond_init(
+    &(async->condQueued),
+    NULL);
+  pthread_cond_init(
+    &(async->condWritten),
+    NULL);
+
+  Try {
+
+    // Allocate the queue
+    SafeRealloc(
+      async->projects,
+      sizeof(char*) * capacity);
+    SafeRealloc(
+      async->measures,
+      sizeof(struct RunRecorderMeasure*) * capacity);
+    SafeRealloc(
+      async->dates,
+      sizeof(long) * capacity);
+
+    // Open the connection of the writer thread. It waits for the lock
+    // at least ASYNC_BUSY_TIMEOUT instead of failing when the connection
+    // of the struct RunRecorder accesses the database at the same time.
+    // The options of the struct RunRecorder are left unchanged.
+    struct RunRecorderOptions options = that->options;
+    if (options.busyTimeout < ASYNC_BUSY_TIMEOUT)
+      options.busyTimeout = ASYNC_BUSY_TIMEOUT;
+    async->writer =
+      RunRecorderAllocWithOptions(
+        that->url,
+        &options);
+    RunRecorderInit(async->writer);
+    RunRecorderSetKeepAlive(
+      async->writer,
+      that->keepAliveIdle,
+      that->keepAliveInterval);
+
+  } CatchDefault {
+
+    int exc = TryCatchGetLastExc();
+    if (async->writer != NULL && async->writer->errMsg != NULL)
+      SafeStrDup(
+        that->errMsg,
+        async->writer->errMsg);
+    RunRecorderAsyncFree(&async);
+    if (exc == TryCatchExc_MallocFailed) Raise(exc);
+    Raise(RunRecorderExc_AsyncFailed);
+
+  } EndCatch;
+
+  // Return the struct RunRecorderAsync
+  return async;
+
+}
+
+// Free a struct RunRecorderAsync, stopping its writer thread if it is
+// running. The writer thread writes the queued measures before ending.
+// Input:
+//   that: the struct RunRecorderAsync
+static void RunRecorderAsyncFree(
+  struct RunRecorderAsync** const that) {
+
+  // If it's already freed, nothing to do
+  if (that == NULL || *that == NULL) return;
+  struct RunRecorderAsync* async = *that;
+
+  // If the writer thread is running, request it to end and wait for it
+  if (async->isRunning == true) {
+
+    pthread_mutex_lock(&(async->lock));
+    async->isStopping = true;
+    pthread_cond_signal(&(async->condQueued));
+    pthread_mutex_unlock(&(async->lock));
+    pthread_join(
+      async->thread,
+      NULL);
+
+  }
+
+  // Free the measures left in the queue
+  ForZeroTo(iMeasure, async->nb) {
+
+    long idx = (async->head + iMeasure) % async->capacity;
+    free(async->projects[idx]);
+    RunRecorderMeasureFree(async->measures + idx);
+
+  }
+
+  // Free memory
+  RunRecorderFree(&(async->writer));
+  free(async->projects);
+  free(async->measures);
+  free(async->dates);
+  free(async->errMsg);
+  pthread_mutex_destroy(&(async->lock));
+  pthread_cond_destroy(&(async->condQueued));
+  pthread_cond_destroy(&(async->condWritten));
+  free(async);
+  *that = NULL;
+
+}
+
+// Copy a struct RunRecorderMeasure
+// Input:
+//   that: the struct RunRecorderMeasure
+// Output:
+//   Return the new struct RunRecorderMeasure
+static struct RunRecorderMeasure* MeasureClone(
+  struct RunRecorderMeasure const* const that) {
+
+  // Create the copy and set the values of the original measure
+  struct RunRecorderMeasure* clone = RunRecorderMeasureCreate();
+  Try {
+
+    ForZeroTo(iMetric, that->nbMetric)
+      MeasureSetValue(
+        clone,
+        that->metrics[iMetric],
+        that->values[iMetric],
+        that->types[iMetric],
+        that->nums[iMetric]);
+
+  } CatchDefault {
+
+    RunRecorderMeasureFree(&clone);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Return the copy
+  return clone;
+
+}
+
+// Queue several measures to be added to a project by the asynchronous
+// writer of a struct RunRecorder. The measures are copied, and if the queue
+// is full the policy of the writer is applied.
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_AsyncQueueFull
+static void AddMeasuresAsync(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure) {
+
+  // The reference of the measures is unknown until they're written
+  struct RunRecorderAsync* async = that->async;
+  that->refLastAddedMeasure = 0;
+
+  // The measures are dated when they're queued, not when they're
+  // written, which may be much later if the writer thread is stalled
+  long const date = GetDateMeasureNow();
+
+  // With the fail policy, check there is room for all the measures
+  // before queuing any of them. The struct RunRecorder is used by one
+  // thread at a time and the writer thread only makes room, so the
+  // room can't be taken by someone else in between.
+  if (async->policy == RunRecorderAsyncPolicy_fail) {
+
+    pthread_mutex_lock(&(async->lock));
+    bool isFull = (async->nb + nbMeasure > async->capacity);
+    pthread_mutex_unlock(&(async->lock));
+    if (isFull == true) {
+
+      SafeStrDup(
+        that->errMsg,
+        "The queue of the asynchronous writer is full");
+      Raise(RunRecorderExc_AsyncQueueFull);
+
+    }
+
+  }
+
+  // Loop on the measures
+  ForZeroTo(iMeasure, nbMeasure) {
+
+    // Copy the measure and the project's label, outside of the lock to
+    // keep it short
+    struct RunRecorderMeasure* clone = NULL;
+    char* label = NULL;
+    Try {
+
+      clone = MeasureClone(measures[iMeasure]);
+      SafeStrDup(
+        label,
+        project);
+
+    } CatchDefault {
+
+      RunRecorderMeasureFree(&clone);
+      Raise(TryCatchGetLastExc());
+
+    } EndCatch;
+
+    pthread_mutex_lock(&(async->lock));
+
+    // If the queue is full, wait for the writer thread or drop the
+    // oldest measures according to the policy
+    while (async->nb == async->capacity) {
+
+      if (async->policy == RunRecorderAsyncPolicy_dropOldest) {
+
+        free(async->projects[async->head]);
+        RunRecorderMeasureFree(async->measures + async->head);
+        async->head = (async->head + 1) % async->capacity;
+        --(async->nb);
+        ++(async->nbDropped);
+
+      } else {
+
+        pthread_cond_wait(
+          &(async->condWritten),
+          &(async->lock));
+
+      }
+
+    }
+
+    // Queue the measure and wake up the writer thread
+    long idx = (async->head + async->nb) % async->capacity;
+    async->projects[idx] = label;
+    async->measures[idx] = clone;
+    async->dates[idx] = date;
+    ++(async->nb);
+    pthread_cond_signal(&(async->condQueued));
+    pthread_mutex_unlock(&(async->lock));
+
+  }
+
+}
+
+// Main function of the writer thread of a struct RunRecorderAsync. Take
+// the queued measures by batches of SIZE_BATCH_ASYNC and write them,
+// until the writer is stopped and the queue is empty.
+// Input:
+//   arg: the struct RunRecorderAsync
+// Output:
+//   Return NULL
+static void* AsyncWriterMain(
+  void* arg) {
+
+  struct RunRecorderAsync* async = arg;
+
+  // Batch of measures taken from the queue
+  char* projects[SIZE_BATCH_ASYNC];
+  struct RunRecorderMeasure* measures[SIZE_BATCH_ASYNC];
+  long dates[SIZE_BATCH_ASYNC];
+
+  pthread_mutex_lock(&(async->lock));
+  while (true) {
+
+    // Wait for queued measures
+    while (async->nb == 0 && async->isStopping == false)
+      pthread_cond_wait(
+        &(async->condQueued),
+        &(async->lock));
+
+    // If the queue is empty, the writer has been stopped
+    if (async->nb == 0) break;
+
+    // Take the oldest measures from the queue, and signal the room made
+    // to the producer
+    long nbMeasure = async->nb;
+    if (nbMeasure > SIZE_BATCH_ASYNC) nbMeasure = SIZE_BATCH_ASYNC;
+    ForZeroTo(iMeasure, nbMeasure) {
+
+      long idx = (async->head + iMeasure) % async->capacity;
+      projects[iMeasure] = async->projects[idx];
+      measures[iMeasure] = async->measures[idx];
+      dates[iMeasure] = async->dates[idx];
+
+    }
+
+    async->head = (async->head + nbMeasure) % async->capacity;
+    async->nb -= nbMeasure;
+    async->nbWriting = nbMeasure;
+    pthread_cond_broadcast(&(async->condWritten));
+    pthread_mutex_unlock(&(async->lock));
+
+    // Write the batch without holding the lock
+    AsyncWriteBatch(
+      async,
+      projects,
+      measures,
+      dates,
+      nbMeasure);
+
+    // Free the batch
+    ForZeroTo(iMeasure, nbMeasure) {
+
+      free(projects[iMeasure]);
+      RunRecorderMeasureFree(measures + iMeasure);
+
+    }
+
+    // Signal the end of the writing of the batch
+    pthread_mutex_lock(&(async->lock));
+    async->nbWriting = 0;
+    pthread_cond_broadcast(&(async->condWritten));
+
+  }
+
+  pthread_mutex_unlock(&(async->lock));
+  return NULL;
+
+}
+
+// Add several measures to a project with given dates, in one single
+// transaction or by batches of requests to the Web API. Used by the
+// asynchronous writer, which has no spool and no session.
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+//        dates: the dates of the measures, in microseconds since the Epoch
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SessionFailed
+static void AddMeasuresDated(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure,
+                             long const* const dates) {
+
+  // Reset the reference of the last added measure and the error messages
+  that->refLastAddedMeasure = 0;
+  FreeErrMsg(that);
+
+  // If the RunRecorder uses a local database
+  if (UsesAPI(that) == false) {
+
+    // Open a handle on the project to resolve the metrics once for all
+    // the measures
+    struct RunRecorderProject* handle =
+      RunRecorderOpenProject(
+        that,
+        project);
+
+    Try {
+
+      AddMeasuresLocal(
+        handle,
+        measures,
+        nbMeasure,
+        dates);
+
+    } CatchDefault {
+
+      PolyFree(&handle);
+      Raise(TryCatchGetLastExc());
+
+    } EndCatch;
+    PolyFree(&handle);
+
+  // Else, the RunRecorder uses the Web API, the dates are sent with the
+  // measures
+  } else {
+
+    AddMeasuresAPI(
+      that,
+      project,
+      measures,
+      nbMeasure,
+      dates);
+
+  }
+
+}
+
+// Write a batch of measures taken from the queue of a struct
+// RunRecorderAsync, with the date they were queued. The consecutive
+// measures of a same project are written in one single transaction or
+// request. Failures are memorised in the struct RunRecorderAsync, to be
+// reported by RunRecorderFlush.
+// Inputs:
+//        that: the struct RunRecorderAsync
+//    projects: the labels of the projects of the measures
+//    measures: the measures
+//       dates: the dates of the measures, in microseconds since the Epoch
+//   nbMeasure: the number of measures
+static void AsyncWriteBatch(
+           struct RunRecorderAsync* const that,
+                       char* const* const projects,
+  struct RunRecorderMeasure* const* const measures,
+                        long const* const dates,
+                               long const nbMeasure) {
+
+  // Loop on the groups of consecutive measures of a same project
+  long iMeasure = 0;
+  while (iMeasure < nbMeasure) {
+
+    long nbMeasureGroup = 1;
+    while (
+      iMeasure + nbMeasureGroup < nbMeasure &&
+      strcmp(
+        projects[iMeasure],
+        projects[iMeasure + nbMeasureGroup]) == 0) ++nbMeasureGroup;
+
+    // Write the group of measures
+    Try {
+
+      AddMeasuresDated(
+        that->writer,
+        projects[iMeasure],
+        (struct RunRecorderMeasure const* const*)(measures + iMeasure),
+        nbMeasureGroup,
+        dates + iMeasure);
+
+    } CatchDefault {
+
+      // Memorise the failure and its error message, the failure is
+      // reported without message if it can't be copied
+      int exc = TryCatchGetLastExc();
+      pthread_mutex_lock(&(that->lock));
+      that->hasFailed = true;
+      Try {
+
+        SafeStrDup(
+          that->errMsg,
+          (that->writer->errMsg != NULL ?
+            that->writer->errMsg : TryCatchExcToStr(exc)));
+
+      } CatchDefault {
+
+        that->errMsg = NULL;
+
+      } EndCatch;
+      pthread_mutex_unlock(&(that->lock));
+
+    } EndCatch;
+
+    // If measures could be added, memorise the reference of the last one
+    if (that->writer->refLastAddedMeasure != 0) {
+
+      pthread_mutex_lock(&(that->lock));
+      that->refLastAddedMeasure = that->writer->refLastAddedMeasure;
+      pthread_mutex_unlock(&(that->lock));
+
+    }
+
+    iMeasure += nbMeasureGroup;
+
+  }
+
+}
+
+// Get the length of a measure as a JSON dictionary {"metric":"value",...}
+// Inputs:
+//   that: the struct RunRecorderMeasure
+//   date: the date of the measure in microseconds since the Epoch, added
+//         to the dictionary as "_date" if it is not 0
+// Output:
+//   Return the length, without the terminating '\0'
+static size_t MeasureJSONLen(
+  struct RunRecorderMeasure const* const that,
+                              long const date) {
+
+  // Length of the braces and, for each value, of the quotes, the colon
+  // and the comma
+  size_t length = 2;
+  ForZeroTo(iVal, that->nbMetric)
+    length +=
+      6 +
+      JSONStrLen(that->metrics[iVal]) +
+      JSONStrLen(that->values[iVal]);
+
+  // Length of the date
+  if (date != 0) {
+
+    char str[LENGTH_NUM_STR];
+    length +=
+      11 +
+      (size_t)snprintf(
+        str,
+        LENGTH_NUM_STR,
+        "%ld",
+        date);
+
+  }
+
+  // Return the length
+  return length;
+
+}
+
+// Copy a measure as a JSON dictionary {"metric":"value",...}
+// Inputs:
+//   dest: where to copy the measure, must be at least of size
+//         MeasureJSONLen(that, date)
+//   that: the struct RunRecorderMeasure
+//   date: the date of the measure in microseconds since the Epoch, added
+//         to the dictionary as "_date" if it is not 0
+// Output:
+//   Return a pointer to the character after the copied measure in dest,
+//   the copied measure is not terminated by '\0'
+static char* MeasureJSONCpy(
+                              char* const dest,
+  struct RunRecorderMeasure const* const that,
+                              long const date) {
+
+  char* ptr = dest;
+  *(ptr++) = '{';
+  if (date != 0) {
+
+    ptr +=
+      sprintf(
+        ptr,
+        "\"_date\":\"%ld\"%s",
+        date,
+        (that->nbMetric > 0 ? "," : ""));
+
+  }
+
+  ForZeroTo(iVal, that->nbMetric) {
+
+    if (iVal > 0) *(ptr++) = ',';
+    *(ptr++) = '"';
+    ptr =
+      JSONStrCpy(
+        ptr,
+        that->metrics[iVal]);
+    *(ptr++) = '"';
+    *(ptr++) = ':';
+    *(ptr++) = '"';
+    ptr =
+      JSONStrCpy(
+        ptr,
+        that->values[iVal]);
+    *(ptr++) = '"';
+
+  }
+
+  *(ptr++) = '}';
+  return ptr;
+
+}
+
+// Send measures to a project through the Web API in one single request
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project to add the measures to
+//      json: the measures as a JSON array of dictionaries
+// Output:
+//   Return the number of measures which couldn't be entirely added, and
+//   set the reference of the last added measure
+// Raise:
+//   RunRecorderExc_CurlRequestFailed
+//   RunRecorderExc_ApiRequestFailed
+static long SendMeasuresJSONAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+          char const* const json) {
+
+  // Reset the reference of the last added measure
+  that->refLastAddedMeasure = 0;
+
+  // Create the request to the Web API, the JSON array is url encoded as
+  // it contains reserved characters
+  char* jsonEncoded =
+    curl_easy_escape(
+      that->curl,
+      json,
+      0);
+  if (jsonEncoded == NULL) Raise(TryCatchExc_MallocFailed);
+  Try {
+
+    StringCreate(
+      &(that->cmd),
+      "action=add_measures&project=%s&measures=%s",
+      project,
+      jsonEncoded);
+
+  } CatchDefault {
+
+    curl_free(jsonEncoded);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+  curl_free(jsonEncoded);
+
+  // Send the request to the API
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+  // Extract the reference of the last measure and the number of failed
+  // measures from the JSON reply
+  char* refLast =
+    GetJSONValOfKey(
+      that->curlReply,
+      "refLastMeasure");
+  char* nbFailed =
+    GetJSONValOfKey(
+      that->curlReply,
+      "nbFailed");
+  long nbFailedMeasure = 0;
+  bool isValidReply =
+    refLast != NULL && nbFailed != NULL &&
+    StrToLong(
+      refLast,
+      &(that->refLastAddedMeasure)) &&
+    StrToLong(
+      nbFailed,
+      &nbFailedMeasure);
+  free(refLast);
+  free(nbFailed);
+  if (isValidReply == false) Raise(RunRecorderExc_ApiRequestFailed);
+
+  // Return the number of failed measures
+  return nbFailedMeasure;
+
+}
+
+// Open a connection to a spool database, creating it if necessary
+// Inputs:
+//        that: the struct RunRecorder
+//   pathSpool: path of the spool database
+// Output:
+//   Return the connection
+// Raise:
+//   RunRecorderExc_SpoolFailed
+static sqlite3* OpenSpoolDb(
+  struct RunRecorder* const that,
+          char const* const pathSpool) {
+
+  // Open the connection, wait for the lock of the other connection
+  // instead of failing, and create the table of the spooled measures.
+  // The spool is written and read concurrently, so it uses the WAL mode
+  sqlite3* db = NULL;
+  int ret =
+    sqlite3_open(
+      pathSpool,
+      &db);
+  if (ret == SQLITE_OK)
+    ret =
+      sqlite3_busy_timeout(
+        db,
+        SPOOL_BUSY_TIMEOUT);
+  if (ret == SQLITE_OK)
+    ret =
+      sqlite3_exec(
+        db,
+        SQL_CREATE_SPOOL,
+        NULL,
+        NULL,
+        NULL);
+  if (ret != SQLITE_OK) {
+
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(db));
+    sqlite3_close(db);
+    Raise(RunRecorderExc_SpoolFailed);
+
+  }
+
+  // Return the connection
+  return db;
+
+}
+
+// Create the spool of a struct RunRecorder. The forwarder thread is not
+// started.
+// Inputs:
+//        that: the struct RunRecorder
+//   pathSpool: path of the spool database
+//        mode: the mode of the spool
+// Output:
+//   Return the new struct RunRecorderSpool
+// Raise:
+//   RunRecorderExc_SpoolFailed
+static struct RunRecorderSpool* RunRecorderSpoolCreate(
+        struct RunRecorder* const that,
+                char const* const pathSpool,
+  enum RunRecorderSpoolMode const mode) {
+
+  // Allocate the struct RunRecorderSpool
+  struct RunRecorderSpool* spool = NULL;
+  SafeRealloc(
+    spool,
+    sizeof(struct RunRecorderSpool));
+  spool->db = NULL;
+  spool->dbForwarder = NULL;
+  spool->insert = NULL;
+  spool->forwarder = NULL;
+  spool->mode = mode;
+  spool->nbPending = 0;
+  spool->backoff = 0;
+  spool->dateRetry = 0;
+  spool->nbRejection = 0;
+  spool->refRejected = 0;
+  spool->isStopping = false;
+  spool->isRunning = false;
+  pthread_mutex_init(
+    &(spool->lock),
+    NULL);
+  pthread_cond_init(
+    &(spool->condSpooled),
+    NULL);
+
+  Try {
+
+    // Open the connections to the spool database
+    spool->db =
+      OpenSpoolDb(
+        that,
+        pathSpool);
+    spool->dbForwarder =
+      OpenSpoolDb(
+        that,
+        pathSpool);
+
+    // Prepare the statement to add measures, and count the measures left
+    // by a previous spool
+    sqlite3_stmt* stmt = NULL;
+    int ret =
+      sqlite3_prepare_v2(
+        spool->db,
+        SQL_ADD_SPOOLED,
+        -1,
+        &(spool->insert),
+        NULL);
+    if (ret == SQLITE_OK)
+      ret =
+        sqlite3_prepare_v2(
+          spool->db,
+          SQL_GET_NB_SPOOLED,
+          -1,
+          &stmt,
+          NULL);
+    if (ret == SQLITE_OK) ret = sqlite3_step(stmt);
+    if (ret == SQLITE_ROW)
+      spool->nbPending =
+        (long)sqlite3_column_int64(
+          stmt,
+          0);
+    sqlite3_finalize(stmt);
+    if (ret != SQLITE_ROW) {
+
+      SafeStrDup(
+        that->errMsg,
+        sqlite3_errmsg(spool->db));
+      Raise(RunRecorderExc_SpoolFailed);
+
+    }
+
+    // Create the struct RunRecorder of the forwarder thread. Only its
+    // connection to the Web API is initialised, as RunRecorderInit
+    // would fail if the Web API can't be reached
+    spool->forwarder = RunRecorderAlloc(that->url);
+    InitWebAPI(spool->forwarder);
+    curl_easy_setopt(
+      spool->forwarder->curl,
+      CURLOPT_CONNECTTIMEOUT,
+      SPOOL_CONNECT_TIMEOUT);
+
+  } CatchDefault {
+
+    if (
+      spool->forwarder != NULL &&
+      spool->forwarder->errMsg != NULL)
+      SafeStrDup(
+        that->errMsg,
+        spool->forwarder->errMsg);
+    RunRecorderSpoolFree(&spool);
+    Raise(RunRecorderExc_SpoolFailed);
+
+  } EndCatch;
+
+  // Return the struct RunRecorderSpool
+  return spool;
+
+}
+
+// Free a struct RunRecorderSpool, stopping its forwarder thread if it is
+// running
+// Input:
+//   that: the struct RunRecorderSpool
+static void RunRecorderSpoolFree(
+  struct RunRecorderSpool** const that) {
+
+  // If it's already freed, nothing to do
+  if (that == NULL || *that == NULL) return;
+  struct RunRecorderSpool* spool = *that;
+
+  // If the forwarder thread is running, request it to end and wait for
+  // it. It ends after its current attempt to forward measures.
+  if (spool->isRunning == true) {
+
+    pthread_mutex_lock(&(spool->lock));
+    spool->isStopping = true;
+    pthread_cond_signal(&(spool->condSpooled));
+    pthread_mutex_unlock(&(spool->lock));
+    pthread_join(
+      spool->thread,
+      NULL);
+
+  }
+
+  // Free memory
+  RunRecorderFree(&(spool->forwarder));
+  sqlite3_finalize(spool->insert);
+  sqlite3_close(spool->db);
+  sqlite3_close(spool->dbForwarder);
+  pthread_mutex_destroy(&(spool->lock));
+  pthread_cond_destroy(&(spool->condSpooled));
+  free(spool);
+  *that = NULL;
+
+}
+
+// Add several measures to a project through the Web API and the spool of
+// a struct RunRecorder. In RunRecorderSpoolMode_always, or if measures
+// are still waiting in the spool (to keep the measures in order), the
+// measures are spooled, else they're sent to the Web API and spooled only
+// if it can't be reached.
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SpoolFailed
+static void AddMeasuresSpool(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure) {
+
+  // Check if the measures must be spooled without trying to send them
+  struct RunRecorderSpool* spool = that->spool;
+  pthread_mutex_lock(&(spool->lock));
+  bool isSpooled =
+    spool->mode == RunRecorderSpoolMode_always || spool->nbPending > 0;
+  pthread_mutex_unlock(&(spool->lock));
+
+  // Spool the measures, or send them. AddMeasuresAPI spools the ones it
+  // can't send
+  if (isSpooled == true) {
+
+    SpoolMeasures(
+      that,
+      project,
+      measures,
+      nbMeasure);
+
+  } else {
+
+    long const* const dates = NULL;
+    AddMeasuresAPI(
+      that,
+      project,
+      measures,
+      nbMeasure,
+      dates);
+
+  }
+
+}
+
+// Add several measures to the spool of a struct RunRecorder, in one
+// single transaction, and wake up the forwarder thread
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_SpoolFailed
+static void SpoolMeasures(
+                     struct RunRecorder* const that,
+                             char const* const project,
+  struct RunRecorderMeasure const* const* const measures,
+                                    long const nbMeasure) {
+
+  // Reset the reference of the last spooled measure
+  that->refLastSpooledMeasure = 0;
+
+  // The measures are dated when they're spooled
+  struct RunRecorderSpool* spool = that->spool;
+  long const date = GetDateMeasureNow();
+  sqlite3_stmt* stmt = spool->insert;
+  char* json = NULL;
+  int ret =
+    sqlite3_exec(
+      spool->db,
+      "BEGIN IMMEDIATE",
+      NULL,
+      NULL,
+      NULL);
+
+  // Loop on the measures
+  for (
+    long iMeasure = 0;
+    iMeasure < nbMeasure && ret == SQLITE_OK;
+    ++iMeasure) {
+
+    // Convert the measure to JSON, with its date
+    size_t length =
+      MeasureJSONLen(
+        measures[iMeasure],
+        date);
+    SafeRealloc(
+      json,
+      length + 1);
+    char* end =
+      MeasureJSONCpy(
+        json,
+        measures[iMeasure],
+        date);
+    *end = '\0';
+
+    // Add it to the spool
+    ret =
+      sqlite3_bind_text(
+        stmt,
+        1,
+        project,
+        -1,
+        SQLITE_STATIC);
+    if (ret == SQLITE_OK)
+      ret =
+        sqlite3_bind_text(
+          stmt,
+          2,
+          json,
+          -1,
+          SQLITE_STATIC);
+    if (ret == SQLITE_OK) ret = sqlite3_step(stmt);
+    if (ret == SQLITE_DONE) ret = SQLITE_OK;
+    sqlite3_reset(stmt);
+
+  }
+
+  free(json);
+
+  // Commit the measures, or cancel them all if one failed
+  if (ret == SQLITE_OK) {
+
+    that->refLastSpooledMeasure = (long)sqlite3_last_insert_rowid(spool->db);
+    ret =
+      sqlite3_exec(
+        spool->db,
+        "COMMIT",
+        NULL,
+        NULL,
+        NULL);
+
+  }
+
+  if (ret != SQLITE_OK) {
+
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(spool->db));
+    sqlite3_exec(
+      spool->db,
+      "ROLLBACK",
+      NULL,
+      NULL,
+      NULL);
+    that->refLastSpooledMeasure = 0;
+    Raise(RunRecorderExc_SpoolFailed);
+
+  }
+
+  // Wake up the forwarder thread
+  pthread_mutex_lock(&(spool->lock));
+  spool->nbPending += nbMeasure;
+  pthread_cond_signal(&(spool->condSpooled));
+  pthread_mutex_unlock(&(spool->lock));
+
+}
+
+// Main function of the forwarder thread of a struct RunRecorderSpool.
+// Forward the spooled measures to the Web API by batches, until the
+// spool is stopped. After a failure, wait SPOOL_BACKOFF_MIN seconds
+// before retrying, then twice longer after each new failure, up to
+// SPOOL_BACKOFF_MAX seconds.
+// Input:
+//   arg: the struct RunRecorderSpool
+// Output:
+//   Return NULL
+static void* SpoolForwarderMain(
+  void* arg) {
+
+  struct RunRecorderSpool* spool = arg;
+
+  pthread_mutex_lock(&(spool->lock));
+  while (spool->isStopping == false) {
+
+    // If there is no measure to forward, wait for new ones
+    if (spool->nbPending == 0) {
+
+      pthread_cond_wait(
+        &(spool->condSpooled),
+        &(spool->lock));
+
+    // Else, if the delay since the last failure has not elapsed, wait
+    // for its end
+    } else if (spool->backoff > 0 && time(NULL) < spool->dateRetry) {
+
+      struct timespec dateRetry = {.tv_sec = spool->dateRetry, .tv_nsec = 0};
+      pthread_cond_timedwait(
+        &(spool->condSpooled),
+        &(spool->lock),
+        &dateRetry);
+
+    // Else, forward a batch of measures without holding the lock, and
+    // update the delay before the next attempt according to the result
+    } else {
+
+      pthread_mutex_unlock(&(spool->lock));
+      bool isForwarded = ForwardSpooledMeasures(spool);
+      pthread_mutex_lock(&(spool->lock));
+      if (isForwarded == true) {
+
+        spool->backoff = 0;
+
+      } else {
+
+        spool->backoff *= 2;
+        if (spool->backoff < SPOOL_BACKOFF_MIN)
+          spool->backoff = SPOOL_BACKOFF_MIN;
+        if (spool->backoff > SPOOL_BACKOFF_MAX)
+          spool->backoff = SPOOL_BACKOFF_MAX;
+        spool->dateRetry = time(NULL) + spool->backoff;
+
+      }
+
+    }
+
+  }
+
+  pthread_mutex_unlock(&(spool->lock));
+  return NULL;
+
+}
+
+// Forward the oldest spooled measures of a same project to the Web API,
+// in one single request of at most SIZE_BATCH_ADD_MEASURES_API measures.
+// The forwarded measures are kept in the spool with their reference in
+// the Web API, to reconcile them, until they're older than the
+// SPOOL_NB_KEPT_REF last spooled measures. Measures rejected by the Web
+// API SPOOL_NB_MAX_REJECTION times in a row are given up.
+// Input:
+//   that: the struct RunRecorderSpool
+// Output:
+//   Return true if the measures have been forwarded (or given up), false
+//   if they must be retried later
+static bool ForwardSpooledMeasures(
+  struct RunRecorderSpool* const that) {
+
+  // Variables to memorise the batch of measures
+  long refs[SIZE_BATCH_ADD_MEASURES_API];
+  long nbMeasure = 0;
+  char* project = NULL;
+  char* json = NULL;
+  sqlite3_stmt* stmt = NULL;
+
+  // Variables to memorise the result
+  bool isForwarded = false;
+  bool isRejected = false;
+  long refLast = 0;
+
+  Try {
+
+    // Get the oldest spooled measures, up to the first one of another
+    // project, and concatenate them in a JSON array
+    size_t length = 1;
+    size_t capacity = 0;
+    int ret =
+      sqlite3_prepare_v2(
+        that->dbForwarder,
+        SQL_GET_SPOOLED,
+        -1,
+        &stmt,
+        NULL);
+    if (ret == SQLITE_OK)
+      ret =
+        sqlite3_bind_int(
+          stmt,
+          1,
+          SIZE_BATCH_ADD_MEASURES_API);
+    if (ret == SQLITE_OK) ret = sqlite3_step(stmt);
+    while (ret == SQLITE_ROW) {
+
+      char const* label =
+        (char const*)sqlite3_column_text(
+          stmt,
+          1);
+      if (project == NULL) {
+
+        SafeStrDup(
+          project,
+          label);
+
+      } else if (strcmp(project, label) != 0) break;
+
+      char const* measure =
+        (char const*)sqlite3_column_text(
+          stmt,
+          2);
+      size_t lengthMeasure = strlen(measure);
+      if (length + lengthMeasure + 2 > capacity) {
+
+        capacity = 2 * (length + lengthMeasure + 2);
+        SafeRealloc(
+          json,
+          capacity);
+
+      }
+
+      json[length - 1] = (nbMeasure == 0 ? '[' : ',');
+      memcpy(
+        json + length,
+        measure,
+        lengthMeasure);
+      length += lengthMeasure + 1;
+      refs[nbMeasure] =
+        (long)sqlite3_column_int64(
+          stmt,
+          0);
+      ++nbMeasure;
+      ret = sqlite3_step(stmt);
+
+    }
+
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+
+    // If the spool couldn't be read, retry later
+    if (ret != SQLITE_ROW && ret != SQLITE_DONE) {
+
+      isForwarded = false;
+
+    // Else, if there is no measure to forward, the number of pending
+    // measures was wrong
+    } else if (nbMeasure == 0) {
+
+      pthread_mutex_lock(&(that->lock));
+      that->nbPending = 0;
+      pthread_mutex_unlock(&(that->lock));
+      isForwarded = true;
+
+    } else {
+
+      json[length - 1] = ']';
+      json[length] = '\0';
+
+      // Send the measures. If the Web API replies with an error the
+      // measures are rejected, else the Web API can't be reached
+      Try {
+
+        SendMeasuresJSONAPI(
+          that->forwarder,
+          project,
+          json);
+        refLast = that->forwarder->refLastAddedMeasure;
+        isForwarded = true;
+
+      } Catch (RunRecorderExc_ApiRequestFailed) {
+
+        char* retCode =
+          GetJSONValOfKey(
+            that->forwarder->curlReply,
+            "ret");
+        isRejected = (retCode != NULL);
+        free(retCode);
+
+      } CatchDefault {
+
+      } EndCatch;
+
+    }
+
+  } CatchDefault {
+
+  } EndCatch;
+
+  sqlite3_finalize(stmt);
+  free(project);
+  free(json);
+
+  // If the measures have been rejected, give them up if it's not the
+  // first time in a row, else retry later
+  if (isRejected == true) {
+
+    pthread_mutex_lock(&(that->lock));
+    if (that->refRejected == refs[0]) {
+
+      ++(that->nbRejection);
+
+    } else {
+
+      that->refRejected = refs[0];
+      that->nbRejection = 1;
+
+    }
+
+    isForwarded = (that->nbRejection >= SPOOL_NB_MAX_REJECTION);
+    pthread_mutex_unlock(&(that->lock));
+
+  }
+
+  // If the measures have been forwarded or given up, update them in the
+  // spool. The Web API adds the measures of a request with consecutive
+  // references
+  if (isForwarded == true && nbMeasure > 0) {
+
+    int ret =
+      sqlite3_exec(
+        that->dbForwarder,
+        "BEGIN IMMEDIATE",
+        NULL,
+        NULL,
+        NULL);
+    if (ret == SQLITE_OK)
+      ret =
+        sqlite3_prepare_v2(
+          that->dbForwarder,
+          SQL_SET_SPOOLED_REF,
+          -1,
+          &stmt,
+          NULL);
+    for (
+      long iMeasure = 0;
+      iMeasure < nbMeasure && ret == SQLITE_OK;
+      ++iMeasure) {
+
+      long refAPI =
+        (isRejected == true ? -1 : refLast - nbMeasure + 1 + iMeasure);
+      ret =
+        sqlite3_bind_int64(
+          stmt,
+          1,
+          refAPI);
+      if (ret == SQLITE_OK)
+        ret =
+          sqlite3_bind_int64(
+            stmt,
+            2,
+            refs[iMeasure]);
+      if (ret == SQLITE_OK) ret = sqlite3_step(stmt);
+      if (ret == SQLITE_DONE) ret = SQLITE_OK;
+      sqlite3_reset(stmt);
+
+    }
+
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+
+    // Forget the oldest forwarded measures
+    if (ret == SQLITE_OK)
+      ret =
+        sqlite3_prepare_v2(
+          that->dbForwarder,
+          SQL_PURGE_SPOOL,
+          -1,
+          &stmt,
+          NULL);
+    if (ret == SQLITE_OK)
+      ret =
+        sqlite3_bind_int64(
+          stmt,
+          1,
+          SPOOL_NB_KEPT_REF);
+    if (ret == SQLITE_OK) ret = sqlite3_step(stmt);
+    if (ret == SQLITE_DONE) ret = SQLITE_OK;
+    sqlite3_finalize(stmt);
+    if (ret == SQLITE_OK)
+      ret =
+        sqlite3_exec(
+          that->dbForwarder,
+          "COMMIT",
+          NULL,
+          NULL,
+          NULL);
+
+    // If the spool couldn't be updated, the measures will be forwarded
+    // again
+    if (ret != SQLITE_OK) {
+
+      sqlite3_exec(
+        that->dbForwarder,
+        "ROLLBACK",
+        NULL,
+        NULL,
+        NULL);
+      isForwarded = false;
+
+    } else {
+
+      pthread_mutex_lock(&(that->lock));
+      that->nbPending -= nbMeasure;
+      pthread_mutex_unlock(&(that->lock));
+
+    }
+
+  }
+
+  // Return the result
+  return isForwarded;
+
+}
+
+// Create and initialise a new struct RunRecorder of a pool, the lock of
+// the pool must be held. The first one checks the database, and upgrades
+// it if necessary, the next ones only open their connection.
+// Input:
+//   that: the struct RunRecorderPool
+// Output:
+//   Return the new struct RunRecorder
+// Raise:
+//   the exceptions of RunRecorderInit
+static struct RunRecorder* PoolCreateRecorder(
+  struct RunRecorderPool* const that) {
+
+  // Make room for the new struct RunRecorder
+  if (that->nbRecorder == that->capacity) {
+
+    long capacity = that->capacity * 2;
+    SafeRealloc(
+      that->recorders,
+      sizeof(struct RunRecorder*) * capacity);
+    SafeRealloc(
+      that->idles,
+      sizeof(struct RunRecorder*) * capacity);
+    that->capacity = capacity;
+
+  }
+
+  // Create and initialise the struct RunRecorder
+  struct RunRecorder* recorder =
+    RunRecorderAllocWithOptions(
+      that->url,
+      &(that->options));
+  Try {
+
+    if (that->isInit == false) RunRecorderInit(recorder);
+    else InitConnection(recorder);
+
+  } CatchDefault {
+
+    RunRecorderFree(&recorder);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Add it to the pool
+  recorder->pool = that;
+  that->recorders[that->nbRecorder] = recorder;
+  ++(that->nbRecorder);
+  that->isInit = true;
+
+  // Return the new struct RunRecorder
+  return recorder;
+
+}
+
+// Give back a struct RunRecorder to the idle ones of its pool, called when
+// the thread using it ends or calls RunRecorderPoolRelease. An opened
+// session is rolled back.
+// Input:
+//   arg: the struct RunRecorder
+static void ReleaseToPool(
+  void* arg) {
+
+  // Shortcut to the struct RunRecorder
+  struct RunRecorder* const recorder = arg;
+
+  // Rollback the opened session, if any, to release the lock on the
+  // database. There is no transaction with the Web API, only the flag
+  // of the session is reset.
+  if (recorder->isInSession == true) {
+
+    if (recorder->db != NULL) {
+
+      Try {
+
+        RollbackSessionLocal(recorder);
+
+      } CatchDefault {
+
+        // Nothing more to do, the transaction is rolled back anyway when
+        // the connection is closed
+
+      } EndCatch;
+
+    }
+
+    recorder->isInSession = false;
+
+  }
+
+  // Add the struct RunRecorder to the idle ones. There is always room as
+  // the array of the idle ones has the size of the array of all of them.
+  struct RunRecorderPool* const pool = recorder->pool;
+  pthread_mutex_lock(&(pool->lock));
+  pool->idles[pool->nbIdle] = recorder;
+  ++(pool->nbIdle);
+  pthread_mutex_unlock(&(pool->lock));
+
+}
+
+// Begin a transaction in a local database
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_SessionFailed
+static void BeginSessionLocal(
+  struct RunRecorder* const that) {
+
+  // Execute the command to begin the transaction
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_begin);
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_DONE) Raise(RunRecorderExc_SessionFailed);
+
+}
+
+// Commit the current transaction in a local database, if the commit fails
+// the transaction is rolled back
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_SessionFailed
+static void CommitSessionLocal(
+  struct RunRecorder* const that) {
+
+  // Execute the command to commit the transaction
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_commit);
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+
+  // If the commit failed
+  if (retStep != SQLITE_DONE) {
+
+    // Rollback the transaction to avoid leaving it opened
+    // The error message of the commit is kept in that->errMsg
+    stmt =
+      GetStmt(
+        that,
+        RunRecorderStmt_rollback);
+    sqlite3_step(stmt);
+    Raise(RunRecorderExc_SessionFailed);
+
+  }
+
+}
+
+// Rollback the current transaction in a local database
+// Input:
+//   that: the struct RunRecorder
+static void RollbackSessionLocal(
+  struct RunRecorder* const that) {
+
+  // Execute the command to rollback the transaction, ignoring the
+  // eventual failure as there is nothing more to do in that case
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_rollback);
+  sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+
+}
+
+// Delete a measure in a local database
+// Inputs:
+//       that: the struct RunRecorder
+//    measure: the reference of the measure to delete
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+static void DeleteMeasureLocal(
+  struct RunRecorder* const that,
+                 long const refMeasure) {
+
+  // Get the project of the measure if it has a materialized table
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_getMaterializedOfMeasure);
+  BindStmtLong(
+    that,
+    stmt,
+    1,
+    refMeasure);
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_ROW && retStep != SQLITE_DONE)
+    Raise(RunRecorderExc_DeleteMeasureFailed);
+
+  // If the project of the measure has a materialized table
+  if (retStep == SQLITE_ROW) {
+
+    // Create the command to delete the measure from the materialized table
+    StringCreate(
+      &(that->cmd),
+      "DELETE FROM \"" MATERIALIZED_PREFIX "%s\" WHERE Ref = %ld",
+      (char const*)sqlite3_column_text(stmt, 0),
+      refMeasure);
+    sqlite3_reset(stmt);
+
+    // Execute the command
+    int retExec =
+      sqlite3_exec(
+        that->db,
+        that->cmd,
+        NULL,
+        NULL,
+        &(that->sqliteErrMsg));
+    if (retExec != SQLITE_OK) Raise(RunRecorderExc_DeleteMeasureFailed);
+
+  }
+
+  // Prepare the SQL command to delete the measure's values
+  stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_deleteValues);
+  BindStmtLong(
+    that,
+    stmt,
+    1,
+    refMeasure);
+
+  // Execute the command to delete the measure's values
+  retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_DONE) Raise(RunRecorderExc_DeleteMeasureFailed);
+
+  // Prepare the SQL command to delete the measure
+  stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_deleteMeasure);
+  BindStmtLong(
+    that,
+    stmt,
+    1,
+    refMeasure);
+
+  // Execute the command to delete the measure
+  retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_DONE) Raise(RunRecorderExc_DeleteMeasureFailed);
+
+  // The space freed by the deletion is reclaimed by RunRecorderCompact
+
+}
+
+// Delete a measure through the Web API
+// Inputs:
+//          that: the struct RunRecorder
+//    refMeasure: the reference of the measure to delete
+static void DeleteMeasureAPI(
+  struct RunRecorder* const that,
+                 long const refMeasure) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=delete_measure&measure=%ld",
+    refMeasure);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+}
+
+// Delete several measures in a local database, in one single transaction
+// if there is no opened session
+// Inputs:
+//          that: the struct RunRecorder
+//   refMeasures: the references of the measures to delete
+//     nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+static void DeleteMeasuresLocal(
+  struct RunRecorder* const that,
+           long const* const refMeasures,
+                 long const nbMeasure) {
+
+  // If there is no opened session, group the deletions in a transaction
+  // of their own, else they'll be committed with the session
+  bool const hasOwnTransaction = (that->isInSession == false);
+  if (hasOwnTransaction == true) BeginSessionLocal(that);
+
+  Try {
+
+    // Loop on the measures
+    ForZeroTo(iMeasure, nbMeasure)
+      DeleteMeasureLocal(
+        that,
+        refMeasures[iMeasure]);
+
+  } CatchDefault {
+
+    // Cancel all the deletions
+    if (hasOwnTransaction == true) RollbackSessionLocal(that);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Commit the transaction
+  if (hasOwnTransaction == true) CommitSessionLocal(that);
+
+}
+
+// Delete several measures through the Web API
+// Inputs:
+//          that: the struct RunRecorder
+//   refMeasures: the references of the measures to delete
+//     nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static void DeleteMeasuresAPI(
+  struct RunRecorder* const that,
+           long const* const refMeasures,
+                 long const nbMeasure) {
+
+  // Nothing to do if there is no measure
+  if (nbMeasure <= 0) return;
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=delete_measures&measures=%ld",
+    refMeasures[0]);
+  for (
+    long iMeasure = 1;
+    iMeasure < nbMeasure;
+    ++iMeasure)
+    StringAppend(
+      &(that->cmd),
+      ",%ld",
+      refMeasures[iMeasure]);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+}
+
+// Delete the measures whose reference is in [fromRef, toRef] in a local
+// database, in one single transaction if there is no opened session
+// Inputs:
+//      that: the struct RunRecorder
+//   fromRef: the first reference to delete
+//     toRef: the last reference to delete
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+static void DeleteMeasuresByRefLocal(
+  struct RunRecorder* const that,
+                 long const fromRef,
+                 long const toRef) {
+
+  // If there is no opened session, group the deletions in a transaction
+  // of their own, else they'll be committed with the session
+  bool const hasOwnTransaction = (that->isInSession == false);
+  if (hasOwnTransaction == true) BeginSessionLocal(that);
+
+  // Declare a variable to memorise the materialized projects
+  struct RunRecorderRefVal* projects = NULL;
+
+  Try {
+
+    // Delete the measures from the materialized tables
+    projects = GetMaterializedProjectsLocal(that);
+    ForZeroTo(iProject, projects->nb) {
+
+      StringCreate(
+        &(that->cmd),
+        "DELETE FROM \"" MATERIALIZED_PREFIX "%s\" "
+        "WHERE Ref BETWEEN %ld AND %ld",
+        projects->values[iProject],
+        fromRef,
+        toRef);
+      int retExec =
+        sqlite3_exec(
+          that->db,
+          that->cmd,
+          NULL,
+          NULL,
+          &(that->sqliteErrMsg));
+      if (retExec != SQLITE_OK) Raise(RunRecorderExc_DeleteMeasureFailed);
+
+    }
+
+    // Commands to delete the values and the measures
+    #define NB_DELETE_BY_REF_STMT 2
+    enum RunRecorderStmt const deleteStmts[NB_DELETE_BY_REF_STMT] = {
+
+      RunRecorderStmt_deleteValuesByRef,
+      RunRecorderStmt_deleteMeasuresByRef
+
+    };
+
+    // Loop on the commands
+    ForZeroTo(iStmt, NB_DELETE_BY_REF_STMT) {
+
+      // Prepare the command
+      sqlite3_stmt* stmt =
+        GetStmt(
+          that,
+          deleteStmts[iStmt]);
+      BindStmtLong(
+        that,
+        stmt,
+        1,
+        fromRef);
+      BindStmtLong(
+        that,
+        stmt,
+        2,
+        toRef);
+
+      // Execute the command
+      int retStep =
+        StepStmt(
+          that,
+          stmt);
+      if (retStep != SQLITE_DONE) Raise(RunRecorderExc_DeleteMeasureFailed);
+
+    }
+
+  } CatchDefault {
+
+    // Cancel all the deletions
+    PolyFree(&projects);
+    if (hasOwnTransaction == true) RollbackSessionLocal(that);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  PolyFree(&projects);
+
+  // Commit the transaction
+  if (hasOwnTransaction == true) CommitSessionLocal(that);
+
+}
+
+// Delete the measures whose reference is in [fromRef, toRef] through the
+// Web API
+// Inputs:
+//      that: the struct RunRecorder
+//   fromRef: the first reference to delete
+//     toRef: the last reference to delete
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static void DeleteMeasuresByRefAPI(
+  struct RunRecorder* const that,
+                 long const fromRef,
+                 long const toRef) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=delete_measures&from_ref=%ld&to_ref=%ld",
+    fromRef,
+    toRef);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+}
+
+// Delete the measures of a project recorded in [fromDate, toDate[ in a
+// local database, in one single transaction if there is no opened session
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+static void DeleteMeasuresByDateLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate) {
+
+  // Convert the dates to the format of _Measure.DateMeasure
+  long const fromDateMeasure = (long)fromDate * USEC_PER_SEC;
+  long const toDateMeasure = (long)toDate * USEC_PER_SEC;
+
+  // If there is no opened session, group the deletions in a transaction
+  // of their own, else they'll be committed with the session
+  bool const hasOwnTransaction = (that->isInSession == false);
+  if (hasOwnTransaction == true) BeginSessionLocal(that);
+
+  Try {
+
+    // If the project has a materialized table, delete the measures from
+    // it
+    bool isMaterialized =
+      IsMaterializedLocal(
+        that,
+        project);
+    if (isMaterialized == true) {
+
+      StringCreate(
+        &(that->cmd),
+        "DELETE FROM \"" MATERIALIZED_PREFIX "%s\" "
+        "WHERE DateMeasure >= %ld AND DateMeasure < %ld",
+        project,
+        fromDateMeasure,
+        toDateMeasure);
+      int retExec =
+        sqlite3_exec(
+          that->db,
+          that->cmd,
+          NULL,
+          NULL,
+          &(that->sqliteErrMsg));
+      if (retExec != SQLITE_OK) Raise(RunRecorderExc_DeleteMeasureFailed);
+
+    }
+
+    // Commands to delete the values and the measures
+    #define NB_DELETE_BY_DATE_STMT 2
+    enum RunRecorderStmt const deleteStmts[NB_DELETE_BY_DATE_STMT] = {
+
+      RunRecorderStmt_deleteValuesByDate,
+      RunRecorderStmt_deleteMeasuresByDate
+
+    };
+
+    // Loop on the commands
+    ForZeroTo(iStmt, NB_DELETE_BY_DATE_STMT) {
+
+      // Prepare the command
+      sqlite3_stmt* stmt =
+        GetStmt(
+          that,
+          deleteStmts[iStmt]);
+      BindStmtText(
+        that,
+        stmt,
+        1,
+        project);
+      BindStmtLong(
+        that,
+        stmt,
+        2,
+        fromDateMeasure);
+      BindStmtLong(
+        that,
+        stmt,
+        3,
+        toDateMeasure);
+
+      // Execute the command
+      int retStep =
+        StepStmt(
+          that,
+          stmt);
+      if (retStep != SQLITE_DONE) Raise(RunRecorderExc_DeleteMeasureFailed);
+
+    }
+
+  } CatchDefault {
+
+    // Cancel all the deletions
+    if (hasOwnTransaction == true) RollbackSessionLocal(that);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Commit the transaction
+  if (hasOwnTransaction == true) CommitSessionLocal(that);
+
+}
+
+// Delete the measures of a project recorded in [fromDate, toDate[ through
+// the Web API
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static void DeleteMeasuresByDateAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=delete_measures&project=%s&from_date=%lld&to_date=%lld",
+    project,
+    (long long)fromDate,
+    (long long)toDate);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+}
+
+// Set the retention policy of a project in a local database
+// Inputs:
+//           that: the struct RunRecorder
+//        project: the project's name
+//         maxAge: the maximum age of the measures in seconds, 0 for no
+//                 limit
+//   maxNbMeasure: the maximum number of measures, 0 for no limit
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+//   RunRecorderExc_RetentionFailed
+static void SetRetentionLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const maxAge,
+                 long const maxNbMeasure) {
+
+  // Prepare the command
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_setRetention);
+  BindStmtLong(
+    that,
+    stmt,
+    1,
+    (maxAge > 0 ? maxAge : 0));
+  BindStmtLong(
+    that,
+    stmt,
+    2,
+    (maxNbMeasure > 0 ? maxNbMeasure : 0));
+  BindStmtText(
+    that,
+    stmt,
+    3,
+    project);
+
+  // Execute the command
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_DONE) Raise(RunRecorderExc_RetentionFailed);
+
+  // If no project was updated, the project doesn't exist
+  if (sqlite3_changes(that->db) == 0) {
+
+    StringCreate(
+      &(that->errMsg),
+      "The project %s doesn't exist.",
+      project);
+    Raise(RunRecorderExc_InvalidProjectName);
+
+  }
+
+}
+
+// Set the retention policy of a project through the Web API
+// Inputs:
+//           that: the struct RunRecorder
+//        project: the project's name
+//         maxAge: the maximum age of the measures in seconds, 0 for no
+//                 limit
+//   maxNbMeasure: the maximum number of measures, 0 for no limit
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static void SetRetentionAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const maxAge,
+                 long const maxNbMeasure) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=set_retention&project=%s&max_age=%ld&max_nb_measure=%ld",
+    project,
+    maxAge,
+    maxNbMeasure);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+}
+
+// Apply the retention policy of a project in a local database
+// Inputs:
+//         that: the struct RunRecorder
+//   refProject: the reference of the project
+// Output:
+//   Return the number of deleted measures
+// Raise:
+//   RunRecorderExc_RetentionFailed
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+static long ApplyRetentionProjectLocal(
+  struct RunRecorder* const that,
+                 long const refProject) {
+
+  // Get the retention policy of the project
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_getRetention);
+  BindStmtLong(
+    that,
+    stmt,
+    1,
+    refProject);
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_ROW) Raise(RunRecorderExc_RetentionFailed);
+  long const maxAge = sqlite3_column_int64(stmt, 0);
+  long const maxNbMeasure = sqlite3_column_int64(stmt, 1);
+  sqlite3_reset(stmt);
+
+  // The expired measures are the ones before the cutoff (date, ref) in
+  // the order of the measures, (DateMeasure, Ref). Start with a date
+  // before any date.
+  long cutoffDate = -1;
+  long cutoffRef = 0;
+
+  // If there is a maximum age, the measures before its date are expired
+  if (maxAge > 0) cutoffDate = GetDateMeasureNow() - maxAge * USEC_PER_SEC;
+
+  // If there is a maximum number of measures, get the most recent
+  // measure beyond that number, it and the measures before it are expired
+  if (maxNbMeasure > 0) {
+
+    stmt =
+      GetStmt(
+        that,
+        RunRecorderStmt_getNthLastMeasure);
+    BindStmtLong(
+      that,
+      stmt,
+      1,
+      refProject);
+    BindStmtLong(
+      that,
+      stmt,
+      2,
+      maxNbMeasure);
+    retStep =
+      StepStmt(
+        that,
+        stmt);
+    if (retStep != SQLITE_ROW && retStep != SQLITE_DONE)
+      Raise(RunRecorderExc_RetentionFailed);
+
+    // If there is such a measure and it's after the cutoff of the
+    // maximum age, it becomes the cutoff
+    if (retStep == SQLITE_ROW) {
+
+      long const date = sqlite3_column_int64(stmt, 0);
+      long const ref = sqlite3_column_int64(stmt, 1);
+      if (date > cutoffDate || (date == cutoffDate && ref > cutoffRef)) {
+
+        cutoffDate = date;
+        cutoffRef = ref;
+
+      }
+
+    }
+    sqlite3_reset(stmt);
+
+  }
+
+  // Variable to memorise the number of deleted measures
+  long nbDeleted = 0;
+
+  // Loop on the batches of expired measures
+  long refMeasures[SIZE_BATCH_RETENTION];
+  long nbMeasure = SIZE_BATCH_RETENTION;
+  while (nbMeasure == SIZE_BATCH_RETENTION) {
+
+    // Get the next batch of expired measures
+    stmt =
+      GetStmt(
+        that,
+        RunRecorderStmt_getExpiredMeasures);
+    BindStmtLong(
+      that,
+      stmt,
+      1,
+      refProject);
+    BindStmtLong(
+      that,
+      stmt,
+      2,
+      cutoffDate);
+    BindStmtLong(
+      that,
+      stmt,
+      3,
+      cutoffRef);
+    BindStmtLong(
+      that,
+      stmt,
+      4,
+      SIZE_BATCH_RETENTION);
+    nbMeasure = 0;
+    retStep =
+      StepStmt(
+        that,
+        stmt);
+    while (retStep == SQLITE_ROW) {
+
+      refMeasures[nbMeasure] = sqlite3_column_int64(stmt, 0);
+      ++nbMeasure;
+      retStep =
+        StepStmt(
+          that,
+          stmt);
+
+    }
+    if (retStep != SQLITE_DONE) Raise(RunRecorderExc_RetentionFailed);
+
+    // Delete the batch in one single transaction
+    DeleteMeasuresLocal(
+      that,
+      refMeasures,
+      nbMeasure);
+    nbDeleted += nbMeasure;
+
+  }
+
+  // Return the number of deleted measures
+  return nbDeleted;
+
+}
+
+// Apply the retention policy of all the projects in a local database
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the number of deleted measures
+// Raise:
+//   RunRecorderExc_RetentionFailed
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+static long ApplyRetentionLocal(
+  struct RunRecorder* const that) {
+
+  // Get the projects having a retention policy
+  struct RunRecorderRefVal* projects =
+    GetProjectsOfStmtLocal(
+      that,
+      RunRecorderStmt_getRetentionProjects);
+
+  // Variable to memorise the number of deleted measures
+  long nbDeleted = 0;
+
+  Try {
+
+    // Loop on the projects and apply their retention policy
+    ForZeroTo(iProject, projects->nb)
+      nbDeleted +=
+        ApplyRetentionProjectLocal(
+          that,
+          projects->refs[iProject]);
+
+  } CatchDefault {
+
+    PolyFree(&projects);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  PolyFree(&projects);
+
+  // Return the number of deleted measures
+  return nbDeleted;
+
+}
+
+// Apply the retention policy of all the projects through the Web API
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the number of deleted measures
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static long ApplyRetentionAPI(
+  struct RunRecorder* const that) {
+
+  // Send the request to the API
+  SetAPIReqPostVal(
+    that,
+    "action=apply_retention");
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+  // Extract the number of deleted measures from the JSON reply
+  char* nbDeletedStr =
+    GetJSONValOfKey(
+      that->curlReply,
+      "nbDeleted");
+  long nbDeleted = 0;
+  if (nbDeletedStr != NULL) {
+
+    nbDeleted =
+      strtol(
+        nbDeletedStr,
+        NULL,
+        10);
+    free(nbDeletedStr);
+
+  }
+
+  // Return the number of deleted measures
+  return nbDeleted;
+
+}
+
+// Execute the SQL command in that->cmd on a local database and get the
+// returned rows as a struct RunRecorderMeasures. The numeric values are
+// memorised in their native type in addition to their string.
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the measures as a struct RunRecorderMeasures
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderMeasures* GetMeasuresOfCmdLocal(
+  struct RunRecorder* const that) {
+
+  // Prepare the request
+  sqlite3_stmt* stmt = NULL;
+  int retPrepare =
+    sqlite3_prepare_v2(
+      that->db,
       that->cmd,
+      -1,
+      &stmt,
+      NULL);
+  if (retPrepare != SQLITE_OK) {
+
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(that->db));
+    Raise(RunRecorderExc_SQLRequestFailed);
+
+  }
+
+  // Declare the struct RunRecorderMeasures to memorise the measures
+  struct RunRecorderMeasures* measures = NULL;
+  Try {
+
+    // Allocate memory for the measures
+    measures = RunRecorderMeasuresCreate();
+
+    // Copy the metrics label
+    measures->nbMetric = sqlite3_column_count(stmt);
+    SafeMalloc(
+      measures->metrics,
+      sizeof(char*) * measures->nbMetric);
+    ForZeroTo(iMetric, measures->nbMetric)
+      measures->metrics[iMetric] =
+        ArenaStrDup(
+          &(measures->arena),
+          sqlite3_column_name(
+            stmt,
+            iMetric));
+
+    // Execute the request and loop on the returned rows
+    int retStep =
+      StepStmt(
+        that,
+        stmt);
+    while (retStep == SQLITE_ROW) {
+
+      // Add a measure, the memory grows geometrically
+      char** values = MeasuresAddRow(measures);
+      long iCell = (measures->nbMeasure - 1) * measures->nbMetric;
+
+      // For each metric
+      ForZeroTo(iMetric, measures->nbMetric) {
+
+        // Memorise the numeric value if the column is numeric, before
+        // the conversion to a string
+        int type =
+          sqlite3_column_type(
+            stmt,
+            iMetric);
+        if (type == SQLITE_INTEGER) {
+
+          measures->types[iCell + iMetric] = RunRecorderMetricType_int;
+          measures->nums[iCell + iMetric].i =
+            sqlite3_column_int64(
+              stmt,
+              iMetric);
+
+        } else if (type == SQLITE_FLOAT) {
+
+          measures->types[iCell + iMetric] = RunRecorderMetricType_double;
+          measures->nums[iCell + iMetric].d =
+            sqlite3_column_double(
+              stmt,
+              iMetric);
+
+        }
+
+        // Copy the value as a string
+        values[iMetric] =
+          ArenaStrDup(
+            &(measures->arena),
+            (char const*)sqlite3_column_text(
+              stmt,
+              iMetric));
+
+      }
+
+      // Move to the next row
+      retStep =
+        StepStmt(
+          that,
+          stmt);
+
+    }
+    if (retStep != SQLITE_DONE) Raise(RunRecorderExc_SQLRequestFailed);
+
+  } CatchDefault {
+
+    sqlite3_finalize(stmt);
+    PolyFree(&measures);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Release the request
+  sqlite3_finalize(stmt);
+
+  // Return the measures
+  return measures;
+
+}
+
+
+// Helper function to commonalize code between GetMeasures and
+// GetLastMeasures
+// Inputs:
+//        that: the struct RunRecorder
+//     project: the project's name
+//   nbMeasure: the number of measures returned, if 0 all measures are
+//              returned
+// Output:
+//   Set the SQL command in that->cmd to get measures as a struct
+//    RunRecorderMeasures
+static void SetCmdToGetMeasuresLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const nbMeasure) {
+
+  // Get the list of metrics for the project
+  struct RunRecorderRefValDef* metrics =
+    RunRecorderGetMetrics(
+      that,
+      project);
+
+  Try {
+
+    // Create the command
+    SetCmdToGetMeasuresOfMetricsLocal(
+      that,
+      project,
+      metrics,
+      nbMeasure);
+
+  } CatchDefault {
+
+    PolyFree(&metrics);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  PolyFree(&metrics);
+
+}
+
+// Set the SQL command in that->cmd to get the measures of a project
+// given its metrics
+// Inputs:
+//        that: the struct RunRecorder
+//     project: the project's name
+//     metrics: the metrics of the project
+//   nbMeasure: the number of measures returned, if 0 all measures are
+//              returned
+static void SetCmdToGetMeasuresOfMetricsLocal(
+                struct RunRecorder* const that,
+                        char const* const project,
+  struct RunRecorderRefValDef const* const metrics,
+                               long const nbMeasure) {
+
+  // Create the head of the command, the reference and date of the
+  // measures come first
+  StringCreate(
+    &(that->cmd),
+    "SELECT Ref,DateMeasure");
+
+  // For each metric, append the metric label to the command
+  ForZeroTo(iMetric, metrics->nb)
+    StringAppend(
+      &(that->cmd),
+      ",\"%s\"",
+      metrics->values[iMetric]);
+
+  // Append the tail of the command
+  StringAppend(
+    &(that->cmd),
+    " FROM \"%s\"",
+    project);
+
+  // If there is a limit on the number of measures to be returned
+  if (nbMeasure > 0) {
+
+    // Append the limit at the end of the command
+    StringAppend(
+      &(that->cmd),
+      " ORDER BY Ref DESC LIMIT %ld",
+      nbMeasure);
+
+  }
+
+}
+
+// Restrict the SQL command in that->cmd, created by
+// SetCmdToGetMeasuresLocal with no limit, to a period of time
+// Inputs:
+//       that: the struct RunRecorder
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+static void AppendCmdInRangeLocal(
+  struct RunRecorder* const that,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit) {
+
+  // Restrict the request to the period, the measures are read in the
+  // order of the index on their date
+  StringAppend(
+    &(that->cmd),
+    " WHERE DateMeasure >= %ld AND DateMeasure < %ld "
+    "ORDER BY DateMeasure, Ref",
+    (long)fromDate * USEC_PER_SEC,
+    (long)toDate * USEC_PER_SEC);
+
+  // If there is a limit on the number of measures to be returned
+  if (limit > 0)
+    StringAppend(
+      &(that->cmd),
+      " LIMIT %ld",
+      limit);
+
+}
+
+// Get the measures of a project from a local database
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project's name
+// Output:
+//   Return the measures as a struct RunRecorderMeasures
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderMeasures* GetMeasuresLocal(
+  struct RunRecorder* const that,
+          char const* const project) {
+
+  // Declare the struct RunRecorderMeasures to memorise the measures
+  struct RunRecorderMeasures* measures = NULL;
+
+  // Create the request with no limit on the number of returned measures
+  long nbMeasure = 0;
+  SetCmdToGetMeasuresLocal(
+    that,
+    project,
+    nbMeasure);
+
+  // Execute the request
+  measures = GetMeasuresOfCmdLocal(that);
+
+  // Return the measures
+  return measures;
+
+}
+
+// Convert CSV data to a new struct RunRecorderMeasures. The CSV data are
+// expected to be formatted as:
+// Ref&Metric1&Metric2&...
+// Ref1&Value1_1&Value1_2&...
+// Ref2&Value2_1&Value2_2&...
+// ...
+// Inputs:
+//   csv: the CSV data
+//   sep: the separator between columns ('&' in the example above)
+// Output:
+//   Return a newly allocated RunRecorderMeasures
+static struct RunRecorderMeasures* CSVToData(
+  char const* const csv,
+         char const sep) {
+
+  // Allocate memory for the result struct RunRecorderMeasures
+  struct RunRecorderMeasures* measures = RunRecorderMeasuresCreate();
+  Try {
+
+    // Copy the CSV data in the arena of the measures, the labels and
+    // values are split in place and point into this copy
+    size_t len = strlen(csv) + 1;
+    char* row =
+      ArenaAlloc(
+        &(measures->arena),
+        len);
+    memcpy(
+      row,
+      csv,
+      len);
+
+    // Extract the metrics label from the first row
+    char* endRow =
+      strchr(
+        row,
+        '\n');
+    if (endRow != NULL) *endRow = '\0';
+    measures->nbMetric =
+      SplitCSVRowInPlace(
+        row,
+        NULL,
+        0,
+        sep);
+    SafeMalloc(
+      measures->metrics,
+      sizeof(char*) * measures->nbMetric);
+    SplitCSVRowInPlace(
+      row,
+      measures->metrics,
+      measures->nbMetric,
+      sep);
+
+    // Calculate the number of measures by counting the number of line
+    // return in the remaining rows, and allocate memory for all of them
+    // at once
+    long nbMeasure = 0;
+    row = (endRow != NULL ? endRow + 1 : row + len - 1);
+    for (
+      char const* ptr = row;
+      *ptr != '\0';
+      ++ptr) if (*ptr == '\n') ++nbMeasure;
+    MeasuresReserve(
+      measures,
+      nbMeasure);
+
+    // Extract the measures
+    ForZeroTo(iMeasure, nbMeasure) {
+
+      endRow =
+        strchr(
+          row,
+          '\n');
+      *endRow = '\0';
+      char** values = MeasuresAddRow(measures);
+      long nbCol =
+        SplitCSVRowInPlace(
+          row,
+          values,
+          measures->nbMetric,
+          sep);
+
+      // If the row is missing values, set them to NULL
+      for (
+        long iMetric = nbCol;
+        iMetric < measures->nbMetric;
+        ++iMetric) values[iMetric] = NULL;
+      row = endRow + 1;
+
+    }
+
+  } CatchDefault {
+
+    PolyFree(&measures);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Return the result struct RunRecorderMeasures
+  return measures;
+
+}
+
+// Get the measures of a project through the Web API
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project's name
+// Output:
+//   Return the measures as a struct RunRecorderMeasures
+static struct RunRecorderMeasures* GetMeasuresAPI(
+  struct RunRecorder* const that,
+          char const* const project) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=csv&project=%s",
+    project);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = false;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+  // Convert the CSV data into a struct RunRecorderMeasures
+  struct RunRecorderMeasures* data =
+    CSVToData(
+      that->curlReply,
+      CSV_SEP);
+
+  // Return the struct RunRecorderMeasures
+  return data;
+
+}
+
+// Get the most recent measures of a project from a local database
+// Inputs:
+//        that: the struct RunRecorder
+//     project: the project's name
+//   nbMeasure: the number of measures to be returned
+// Output:
+//   Return the measures as a struct RunRecorderMeasures, ordered from the
+//   most recent to the oldest
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderMeasures* GetLastMeasuresLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const nbMeasure) {
+
+  // Declate the struct RunRecorderMeasures to memorise the measures
+  struct RunRecorderMeasures* measures = NULL;
+
+  // Create the request with the requested limit
+  SetCmdToGetMeasuresLocal(
+    that,
+    project,
+    nbMeasure);
+
+  // Execute the request
+  measures = GetMeasuresOfCmdLocal(that);
+
+  // Return the measures
+  return measures;
+
+}
+
+// Get the most recent measures of a project through the Web API
+// Inputs:
+//        that: the struct RunRecorder
+//     project: the project's name
+//   nbMeasure: the number of measures to be returned
+// Output:
+//   Return the measures as a struct RunRecorderMeasures, ordered from the
+//   most recent to the oldest
+static struct RunRecorderMeasures* GetLastMeasuresAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const nbMeasure) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=csv&project=%s&last=%ld",
+    project,
+    nbMeasure);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = false;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+  // Convert the CSV data into a struct RunRecorderMeasures
+  struct RunRecorderMeasures* data =
+    CSVToData(
+      that->curlReply,
+      CSV_SEP);
+
+  // Return the struct RunRecorderMeasures
+  return data;
+
+}
+
+// Get the measures of a project in a period of time from a local
+// database
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a struct RunRecorderMeasures, ordered from the
+//   oldest to the most recent
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderMeasures* GetMeasuresInRangeLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit) {
+
+  // Declare the struct RunRecorderMeasures to memorise the measures
+  struct RunRecorderMeasures* measures = NULL;
+
+  // Create the request with no limit on the number of returned measures
+  long nbMeasure = 0;
+  SetCmdToGetMeasuresLocal(
+    that,
+    project,
+    nbMeasure);
+
+  // Restrict the request to the period
+  AppendCmdInRangeLocal(
+    that,
+    fromDate,
+    toDate,
+    limit);
+
+  // Execute the request
+  measures = GetMeasuresOfCmdLocal(that);
+
+  // Return the measures
+  return measures;
+
+}
+
+// Get the measures of a project in a period of time through the Web API
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a struct RunRecorderMeasures, ordered from the
+//   oldest to the most recent
+static struct RunRecorderMeasures* GetMeasuresInRangeAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=csv&project=%s&from=%ld&to=%ld&limit=%ld",
+    project,
+    (long)fromDate,
+    (long)toDate,
+    limit);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = false;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+  // Convert the CSV data into a struct RunRecorderMeasures
+  struct RunRecorderMeasures* data =
+    CSVToData(
+      that->curlReply,
+      CSV_SEP);
+
+  // Return the struct RunRecorderMeasures
+  return data;
+
+}
+
+// Get the measures of a project added after a given measure from a
+// local database
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   refSince: the reference of the last measure already read
+// Output:
+//   Return the measures as a struct RunRecorderMeasures, ordered by
+//   reference
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderMeasures* GetMeasuresSinceLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const refSince) {
+
+  // Create the request with no limit on the number of returned measures
+  long nbMeasure = 0;
+  SetCmdToGetMeasuresLocal(
+    that,
+    project,
+    nbMeasure);
+
+  // Restrict the request to the new measures, they are found through the
+  // primary key of the measures
+  StringAppend(
+    &(that->cmd),
+    " WHERE Ref > %ld ORDER BY Ref",
+    refSince);
+
+  // Execute the request and return the measures
+  return GetMeasuresOfCmdLocal(that);
+
+}
+
+// Get the measures of a project added after a given measure through the
+// Web API
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   refSince: the reference of the last measure already read
+// Output:
+//   Return the measures as a struct RunRecorderMeasures, ordered by
+//   reference
+static struct RunRecorderMeasures* GetMeasuresSinceAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const refSince) {
+
+  // Create the request to the Web API
+  StringCreate(
+    &(that->cmd),
+    "action=csv&project=%s&since=%ld",
+    project,
+    refSince);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
+
+  // Send the request to the API
+  bool isJsonReq = false;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+  // Convert the CSV data into a struct RunRecorderMeasures
+  struct RunRecorderMeasures* data =
+    CSVToData(
+      that->curlReply,
+      CSV_SEP);
+
+  // Return the struct RunRecorderMeasures
+  return data;
+
+}
+
+// Split a row of CSV data in place, replacing the separators with '\0'
+// Inputs:
+//     row: the row, without its line return
+//     tgt: the array where to memorise the pointers to the columns, or
+//          NULL to only count the columns (the row is then unchanged)
+//   nbCol: the size of tgt
+//     sep: the separator between columns
+// Output:
+//   Return the number of columns in the row
+static long SplitCSVRowInPlace(
+  char* const row,
+  char** const tgt,
+   long const nbCol,
+   char const sep) {
+
+  // Loop on the columns
+  long iCol = 0;
+  char* ptr = row;
+  while (true) {
+
+    // Memorise the start of the column
+    if (tgt != NULL && iCol < nbCol) tgt[iCol] = ptr;
+    ++iCol;
+
+    // Search the end of the column, if there is none it was the last one
+    ptr =
+      strchr(
+        ptr,
+        sep);
+    if (ptr == NULL) return iCol;
+
+    // Terminate the column and move to the next one
+    if (tgt != NULL) *ptr = '\0';
+    ++ptr;
+
+  }
+
+}
+
+// Callback to memorise the incoming data from the Web API for a cursor.
+// The transfer is paused while the buffer contains a row not read yet,
+// so the buffer never holds more than one row and one chunk of data.
+// Input:
+//    data: incoming data
+//    size: always 1
+//   nmemb: number of incoming byte
+//     ptr: the struct RunRecorderMeasuresCursor
+// Output:
+//   Return the number of received byte, CURL_WRITEFUNC_PAUSE to pause
+//   the transfer, or 0 to abort it if the memory allocation failed
+static size_t GetReplyCursorAPI(
+   char* data,
+  size_t size,
+  size_t nmemb,
+   void* ptr) {
+
+  // Cast the cursor
+  struct RunRecorderMeasuresCursor* that =
+    (struct RunRecorderMeasuresCursor*)ptr;
+
+  // Get the size in byte of the received data
+  size_t dataSize = size * nmemb;
+
+  // If the buffer contains a complete row not read yet, pause the
+  // transfer, the data will be delivered again when it's resumed
+  size_t lenUnread = that->lenBuffer - that->posBuffer;
+  if (lenUnread > 0 &&
+      memchr(that->buffer + that->posBuffer, '\n', lenUnread) != NULL) {
+
+    that->isPaused = true;
+    return CURL_WRITEFUNC_PAUSE;
+
+  }
+
+  // Move the data not read yet at the beginning of the buffer
+  if (that->posBuffer > 0) {
+
+    memmove(
+      that->buffer,
+      that->buffer + that->posBuffer,
+      lenUnread);
+    that->lenBuffer = lenUnread;
+    that->posBuffer = 0;
+
+  }
+
+  Try {
+
+    // If the buffer is too small for the incoming data and the
+    // terminating '\0', enlarge it
+    size_t sizeRequired = that->lenBuffer + dataSize + 1;
+    if (sizeRequired > that->sizeBuffer) {
+
+      if (sizeRequired < 2 * that->sizeBuffer)
+        sizeRequired = 2 * that->sizeBuffer;
+      SafeRealloc(
+        that->buffer,
+        sizeRequired);
+      that->sizeBuffer = sizeRequired;
+
+    }
+
+  } CatchDefault {
+
+    return 0;
+
+  } EndCatch;
+
+  // Copy the incoming data at the end of the buffer
+  memcpy(
+    that->buffer + that->lenBuffer,
+    data,
+    dataSize);
+  that->lenBuffer += dataSize;
+  that->buffer[that->lenBuffer] = '\0';
+
+  // Return the number of byte received
+  return dataSize;
+
+}
+
+// Receive data from the Web API for a cursor until its buffer contains
+// a complete row not read yet, or the transfer is completed
+// Input:
+//   that: the struct RunRecorderMeasuresCursor
+// Output:
+//   Return a pointer to the line return at the end of the row in the
+//   buffer, or NULL if there is no more row
+// Raise:
+//   RunRecorderExc_CurlRequestFailed
+static char* FillCursorBufferAPI(
+  struct RunRecorderMeasuresCursor* const that) {
+
+  // Shortcut to the struct RunRecorder
+  struct RunRecorder* const recorder = that->recorder;
+
+  // Loop until there is a complete row or the transfer is completed
+  bool isWaitNeeded = false;
+  while (true) {
+
+    // If the buffer contains a complete row, or there is no more data,
+    // return the end of the row
+    char* endRow = NULL;
+    size_t lenUnread = that->lenBuffer - that->posBuffer;
+    if (lenUnread > 0)
+      endRow =
+        memchr(
+          that->buffer + that->posBuffer,
+          '\n',
+          lenUnread);
+    if (endRow != NULL || that->isTransferDone == true) return endRow;
+
+    // If the transfer is paused, resume it
+    if (that->isPaused == true) {
+
+      that->isPaused = false;
+      CURLcode res =
+        curl_easy_pause(
+          recorder->curl,
+          CURLPAUSE_CONT);
+      if (res != CURLE_OK) {
+
+        SafeStrDup(
+          recorder->errMsg,
+          curl_easy_strerror(res));
+        Raise(RunRecorderExc_CurlRequestFailed);
+
+      }
+
+    }
+
+    // Wait for incoming data if the previous run of the transfer didn't
+    // complete the row, then run the transfer
+    int nbRunning = 0;
+    CURLMcode resMulti = CURLM_OK;
+    if (isWaitNeeded == true)
+      resMulti =
+        curl_multi_poll(
+          that->curlMulti,
+          NULL,
+          0,
+          1000,
+          NULL);
+    if (resMulti == CURLM_OK)
+      resMulti =
+        curl_multi_perform(
+          that->curlMulti,
+          &nbRunning);
+    if (resMulti != CURLM_OK) {
+
+      SafeStrDup(
+        recorder->errMsg,
+        curl_multi_strerror(resMulti));
+      Raise(RunRecorderExc_CurlRequestFailed);
+
+    }
+    isWaitNeeded = true;
+
+    // If the transfer is completed, check its result
+    if (nbRunning == 0) {
+
+      that->isTransferDone = true;
+      int nbMsg = 0;
+      CURLMsg* msg =
+        curl_multi_info_read(
+          that->curlMulti,
+          &nbMsg);
+      if (msg != NULL && msg->msg == CURLMSG_DONE &&
+          msg->data.result != CURLE_OK) {
+
+        SafeStrDup(
+          recorder->errMsg,
+          curl_easy_strerror(msg->data.result));
+        Raise(RunRecorderExc_CurlRequestFailed);
+
+      }
+
+    }
+
+  }
+
+}
+
+// Open a cursor on the measures of a project in a local database
+// Inputs:
+//      that: the struct RunRecorderMeasuresCursor
+//   project: the project's name
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static void OpenCursorLocal(
+  struct RunRecorderMeasuresCursor* const that,
+                        char const* const project) {
+
+  // Shortcut to the struct RunRecorder
+  struct RunRecorder* const recorder = that->recorder;
+
+  // Create the request with no limit on the number of returned measures
+  long nbMeasure = 0;
+  SetCmdToGetMeasuresLocal(
+    recorder,
+    project,
+    nbMeasure);
+
+  // Prepare the request, it's stepped by RunRecorderMeasuresCursorNext
+  int retPrepare =
+    sqlite3_prepare_v2(
+      recorder->db,
+      recorder->cmd,
+      -1,
+      &(that->stmt),
+      NULL);
+  if (retPrepare != SQLITE_OK) {
+
+    SafeStrDup(
+      recorder->errMsg,
+      sqlite3_errmsg(recorder->db));
+    Raise(RunRecorderExc_SQLRequestFailed);
+
+  }
+
+  // Copy the metrics label
+  that->nbMetric = sqlite3_column_count(that->stmt);
+  SafeMalloc(
+    that->metrics,
+    sizeof(char*) * that->nbMetric);
+  ForZeroTo(iMetric, that->nbMetric) that->metrics[iMetric] = NULL;
+  ForZeroTo(iMetric, that->nbMetric)
+    SafeStrDup(
+      that->metrics[iMetric],
+      sqlite3_column_name(
+        that->stmt,
+        iMetric));
+
+  // Allocate memory for the values
+  SafeMalloc(
+    that->values,
+    sizeof(char const*) * that->nbMetric);
+  ForZeroTo(iMetric, that->nbMetric) that->values[iMetric] = NULL;
+
+}
+
+// Open a cursor on the measures of a project through the Web API. The
+// CSV reply of the Web API is received and parsed as the measures are
+// read.
+// Inputs:
+//      that: the struct RunRecorderMeasuresCursor
+//   project: the project's name
+// Raise:
+//   RunRecorderExc_CreateCurlFailed
+//   RunRecorderExc_CurlSetOptFailed
+//   RunRecorderExc_CurlRequestFailed
+//   RunRecorderExc_ApiRequestFailed
+static void OpenCursorAPI(
+  struct RunRecorderMeasuresCursor* const that,
+                        char const* const project) {
+
+  // Shortcut to the struct RunRecorder
+  struct RunRecorder* const recorder = that->recorder;
+
+  // Create the request to the Web API. The request is copied by Curl as
+  // that->cmd may be reused before the end of the transfer.
+  StringCreate(
+    &(recorder->cmd),
+    "action=csv&project=%s",
+    project);
+  CURLcode res =
+    curl_easy_setopt(
+      recorder->curl,
+      CURLOPT_COPYPOSTFIELDS,
+      recorder->cmd);
+
+  // Redirect the incoming data to the cursor
+  if (res == CURLE_OK)
+    res =
+      curl_easy_setopt(
+        recorder->curl,
+        CURLOPT_WRITEDATA,
+        that);
+  if (res == CURLE_OK)
+    res =
+      curl_easy_setopt(
+        recorder->curl,
+        CURLOPT_WRITEFUNCTION,
+        GetReplyCursorAPI);
+  if (res != CURLE_OK) {
+
+    SafeStrDup(
+      recorder->errMsg,
+      curl_easy_strerror(res));
+    Raise(RunRecorderExc_CurlSetOptFailed);
+
+  }
+
+  // Start the transfer
+  that->curlMulti = curl_multi_init();
+  if (that->curlMulti == NULL) Raise(RunRecorderExc_CreateCurlFailed);
+  CURLMcode resMulti =
+    curl_multi_add_handle(
+      that->curlMulti,
+      recorder->curl);
+  if (resMulti != CURLM_OK) {
+
+    SafeStrDup(
+      recorder->errMsg,
+      curl_multi_strerror(resMulti));
+    Raise(RunRecorderExc_CurlRequestFailed);
+
+  }
+
+  // Receive the first row
+  char* endRow = FillCursorBufferAPI(that);
+
+  // If the reply is not CSV data, the Web API has replied with an error
+  // in JSON format
+  if (endRow == NULL || that->buffer[that->posBuffer] == '{') {
+
+    free(recorder->errMsg);
+    recorder->errMsg = NULL;
+    if (that->buffer != NULL)
+      recorder->errMsg =
+        GetJSONValOfKey(
+          that->buffer + that->posBuffer,
+          "errMsg");
+    Raise(RunRecorderExc_ApiRequestFailed);
+
+  }
+
+  // Split the first row
+  char* row = that->buffer + that->posBuffer;
+  *endRow = '\0';
+  that->posBuffer = endRow + 1 - that->buffer;
+  that->nbMetric =
+    SplitCSVRowInPlace(
+      row,
       NULL,
-      NULL,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_AddMetricFailed);
+      0,
+      CSV_SEP);
+  SafeMalloc(
+    that->values,
+    sizeof(char const*) * that->nbMetric);
+  SplitCSVRowInPlace(
+    row,
+    (char**)(that->values),
+    that->nbMetric,
+    CSV_SEP);
+
+  // Copy the metrics label
+  SafeMalloc(
+    that->metrics,
+    sizeof(char*) * that->nbMetric);
+  ForZeroTo(iMetric, that->nbMetric) that->metrics[iMetric] = NULL;
+  ForZeroTo(iMetric, that->nbMetric)
+    SafeStrDup(
+      that->metrics[iMetric],
+      that->values[iMetric]);
 
-  // Update the view for this project
-  UpdateViewProject(
+}
+
+// Move a cursor on the measures of a local database to the next measure
+// Input:
+//   that: the struct RunRecorderMeasuresCursor
+// Output:
+//   Return true if there is a next measure, else false
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static bool NextCursorLocal(
+  struct RunRecorderMeasuresCursor* const that) {
+
+  // Step the request
+  int retStep = sqlite3_step(that->stmt);
+  if (retStep == SQLITE_DONE) return false;
+  if (retStep != SQLITE_ROW) {
+
+    SafeStrDup(
+      that->recorder->errMsg,
+      sqlite3_errmsg(that->recorder->db));
+    Raise(RunRecorderExc_SQLRequestFailed);
+
+  }
+
+  // Set the values of the measure, they stay valid until the next step
+  ForZeroTo(iMetric, that->nbMetric)
+    that->values[iMetric] =
+      (char const*)sqlite3_column_text(
+        that->stmt,
+        iMetric);
+
+  // Return the flag for the next measure
+  return true;
+
+}
+
+// Move a cursor on the measures through the Web API to the next measure
+// Input:
+//   that: the struct RunRecorderMeasuresCursor
+// Output:
+//   Return true if there is a next measure, else false
+// Raise:
+//   RunRecorderExc_CurlRequestFailed
+//   RunRecorderExc_ApiRequestFailed
+static bool NextCursorAPI(
+  struct RunRecorderMeasuresCursor* const that) {
+
+  // Receive the next row
+  char* endRow = FillCursorBufferAPI(that);
+  if (endRow == NULL) return false;
+
+  // Split the row, the values stay valid until the buffer is updated by
+  // the next call
+  char* row = that->buffer + that->posBuffer;
+  *endRow = '\0';
+  that->posBuffer = endRow + 1 - that->buffer;
+  long nbCol =
+    SplitCSVRowInPlace(
+      row,
+      (char**)(that->values),
+      that->nbMetric,
+      CSV_SEP);
+  if (nbCol != that->nbMetric) {
+
+    SafeStrDup(
+      that->recorder->errMsg,
+      "Invalid number of columns in API reply");
+    Raise(RunRecorderExc_ApiRequestFailed);
+
+  }
+
+  // Return the flag for the next measure
+  return true;
+
+}
+
+// Set the value of a metric in a struct RunRecorderMeasure, adding the
+// metric if it is not yet in the measure
+// Input:
+//     that: the struct RunRecorderMeasure
+//   metric: the value's metric
+//      val: the value as a string
+//     type: the type of the value
+//      num: the numeric value, used according to type
+static void MeasureSetValue(
+   struct RunRecorderMeasure* const that,
+                  char const* const metric,
+                  char const* const val,
+   enum RunRecorderMetricType const type,
+      union RunRecorderNumVal const num) {
+
+  // Search the metric in the measure
+  long idx = -1;
+  ForZeroTo(iMetric, that->nbMetric) {
+
+    int retCmp =
+      strcmp(
+        that->metrics[iMetric],
+        metric);
+    if (retCmp == 0) idx = iMetric;
+
+  }
+
+  // If the metric wasn't already in the measure
+  if (idx == -1) {
+
+    // Reallocate memory for the added value and its metric
+    SafeRealloc(
+      that->metrics,
+      sizeof(char*) * (that->nbMetric + 1));
+    SafeRealloc(
+      that->values,
+      sizeof(char*) * (that->nbMetric + 1));
+    SafeRealloc(
+      that->types,
+      sizeof(enum RunRecorderMetricType) * (that->nbMetric + 1));
+    SafeRealloc(
+      that->nums,
+      sizeof(union RunRecorderNumVal) * (that->nbMetric + 1));
+    that->metrics[that->nbMetric] = NULL;
+    that->values[that->nbMetric] = NULL;
+
+    // Update the number of metric in the measure
+    ++(that->nbMetric);
+    idx = that->nbMetric - 1;
+
+    // Copy the metric in the measure
+    SafeStrDup(
+      that->metrics[idx],
+      metric);
+
+  }
+
+  // Copy the value, replacing the previous one if any
+  SafeStrDup(
+    that->values[idx],
+    val);
+  that->types[idx] = type;
+  that->nums[idx] = num;
+
+}
+
+// Create a struct RunRecorderMeasures
+// Output:
+//   Return the dynamically allocated struct RunRecorderMeasures
+static struct RunRecorderMeasures* RunRecorderMeasuresCreate(
+  void) {
+
+  // Declare the new struct RunRecorderMeasures
+  struct RunRecorderMeasures* that = NULL;
+  SafeMalloc(
     that,
-    project);
+    sizeof(struct RunRecorderMeasures));
+
+  // Init properties
+  that->nbMetric = 0;
+  that->nbMeasure = 0;
+  that->metrics = NULL;
+  that->values = NULL;
+  that->capacity = 0;
+  that->cells = NULL;
+  that->types = NULL;
+  that->nums = NULL;
+  that->arena = NULL;
+
+  // Return the new struct RunRecorderMeasures
+  return that;
 
 }
 
-// Add a metric to a project through the Web API
+// Allocate memory in a chain of struct RunRecorderArenaBlock
+// Inputs:
+//   arena: the chain of blocks
+//    size: the number of byte to allocate
+// Output:
+//   Return a pointer to the allocated memory, it stays valid until the
+//   chain of blocks is freed
+// Raise:
+//   TryCatchExc_MallocFailed
+static char* ArenaAlloc(
+  struct RunRecorderArenaBlock** const arena,
+                          size_t const size) {
+
+  // If there is no block yet or the current one is too small
+  struct RunRecorderArenaBlock* block = *arena;
+  if (block == NULL || block->size - block->len < size) {
+
+    // Get the size of the new block, twice the size of the current one
+    // within limits, and at least the requested size
+    size_t sizeBlock = SIZE_MIN_ARENA_BLOCK;
+    if (block != NULL) sizeBlock = block->size * 2;
+    if (sizeBlock > SIZE_MAX_ARENA_BLOCK) sizeBlock = SIZE_MAX_ARENA_BLOCK;
+    if (sizeBlock < size) sizeBlock = size;
+
+    // Allocate the new block and chain it as the current one
+    block = NULL;
+    SafeRealloc(
+      block,
+      sizeof(struct RunRecorderArenaBlock) + sizeBlock);
+    block->next = *arena;
+    block->size = sizeBlock;
+    block->len = 0;
+    *arena = block;
+
+  }
+
+  // Reserve the memory in the current block
+  char* ptr = block->data + block->len;
+  block->len += size;
+
+  // Return the allocated memory
+  return ptr;
+
+}
+
+// Copy a string in a chain of struct RunRecorderArenaBlock
+// Inputs:
+//   arena: the chain of blocks
+//     str: the string to copy
+// Output:
+//   Return the copy of the string, or NULL if str is NULL
+// Raise:
+//   TryCatchExc_MallocFailed
+static char* ArenaStrDup(
+  struct RunRecorderArenaBlock** const arena,
+                     char const* const str) {
+
+  // If the string is null, nothing to copy
+  if (str == NULL) return NULL;
+
+  // Copy the string, including its null terminating character
+  size_t len = strlen(str) + 1;
+  char* copy =
+    ArenaAlloc(
+      arena,
+      len);
+  memcpy(
+    copy,
+    str,
+    len);
+
+  // Return the copy
+  return copy;
+
+}
+
+// Free a chain of struct RunRecorderArenaBlock
 // Input:
-//         that: the struct RunRecorder
-//      project: the name of the project to which add to the metric
-//        label: the label of the metric, it must respect the following
-//               pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
-//               There cannot be two metrics with the same label for the
-//               same project. A metric label can't be 'action' or 'project'
-//               (case sensitive, so 'Action' is fine).
-//   defaultVal: the default value of the metric, it must respect the
-//               following pattern: /^[^"=&]+$*/
+//   arena: the chain of blocks
+static void ArenaFree(
+  struct RunRecorderArenaBlock** const arena) {
+
+  // Loop on the blocks and free them
+  struct RunRecorderArenaBlock* block = *arena;
+  while (block != NULL) {
+
+    struct RunRecorderArenaBlock* next = block->next;
+    free(block);
+    block = next;
+
+  }
+  *arena = NULL;
+
+}
+
+// Allocate memory for a given number of measures in a struct
+// RunRecorderMeasures, its nbMetric must be set
+// Inputs:
+//       that: the struct RunRecorderMeasures
+//   capacity: the number of measures
+// Raise:
+//   TryCatchExc_MallocFailed
+static void MeasuresReserve(
+  struct RunRecorderMeasures* const that,
+                         long const capacity) {
+
+  // If there is already enough memory, nothing to do
+  if (capacity <= that->capacity) return;
+
+  // Reallocate the values of all the measures in one array
+  size_t nbCell = (size_t)capacity * (size_t)(that->nbMetric);
+  size_t nbCellAlloc = (nbCell > 0 ? nbCell : 1);
+  SafeRealloc(
+    that->cells,
+    sizeof(char*) * nbCellAlloc);
+  SafeRealloc(
+    that->types,
+    sizeof(enum RunRecorderMetricType) * nbCellAlloc);
+  SafeRealloc(
+    that->nums,
+    sizeof(union RunRecorderNumVal) * nbCellAlloc);
+  SafeRealloc(
+    that->values,
+    sizeof(char**) * capacity);
+
+  // The new cells have no numeric value until set otherwise
+  size_t iFirstNewCell = (size_t)(that->capacity) * (size_t)(that->nbMetric);
+  for (
+    size_t iCell = iFirstNewCell;
+    iCell < nbCell;
+    ++iCell) that->types[iCell] = RunRecorderMetricType_text;
+  that->capacity = capacity;
+
+  // Update the pointers to the values of each measure, as the cells may
+  // have moved
+  ForZeroTo(iMeasure, capacity)
+    that->values[iMeasure] = that->cells + iMeasure * that->nbMetric;
+
+}
+
+// Add a measure at the end of a struct RunRecorderMeasures, its
+// nbMetric must be set. The capacity is doubled when it is reached.
+// Input:
+//   that: the struct RunRecorderMeasures
+// Output:
+//   Return the array of values of the new measure, uninitialised
+// Raise:
+//   TryCatchExc_MallocFailed
+static char** MeasuresAddRow(
+  struct RunRecorderMeasures* const that) {
+
+  // If the capacity is reached, double it
+  if (that->nbMeasure >= that->capacity) {
+
+    long capacity = that->capacity * 2;
+    if (capacity < NB_MIN_MEASURE_ALLOC) capacity = NB_MIN_MEASURE_ALLOC;
+    MeasuresReserve(
+      that,
+      capacity);
+
+  }
+
+  // Update the number of measures
+  ++(that->nbMeasure);
+
+  // Return the values of the new measure
+  return that->values[that->nbMeasure - 1];
+
+}
+
+// Get the measures of a project by column from a local database
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+// Output:
+//   Return the measures as a struct RunRecorderColumns
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderColumns* GetColumnsLocal(
+  struct RunRecorder* const that,
+          char const* const project) {
+
+  // Get the list of metrics for the project, giving the type of the
+  // columns
+  struct RunRecorderRefValDef* metrics =
+    RunRecorderGetMetrics(
+      that,
+      project);
+
+  // Declare the struct RunRecorderColumns to memorise the measures
+  struct RunRecorderColumns* columns = NULL;
+  Try {
+
+    // Create the request with no limit on the number of returned measures
+    long nbMeasure = 0;
+    SetCmdToGetMeasuresOfMetricsLocal(
+      that,
+      project,
+      metrics,
+      nbMeasure);
+
+    // Execute the request
+    columns =
+      GetColumnsOfCmdLocal(
+        that,
+        metrics);
+
+  } CatchDefault {
+
+    PolyFree(&metrics);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  PolyFree(&metrics);
+
+  // Return the measures
+  return columns;
+
+}
+
+// Get the measures of a project in a period of time by column from a
+// local database
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a struct RunRecorderColumns, ordered from the
+//   oldest to the most recent
 // Raise:
-//   RunRecorderExc_InvalidMetricLabel
-//   RunRecorderExc_MetricNameAlreadyUsed
-static void AddMetricAPI(
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderColumns* GetColumnsInRangeLocal(
   struct RunRecorder* const that,
           char const* const project,
-          char const* const label,
-          char const* const defaultVal) {
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit) {
 
-  // Create the request to the Web API
-  StringCreate(
-    &(that->cmd),
-    "action=add_metric&project=%s&label=%s&default=%s",
-    project,
-    label,
-    defaultVal);
-  SetAPIReqPostVal(
-    that,
-    that->cmd);
+  // Get the list of metrics for the project, giving the type of the
+  // columns
+  struct RunRecorderRefValDef* metrics =
+    RunRecorderGetMetrics(
+      that,
+      project);
 
-  // Send the request to the API
-  bool isJsonReq = true;
-  SendAPIReq(
-    that,
-    isJsonReq);
+  // Declare the struct RunRecorderColumns to memorise the measures
+  struct RunRecorderColumns* columns = NULL;
+  Try {
+
+    // Create the request with no limit on the number of returned
+    // measures, and restrict it to the period
+    long nbMeasure = 0;
+    SetCmdToGetMeasuresOfMetricsLocal(
+      that,
+      project,
+      metrics,
+      nbMeasure);
+    AppendCmdInRangeLocal(
+      that,
+      fromDate,
+      toDate,
+      limit);
+
+    // Execute the request
+    columns =
+      GetColumnsOfCmdLocal(
+        that,
+        metrics);
+
+  } CatchDefault {
+
+    PolyFree(&metrics);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  PolyFree(&metrics);
+
+  // Return the measures
+  return columns;
 
 }
 
-// Add a measure to a project in a local database
+// Execute the SQL command in that->cmd on a local database and get the
+// returned rows as a struct RunRecorderColumns. The numeric values are
+// copied in the columns without conversion to a string.
 // Inputs:
-//         that: the struct RunRecorder
-//      project: the project to add the measure to
-//      measure: the measure to add
+//      that: the struct RunRecorder
+//   metrics: the metrics of the project, giving the type of the columns
+// Output:
+//   Return the measures as a struct RunRecorderColumns
 // Raise:
-//   RunRecorderExc_AddMeasureFailed
-static void AddMeasureLocal(
-               struct RunRecorder* const that,
-                       char const* const project,
-  struct RunRecorderMeasure const* const measure) {
+//   RunRecorderExc_SQLRequestFailed
+static struct RunRecorderColumns* GetColumnsOfCmdLocal(
+                struct RunRecorder* const that,
+  struct RunRecorderRefValDef const* const metrics) {
+
+  // Prepare the request
+  sqlite3_stmt* stmt = NULL;
+  int retPrepare =
+    sqlite3_prepare_v2(
+      that->db,
+      that->cmd,
+      -1,
+      &stmt,
+      NULL);
+  if (retPrepare != SQLITE_OK) {
 
-  // Reset the reference of the last added measure
-  that->refLastAddedMeasure = 0;
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(that->db));
+    Raise(RunRecorderExc_SQLRequestFailed);
 
-  // Get the date of the record (use the current local date)
-  time_t mytime = time(NULL);
-  char* dateStr = ctime(&mytime);
+  }
 
-  // Remove the line return at the end of the date
-  dateStr[strlen(dateStr) - 1] = '\0';
+  // Declare the struct RunRecorderColumns to memorise the measures, and
+  // the array of labels of the columns
+  struct RunRecorderColumns* columns = NULL;
+  char const** labels = NULL;
+  Try {
 
-  // Create the SQL command
-  StringCreate(
-    &(that->cmd),
-    "INSERT INTO _Measure (RefProject, DateMeasure) "
-    "SELECT _Project.Ref, \"%s\" FROM _Project "
-    "WHERE _Project.Label = \"%s\"",
-    dateStr,
-    project);
+    // Create the columns from the labels of the columns of the request
+    long nbMetric = sqlite3_column_count(stmt);
+    SafeMalloc(
+      labels,
+      sizeof(char*) * (nbMetric > 0 ? nbMetric : 1));
+    ForZeroTo(iMetric, nbMetric)
+      labels[iMetric] =
+        sqlite3_column_name(
+          stmt,
+          iMetric);
+    columns =
+      RunRecorderColumnsCreate(
+        labels,
+        nbMetric,
+        metrics);
+    PolyFree(&labels);
+
+    // Execute the request and loop on the returned rows
+    int retStep =
+      StepStmt(
+        that,
+        stmt);
+    while (retStep == SQLITE_ROW) {
+
+      // Add a measure, the memory grows geometrically, and set its values
+      long iMeasure = ColumnsAddRow(columns);
+      ForZeroTo(iMetric, columns->nbMetric)
+        ColumnsSetValueLocal(
+          columns,
+          iMetric,
+          iMeasure,
+          stmt);
+
+      // Move to the next row
+      retStep =
+        StepStmt(
+          that,
+          stmt);
 
-  // Execute the command to add the measure
-  int retExec =
-    sqlite3_exec(
-      that->db,
-      that->cmd,
-      NULL,
-      NULL,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_AddMeasureFailed);
+    }
+    if (retStep != SQLITE_DONE) Raise(RunRecorderExc_SQLRequestFailed);
 
-  // Get the reference of the measure
-  that->refLastAddedMeasure = sqlite3_last_insert_rowid(that->db);
+  } CatchDefault {
 
-  // Declare a variable to memorise an eventual failure
-  // The policy here is to try to save has much data has possible
-  // even if some fails, inform the user and let him/her take
-  // appropriate action
-  bool hasFailed = false;
+    sqlite3_finalize(stmt);
+    PolyFree(&labels);
+    PolyFree(&columns);
+    Raise(TryCatchGetLastExc());
 
-  // Loop on the values in the measure
-  ForZeroTo(iVal, measure->nbMetric) {
+  } EndCatch;
 
-    Try {
+  // Release the request
+  sqlite3_finalize(stmt);
 
-      // Create the SQL command
-      StringCreate(
-        &(that->cmd),
-        "INSERT INTO _Value (RefMeasure, RefMetric, Value) "
-        "SELECT %ld, _Metric.Ref, \"%s\" FROM _Metric "
-        "WHERE _Metric.Label = \"%s\"",
-        that->refLastAddedMeasure,
-        measure->values[iVal],
-        measure->metrics[iVal]);
+  // Return the measures
+  return columns;
 
-      // Execute the command to add the value
-      int retExec =
-        sqlite3_exec(
-          that->db,
-          that->cmd,
-          NULL,
-          NULL,
-          &(that->sqliteErrMsg));
-      if (retExec != SQLITE_OK) hasFailed = true;
+}
 
-    } CatchDefault {
+// Get the measures of a project by column through the Web API
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+// Output:
+//   Return the measures as a struct RunRecorderColumns
+static struct RunRecorderColumns* GetColumnsAPI(
+  struct RunRecorder* const that,
+          char const* const project) {
 
-      hasFailed = true;
+  // Get the list of metrics for the project, giving the type of the
+  // columns
+  struct RunRecorderRefValDef* metrics =
+    RunRecorderGetMetrics(
+      that,
+      project);
 
-    } EndCatch;
+  // Declare the struct RunRecorderColumns to memorise the measures
+  struct RunRecorderColumns* columns = NULL;
+  Try {
 
-  }
+    // Create the request to the Web API
+    StringCreate(
+      &(that->cmd),
+      "action=csv&project=%s",
+      project);
 
-  // If there has been a failure, raise an exception
-  if (hasFailed == true) Raise(RunRecorderExc_AddMeasureFailed);
+    // Send the request and convert its reply
+    columns =
+      GetColumnsOfReqAPI(
+        that,
+        metrics);
+
+  } CatchDefault {
+
+    PolyFree(&metrics);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  PolyFree(&metrics);
+
+  // Return the measures
+  return columns;
 
 }
 
-// Add a measure to a project through the WebAPI
+// Get the measures of a project in a period of time by column through
+// the Web API
 // Inputs:
-//         that: the struct RunRecorder
-//      project: the project to add the measure to
-//      measure: the measure to add
-// Raise:
-//   RunRecorderExc_ApiRequestFailed
-static void AddMeasureAPI(
-               struct RunRecorder* const that,
-                       char const* const project,
-  struct RunRecorderMeasure const* const measure) {
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a struct RunRecorderColumns, ordered from the
+//   oldest to the most recent
+static struct RunRecorderColumns* GetColumnsInRangeAPI(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit) {
 
-  // Reset the reference of the last added measure
-  that->refLastAddedMeasure = 0;
+  // Get the list of metrics for the project, giving the type of the
+  // columns
+  struct RunRecorderRefValDef* metrics =
+    RunRecorderGetMetrics(
+      that,
+      project);
 
-  // Create the request to the Web API
-  StringCreate(
-    &(that->cmd),
-    "action=add_measure&project=%s",
-    project);
-  ForZeroTo(iVal, measure->nbMetric)
-    StringAppend(
+  // Declare the struct RunRecorderColumns to memorise the measures
+  struct RunRecorderColumns* columns = NULL;
+  Try {
+
+    // Create the request to the Web API
+    StringCreate(
       &(that->cmd),
-      "&%s=%s",
-      measure->metrics[iVal],
-      measure->values[iVal]);
+      "action=csv&project=%s&from=%ld&to=%ld&limit=%ld",
+      project,
+      (long)fromDate,
+      (long)toDate,
+      limit);
+
+    // Send the request and convert its reply
+    columns =
+      GetColumnsOfReqAPI(
+        that,
+        metrics);
+
+  } CatchDefault {
+
+    PolyFree(&metrics);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  PolyFree(&metrics);
+
+  // Return the measures
+  return columns;
+
+}
+
+// Send the request in that->cmd to the Web API and convert its CSV reply
+// to a struct RunRecorderColumns
+// Inputs:
+//      that: the struct RunRecorder
+//   metrics: the metrics of the project, giving the type of the columns
+// Output:
+//   Return the measures as a struct RunRecorderColumns
+static struct RunRecorderColumns* GetColumnsOfReqAPI(
+                struct RunRecorder* const that,
+  struct RunRecorderRefValDef const* const metrics) {
+
+  // Send the request to the API
   SetAPIReqPostVal(
     that,
     that->cmd);
-
-  // Send the request to the API
-  bool isJsonReq = true;
+  bool isJsonReq = false;
   SendAPIReq(
     that,
     isJsonReq);
 
-  // Extract the reference of the measure from the JSON reply
-  char* version =
-    GetJSONValOfKey(
+  // Convert the CSV data into a struct RunRecorderColumns, the reply is
+  // not used after and can be split in place
+  struct RunRecorderColumns* columns =
+    CSVToColumns(
       that->curlReply,
-      "refMeasure");
-  if (version == NULL) Raise(RunRecorderExc_ApiRequestFailed);
-  errno = 0;
-  that->refLastAddedMeasure =
-    strtol(
-      version,
-      NULL,
-      10);
-  free(version);
-  if (errno != 0) Raise(RunRecorderExc_ApiRequestFailed);
+      CSV_SEP,
+      metrics);
+
+  // Return the struct RunRecorderColumns
+  return columns;
 
 }
 
-// Delete a measure in a local database
+// Convert CSV data, formatted as for CSVToData, to a new struct
+// RunRecorderColumns. The CSV data are split in place.
 // Inputs:
-//       that: the struct RunRecorder
-//    measure: the reference of the measure to delete
-// Raise:
-//   RunRecorderExc_DeleteMeasureFailed
-static void DeleteMeasureLocal(
-  struct RunRecorder* const that,
-                 long const refMeasure) {
+//       csv: the CSV data
+//       sep: the separator between columns
+//   metrics: the metrics of the project, giving the type of the columns
+// Output:
+//   Return a newly allocated struct RunRecorderColumns
+static struct RunRecorderColumns* CSVToColumns(
+                              char* const csv,
+                               char const sep,
+  struct RunRecorderRefValDef const* const metrics) {
+
+  // Declare the result struct RunRecorderColumns, and the array of
+  // pointers to the columns of the current row
+  struct RunRecorderColumns* columns = NULL;
+  char** cells = NULL;
+  Try {
 
-  // Create the SQL command to delete the measure's values
-  StringCreate(
-    &(that->cmd),
-    "DELETE FROM _Value WHERE RefMeasure = %ld",
-    refMeasure);
+    // Extract the metrics label from the first row and create the
+    // columns
+    char* row = csv;
+    char* endRow =
+      strchr(
+        row,
+        '\n');
+    if (endRow != NULL) *endRow = '\0';
+    long nbMetric =
+      SplitCSVRowInPlace(
+        row,
+        NULL,
+        0,
+        sep);
+    SafeMalloc(
+      cells,
+      sizeof(char*) * nbMetric);
+    SplitCSVRowInPlace(
+      row,
+      cells,
+      nbMetric,
+      sep);
+    columns =
+      RunRecorderColumnsCreate(
+        (char const* const*)cells,
+        nbMetric,
+        metrics);
+
+    // Calculate the number of measures by counting the number of line
+    // return in the remaining rows, and allocate memory for all of them
+    // at once
+    long nbMeasure = 0;
+    row = (endRow != NULL ? endRow + 1 : row + strlen(row));
+    for (
+      char const* ptr = row;
+      *ptr != '\0';
+      ++ptr) if (*ptr == '\n') ++nbMeasure;
+    ColumnsReserve(
+      columns,
+      nbMeasure);
 
-  // Execute the command to delete the measure's values
-  int retExec =
-    sqlite3_exec(
-      that->db,
-      that->cmd,
-      NULL,
-      NULL,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_DeleteMeasureFailed);
+    // Extract the measures
+    ForZeroTo(iRow, nbMeasure) {
+
+      endRow =
+        strchr(
+          row,
+          '\n');
+      *endRow = '\0';
+      long iMeasure = ColumnsAddRow(columns);
+      long nbCol =
+        SplitCSVRowInPlace(
+          row,
+          cells,
+          nbMetric,
+          sep);
 
-  // Create the SQL command to delete the measure
-  StringCreate(
-    &(that->cmd),
-    "DELETE FROM _Measure WHERE Ref = %ld ; VACUUM",
-    refMeasure);
+      // Convert the values, the missing ones are null
+      ForZeroTo(iMetric, nbMetric)
+        ColumnsSetValueStr(
+          columns,
+          iMetric,
+          iMeasure,
+          (iMetric < nbCol ? cells[iMetric] : NULL));
+      row = endRow + 1;
 
-  // Execute the command to delete the measure
-  retExec =
-    sqlite3_exec(
-      that->db,
-      that->cmd,
-      NULL,
-      NULL,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_DeleteMeasureFailed);
+    }
+
+  } CatchDefault {
 
-}
+    PolyFree(&cells);
+    PolyFree(&columns);
+    Raise(TryCatchGetLastExc());
 
-// Delete a measure through the Web API
-// Inputs:
-//          that: the struct RunRecorder
-//    refMeasure: the reference of the measure to delete
-static void DeleteMeasureAPI(
-  struct RunRecorder* const that,
-                 long const refMeasure) {
+  } EndCatch;
 
-  // Create the request to the Web API
-  StringCreate(
-    &(that->cmd),
-    "action=delete_measure&measure=%ld",
-    refMeasure);
-  SetAPIReqPostVal(
-    that,
-    that->cmd);
+  // Free memory
+  PolyFree(&cells);
 
-  // Send the request to the API
-  bool isJsonReq = true;
-  SendAPIReq(
-    that,
-    isJsonReq);
+  // Return the result struct RunRecorderColumns
+  return columns;
 
 }
 
-// Callback to receive the measures from sqlite3
-// Input:
-//      data: The measures
-//     nbCol: Number of columns in the returned rows
-//    colVal: Row values
-//   colName: Columns name
+// Create a struct RunRecorderColumns with no measure
+// Inputs:
+//     labels: the labels of the columns
+//   nbMetric: the number of columns
+//    metrics: the metrics of the project, giving the type of the columns.
+//             'Ref' and 'DateMeasure' are integers, and the columns
+//             without metric are text
 // Output:
-//   Return 0 if successfull, else 1
-static int GetMeasuresLocalCb(
-   void* data,
-     int nbCol,
-  char** colVal,
-  char** colName) {
+//   Return the dynamically allocated struct RunRecorderColumns
+static struct RunRecorderColumns* RunRecorderColumnsCreate(
+                char const* const* const labels,
+                               long const nbMetric,
+  struct RunRecorderRefValDef const* const metrics) {
+
+  // Declare the new struct RunRecorderColumns
+  struct RunRecorderColumns* that = NULL;
+  SafeMalloc(
+    that,
+    sizeof(struct RunRecorderColumns));
 
-  // Unused argument
-  (void)colName;
+  // Init properties
+  that->nbMeasure = 0;
+  that->nbMetric = 0;
+  that->columns = NULL;
+  that->capacity = 0;
+  that->arena = NULL;
 
-  // Cast the data
-  struct RunRecorderMeasures** measures = (struct RunRecorderMeasures**)data;
+  Try {
 
-  // If the arguments are invalid
-  // Return non zero to trigger SQLITE_ABORT in the calling function
-  if (nbCol == 0 || colVal == NULL || colName == NULL ) return 1;
+    // Allocate the columns and init their properties
+    SafeRealloc(
+      that->columns,
+      sizeof(struct RunRecorderColumn) * (nbMetric > 0 ? nbMetric : 1));
+    that->nbMetric = nbMetric;
+    ForZeroTo(iMetric, nbMetric) {
+
+      struct RunRecorderColumn* column = that->columns + iMetric;
+      column->label = NULL;
+      column->type = RunRecorderMetricType_text;
+      column->ints = NULL;
+      column->doubles = NULL;
+      column->codes = NULL;
+      column->validity = NULL;
+      column->nbDict = 0;
+      column->dict = NULL;
+      column->sizeHash = 0;
+      column->hash = NULL;
 
-  Try {
+    }
 
-    // If the measures are not allocated yet
-    if (*measures == NULL) {
+    // Loop on the columns
+    ForZeroTo(iMetric, nbMetric) {
 
-      // Allocate memory for the measures
-      *measures = RunRecorderMeasuresCreate();
+      // Copy the label
+      struct RunRecorderColumn* column = that->columns + iMetric;
+      column->label =
+        ArenaStrDup(
+          &(that->arena),
+          labels[iMetric]);
 
-      // Copy the metrics label
-      (*measures)->nbMetric = nbCol;
-      SafeMalloc(
-        (*measures)->metrics,
-        sizeof(char*) * nbCol);
-      ForZeroTo(iMetric, (*measures)->nbMetric)
-        (*measures)->metrics[iMetric] = NULL;
-      ForZeroTo(iMetric, (*measures)->nbMetric)
-        SafeStrDup(
-          (*measures)->metrics[iMetric],
-          colName[iMetric]);
+      // If it's the reference or date of the measures, it's an integer
+      bool isRef = (strcmp(column->label, "Ref") == 0);
+      bool isDate = (strcmp(column->label, "DateMeasure") == 0);
+      if (isRef == true || isDate == true) {
 
-    // Else, the measures are already allocated
-    } else {
+        column->type = RunRecorderMetricType_int;
 
-      // If the number of columns in data doesn't match the number of
-      // metrics in the struct RunRecordMeasures in argument,
-      // return non zero to trigger SQLITE_ABORT in the calling function
-      if (nbCol != (*measures)->nbMetric) return 1;
+      // Else, search the type of its metric
+      } else {
 
-    }
+        ForZeroTo(iDef, metrics->nb) {
 
-    // Allocate memory for the received measure
-    SafeRealloc(
-      (*measures)->values,
-      sizeof(char**) * ((*measures)->nbMeasure + 1));
-    (*measures)->values[(*measures)->nbMeasure] = NULL;
+          int retCmp =
+            strcmp(
+              metrics->values[iDef],
+              column->label);
+          if (retCmp == 0) column->type = metrics->types[iDef];
 
-    // Allocate memory for the received measure's values
-    SafeMalloc(
-      (*measures)->values[(*measures)->nbMeasure],
-      sizeof(char*) * nbCol);
-    ForZeroTo(iMetric, (*measures)->nbMetric)
-      (*measures)->values[(*measures)->nbMeasure][iMetric] = NULL;
+        }
 
-    // Update the number of measure
-    ++((*measures)->nbMeasure);
+      }
 
-    // For each metric, copy the value of the received measure
-    ForZeroTo(iMetric, (*measures)->nbMetric)
-      SafeStrDup(
-        (*measures)->values[(*measures)->nbMeasure - 1][iMetric],
-        colVal[iMetric]);
+    }
 
   } CatchDefault {
 
-    return 1;
+    PolyFree(&that);
+    Raise(TryCatchGetLastExc());
 
   } EndCatch;
 
-  // Return success code
-  return 0;
+  // Return the new struct RunRecorderColumns
+  return that;
 
 }
 
-// Helper function to commonalize code between GetMeasures and
-// GetLastMeasures
+// Allocate memory for a given number of measures in a struct
+// RunRecorderColumns
 // Inputs:
-//        that: the struct RunRecorder
-//     project: the project's name
-//   nbMeasure: the number of measures returned, if 0 all measures are
-//              returned
-// Output:
-//   Set the SQL command in that->cmd to get measures as a struct
-//    RunRecorderMeasures
-static void SetCmdToGetMeasuresLocal(
-  struct RunRecorder* const that,
-          char const* const project,
-                 long const nbMeasure) {
-
-  // Get the list of metrics for the project
-  struct RunRecorderRefValDef* metrics =
-    RunRecorderGetMetrics(
-      that,
-      project);
+//       that: the struct RunRecorderColumns
+//   capacity: the number of measures
+// Raise:
+//   TryCatchExc_MallocFailed
+static void ColumnsReserve(
+  struct RunRecorderColumns* const that,
+                        long const capacity) {
 
-  Try {
+  // If there is already enough memory, nothing to do
+  if (capacity <= that->capacity) return;
 
-    // Create the head of the command
-    StringCreate(
-      &(that->cmd),
-      "SELECT Ref,");
+  // Size in byte of the validity bitmaps before and after reallocation
+  size_t sizeValidity = ((size_t)capacity + 7) / 8;
+  size_t sizeValidityPrev = ((size_t)(that->capacity) + 7) / 8;
 
-    // For each metric
-    ForZeroTo(iMetric, metrics->nb) {
+  // Loop on the columns
+  ForZeroTo(iMetric, that->nbMetric) {
 
-      // Append the metric label to the command
-      char sep = ',';
-      if (iMetric == metrics->nb - 1) sep = ' ';
-      StringAppend(
-        &(that->cmd),
-        "\"%s\"%c",
-        metrics->values[iMetric],
-        sep);
+    // Reallocate the array of values of the type of the column
+    struct RunRecorderColumn* column = that->columns + iMetric;
+    if (column->type == RunRecorderMetricType_int)
+      SafeRealloc(
+        column->ints,
+        sizeof(long) * capacity);
+    else if (column->type == RunRecorderMetricType_double)
+      SafeRealloc(
+        column->doubles,
+        sizeof(double) * capacity);
+    else
+      SafeRealloc(
+        column->codes,
+        sizeof(long) * capacity);
+
+    // Reallocate the validity bitmap, the new values are invalid until
+    // they're set
+    SafeRealloc(
+      column->validity,
+      sizeValidity);
+    memset(
+      column->validity + sizeValidityPrev,
+      0,
+      sizeValidity - sizeValidityPrev);
 
-    }
+  }
 
-    // Free memory
-    PolyFree(&metrics);
+  // Update the capacity
+  that->capacity = capacity;
 
-    // Append the tail of the command
-    StringAppend(
-      &(that->cmd),
-      "FROM \"%s\"",
-      project);
+}
 
-    // If there is a limit on the number of measures to be returned
-    if (nbMeasure > 0) {
+// Add a measure at the end of a struct RunRecorderColumns. The capacity
+// is doubled when it is reached.
+// Input:
+//   that: the struct RunRecorderColumns
+// Output:
+//   Return the index of the new measure, its values are uninitialised and
+//   invalid
+// Raise:
+//   TryCatchExc_MallocFailed
+static long ColumnsAddRow(
+  struct RunRecorderColumns* const that) {
 
-      // Append the limit at the end of the command
-      StringAppend(
-        &(that->cmd),
-        " ORDER BY Ref DESC LIMIT %ld",
-        nbMeasure);
+  // If the capacity is reached, double it
+  if (that->nbMeasure >= that->capacity) {
 
-    }
+    long capacity = that->capacity * 2;
+    if (capacity < NB_MIN_MEASURE_ALLOC) capacity = NB_MIN_MEASURE_ALLOC;
+    ColumnsReserve(
+      that,
+      capacity);
 
-  } CatchDefault {
+  }
 
-    PolyFree(&metrics);
-    Raise(TryCatchGetLastExc());
+  // Update the number of measures
+  ++(that->nbMeasure);
 
-  } EndCatch;
+  // Return the index of the new measure
+  return that->nbMeasure - 1;
 
 }
 
-// Get the measures of a project from a local database
+// Set a value of a struct RunRecorderColumns from its string, converted
+// to the type of the column
 // Inputs:
-//         that: the struct RunRecorder
-//      project: the project's name
-// Output:
-//   Return the measures as a struct RunRecorderMeasures
+//       that: the struct RunRecorderColumns
+//    iMetric: the index of the column
+//   iMeasure: the index of the measure
+//        str: the value, NULL for a null value
 // Raise:
-//   RunRecorderExc_SQLRequestFailed
-static struct RunRecorderMeasures* GetMeasuresLocal(
-  struct RunRecorder* const that,
-          char const* const project) {
+//   TryCatchExc_MallocFailed
+static void ColumnsSetValueStr(
+  struct RunRecorderColumns* const that,
+                        long const iMetric,
+                        long const iMeasure,
+                 char const* const str) {
+
+  // Variable to memorise if the value is valid
+  bool isValid = false;
+
+  // If the column is an integer
+  struct RunRecorderColumn* column = that->columns + iMetric;
+  if (column->type == RunRecorderMetricType_int) {
+
+    // Parse the integer, truncating the decimals if any as
+    // RunRecorderMeasuresGetLong
+    long val = 0;
+    isValid =
+      StrToLong(
+        str,
+        &val);
+    if (isValid == false) {
+
+      double valDouble = 0.0;
+      isValid =
+        StrToDouble(
+          str,
+          &valDouble);
+      if (isValid == true) val = (long)valDouble;
 
-  // Declare the struct RunRecorderMeasures to memorise the measures
-  struct RunRecorderMeasures* measures = NULL;
+    }
+    column->ints[iMeasure] = val;
 
-  // Create the request with no limit on the number of returned measures
-  long nbMeasure = 0;
-  SetCmdToGetMeasuresLocal(
-    that,
-    project,
-    nbMeasure);
+  // Else, if the column is a double
+  } else if (column->type == RunRecorderMetricType_double) {
 
-  // Execute the request
-  int retExec =
-    sqlite3_exec(
-      that->db,
-      that->cmd,
-      GetMeasuresLocalCb,
-      &measures,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_SQLRequestFailed);
+    // Parse the double
+    double val = 0.0;
+    isValid =
+      StrToDouble(
+        str,
+        &val);
+    column->doubles[iMeasure] = val;
 
-  // If there is no measures GetMeasuresLocalCb won't get called and
-  // an empty struct RunRecorderMeasures needs to be allocated here
-  if (measures == NULL) measures = RunRecorderMeasuresCreate();
+  // Else, the column is a text
+  } else {
 
-  // Return the measures
-  return measures;
+    // Replace the string with its index in the dictionary
+    long code = -1;
+    if (str != NULL) {
 
-}
+      code =
+        ColumnDictAdd(
+          that,
+          column,
+          str);
+      isValid = true;
 
-// Helper function to commonalize code in RunRecorderCSVToData
-// Inputs
-//   csv: Pointer to the start of the row in CSV data
-//   tgt: The array of char* where to copy the values
-//   sep: The separator character
-// Output:
-//   Return a pointer to the end of the row
-static char const* SplitCSVRowToData(
-   char const* const csv,
-        char** const tgt,
-          char const sep) {
+    }
+    column->codes[iMeasure] = code;
 
-  // Loop on one line of the CSV data
-  long iCol = 0;
-  char const* ptr = csv;
-  while (*ptr != '\n') {
+  }
 
-    // Get the next separator
-    char const* ptrSep = ptr;
-    if (ptr != csv) ++ptrSep;
-    while (*ptrSep != sep && *ptrSep != '\n' && *ptrSep != '\0') ++ptrSep;
+  // Update the validity bitmap
+  if (isValid == true)
+    column->validity[iMeasure / 8] |= (unsigned char)(1 << (iMeasure % 8));
 
-    // If the next separator is the current position or the next character
-    if (ptrSep == ptr || ptrSep == ptr + 1) {
+}
 
-      // If the current position is a separator
-      if (*ptr == sep) {
+// Set a value of a struct RunRecorderColumns from a column of the current
+// row of a SQL request
+// Inputs:
+//       that: the struct RunRecorderColumns
+//    iMetric: the index of the column, in the columns and in the request
+//   iMeasure: the index of the measure
+//       stmt: the SQL request
+// Raise:
+//   TryCatchExc_MallocFailed
+static void ColumnsSetValueLocal(
+  struct RunRecorderColumns* const that,
+                        long const iMetric,
+                        long const iMeasure,
+                sqlite3_stmt* const stmt) {
+
+  // Get the type of the value in the request
+  struct RunRecorderColumn* column = that->columns + iMetric;
+  int type =
+    sqlite3_column_type(
+      stmt,
+      (int)iMetric);
+
+  // If the value is an integer in an integer column, copy it
+  if (
+    type == SQLITE_INTEGER &&
+    column->type == RunRecorderMetricType_int) {
 
-        // The column is empty
-        SafeMalloc(
-          tgt[iCol],
-          1);
-        tgt[iCol][0] = '\0';
+    column->ints[iMeasure] =
+      sqlite3_column_int64(
+        stmt,
+        (int)iMetric);
 
-      // Else, the current position is not a separator
-      } else {
+  // Else, if the value is a number in a double column, copy it
+  } else if (
+    (type == SQLITE_INTEGER || type == SQLITE_FLOAT) &&
+    column->type == RunRecorderMetricType_double) {
 
-        // The column is one character wide
-        SafeMalloc(
-          tgt[iCol],
-          2);
-        tgt[iCol][0] = *ptr;
-        tgt[iCol][1] = '\0';
+    column->doubles[iMeasure] =
+      sqlite3_column_double(
+        stmt,
+        (int)iMetric);
 
-      }
+  // Else, convert the value from its string, null values are invalid
+  } else {
 
-    // Else the next separator is more than 1 character away
-    } else {
+    ColumnsSetValueStr(
+      that,
+      iMetric,
+      iMeasure,
+      (char const*)sqlite3_column_text(
+        stmt,
+        (int)iMetric));
+    return;
 
-      // If the current position is still on the last separator, increment it
-      if (*ptr == sep || *ptr == '\n') ++ptr;
+  }
 
-      // Get the length of the column
-      size_t len = ptrSep - ptr;
+  // The copied value is valid
+  column->validity[iMeasure / 8] |= (unsigned char)(1 << (iMeasure % 8));
 
-      // Allocate memory for the value
-      SafeMalloc(
-        tgt[iCol],
-        len + 1);
+}
 
-      // Copy the value
-      memcpy(
-        tgt[iCol],
-        ptr,
-        len);
-      tgt[iCol][len] = '\0';
+// Get the index of a string in the dictionary of a text column of a
+// struct RunRecorderColumns, adding it if it is not yet in the dictionary
+// Inputs:
+//     that: the struct RunRecorderColumns
+//   column: the column
+//      str: the string
+// Output:
+//   Return the index of the string in the dictionary
+// Raise:
+//   TryCatchExc_MallocFailed
+static long ColumnDictAdd(
+  struct RunRecorderColumns* const that,
+    struct RunRecorderColumn* const column,
+                 char const* const str) {
+
+  // If adding a string would fill more than half of the hash table
+  if (2 * (column->nbDict + 1) > column->sizeHash) {
+
+    // Double the size of the hash table, the dictionary can hold up to
+    // half of its size
+    long sizeHash = column->sizeHash * 2;
+    if (sizeHash < SIZE_MIN_DICT_HASH) sizeHash = SIZE_MIN_DICT_HASH;
+    SafeRealloc(
+      column->dict,
+      sizeof(char*) * (sizeHash / 2));
+    long* hash = NULL;
+    SafeRealloc(
+      hash,
+      sizeof(long) * sizeHash);
+
+    // Insert the strings of the dictionary in the new hash table
+    ForZeroTo(iHash, sizeHash) hash[iHash] = -1;
+    unsigned long long mask = (unsigned long long)sizeHash - 1;
+    ForZeroTo(iDict, column->nbDict) {
+
+      unsigned long long iHash = HashStr(column->dict[iDict]) & mask;
+      while (hash[iHash] != -1) iHash = (iHash + 1) & mask;
+      hash[iHash] = iDict;
 
     }
+    free(column->hash);
+    column->hash = hash;
+    column->sizeHash = sizeHash;
 
-    // Move to the next column
-    ++iCol;
-    ptr = ptrSep;
+  }
 
-    // To escape an empty first column
-    if (ptr == csv) ++ptr;
+  // Search the string in the hash table, by linear probing from its hash
+  unsigned long long mask = (unsigned long long)(column->sizeHash) - 1;
+  unsigned long long iHash = HashStr(str) & mask;
+  while (column->hash[iHash] != -1) {
+
+    // If it's the string, return its index
+    long iDict = column->hash[iHash];
+    int retCmp =
+      strcmp(
+        column->dict[iDict],
+        str);
+    if (retCmp == 0) return iDict;
+    iHash = (iHash + 1) & mask;
 
   }
 
-  // Skip the line return
-  if (*ptr == '\n') ++ptr;
+  // The string is not in the dictionary, add it at the free position in
+  // the hash table
+  column->dict[column->nbDict] =
+    ArenaStrDup(
+      &(that->arena),
+      str);
+  column->hash[iHash] = column->nbDict;
+  ++(column->nbDict);
 
-  // Return the pointer to the end of the row
-  return ptr;
+  // Return the index of the string
+  return column->nbDict - 1;
 
 }
 
-// Convert CSV data to a new struct RunRecorderMeasures. The CSV data are
-// expected to be formatted as:
-// Ref&Metric1&Metric2&...
-// Ref1&Value1_1&Value1_2&...
-// Ref2&Value2_1&Value2_2&...
-// ...
-// Inputs:
-//   csv: the CSV data
-//   sep: the separator between columns ('&' in the example above)
+// Hash a string (FNV-1a)
+// Input:
+//   str: the string
 // Output:
-//   Return a newly allocated RunRecorderMeasures
-static struct RunRecorderMeasures* CSVToData(
-  char const* const csv,
-         char const sep) {
+//   Return the hash of the string
+static unsigned long long HashStr(
+  char const* const str) {
 
-  // Calculate the number of columns by counting the separator in the first
-  // row
-  long nbCol = 1;
-  char const* ptr = csv;
-  while (*ptr != '\n' && *ptr != '\0') {
+  // Loop on the characters of the string and combine them into the hash
+  unsigned long long hash = 14695981039346656037ULL;
+  for (
+    char const* ptr = str;
+    *ptr != '\0';
+    ++ptr) {
 
-    if (*ptr == sep) ++nbCol;
-    ++ptr;
+    hash ^= (unsigned char)(*ptr);
+    hash *= 1099511628211ULL;
 
   }
 
-  // Skip the line return of the first line
-  if (*ptr == '\n') ++ptr;
+  // Return the hash
+  return hash;
 
-  // Calculate the number of measures by counting the number of line return
-  // in the remaining rows
-  long nbMeasure = 0;
-  do {
+}
 
-    if (*ptr == '\n') ++nbMeasure;
-    ++ptr;
+// Check a metric exists in a project of a local database
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+//    metric: the metric's label
+// Raise:
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_SQLRequestFailed
+static void CheckMetricLocal(
+  struct RunRecorder* const that,
+          char const* const project,
+          char const* const metric) {
+
+  // Get the metrics of the project and search the metric among them
+  struct RunRecorderRefValDef* metrics =
+    GetMetricsLocal(
+      that,
+      project);
+  bool isFound = false;
+  ForZeroTo(iMetric, metrics->nb)
+    if (strcmp(metrics->values[iMetric], metric) == 0) isFound = true;
+  PolyFree(&metrics);
 
-  } while (*ptr != '\0');
+  // If the metric doesn't exist, raise an exception
+  if (isFound == false) {
 
-  // Allocate memory for the result struct RunRecorderMeasures
-  struct RunRecorderMeasures* measures = RunRecorderMeasuresCreate();
-  Try {
+    StringCreate(
+      &(that->errMsg),
+      "The metric %s is invalid.",
+      metric);
+    Raise(RunRecorderExc_InvalidMetricLabel);
 
-    // Set the number of metrics and measure
-    measures->nbMetric = nbCol;
-    measures->nbMeasure = nbMeasure;
+  }
 
-    // Allocate memory for the metrics
-    SafeMalloc(
-      measures->metrics,
-      sizeof(char*) * measures->nbMetric);
-    ForZeroTo(iMetric, measures->nbMetric)
-      measures->metrics[iMetric] = NULL;
+}
 
-    // Allocate memory for the measures
-    SafeMalloc(
-      measures->values,
-      sizeof(char**) * nbMeasure);
-    ForZeroTo(iMeasure, nbMeasure) measures->values[iMeasure] = NULL;
+// Aggregate the values of a metric of a project in a period of time in a
+// local database
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+// Output:
+//   Return the aggregated value
+// Raise:
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_SQLRequestFailed
+static double AggregateLocal(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate) {
+
+  // Check the metric, as an unknown label would be read as a string
+  CheckMetricLocal(
+    that,
+    project,
+    metric);
 
-    // Allocate memory for the values
-    ForZeroTo(iMeasure, nbMeasure) {
+  // Create the request, the period is read through the index on the
+  // date of the measures
+  StringCreate(
+    &(that->cmd),
+    "SELECT %s(\"%s\".\"%s\") FROM \"%s\" "
+    "WHERE DateMeasure >= %ld AND DateMeasure < %ld",
+    aggregateFnSql[fn],
+    project,
+    metric,
+    project,
+    (long)fromDate * USEC_PER_SEC,
+    (long)toDate * USEC_PER_SEC);
 
-      SafeMalloc(
-        measures->values[iMeasure],
-        sizeof(char*) * nbCol);
-      ForZeroTo(iMetric, measures->nbMetric)
-        measures->values[iMeasure][iMetric] = NULL;
+  // Prepare the request
+  sqlite3_stmt* stmt = NULL;
+  int retPrepare =
+    sqlite3_prepare_v2(
+      that->db,
+      that->cmd,
+      -1,
+      &stmt,
+      NULL);
+  if (retPrepare != SQLITE_OK) {
 
-    }
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(that->db));
+    Raise(RunRecorderExc_SQLRequestFailed);
 
-    // Extract the metrics label
-    ptr =
-      SplitCSVRowToData(
-        csv,
-        measures->metrics,
-        sep);
+  }
 
-    // Extract the measures
-    long iMeasure = 0;
-    while (*ptr != '\0') {
+  // Variable to memorise the aggregated value
+  double val = NAN;
 
-      ptr =
-        SplitCSVRowToData(
-          ptr,
-          measures->values[iMeasure],
-          sep);
-      ++iMeasure;
+  Try {
 
-    }
+    // Execute the request, it returns one single row
+    int retStep =
+      StepStmt(
+        that,
+        stmt);
+    if (retStep != SQLITE_ROW) Raise(RunRecorderExc_SQLRequestFailed);
+    val =
+      GetStmtColumnDouble(
+        stmt,
+        0);
 
   } CatchDefault {
 
-    PolyFree(&measures);
+    sqlite3_finalize(stmt);
     Raise(TryCatchGetLastExc());
 
   } EndCatch;
 
-  // Return the result struct RunRecorderMeasures
-  return measures;
+  // Release the request
+  sqlite3_finalize(stmt);
+
+  // Return the aggregated value
+  return val;
 
 }
 
-// Get the measures of a project through the Web API
+// Aggregate the values of a metric of a project in a period of time
+// through the Web API
 // Inputs:
-//         that: the struct RunRecorder
-//      project: the project's name
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
 // Output:
-//   Return the measures as a struct RunRecorderMeasures
-static struct RunRecorderMeasures* GetMeasuresAPI(
-  struct RunRecorder* const that,
-          char const* const project) {
+//   Return the aggregated value
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static double AggregateAPI(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate) {
 
   // Create the request to the Web API
   StringCreate(
     &(that->cmd),
-    "action=csv&project=%s",
-    project);
+    "action=aggregate&project=%s&metric=%s&fn=%s&from=%ld&to=%ld",
+    project,
+    metric,
+    aggregateFnStr[fn],
+    (long)fromDate,
+    (long)toDate);
   SetAPIReqPostVal(
     that,
     that->cmd);
 
   // Send the request to the API
-  bool isJsonReq = false;
+  bool isJsonReq = true;
   SendAPIReq(
     that,
     isJsonReq);
 
-  // Convert the CSV data into a struct RunRecorderMeasures
-  struct RunRecorderMeasures* data =
-    CSVToData(
+  // Extract the aggregated value from the JSON reply, it is empty if
+  // there is no measure in the period
+  char* valStr =
+    GetJSONValOfKey(
       that->curlReply,
-      CSV_SEP);
-
-  // Return the struct RunRecorderMeasures
-  return data;
+      "value");
+  if (valStr == NULL) Raise(RunRecorderExc_ApiRequestFailed);
+  double val = NAN;
+  StrToDouble(
+    valStr,
+    &val);
+  free(valStr);
+
+  // Return the aggregated value
+  return val;
 
 }
 
-// Get the most recent measures of a project from a local database
+// Aggregate the values of a metric of a project in a period of time, per
+// interval of time, in a local database
 // Inputs:
-//        that: the struct RunRecorder
-//     project: the project's name
-//   nbMeasure: the number of measures to be returned
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//   interval: the duration of the intervals in seconds
 // Output:
-//   Return the measures as a struct RunRecorderMeasures, ordered from the
-//   most recent to the oldest
+//   Return the aggregated values as a struct RunRecorderAggregates
 // Raise:
+//   RunRecorderExc_InvalidMetricLabel
 //   RunRecorderExc_SQLRequestFailed
-static struct RunRecorderMeasures* GetLastMeasuresLocal(
-  struct RunRecorder* const that,
-          char const* const project,
-                 long const nbMeasure) {
-
-  // Declate the struct RunRecorderMeasures to memorise the measures
-  struct RunRecorderMeasures* measures = NULL;
-
-  // Create the request with the requested limit
-  SetCmdToGetMeasuresLocal(
+static struct RunRecorderAggregates* AggregateByIntervalLocal(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate,
+                         long const interval) {
+
+  // Check the metric, as an unknown label would be read as a string
+  CheckMetricLocal(
     that,
     project,
-    nbMeasure);
+    metric);
 
-  // Execute the request
-  int retExec =
-    sqlite3_exec(
+  // Create the request, grouping the measures by the index of their
+  // interval since the Epoch
+  StringCreate(
+    &(that->cmd),
+    "SELECT DateMeasure / %ld AS Bucket, %s(\"%s\".\"%s\") "
+    "FROM \"%s\" "
+    "WHERE DateMeasure >= %ld AND DateMeasure < %ld "
+    "GROUP BY Bucket ORDER BY Bucket",
+    interval * USEC_PER_SEC,
+    aggregateFnSql[fn],
+    project,
+    metric,
+    project,
+    (long)fromDate * USEC_PER_SEC,
+    (long)toDate * USEC_PER_SEC);
+
+  // Prepare the request
+  sqlite3_stmt* stmt = NULL;
+  int retPrepare =
+    sqlite3_prepare_v2(
       that->db,
       that->cmd,
-      GetMeasuresLocalCb,
-      &measures,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_SQLRequestFailed);
+      -1,
+      &stmt,
+      NULL);
+  if (retPrepare != SQLITE_OK) {
+
+    SafeStrDup(
+      that->errMsg,
+      sqlite3_errmsg(that->db));
+    Raise(RunRecorderExc_SQLRequestFailed);
+
+  }
 
-  // If there is no measures GetMeasuresLocalCb won't get called and
-  // an empty struct RunRecorderMeasures needs to be allocated here
-  if (measures == NULL) measures = RunRecorderMeasuresCreate();
+  // Declare the struct RunRecorderAggregates to memorise the result
+  struct RunRecorderAggregates* aggregates = NULL;
+  Try {
 
-  // Return the measures
-  return measures;
+    // Allocate memory for the result
+    aggregates = RunRecorderAggregatesCreate();
+
+    // Execute the request and loop on the returned rows
+    int retStep =
+      StepStmt(
+        that,
+        stmt);
+    while (retStep == SQLITE_ROW) {
+
+      // Add the interval to the result
+      long bucket =
+        sqlite3_column_int64(
+          stmt,
+          0);
+      double val =
+        GetStmtColumnDouble(
+          stmt,
+          1);
+      AggregatesAdd(
+        aggregates,
+        (time_t)(bucket * interval),
+        val);
+
+      // Move to the next row
+      retStep =
+        StepStmt(
+          that,
+          stmt);
+
+    }
+    if (retStep != SQLITE_DONE) Raise(RunRecorderExc_SQLRequestFailed);
+
+  } CatchDefault {
+
+    sqlite3_finalize(stmt);
+    PolyFree(&aggregates);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Release the request
+  sqlite3_finalize(stmt);
+
+  // Return the result
+  return aggregates;
 
 }
 
-// Get the most recent measures of a project through the Web API
+// Aggregate the values of a metric of a project in a period of time, per
+// interval of time, through the Web API
 // Inputs:
-//        that: the struct RunRecorder
-//     project: the project's name
-//   nbMeasure: the number of measures to be returned
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//   interval: the duration of the intervals in seconds
 // Output:
-//   Return the measures as a struct RunRecorderMeasures, ordered from the
-//   most recent to the oldest
-static struct RunRecorderMeasures* GetLastMeasuresAPI(
-  struct RunRecorder* const that,
-          char const* const project,
-                 long const nbMeasure) {
+//   Return the aggregated values as a struct RunRecorderAggregates
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static struct RunRecorderAggregates* AggregateByIntervalAPI(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate,
+                         long const interval) {
 
   // Create the request to the Web API
   StringCreate(
     &(that->cmd),
-    "action=csv&project=%s&last=%ld",
+    "action=aggregate&project=%s&metric=%s&fn=%s&from=%ld&to=%ld"
+    "&interval=%ld",
     project,
-    nbMeasure);
+    metric,
+    aggregateFnStr[fn],
+    (long)fromDate,
+    (long)toDate,
+    interval);
   SetAPIReqPostVal(
     that,
     that->cmd);
 
   // Send the request to the API
-  bool isJsonReq = false;
+  bool isJsonReq = true;
   SendAPIReq(
     that,
     isJsonReq);
 
-  // Convert the CSV data into a struct RunRecorderMeasures
-  struct RunRecorderMeasures* data =
-    CSVToData(
-      that->curlReply,
-      CSV_SEP);
+  // Declare the struct RunRecorderAggregates to memorise the result, and
+  // the arrays of dates and values in the JSON reply
+  struct RunRecorderAggregates* aggregates = NULL;
+  char* dates = NULL;
+  char* values = NULL;
+  Try {
 
-  // Return the struct RunRecorderMeasures
-  return data;
+    // Extract the arrays of dates and values from the JSON reply
+    dates =
+      GetJSONValOfKey(
+        that->curlReply,
+        "dates");
+    values =
+      GetJSONValOfKey(
+        that->curlReply,
+        "values");
+    if (dates == NULL || values == NULL)
+      Raise(RunRecorderExc_ApiRequestFailed);
+
+    // Loop on the elements of the arrays, they are both of the form
+    // "e1","e2",... and contain numbers, so they can be split on the commas
+    aggregates = RunRecorderAggregatesCreate();
+    char* date = dates;
+    char* val = values;
+    while (*date != '\0' && *val != '\0') {
+
+      // Terminate the current elements and get the next ones
+      char* nextDate =
+        strchr(
+          date,
+          ',');
+      if (nextDate != NULL) *(nextDate++) = '\0';
+      char* nextVal =
+        strchr(
+          val,
+          ',');
+      if (nextVal != NULL) *(nextVal++) = '\0';
+
+      // Remove the double quotes around the elements
+      if (*date == '"') date[strlen(date) - 1] = '\0';
+      if (*val == '"') val[strlen(val) - 1] = '\0';
+
+      // Convert the elements and add them to the result
+      long dateInterval = 0;
+      bool isDate =
+        StrToLong(
+          date + (*date == '"' ? 1 : 0),
+          &dateInterval);
+      if (isDate == false) Raise(RunRecorderExc_ApiRequestFailed);
+      double aggregate = NAN;
+      StrToDouble(
+        val + (*val == '"' ? 1 : 0),
+        &aggregate);
+      AggregatesAdd(
+        aggregates,
+        (time_t)dateInterval,
+        aggregate);
+
+      // Move to the next elements
+      date = (nextDate != NULL ? nextDate : date + strlen(date));
+      val = (nextVal != NULL ? nextVal : val + strlen(val));
+
+    }
+
+    // If the arrays don't have the same length, the reply is invalid
+    if (*date != '\0' || *val != '\0')
+      Raise(RunRecorderExc_ApiRequestFailed);
+
+  } CatchDefault {
+
+    free(dates);
+    free(values);
+    PolyFree(&aggregates);
+    Raise(TryCatchGetLastExc());
+
+  } EndCatch;
+
+  // Free memory
+  free(dates);
+  free(values);
+
+  // Return the result
+  return aggregates;
 
 }
 
-// Create a struct RunRecorderMeasures
+// Create a struct RunRecorderAggregates
 // Output:
-//   Return the dynamically allocated struct RunRecorderMeasures
-static struct RunRecorderMeasures* RunRecorderMeasuresCreate(
+//   Return the dynamically allocated struct RunRecorderAggregates
+static struct RunRecorderAggregates* RunRecorderAggregatesCreate(
   void) {
 
-  // Declare the new struct RunRecorderMeasures
-  struct RunRecorderMeasures* that = NULL;
+  // Declare the new struct RunRecorderAggregates
+  struct RunRecorderAggregates* that = NULL;
   SafeMalloc(
     that,
-    sizeof(struct RunRecorderMeasures));
+    sizeof(struct RunRecorderAggregates));
 
   // Init properties
-  that->nbMetric = 0;
-  that->nbMeasure = 0;
-  that->metrics = NULL;
+  that->nb = 0;
+  that->dates = NULL;
   that->values = NULL;
+  that->capacity = 0;
 
-  // Return the new struct RunRecorderMeasures
+  // Return the new struct RunRecorderAggregates
   return that;
 
 }
 
+// Add an interval at the end of a struct RunRecorderAggregates. The
+// capacity is doubled when it is reached.
+// Inputs:
+//    that: the struct RunRecorderAggregates
+//    date: the start date of the interval
+//     val: the aggregated value of the interval
+// Raise:
+//   TryCatchExc_MallocFailed
+static void AggregatesAdd(
+  struct RunRecorderAggregates* const that,
+                         time_t const date,
+                         double const val) {
+
+  // If the capacity is reached, double it
+  if (that->nb >= that->capacity) {
+
+    long capacity = that->capacity * 2;
+    if (capacity < NB_MIN_MEASURE_ALLOC) capacity = NB_MIN_MEASURE_ALLOC;
+    SafeRealloc(
+      that->dates,
+      sizeof(time_t) * capacity);
+    SafeRealloc(
+      that->values,
+      sizeof(double) * capacity);
+    that->capacity = capacity;
+
+  }
+
+  // Add the interval
+  that->dates[that->nb] = date;
+  that->values[that->nb] = val;
+  ++(that->nb);
+
+}
+
+// Get a column of the current row of a SQL request as a double
+// Inputs:
+//   stmt: the SQL request
+//   iCol: the index of the column
+// Output:
+//   Return the value, or NAN if it's not a number
+static double GetStmtColumnDouble(
+  sqlite3_stmt* const stmt,
+            int const iCol) {
+
+  // Get the type of the value
+  int type =
+    sqlite3_column_type(
+      stmt,
+      iCol);
+
+  // If the value is a number, return it
+  if (type == SQLITE_INTEGER || type == SQLITE_FLOAT)
+    return
+      sqlite3_column_double(
+        stmt,
+        iCol);
+
+  // Else, try to convert it from its string, null values are not numbers
+  double val = NAN;
+  StrToDouble(
+    (char const*)sqlite3_column_text(
+      stmt,
+      iCol),
+    &val);
+
+  // Return the value
+  return val;
+
+}
+
 // Remove a project from a local database
 // Inputs:
 //         that: the struct RunRecorder
@@ -4064,16 +14357,48 @@ static void FlushProjectLocal(
   struct RunRecorder* const that,
           char const* const project) {
 
-  // Create the SQL command to delete values
+  // Commands to delete values, measures and metrics of the project
+  #define NB_FLUSH_STMT 3
+  enum RunRecorderStmt const flushStmts[NB_FLUSH_STMT] = {
+
+    RunRecorderStmt_flushValues,
+    RunRecorderStmt_flushMeasures,
+    RunRecorderStmt_flushMetrics
+
+  };
+
+  // Loop on the commands
+  ForZeroTo(iStmt, NB_FLUSH_STMT) {
+
+    // Prepare the command
+    sqlite3_stmt* stmt =
+      GetStmt(
+        that,
+        flushStmts[iStmt]);
+    BindStmtText(
+      that,
+      stmt,
+      1,
+      project);
+
+    // Execute the command
+    int retStep =
+      StepStmt(
+        that,
+        stmt);
+    if (retStep != SQLITE_DONE) Raise(RunRecorderExc_FlushProjectFailed);
+
+  }
+
+  // Create the SQL command to delete the view and the eventual
+  // materialized table
   StringCreate(
     &(that->cmd),
-    "DELETE FROM _Value WHERE RefMeasure IN "
-    "(SELECT _Measure.Ref FROM _Measure, _Project "
-    "WHERE _Measure.RefProject = _Project.Ref "
-    "AND _Project.Label = \"%s\")",
+    "DROP VIEW \"%s\";DROP TABLE IF EXISTS \"" MATERIALIZED_PREFIX "%s\"",
+    project,
     project);
 
-  // Execute the command to delete values
+  // Execute the command to delete the view
   int retExec =
     sqlite3_exec(
       that->db,
@@ -4083,91 +14408,120 @@ static void FlushProjectLocal(
       &(that->sqliteErrMsg));
   if (retExec != SQLITE_OK) Raise(RunRecorderExc_FlushProjectFailed);
 
-  // Create the SQL command to delete measures
-  StringCreate(
-    &(that->cmd),
-    "DELETE FROM _Measure WHERE Ref IN "
-    "(SELECT _Measure.Ref FROM _Measure, _Project "
-    "WHERE _Measure.RefProject = _Project.Ref "
-    "AND _Project.Label = \"%s\")",
+  // Prepare the SQL command to delete the project
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_flushProject);
+  BindStmtText(
+    that,
+    stmt,
+    1,
     project);
 
-  // Execute the command to delete measures
-  retExec =
-    sqlite3_exec(
-      that->db,
-      that->cmd,
-      NULL,
-      NULL,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_FlushProjectFailed);
+  // Execute the command to delete the project
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_DONE) Raise(RunRecorderExc_FlushProjectFailed);
 
-  // Create the SQL command to delete metrics
-  StringCreate(
-    &(that->cmd),
-    "DELETE FROM _Metric WHERE RefProject = "
-    "(SELECT Ref FROM _Project "
-    "WHERE _Project.Label = \"%s\")",
-    project);
+}
 
-  // Execute the command to delete metrics
-  retExec =
-    sqlite3_exec(
-      that->db,
-      that->cmd,
-      NULL,
-      NULL,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_FlushProjectFailed);
+// Remove a project through the Web API
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project's name
+static void FlushProjectAPI(
+  struct RunRecorder* const that,
+          char const* const project) {
 
-  // Create the SQL command to delete the view
+  // Create the request to the Web API
   StringCreate(
     &(that->cmd),
-    "DROP VIEW \"%s\"",
+    "action=flush&project=%s",
     project);
+  SetAPIReqPostVal(
+    that,
+    that->cmd);
 
-  // Execute the command to delete the view
-  retExec =
-    sqlite3_exec(
-      that->db,
-      that->cmd,
-      NULL,
-      NULL,
-      &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_FlushProjectFailed);
+  // Send the request to the API
+  bool isJsonReq = true;
+  SendAPIReq(
+    that,
+    isJsonReq);
+
+}
+
+// Release free pages of a local database
+// Inputs:
+//     that: the struct RunRecorder
+//   budget: the maximum number of pages to release, if <= 0 all the
+//           free pages are released
+// Output:
+//   Return the number of free pages remaining after the call
+// Raise:
+//   RunRecorderExc_CompactFailed
+static long CompactLocal(
+  struct RunRecorder* const that,
+                 long const budget) {
 
-  // Create the SQL command to delete the project
+  // Release the pages. The pragma doesn't accept bound parameters, and
+  // the budget is normalised to avoid the unlimited default of 0
   StringCreate(
     &(that->cmd),
-    "DELETE FROM _Project "
-    "WHERE _Project.Label = \"%s\"",
-    project);
-
-  // Execute the command to delete the project
-  retExec =
+    "PRAGMA incremental_vacuum(%ld)",
+    (budget > 0 ? budget : -1));
+  int retExec =
     sqlite3_exec(
       that->db,
       that->cmd,
       NULL,
       NULL,
       &(that->sqliteErrMsg));
-  if (retExec != SQLITE_OK) Raise(RunRecorderExc_FlushProjectFailed);
+  if (retExec != SQLITE_OK) Raise(RunRecorderExc_CompactFailed);
+
+  // Get the number of remaining free pages
+  sqlite3_stmt* stmt =
+    GetStmt(
+      that,
+      RunRecorderStmt_getFreePages);
+  int retStep =
+    StepStmt(
+      that,
+      stmt);
+  if (retStep != SQLITE_ROW) Raise(RunRecorderExc_CompactFailed);
+  long nbFreePage =
+    sqlite3_column_int64(
+      stmt,
+      0);
+
+  // Release the statement
+  sqlite3_reset(stmt);
+
+  // Return the number of remaining free pages
+  return nbFreePage;
 
 }
 
-// Remove a project through the Web API
+// Release free pages of the database through the Web API
 // Inputs:
-//         that: the struct RunRecorder
-//      project: the project's name
-static void FlushProjectAPI(
+//     that: the struct RunRecorder
+//   budget: the maximum number of pages to release, if <= 0 all the
+//           free pages are released
+// Output:
+//   Return the number of free pages remaining after the call
+// Raise:
+//   RunRecorderExc_ApiRequestFailed
+static long CompactAPI(
   struct RunRecorder* const that,
-          char const* const project) {
+                 long const budget) {
 
   // Create the request to the Web API
   StringCreate(
     &(that->cmd),
-    "action=flush&project=%s",
-    project);
+    "action=compact&budget=%ld",
+    budget);
   SetAPIReqPostVal(
     that,
     that->cmd);
@@ -4178,6 +14532,26 @@ static void FlushProjectAPI(
     that,
     isJsonReq);
 
+  // Extract the number of remaining free pages from the JSON reply
+  char* nbFreePageStr =
+    GetJSONValOfKey(
+      that->curlReply,
+      "nbFreePage");
+  long nbFreePage = 0;
+  if (nbFreePageStr != NULL) {
+
+    nbFreePage =
+      strtol(
+        nbFreePageStr,
+        NULL,
+        10);
+    free(nbFreePageStr);
+
+  }
+
+  // Return the number of remaining free pages
+  return nbFreePage;
+
 }
 
 // Function to convert a RunRecorder exception ID to char*
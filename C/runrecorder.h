@@ -14,6 +14,7 @@
 #include <time.h>
 #include <SQLite3/sqlite3.h>
 #include <curl/curl.h>
+#include <pthread.h>
 #include <errno.h>
 #include <TryCatchC/trycatchc.h>
 
@@ -41,12 +42,194 @@ enum RunRecorderException {
   RunRecorderExc_MetricNameAlreadyUsed,
   RunRecorderExc_AddMeasureFailed,
   RunRecorderExc_DeleteMeasureFailed,
+  RunRecorderExc_SessionFailed,
+  RunRecorderExc_UpgradeDbFailed,
+  RunRecorderExc_MaterializeFailed,
+  RunRecorderExc_CompactFailed,
+  RunRecorderExc_RetentionFailed,
+  RunRecorderExc_InvalidMetricType,
+  RunRecorderExc_InvalidAggregate,
+  RunRecorderExc_AsyncFailed,
+  RunRecorderExc_AsyncQueueFull,
+  RunRecorderExc_SpoolFailed,
+  RunRecorderExc_PoolFailed,
   RunRecorderExc_LastID
 
 };
 
+// ================== Prepared statements =========================
+
+// Identifiers of the fixed-shape SQL statements prepared once and cached
+// in a struct RunRecorder using a local database
+enum RunRecorderStmt {
+
+  RunRecorderStmt_getVersion,
+  RunRecorderStmt_addProject,
+  RunRecorderStmt_getProjectRef,
+  RunRecorderStmt_isMaterialized,
+  RunRecorderStmt_setMaterialized,
+  RunRecorderStmt_getMaterializedOfMeasure,
+  RunRecorderStmt_getProjects,
+  RunRecorderStmt_getMetrics,
+  RunRecorderStmt_addMetric,
+  RunRecorderStmt_addMeasure,
+  RunRecorderStmt_addValue,
+  RunRecorderStmt_deleteValues,
+  RunRecorderStmt_deleteMeasure,
+  RunRecorderStmt_deleteValuesByRef,
+  RunRecorderStmt_deleteMeasuresByRef,
+  RunRecorderStmt_deleteValuesByDate,
+  RunRecorderStmt_deleteMeasuresByDate,
+  RunRecorderStmt_getMaterializedProjects,
+  RunRecorderStmt_setRetention,
+  RunRecorderStmt_getRetentionProjects,
+  RunRecorderStmt_getRetention,
+  RunRecorderStmt_getNthLastMeasure,
+  RunRecorderStmt_getExpiredMeasures,
+  RunRecorderStmt_flushValues,
+  RunRecorderStmt_flushMeasures,
+  RunRecorderStmt_flushMetrics,
+  RunRecorderStmt_flushProject,
+  RunRecorderStmt_begin,
+  RunRecorderStmt_commit,
+  RunRecorderStmt_rollback,
+  RunRecorderStmt_getFreePages,
+  RunRecorderStmt_nb
+
+};
+
+// ================== Metric types =========================
+
+// Types of the values of a metric. The values of numeric metrics are
+// stored as native SQLite INTEGER or REAL, those of text metrics as TEXT.
+enum RunRecorderMetricType {
+
+  RunRecorderMetricType_text,
+  RunRecorderMetricType_int,
+  RunRecorderMetricType_double,
+  RunRecorderMetricType_nb
+
+};
+
+// ================== Aggregate functions =========================
+
+// Functions to aggregate the values of a metric, executed by the database
+enum RunRecorderAggregateFn {
+
+  RunRecorderAggregateFn_min,
+  RunRecorderAggregateFn_max,
+  RunRecorderAggregateFn_mean,
+  RunRecorderAggregateFn_sum,
+  RunRecorderAggregateFn_count,
+  RunRecorderAggregateFn_nb
+
+};
+
+// ================== Options of the local database =========================
+
+// Journal modes of a local database, RunRecorderJournalMode_default keeps
+// the default of SQLite (delete). In WAL mode the readers don't block the
+// writer and the writer doesn't block the readers.
+enum RunRecorderJournalMode {
+
+  RunRecorderJournalMode_default,
+  RunRecorderJournalMode_delete,
+  RunRecorderJournalMode_truncate,
+  RunRecorderJournalMode_wal,
+  RunRecorderJournalMode_nb
+
+};
+
+// Synchronous levels of a local database, RunRecorderSynchronous_default
+// keeps the default of SQLite (full). In WAL mode, the normal level is
+// safe against corruption and doesn't sync at each commit.
+enum RunRecorderSynchronous {
+
+  RunRecorderSynchronous_default,
+  RunRecorderSynchronous_off,
+  RunRecorderSynchronous_normal,
+  RunRecorderSynchronous_full,
+  RunRecorderSynchronous_nb
+
+};
+
+// ================== Asynchronous writing =========================
+
+// Policies applied when a measure is added while the queue of the
+// asynchronous writer is full
+enum RunRecorderAsyncPolicy {
+
+  // Wait until the writer thread has made room in the queue
+  RunRecorderAsyncPolicy_block,
+
+  // Drop the oldest measures in the queue to make room
+  RunRecorderAsyncPolicy_dropOldest,
+
+  // Raise RunRecorderExc_AsyncQueueFull without adding the measures
+  RunRecorderAsyncPolicy_fail,
+  RunRecorderAsyncPolicy_nb
+
+};
+
+// ================== Spool =========================
+
+// Modes of the spool of the measures added through the Web API
+enum RunRecorderSpoolMode {
+
+  // The measures are spooled only when the Web API can't be reached
+  RunRecorderSpoolMode_onFailure,
+
+  // All the measures are spooled, and forwarded in background
+  RunRecorderSpoolMode_always,
+  RunRecorderSpoolMode_nb
+
+};
+
 // ================== Structures definitions =========================
 
+// Numeric value of a measure, the member in use depends on the
+// enum RunRecorderMetricType associated to the value
+union RunRecorderNumVal {
+
+  // Value of a RunRecorderMetricType_int
+  long i;
+
+  // Value of a RunRecorderMetricType_double
+  double d;
+
+};
+
+// Options of the connection to a local database, applied by
+// RunRecorderInit. The sizes equal to 0 keep the default of SQLite.
+struct RunRecorderOptions {
+
+  // Journal mode
+  enum RunRecorderJournalMode journalMode;
+
+  // Synchronous level
+  enum RunRecorderSynchronous synchronous;
+
+  // Size of the page cache, in KiB
+  long cacheSize;
+
+  // Maximum size of the database file mapped in memory, in bytes
+  long mmapSize;
+
+  // Size of the pages, in bytes (power of 2 between 512 and 65536). Only
+  // applied when the database is created.
+  long pageSize;
+
+  // Maximum time, in milliseconds, to wait for the lock of the database
+  // held by another connection before failing, 0 to fail immediately
+  long busyTimeout;
+
+  // Maximum delay, in milliseconds, between two attempts to get the lock.
+  // The delay doubles from 1ms after each attempt up to this value, with
+  // a random jitter to spread the attempts of concurrent connections.
+  long busyBackoff;
+
+};
+
 // Structure of a RunRecorder
 struct RunRecorder {
 
@@ -66,6 +249,10 @@ struct RunRecorder {
   // Connection to the database if it's a local file
   sqlite3* db;
 
+  // Options of the connection to the local database, to be set before
+  // RunRecorderInit
+  struct RunRecorderOptions options;
+
   // Curl instance if we use the Web API
   CURL* curl;
 
@@ -75,9 +262,47 @@ struct RunRecorder {
   // String to memorise the API or SQL commands
   char* cmd;
 
+  // Cache of prepared statements, prepared at their first use and
+  // finalized when the struct RunRecorder is freed
+  sqlite3_stmt* stmts[RunRecorderStmt_nb];
+
   // Reference of the last added measure
   long refLastAddedMeasure;
 
+  // Flag to memorise if a session is opened, i.e. if the added measures
+  // are currently grouped into one single transaction
+  bool isInSession;
+
+  // Delays in seconds before the first TCP keep-alive probe on the idle
+  // connection to the Web API (0 if disabled), and between probes
+  long keepAliveIdle;
+  long keepAliveInterval;
+
+  // Asynchronous writer of the added measures, NULL if the measures are
+  // written synchronously
+  struct RunRecorderAsync* async;
+
+  // Spool of the measures added through the Web API, NULL if the
+  // measures are not spooled
+  struct RunRecorderSpool* spool;
+
+  // Reference in the spool of the last added measure if it has been
+  // spooled, else 0
+  long refLastSpooledMeasure;
+
+  // Time, in microseconds of the monotonic clock, when the connection to
+  // the local database started to wait for a lock held by another
+  // connection
+  long dateBusy;
+
+  // Number of attempts to get a lock held by another connection since
+  // the creation of the struct RunRecorder
+  long nbBusyRetry;
+
+  // Pool the struct RunRecorder belongs to, NULL if it doesn't belong to
+  // a pool
+  struct RunRecorderPool* pool;
+
 };
 
 // Structure to memorise pairs of ref/value
@@ -109,6 +334,9 @@ struct RunRecorderRefValDef {
   // Array of default value as string
   char** defaultValues;
 
+  // Array of type of the values
+  enum RunRecorderMetricType* types;
+
 };
 
 // Structure to add one measurement (i.e. a set of metrics and their
@@ -124,6 +352,32 @@ struct RunRecorderMeasure {
   // Array of values as string
   char** values;
 
+  // Array of types of the values, RunRecorderMetricType_text if the value
+  // was added as a string
+  enum RunRecorderMetricType* types;
+
+  // Array of numeric values, used according to types
+  union RunRecorderNumVal* nums;
+
+};
+
+// Structure to memorise a block of memory used to store the strings of
+// a struct RunRecorderMeasures, blocks are chained to avoid one allocation
+// per string
+struct RunRecorderArenaBlock {
+
+  // Next block in the chain
+  struct RunRecorderArenaBlock* next;
+
+  // Size in byte of the data of the block
+  size_t size;
+
+  // Number of bytes of the data of the block already used
+  size_t len;
+
+  // Data of the block
+  char data[];
+
 };
 
 // Structure to memorise the measures of one project
@@ -135,13 +389,325 @@ struct RunRecorderMeasures {
   // Number of metrics
   long nbMetric;
 
-  // Array of metrics label
+  // Array of metrics label. The first two columns are 'Ref', the
+  // reference of the measure, and 'DateMeasure', the date of the measure
+  // as the number of microseconds since the Epoch (UTC)
   char** metrics;
 
   // Array of array of values as string, to be used as
   // values[iMeasure][iMetric]
   char*** values;
 
+  // Number of measures which can be stored before values and cells
+  // need to be reallocated
+  long capacity;
+
+  // Array of nbMetric * capacity values as string, values[iMeasure]
+  // points to cells[iMeasure * nbMetric]
+  char** cells;
+
+  // Arrays of nbMetric * capacity types and numeric values of the
+  // cells. The type is RunRecorderMetricType_text when only the string is
+  // available (e.g. through the Web API), the numeric value is then
+  // parsed from the string by the accessors.
+  enum RunRecorderMetricType* types;
+  union RunRecorderNumVal* nums;
+
+  // Blocks of memory where the labels of metrics and values are stored
+  struct RunRecorderArenaBlock* arena;
+
+};
+
+// Structure to memorise the values of one metric in a struct
+// RunRecorderColumns, as one contiguous array of the type of the metric
+struct RunRecorderColumn {
+
+  // Label of the metric
+  char* label;
+
+  // Type of the values. 'Ref' and 'DateMeasure' are
+  // RunRecorderMetricType_int
+  enum RunRecorderMetricType type;
+
+  // Values of a RunRecorderMetricType_int column, NULL for other types
+  long* ints;
+
+  // Values of a RunRecorderMetricType_double column, NULL for other types
+  double* doubles;
+
+  // Values of a RunRecorderMetricType_text column as indices in dict,
+  // NULL for other types
+  long* codes;
+
+  // Validity bitmap of the values, the value of the iMeasure-th measure
+  // is valid if the bit (iMeasure % 8) of validity[iMeasure / 8] is set.
+  // Invalid values (null or not a number of the column's type) are set
+  // to 0, or -1 in codes
+  unsigned char* validity;
+
+  // Number of distinct values of a RunRecorderMetricType_text column, and
+  // the values as string
+  long nbDict;
+  char** dict;
+
+  // Hash table of the indices in dict, used to find the index of a string
+  // while the column is filled
+  long sizeHash;
+  long* hash;
+
+};
+
+// Structure to memorise the measures of one project by column, to be
+// used for numeric analysis
+struct RunRecorderColumns {
+
+  // Number of measures
+  long nbMeasure;
+
+  // Number of metrics
+  long nbMetric;
+
+  // Array of columns, one per metric, in the same order as the metrics of
+  // a struct RunRecorderMeasures
+  struct RunRecorderColumn* columns;
+
+  // Number of measures which can be stored before the columns need to be
+  // reallocated
+  long capacity;
+
+  // Blocks of memory where the labels of metrics and the strings of the
+  // dictionaries are stored
+  struct RunRecorderArenaBlock* arena;
+
+};
+
+// Structure to memorise the aggregated values of a metric per interval
+// of time
+struct RunRecorderAggregates {
+
+  // Number of intervals. The intervals without measure are omitted
+  long nb;
+
+  // Array of start dates of the intervals, in seconds since the Epoch
+  time_t* dates;
+
+  // Array of aggregated values, NAN if the aggregated values are not
+  // numbers
+  double* values;
+
+  // Number of intervals which can be stored before dates and values
+  // need to be reallocated
+  long capacity;
+
+};
+
+// Structure to memorise the asynchronous writer of a struct RunRecorder.
+// The added measures are queued in a ring buffer and written by a
+// dedicated thread through its own connection to the database or Web API
+struct RunRecorderAsync {
+
+  // The struct RunRecorder used by the writer thread
+  struct RunRecorder* writer;
+
+  // Policy when the queue is full
+  enum RunRecorderAsyncPolicy policy;
+
+  // Ring buffer of the queued measures and the label of their project,
+  // owned by the queue
+  char** projects;
+  struct RunRecorderMeasure** measures;
+
+  // Dates of the queued measures, in microseconds since the Epoch, taken
+  // when they're queued
+  long* dates;
+
+  // Size of the ring buffer, index of the oldest queued measure and
+  // number of queued measures
+  long capacity;
+  long head;
+  long nb;
+
+  // Number of measures taken from the queue and being written
+  long nbWriting;
+
+  // Number of measures dropped by RunRecorderAsyncPolicy_dropOldest
+  long nbDropped;
+
+  // Reference of the last measure written by the writer thread
+  long refLastAddedMeasure;
+
+  // Flag and error message of the writer thread if a batch failed since
+  // the last RunRecorderFlush
+  bool hasFailed;
+  char* errMsg;
+
+  // Flag to request the writer thread to end once the queue is empty
+  bool isStopping;
+
+  // The writer thread and the flag to memorise if it is running
+  pthread_t thread;
+  bool isRunning;
+
+  // Lock on the queue and the properties above, condition signaled when
+  // measures are queued, and condition signaled when measures are taken
+  // from the queue or have been written
+  pthread_mutex_t lock;
+  pthread_cond_t condQueued;
+  pthread_cond_t condWritten;
+
+};
+
+// Structure to memorise the spool of a struct RunRecorder. The measures
+// which can't be sent to the Web API (or all of them) are stored in a
+// local SQLite database, and a dedicated thread forwards them to the Web
+// API by batches, retrying with an exponential backoff
+struct RunRecorderSpool {
+
+  // Connections to the spool database of the thread adding the measures
+  // and of the forwarder thread
+  sqlite3* db;
+  sqlite3* dbForwarder;
+
+  // Prepared statement to add a measure in the spool
+  sqlite3_stmt* insert;
+
+  // The struct RunRecorder used by the forwarder thread
+  struct RunRecorder* forwarder;
+
+  // Mode of the spool
+  enum RunRecorderSpoolMode mode;
+
+  // Number of spooled measures not yet forwarded
+  long nbPending;
+
+  // Delay in seconds before retrying to forward the measures after a
+  // failure (0 if the last attempt succeeded), and date of the retry
+  long backoff;
+  time_t dateRetry;
+
+  // Number of consecutive rejections by the Web API of the batch of
+  // measures starting with the spooled measure refRejected
+  long nbRejection;
+  long refRejected;
+
+  // Flag to request the forwarder thread to end
+  bool isStopping;
+
+  // The forwarder thread and the flag to memorise if it is running
+  pthread_t thread;
+  bool isRunning;
+
+  // Lock on the properties above and condition signaled when measures
+  // are spooled
+  pthread_mutex_t lock;
+  pthread_cond_t condSpooled;
+
+};
+
+// Structure to memorise a pool of struct RunRecorder using the same
+// database or Web API, one per thread. Each thread gets its own
+// connection, buffers and error state, so the threads record without
+// locking each other.
+struct RunRecorderPool {
+
+  // Path to the SQLite database or Web API
+  char* url;
+
+  // Options of the connections to the local database
+  struct RunRecorderOptions options;
+
+  // Key of the struct RunRecorder of the calling thread
+  pthread_key_t key;
+
+  // All the struct RunRecorder of the pool, the idle ones (not used by
+  // any thread), their numbers, and the size of the arrays
+  struct RunRecorder** recorders;
+  struct RunRecorder** idles;
+  long nbRecorder;
+  long nbIdle;
+  long capacity;
+
+  // Flag to memorise if the database has been checked, and upgraded if
+  // necessary, by the first struct RunRecorder of the pool
+  bool isInit;
+
+  // Lock on the properties above
+  pthread_mutex_t lock;
+
+};
+
+// Structure to memorise a handle on a project. It caches the reference of
+// the project and the references of its metrics, to avoid looking them up
+// by label for each request
+struct RunRecorderProject {
+
+  // The struct RunRecorder used to access the project
+  struct RunRecorder* recorder;
+
+  // Label of the project
+  char* label;
+
+  // Reference of the project
+  long ref;
+
+  // Metrics of the project sorted by label, only used with a local
+  // database (NULL when using the Web API)
+  struct RunRecorderRefValDef* metrics;
+
+  // Flag to memorise if the project has a materialized table
+  bool isMaterialized;
+
+  // Prepared statement to insert a measure in the materialized table,
+  // prepared at its first use and finalized when the metrics are
+  // reloaded or the handle is freed
+  sqlite3_stmt* insertMaterialized;
+
+};
+
+// Structure to memorise a cursor on the measures of a project. The
+// measures are read one at a time, so the memory used by the cursor
+// doesn't depend on the number of measures
+struct RunRecorderMeasuresCursor {
+
+  // The struct RunRecorder used to read the measures. With the Web API,
+  // it can't be used for other requests until the cursor is closed
+  struct RunRecorder* recorder;
+
+  // Number of metrics
+  long nbMetric;
+
+  // Array of metrics label, same as in struct RunRecorderMeasures
+  char** metrics;
+
+  // Array of values as string of the current measure, to be used as
+  // values[iMetric]. They're overwritten by the next call to
+  // RunRecorderMeasuresCursorNext
+  char const** values;
+
+  // Prepared statement reading the measures, only used with a local
+  // database
+  sqlite3_stmt* stmt;
+
+  // Curl multi handle running the request, only used with the Web API
+  CURLM* curlMulti;
+
+  // Buffer of the data received from the Web API, the rows before
+  // posBuffer have already been read
+  char* buffer;
+
+  // Size of the allocated buffer, length of the received data in it and
+  // position of the next row
+  size_t sizeBuffer;
+  size_t lenBuffer;
+  size_t posBuffer;
+
+  // Flag to memorise if the transfer is paused until the received rows
+  // have been read
+  bool isPaused;
+
+  // Flag to memorise if the transfer is completed
+  bool isTransferDone;
+
 };
 
 // ================== Public functions declarations =========================
@@ -162,6 +728,24 @@ struct RunRecorder RunRecorderCreate(
 struct RunRecorder* RunRecorderAlloc(
   char const* const url);
 
+// Allocate memory for a struct RunRecorder with given options for the
+// connection to a local database
+// Inputs:
+//       url: Path to the SQLite database or Web API
+//   options: the options
+// Output:
+//  Return a new struct RunRecorder
+struct RunRecorder* RunRecorderAllocWithOptions(
+                 char const* const url,
+  struct RunRecorderOptions const* const options);
+
+// Create a struct RunRecorderOptions with the default of SQLite for all
+// the options, except the busy timeout (5s) and backoff (100ms)
+// Output:
+//  Return a new struct RunRecorderOptions
+struct RunRecorderOptions RunRecorderOptionsCreate(
+  void);
+
 // Initialise a struct RunRecorder
 // Input:
 //   that: The struct RunRecorder
@@ -174,6 +758,22 @@ void RunRecorderInit(
 void RunRecorderFree(
   struct RunRecorder** const that);
 
+// Set the TCP keep-alive of the connection to the Web API. Probes are
+// sent on the idle connection to keep it open between requests (by
+// default after 60s, then every 30s). Can be called before or after
+// RunRecorderInit, has no effect on a local database.
+// Inputs:
+//       that: the struct RunRecorder
+//       idle: the delay in seconds before the first probe, 0 to disable
+//             the probes
+//   interval: the delay in seconds between probes
+// Raise:
+//   RunRecorderExc_CurlSetOptFailed
+void RunRecorderSetKeepAlive(
+  struct RunRecorder* const that,
+                 long const idle,
+                 long const interval);
+
 // Get the version of the database
 // Input:
 //   that: the struct RunRecorder
@@ -237,8 +837,9 @@ struct RunRecorderRefValDef* RunRecorderGetMetrics(
 //        label: the label of the metric, it must respect the following
 //               pattern: /^[a-zA-Z][a-zA-Z0-9_]*$/
 //               There cannot be two metrics with the same label for the
-//               same project. A metric label can't be 'action' or 'project'
-//               (case sensitive, so 'Action' is fine).
+//               same project. A metric label can't be 'action',
+//               'project' or 'DateMeasure' (case sensitive, so 'Action' is
+//               fine).
 //   defaultVal: the default value of the metric, it must respect the
 //               following pattern: /^[^"=&]+$*/
 // Raise:
@@ -250,6 +851,33 @@ void RunRecorderAddMetric(
           char const* const label,
           char const* const defaultVal);
 
+// Add a metric with a given type to a project. The values of numeric
+// metrics are stored as native SQLite INTEGER or REAL, RunRecorderAddMetric
+// adds a RunRecorderMetricType_text metric. A value which is not a number,
+// or not an integer for a RunRecorderMetricType_int metric, is not saved
+// and RunRecorderAddMeasure raises RunRecorderExc_AddMeasureFailed after
+// saving the other values of the measure.
+// Input:
+//         that: the struct RunRecorder
+//      project: the name of the project to which add to the metric
+//        label: the label of the metric, same constraints as for
+//               RunRecorderAddMetric
+//   defaultVal: the default value of the metric, same constraints as for
+//               RunRecorderAddMetric, and it must be a number if the
+//               metric is numeric
+//         type: the type of the values of the metric
+// Raise:
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_InvalidMetricDefVal
+//   RunRecorderExc_InvalidMetricType
+//   RunRecorderExc_MetricNameAlreadyUsed
+void RunRecorderAddTypedMetric(
+             struct RunRecorder* const that,
+                     char const* const project,
+                     char const* const label,
+                     char const* const defaultVal,
+  enum RunRecorderMetricType const type);
+
 // Create a new struct RunRecorderMeasure
 // Output:
 //   Return the new struct RunRecorderMeasure
@@ -287,7 +915,9 @@ void RunRecorderMeasureAddValueInt(
                         long const val);
 
 // Add a double value to a struct RunRecorderMeasure if there is not yet a
-// value for the metric, or replace its value else
+// value for the metric, or replace its value else. The value is kept as
+// it is for numeric metrics, and converted to a string with enough digits
+// to convert back exactly for text metrics and the Web API.
 // Input:
 //     that: the struct RunRecorderMeasure
 //   metric: the value's metric
@@ -307,6 +937,182 @@ void RunRecorderAddMeasure(
                        char const* const project,
   struct RunRecorderMeasure const* const measure);
 
+// Add several measures to a project. The measures are written in one
+// single transaction (or in the current session if there is one). The
+// policy is to save as much as possible: if a measure fails the remaining
+// ones are still added and the exception is raised at the end.
+// Inputs:
+//         that: the struct RunRecorder
+//      project: the project to add the measures to
+//     measures: the measures to add
+//    nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SessionFailed
+//   RunRecorderExc_AsyncQueueFull
+//   RunRecorderExc_SpoolFailed
+void RunRecorderAddMeasures(
+               struct RunRecorder* const that,
+                       char const* const project,
+  struct RunRecorderMeasure* const* const measures,
+                              long const nbMeasure);
+
+// Begin a session: all the measures added until the end of the session
+// are written to the database in one single transaction. The write lock
+// of the database is taken at the beginning of the session, so other
+// connections wait for its end to write. Has no effect when using the
+// Web API.
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_SessionFailed
+void RunRecorderBeginSession(
+  struct RunRecorder* const that);
+
+// Commit a session opened with RunRecorderBeginSession
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_SessionFailed
+void RunRecorderCommitSession(
+  struct RunRecorder* const that);
+
+// Start the asynchronous writing of the measures: RunRecorderAddMeasure,
+// RunRecorderAddMeasures and RunRecorderProjectAddMeasure(s) copy the
+// measures in a queue and return immediately, and a dedicated thread
+// writes them by batches through its own connection. The errors of the
+// writer thread and the reference of the last written measure are
+// reported by RunRecorderFlush. The measures are dated when they're
+// queued, not when they're written. The measures written asynchronously
+// are not part of the current session. With a local database, the
+// connection of the writer thread waits at least 5s for the locks held by
+// other connections, whatever the busy timeout in the options of the
+// struct RunRecorder, which are left unchanged.
+// Inputs:
+//       that: the struct RunRecorder, already initialised
+//   capacity: the maximum number of measures in the queue
+//     policy: the policy when the queue is full
+// Raise:
+//   RunRecorderExc_AsyncFailed
+void RunRecorderStartAsync(
+            struct RunRecorder* const that,
+                           long const capacity,
+  enum RunRecorderAsyncPolicy const policy);
+
+// Wait until all the measures queued for asynchronous writing have been
+// written. Has no effect if the asynchronous writing is not started.
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_AddMeasureFailed (if a batch failed since the last
+//   call, errMsg is the one of the last failure)
+void RunRecorderFlush(
+  struct RunRecorder* const that);
+
+// Write the queued measures and stop the asynchronous writing, the
+// measures are written synchronously again. Done automatically, without
+// reporting errors, by RunRecorderFree.
+// Input:
+//   that: the struct RunRecorder
+// Raise:
+//   RunRecorderExc_AddMeasureFailed (if a batch failed since the last
+//   RunRecorderFlush)
+void RunRecorderStopAsync(
+  struct RunRecorder* const that);
+
+// Start the spool of the measures added through the Web API. The
+// measures which can't be sent because the Web API is unreachable (or all
+// the measures, according to the mode) are stored in a local SQLite
+// database instead, with their date, and a dedicated thread forwards them
+// to the Web API by batches, retrying with an exponential backoff. The
+// measures still in the spool when it is stopped are forwarded after the
+// next start. Can be used even if RunRecorderInit failed with
+// RunRecorderExc_CurlRequestFailed. Can't be used together with the
+// asynchronous writing.
+// Inputs:
+//        that: the struct RunRecorder
+//   pathSpool: path of the spool database, created if it doesn't exist
+//        mode: the mode of the spool
+// Raise:
+//   RunRecorderExc_SpoolFailed
+void RunRecorderStartSpool(
+        struct RunRecorder* const that,
+                char const* const pathSpool,
+  enum RunRecorderSpoolMode const mode);
+
+// Stop the spool, the measures not yet forwarded stay in the spool
+// database. Done automatically by RunRecorderFree.
+// Input:
+//   that: the struct RunRecorder
+void RunRecorderStopSpool(
+  struct RunRecorder* const that);
+
+// Get the number of spooled measures not yet forwarded to the Web API
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the number of measures, 0 if the spool is not started
+long RunRecorderGetNbSpooledMeasure(
+  struct RunRecorder* const that);
+
+// Get the reference in the Web API of a spooled measure
+// Inputs:
+//         that: the struct RunRecorder
+//   refSpooled: the reference of the measure in the spool (as given by
+//               refLastSpooledMeasure)
+// Output:
+//   Return the reference of the measure in the Web API, 0 if it has not
+//   been forwarded yet, -1 if it has been rejected by the Web API or is
+//   unknown
+// Raise:
+//   RunRecorderExc_SpoolFailed
+long RunRecorderGetSpooledMeasureRef(
+  struct RunRecorder* const that,
+                 long const refSpooled);
+
+// Create a new pool of struct RunRecorder, one per thread, all using the
+// same database or Web API
+// Inputs:
+//       url: Path to the SQLite database or Web API
+//   options: the options of the connections to the local database
+// Output:
+//   Return a new struct RunRecorderPool
+// Raise:
+//   RunRecorderExc_PoolFailed
+struct RunRecorderPool* RunRecorderPoolAlloc(
+                 char const* const url,
+  struct RunRecorderOptions const* const options);
+
+// Free memory used by a struct RunRecorderPool and all its struct
+// RunRecorder. Must be called once no thread uses the pool anymore.
+// Input:
+//   that: The struct RunRecorderPool to be freed
+void RunRecorderPoolFree(
+  struct RunRecorderPool** const that);
+
+// Get the struct RunRecorder of the calling thread. At the first call in
+// a thread, an idle struct RunRecorder of the pool is given to the
+// thread, or a new one is created and initialised. It is used by this
+// thread only, until the thread ends or calls RunRecorderPoolRelease,
+// and must not be freed.
+// Input:
+//   that: the struct RunRecorderPool
+// Output:
+//   Return the struct RunRecorder of the calling thread
+// Raise:
+//   RunRecorderExc_PoolFailed
+//   and the exceptions of RunRecorderInit
+struct RunRecorder* RunRecorderPoolGet(
+  struct RunRecorderPool* const that);
+
+// Give back the struct RunRecorder of the calling thread to the pool, to
+// be reused by another thread. Done automatically when the thread ends.
+// An opened session is rolled back.
+// Input:
+//   that: the struct RunRecorderPool
+void RunRecorderPoolRelease(
+  struct RunRecorderPool* const that);
+
 // Delete a measure
 // Inputs:
 //          that: the struct RunRecorder
@@ -315,6 +1121,81 @@ void RunRecorderDeleteMeasure(
   struct RunRecorder* const that,
                  long const refMeasure);
 
+// Delete several measures in one single transaction
+// Inputs:
+//          that: the struct RunRecorder
+//   refMeasures: the references of the measures to delete
+//     nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+void RunRecorderDeleteMeasures(
+  struct RunRecorder* const that,
+           long const* const refMeasures,
+                 long const nbMeasure);
+
+// Delete the measures whose reference is in [fromRef, toRef], in one
+// single transaction
+// Inputs:
+//      that: the struct RunRecorder
+//   fromRef: the first reference to delete
+//     toRef: the last reference to delete
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+void RunRecorderDeleteMeasuresByRef(
+  struct RunRecorder* const that,
+                 long const fromRef,
+                 long const toRef);
+
+// Delete the measures of a project recorded in [fromDate, toDate[, in
+// one single transaction
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+// Raise:
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+void RunRecorderDeleteMeasuresByDate(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate);
+
+// Set the retention policy of a project. The measures older than the
+// maximum age, and the oldest measures beyond the maximum number of
+// measures, are deleted by RunRecorderApplyRetention.
+// Inputs:
+//           that: the struct RunRecorder
+//        project: the project's name
+//         maxAge: the maximum age of the measures in seconds, 0 for no
+//                 limit
+//   maxNbMeasure: the maximum number of measures, 0 for no limit
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+//   RunRecorderExc_RetentionFailed
+void RunRecorderSetRetention(
+  struct RunRecorder* const that,
+          char const* const project,
+                 long const maxAge,
+                 long const maxNbMeasure);
+
+// Apply the retention policy of all the projects. The expired measures
+// are deleted by batches, each in its own transaction, to keep the
+// database available to writers.
+// Input:
+//   that: the struct RunRecorder
+// Output:
+//   Return the number of deleted measures
+// Raise:
+//   RunRecorderExc_RetentionFailed
+//   RunRecorderExc_DeleteMeasureFailed
+//   RunRecorderExc_SessionFailed
+long RunRecorderApplyRetention(
+  struct RunRecorder* const that);
+
 // Get the measures of a project
 // Inputs:
 //         that: the struct RunRecorder
@@ -338,6 +1219,40 @@ struct RunRecorderMeasures* RunRecorderGetLastMeasures(
           char const* const project,
                  long const nbMeasure);
 
+// Get the measures of a project in a period of time
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a new struct RunRecorderMeasures, ordered
+//   from the oldest to the most recent
+struct RunRecorderMeasures* RunRecorderGetMeasuresInRange(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit);
+
+// Get the measures of a project added after a given measure, to poll
+// the new measures at a cost independent of the size of the project
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+//   refLast: the reference of the last measure already read (0 to read
+//            all the measures), updated to the reference of the last
+//            returned measure, unchanged if there is no new measure
+// Output:
+//   Return the measures as a new struct RunRecorderMeasures, ordered
+//   from the oldest to the most recent added
+struct RunRecorderMeasures* RunRecorderGetMeasuresSince(
+  struct RunRecorder* const that,
+          char const* const project,
+                long* const refLast);
+
 // Free a struct RunRecorderMeasures
 // Input:
 //   that: the struct RunRecorderMeasures
@@ -356,6 +1271,24 @@ void RunRecorderMeasuresPrintCSV(
   struct RunRecorderMeasures const* const that,
                               FILE* const stream);
 
+// Enable or disable the materialized table of a project. When enabled,
+// the measures of the project are also stored in a table with one row per
+// measure and one column per metric, maintained each time a measure or
+// a metric is added or deleted. Reading the measures is then a simple
+// scan of that table instead of the resolution of the values of each
+// measure. Enabling populates the table with the existing measures.
+// Inputs:
+//             that: the struct RunRecorder
+//          project: the project's name
+//   isMaterialized: true to enable, false to disable
+// Raise:
+//   RunRecorderExc_MaterializeFailed
+//   RunRecorderExc_SessionFailed
+void RunRecorderSetMaterialized(
+  struct RunRecorder* const that,
+          char const* const project,
+                 bool const isMaterialized);
+
 // Remove a project
 // Inputs:
 //         that: the struct RunRecorder
@@ -364,6 +1297,22 @@ void RunRecorderFlushProject(
   struct RunRecorder* const that,
           char const* const project);
 
+// Reclaim the space freed by deleted measures and projects. Deletions
+// don't shrink the database file, the freed pages are kept for reuse.
+// This function releases them in bounded steps to keep the database
+// available to writers, and can be called repeatedly until it returns 0.
+// Inputs:
+//     that: the struct RunRecorder
+//   budget: the maximum number of pages to release, if <= 0 all the
+//           free pages are released
+// Output:
+//   Return the number of free pages remaining after the call
+// Raise:
+//   RunRecorderExc_CompactFailed
+long RunRecorderCompact(
+  struct RunRecorder* const that,
+                 long const budget);
+
 // Free a struct RunRecorderRefVal
 // Input:
 //   that: the struct RunRecorderRefVal
@@ -386,6 +1335,290 @@ int RunRecorderMeasuresGetIdxMetric(
   struct RunRecorderMeasures const* const that,
                         char const* const metric);
 
+// Get a value of a struct RunRecorderMeasures as an integer. Values read
+// from a numeric column of a local database are returned without parsing,
+// others are parsed from their string.
+// Inputs:
+//       that: the struct RunRecorderMeasures
+//   iMeasure: the index of the measure
+//    iMetric: the index of the metric
+// Output:
+//   Return the value, or 0 if it is not a number
+long RunRecorderMeasuresGetLong(
+  struct RunRecorderMeasures const* const that,
+                               long const iMeasure,
+                               long const iMetric);
+
+// Get a value of a struct RunRecorderMeasures as a double. Values read
+// from a numeric column of a local database are returned without parsing,
+// exactly as they were added, others are parsed from their string.
+// Inputs:
+//       that: the struct RunRecorderMeasures
+//   iMeasure: the index of the measure
+//    iMetric: the index of the metric
+// Output:
+//   Return the value, or 0 if it is not a number
+double RunRecorderMeasuresGetDouble(
+  struct RunRecorderMeasures const* const that,
+                               long const iMeasure,
+                               long const iMetric);
+
+// Get the measures of a project by column. The numeric values are
+// stored in arrays of the type of their metric, and the values of text
+// metrics as indices in a dictionary of their distinct values.
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+// Output:
+//   Return the measures as a new struct RunRecorderColumns
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+struct RunRecorderColumns* RunRecorderGetColumns(
+  struct RunRecorder* const that,
+          char const* const project);
+
+// Get the measures of a project in a period of time by column
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a new struct RunRecorderColumns, ordered
+//   from the oldest to the most recent
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+struct RunRecorderColumns* RunRecorderGetColumnsInRange(
+  struct RunRecorder* const that,
+          char const* const project,
+               time_t const fromDate,
+               time_t const toDate,
+                 long const limit);
+
+// Free a struct RunRecorderColumns
+// Input:
+//   that: the struct RunRecorderColumns
+void RunRecorderColumnsFree(
+  struct RunRecorderColumns** const that);
+
+// Get the index of a metric in a struct RunRecorderColumns
+// Inputs:
+//     that: the struct RunRecorderColumns
+//   metric: the metric's label
+// Output:
+//   Return the index of the metric
+// Raise:
+//   RunRecorderExc_InvalidMetricLabel
+long RunRecorderColumnsGetIdxMetric(
+  struct RunRecorderColumns const* const that,
+                        char const* const metric);
+
+// Check if a value of a struct RunRecorderColumn is valid
+// Inputs:
+//       that: the struct RunRecorderColumn
+//   iMeasure: the index of the measure
+// Output:
+//   Return true if the value is valid, else false
+bool RunRecorderColumnIsValid(
+  struct RunRecorderColumn const* const that,
+                             long const iMeasure);
+
+// Aggregate the values of a metric of a project in a period of time. The
+// aggregation is executed by the database, only its result is returned.
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+// Output:
+//   Return the aggregated value, or NAN if there is no measure in the
+//   period (except for RunRecorderAggregateFn_count) or the result is not
+//   a number (e.g. the minimum of a text metric)
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_InvalidAggregate
+//   RunRecorderExc_SQLRequestFailed
+double RunRecorderAggregate(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate);
+
+// Aggregate the values of a metric of a project in a period of time, per
+// interval of time. The intervals are aligned on the Epoch, so an interval
+// of 86400 seconds gives one value per day (UTC).
+// Inputs:
+//       that: the struct RunRecorder
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//   interval: the duration of the intervals in seconds, must be > 0
+// Output:
+//   Return the aggregated values as a new struct RunRecorderAggregates,
+//   ordered from the oldest to the most recent interval
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+//   RunRecorderExc_InvalidMetricLabel
+//   RunRecorderExc_InvalidAggregate
+//   RunRecorderExc_SQLRequestFailed
+struct RunRecorderAggregates* RunRecorderAggregateByInterval(
+          struct RunRecorder* const that,
+                  char const* const project,
+                  char const* const metric,
+  enum RunRecorderAggregateFn const fn,
+                       time_t const fromDate,
+                       time_t const toDate,
+                         long const interval);
+
+// Free a struct RunRecorderAggregates
+// Input:
+//   that: the struct RunRecorderAggregates
+void RunRecorderAggregatesFree(
+  struct RunRecorderAggregates** const that);
+
+// Open a handle on a project
+// Inputs:
+//   that: the struct RunRecorder
+//   name: the project's name
+// Output:
+//   Return a new struct RunRecorderProject
+// Raise:
+//   RunRecorderExc_InvalidProjectName
+struct RunRecorderProject* RunRecorderOpenProject(
+  struct RunRecorder* const that,
+          char const* const name);
+
+// Free a handle on a project. The struct RunRecorder it refers to is not
+// freed.
+// Input:
+//   that: the struct RunRecorderProject
+void RunRecorderProjectFree(
+  struct RunRecorderProject** const that);
+
+// Add a measure to a project through its handle
+// Inputs:
+//      that: the handle on the project
+//   measure: the measure to add
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SessionFailed
+//   RunRecorderExc_AsyncQueueFull
+//   RunRecorderExc_SpoolFailed
+void RunRecorderProjectAddMeasure(
+         struct RunRecorderProject* const that,
+  struct RunRecorderMeasure const* const measure);
+
+// Add several measures to a project through its handle, in one single
+// transaction (or in the current session if there is one). Same policy
+// as RunRecorderAddMeasures.
+// Inputs:
+//        that: the handle on the project
+//    measures: the measures to add
+//   nbMeasure: the number of measures
+// Raise:
+//   RunRecorderExc_AddMeasureFailed
+//   RunRecorderExc_SessionFailed
+//   RunRecorderExc_AsyncQueueFull
+//   RunRecorderExc_SpoolFailed
+void RunRecorderProjectAddMeasures(
+        struct RunRecorderProject* const that,
+  struct RunRecorderMeasure* const* const measures,
+                              long const nbMeasure);
+
+// Get the measures of a project through its handle
+// Input:
+//   that: the handle on the project
+// Output:
+//   Return the measures as a new struct RunRecorderMeasures
+struct RunRecorderMeasures* RunRecorderProjectGetMeasures(
+  struct RunRecorderProject* const that);
+
+// Get the most recent measures of a project through its handle
+// Inputs:
+//        that: the handle on the project
+//   nbMeasure: the number of measures to be returned
+// Output:
+//   Return the measures as a new struct RunRecorderMeasures, ordered
+//   from the most recent to the oldest
+struct RunRecorderMeasures* RunRecorderProjectGetLastMeasures(
+  struct RunRecorderProject* const that,
+                        long const nbMeasure);
+
+// Get the measures of a project in a period of time through its handle
+// Inputs:
+//       that: the handle on the project
+//   fromDate: the start of the period
+//     toDate: the end of the period (excluded)
+//      limit: the maximum number of measures to be returned, if 0 all
+//             the measures in the period are returned
+// Output:
+//   Return the measures as a new struct RunRecorderMeasures, ordered
+//   from the oldest to the most recent
+struct RunRecorderMeasures* RunRecorderProjectGetMeasuresInRange(
+  struct RunRecorderProject* const that,
+                      time_t const fromDate,
+                      time_t const toDate,
+                        long const limit);
+
+// Get the measures of a project added after a given measure through its
+// handle
+// Inputs:
+//      that: the handle on the project
+//   refLast: the reference of the last measure already read (0 to read
+//            all the measures), updated to the reference of the last
+//            returned measure, unchanged if there is no new measure
+// Output:
+//   Return the measures as a new struct RunRecorderMeasures, ordered
+//   from the oldest to the most recent added
+struct RunRecorderMeasures* RunRecorderProjectGetMeasuresSince(
+  struct RunRecorderProject* const that,
+                       long* const refLast);
+
+// Open a cursor on the measures of a project. The measures are then read
+// one at a time with RunRecorderMeasuresCursorNext, in the same order as
+// RunRecorderGetMeasures, without loading all of them in memory
+// Inputs:
+//      that: the struct RunRecorder
+//   project: the project's name
+// Output:
+//   Return a new struct RunRecorderMeasuresCursor
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+//   RunRecorderExc_CurlSetOptFailed
+//   RunRecorderExc_CurlRequestFailed
+//   RunRecorderExc_ApiRequestFailed
+struct RunRecorderMeasuresCursor* RunRecorderMeasuresCursorOpen(
+  struct RunRecorder* const that,
+          char const* const project);
+
+// Move a cursor to the next measure
+// Input:
+//   that: the struct RunRecorderMeasuresCursor
+// Output:
+//   Return true and set that->values to the values of the measure if
+//   there is a next measure, else return false
+// Raise:
+//   RunRecorderExc_SQLRequestFailed
+//   RunRecorderExc_CurlRequestFailed
+//   RunRecorderExc_ApiRequestFailed
+bool RunRecorderMeasuresCursorNext(
+  struct RunRecorderMeasuresCursor* const that);
+
+// Close a cursor and free the memory it uses
+// Input:
+//   that: the struct RunRecorderMeasuresCursor
+void RunRecorderMeasuresCursorClose(
+  struct RunRecorderMeasuresCursor** const that);
+
 // ================== Macros =========================
 
 // Polymorphic RunRecorderMeasureAddValue
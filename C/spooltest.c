@@ -0,0 +1,349 @@
+// Needed for sleep()
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "runrecorder.h"
+
+// Directory the Web API is served from during the test, it is recreated
+// with a copy of api.php at the beginning of each run
+#define DIR_SERVER "./spooltest.d"
+
+// Path to the copied Web API
+#define PATH_API "../WebAPI/api.php"
+
+// Default url of the Web API and default command starting the server in
+// DIR_SERVER (the PHP development server)
+#define URL_API "http://127.0.0.1:8765/api.php"
+#define CMD_SERVER "php -S 127.0.0.1:8765"
+
+// Path to the spool database, it is deleted at the beginning and the end
+// of each run
+#define PATH_SPOOL "./spooltest.db"
+
+// Label of the project used by the test
+#define PROJECT "SpoolTest"
+
+// Number of measures spooled while the server is down
+#define NB_MEASURE 10
+
+// Maximum delays in seconds to wait for the server to start and for the
+// spooled measures to be forwarded
+#define TIMEOUT_SERVER 10
+#define TIMEOUT_FORWARD 60
+
+// Print the result of a check
+// Inputs:
+//    isOk: the result of the check
+//   check: string to identify the check
+// Output:
+//   Return isOk
+static bool PrintCheck(
+         bool const isOk,
+  char const* const check) {
+
+  printf(
+    "Check %s: %s\n",
+    (isOk == true ? "passed" : "failed"),
+    check);
+  return isOk;
+
+}
+
+// Start the server in the background, in DIR_SERVER
+// Input:
+//   cmd: the command starting the server
+// Output:
+//   Return true if the command could be run, else false
+static bool StartServer(
+  char const* const cmd) {
+
+  char* shellCmd = NULL;
+  size_t len =
+    (size_t)snprintf(
+      NULL,
+      0,
+      "cd %s && { %s > server.log 2>&1 & echo $! > server.pid; }",
+      DIR_SERVER,
+      cmd);
+  shellCmd = malloc(len + 1);
+  if (shellCmd == NULL) return false;
+  sprintf(
+    shellCmd,
+    "cd %s && { %s > server.log 2>&1 & echo $! > server.pid; }",
+    DIR_SERVER,
+    cmd);
+  int ret = system(shellCmd);
+  free(shellCmd);
+  return (ret == 0);
+
+}
+
+// Stop the server started by StartServer
+static void StopServer(
+  void) {
+
+  int ret = system("kill $(cat " DIR_SERVER "/server.pid) 2> /dev/null");
+  (void)ret;
+
+  // Give the server the time to release its port
+  sleep(1);
+
+}
+
+// Wait until the Web API replies
+// Input:
+//   url: the url of the Web API
+// Output:
+//   Return true if the Web API replied before TIMEOUT_SERVER, else false
+static bool WaitServer(
+  char const* const url) {
+
+  bool isUp = false;
+  for (
+    int iTry = 0;
+    isUp == false && iTry < TIMEOUT_SERVER;
+    ++iTry) {
+
+    struct RunRecorder* recorder = RunRecorderAlloc(url);
+    Try {
+
+      RunRecorderInit(recorder);
+      isUp = true;
+
+    } CatchDefault {
+
+      sleep(1);
+
+    } EndCatch;
+    RunRecorderFree(&recorder);
+
+  }
+
+  return isUp;
+
+}
+
+// Spool measures while the server is down, restart the server and check
+// the measures are forwarded with their date
+// Inputs:
+//   url: the url of the Web API
+//   cmd: the command starting the server
+// Output:
+//   Return true if all the checks passed, else false
+static bool RunSpoolTest(
+  char const* const url,
+  char const* const cmd) {
+
+  bool isOk = true;
+  struct RunRecorder* recorder = NULL;
+  struct RunRecorderMeasure* measure = NULL;
+  struct RunRecorderMeasures* measures = NULL;
+  Try {
+
+    // Create the project while the server is up, and start the spool
+    isOk = StartServer(cmd) && WaitServer(url);
+    recorder = RunRecorderAlloc(url);
+    if (isOk == true) {
+
+      RunRecorderInit(recorder);
+      RunRecorderAddProject(
+        recorder,
+        PROJECT);
+      RunRecorderAddMetric(
+        recorder,
+        PROJECT,
+        "Value",
+        "-");
+      RunRecorderStartSpool(
+        recorder,
+        PATH_SPOOL,
+        RunRecorderSpoolMode_onFailure);
+
+    }
+    isOk =
+      PrintCheck(
+        isOk,
+        "server started, project created");
+
+    // Add the measures while the server is down, they are spooled
+    long refSpooled[NB_MEASURE];
+    time_t dateStart = time(NULL);
+    if (isOk == true) {
+
+      StopServer();
+      measure = RunRecorderMeasureCreate();
+      for (
+        long iMeasure = 0;
+        iMeasure < NB_MEASURE;
+        ++iMeasure) {
+
+        RunRecorderMeasureAddValue(
+          measure,
+          "Value",
+          iMeasure);
+        RunRecorderAddMeasure(
+          recorder,
+          PROJECT,
+          measure);
+        refSpooled[iMeasure] = recorder->refLastSpooledMeasure;
+        isOk =
+          isOk &&
+          recorder->refLastAddedMeasure == 0 &&
+          refSpooled[iMeasure] > 0 &&
+          RunRecorderGetSpooledMeasureRef(
+            recorder,
+            refSpooled[iMeasure]) == 0;
+
+      }
+      RunRecorderMeasureFree(&measure);
+      isOk =
+        isOk &&
+        RunRecorderGetNbSpooledMeasure(recorder) == NB_MEASURE;
+
+    }
+    time_t dateEnd = time(NULL);
+    isOk =
+      PrintCheck(
+        isOk,
+        "measures queued while the server is down");
+
+    // Restart the server later than the spooled measures, and wait for
+    // the measures to be forwarded
+    if (isOk == true) {
+
+      sleep(2);
+      isOk = StartServer(cmd) && WaitServer(url);
+      for (
+        int iWait = 0;
+        isOk == true &&
+        iWait < TIMEOUT_FORWARD &&
+        RunRecorderGetNbSpooledMeasure(recorder) > 0;
+        ++iWait)
+        sleep(1);
+      isOk = isOk && RunRecorderGetNbSpooledMeasure(recorder) == 0;
+
+    }
+    isOk =
+      PrintCheck(
+        isOk,
+        "measures forwarded once the server is up");
+
+    // The measures are recorded with the date they were spooled, not the
+    // date they were forwarded, and the spool gives their reference in
+    // the Web API
+    if (isOk == true) {
+
+      measures =
+        RunRecorderGetMeasuresInRange(
+          recorder,
+          PROJECT,
+          dateStart,
+          dateEnd + 1,
+          0);
+      isOk = (measures->nbMeasure == NB_MEASURE);
+      for (
+        long iMeasure = 0;
+        isOk == true && iMeasure < measures->nbMeasure;
+        ++iMeasure) {
+
+        char value[20];
+        sprintf(
+          value,
+          "%ld",
+          iMeasure);
+        long refApi =
+          RunRecorderGetSpooledMeasureRef(
+            recorder,
+            refSpooled[iMeasure]);
+        isOk =
+          refApi > 0 &&
+          refApi == atol(measures->values[iMeasure][0]) &&
+          strcmp(measures->values[iMeasure][2], value) == 0;
+
+      }
+      RunRecorderMeasuresFree(&measures);
+      isOk =
+        PrintCheck(
+          isOk,
+          "measures forwarded with their date and their reference");
+
+    }
+
+  } CatchDefault {
+
+    fprintf(
+      stderr,
+      "Caught exception %s\n",
+      TryCatchExcToStr(TryCatchGetLastExc()));
+    if (recorder != NULL && recorder->errMsg != NULL)
+      fprintf(
+        stderr,
+        "%s\n",
+        recorder->errMsg);
+    isOk = false;
+
+  } EndCatch;
+
+  // Free memory and stop the server
+  RunRecorderMeasureFree(&measure);
+  RunRecorderMeasuresFree(&measures);
+  RunRecorderFree(&recorder);
+  StopServer();
+
+  return isOk;
+
+}
+
+// Main function
+// Usage: spooltest [url of the Web API] [command starting the server]
+// The command is run in the directory DIR_SERVER, where api.php has been
+// copied, and must serve it at the given url
+int main(
+     int argc,
+  char** argv) {
+
+  // Get the arguments
+  char const* url = URL_API;
+  char const* cmd = CMD_SERVER;
+  if (argc > 1) url = argv[1];
+  if (argc > 2) cmd = argv[2];
+  if (argc > 3) {
+
+    fprintf(
+      stderr,
+      "Usage: %s [url of the Web API] [command starting the server]\n",
+      argv[0]);
+    return EXIT_FAILURE;
+
+  }
+
+  // Prepare the directory of the server and delete the spool
+  int ret =
+    system(
+      "rm -rf " DIR_SERVER " && mkdir " DIR_SERVER
+      " && cp " PATH_API " " DIR_SERVER);
+  if (ret != 0) {
+
+    fprintf(
+      stderr,
+      "Couldn't copy %s in %s\n",
+      PATH_API,
+      DIR_SERVER);
+    return EXIT_FAILURE;
+
+  }
+  remove(PATH_SPOOL);
+
+  // Run the test
+  bool isOk =
+    RunSpoolTest(
+      url,
+      cmd);
+
+  // Delete the spool
+  remove(PATH_SPOOL);
+
+  return (isOk == true ? EXIT_SUCCESS : EXIT_FAILURE);
+
+}
@@ -0,0 +1,573 @@
+// Needed for fork(), pipe() and waitpid()
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "runrecorder.h"
+
+// Path to the SQLite database used by the stress benchmark, it is deleted
+// at the beginning and the end of each run
+#define PATH_DB "./stress.db"
+
+// Label of the project used by the stress benchmark
+#define PROJECT "Stress"
+
+// Default numbers of writer and reader processes, and default duration
+// in seconds of each run
+#define NB_WRITER 4
+#define NB_READER 4
+#define DURATION 5.0
+
+// Number of most recent measures read by each operation of the readers
+#define NB_LAST_MEASURE 100
+
+// Results of one process, followed in the pipe to the parent process by
+// the latency in seconds of each successful operation
+struct StressResult {
+
+  // Number of successful operations
+  long nbOp;
+
+  // Number of failed operations
+  long nbFailed;
+
+  // Number of attempts to get a lock held by another process
+  long nbBusyRetry;
+
+};
+
+// Get the current time in seconds
+// Output:
+//   Return the time
+static double GetTime(
+  void) {
+
+  struct timespec ts;
+  timespec_get(
+    &ts,
+    TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+
+}
+
+// Write a buffer entirely in a file descriptor
+// Inputs:
+//     fd: the file descriptor
+//    buf: the buffer
+//   size: the size of the buffer in bytes
+// Output:
+//   Return true if successful, else false
+static bool WriteAll(
+          int const fd,
+  void const* const buf,
+       size_t const size) {
+
+  size_t nbWritten = 0;
+  while (nbWritten < size) {
+
+    ssize_t ret =
+      write(
+        fd,
+        (char const*)buf + nbWritten,
+        size - nbWritten);
+    if (ret <= 0) return false;
+    nbWritten += (size_t)ret;
+
+  }
+
+  return true;
+
+}
+
+// Read a buffer entirely from a file descriptor
+// Inputs:
+//     fd: the file descriptor
+//    buf: the buffer
+//   size: the size of the buffer in bytes
+// Output:
+//   Return true if successful, else false
+static bool ReadAll(
+     int const fd,
+  void* const buf,
+  size_t const size) {
+
+  size_t nbRead = 0;
+  while (nbRead < size) {
+
+    ssize_t ret =
+      read(
+        fd,
+        (char*)buf + nbRead,
+        size - nbRead);
+    if (ret <= 0) return false;
+    nbRead += (size_t)ret;
+
+  }
+
+  return true;
+
+}
+
+// Compare two latencies for qsort
+// Inputs:
+//   a, b: the latencies
+// Output:
+//   Return -1, 0 or 1 if a is smaller, equal or greater than b
+static int CmpLatency(
+  void const* const a,
+  void const* const b) {
+
+  double const la = *(double const*)a;
+  double const lb = *(double const*)b;
+  return (la > lb) - (la < lb);
+
+}
+
+// Main function of a writer or reader process: adds one measure, or
+// reads the most recent measures, per operation until the deadline, and
+// sends the results to the parent process. Each operation is one
+// transaction of its own.
+// Inputs:
+//    options: the options of the database
+//   isWriter: flag to add measures instead of reading them
+//   deadline: the time when the process stops
+//         fd: the file descriptor of the pipe to the parent process
+// Output:
+//   Return the exit status of the process
+static int RunProcess(
+  struct RunRecorderOptions const* const options,
+                         bool const isWriter,
+                       double const deadline,
+                          int const fd) {
+
+  struct StressResult result = {.nbOp = 0, .nbFailed = 0, .nbBusyRetry = 0};
+  double* latencies = NULL;
+  long capacity = 0;
+  struct RunRecorder* recorder = NULL;
+  struct RunRecorderProject* project = NULL;
+  struct RunRecorderMeasure* measure = NULL;
+  bool isOk = true;
+  Try {
+
+    recorder =
+      RunRecorderAllocWithOptions(
+        PATH_DB,
+        options);
+    RunRecorderInit(recorder);
+    project =
+      RunRecorderOpenProject(
+        recorder,
+        PROJECT);
+    measure = RunRecorderMeasureCreate();
+
+  } CatchDefault {
+
+    isOk = false;
+
+  } EndCatch;
+
+  // Loop on the operations until the deadline
+  while (isOk == true && GetTime() < deadline) {
+
+    // Execute one operation and measure the time it takes
+    double start = GetTime();
+    bool hasFailed = false;
+    Try {
+
+      if (isWriter == true) {
+
+        RunRecorderMeasureAddValue(
+          measure,
+          "m",
+          (double)(result.nbOp));
+        RunRecorderProjectAddMeasure(
+          project,
+          measure);
+
+      } else {
+
+        struct RunRecorderMeasures* measures =
+          RunRecorderProjectGetLastMeasures(
+            project,
+            NB_LAST_MEASURE);
+        RunRecorderMeasuresFree(&measures);
+
+      }
+
+    } CatchDefault {
+
+      hasFailed = true;
+
+    } EndCatch;
+    double end = GetTime();
+
+    // Memorise the result of the operation
+    if (hasFailed == true) {
+
+      ++(result.nbFailed);
+
+    } else {
+
+      if (result.nbOp == capacity) {
+
+        capacity = (capacity == 0 ? 1024 : capacity * 2);
+        double* ptr =
+          realloc(
+            latencies,
+            sizeof(double) * (size_t)capacity);
+        if (ptr == NULL) isOk = false;
+        else latencies = ptr;
+
+      }
+
+      if (isOk == true) {
+
+        latencies[result.nbOp] = end - start;
+        ++(result.nbOp);
+
+      }
+
+    }
+
+  }
+
+  // Send the results to the parent process
+  if (isOk == true) result.nbBusyRetry = recorder->nbBusyRetry;
+  if (isOk == true)
+    isOk =
+      WriteAll(
+        fd,
+        &result,
+        sizeof(result));
+  if (isOk == true)
+    isOk =
+      WriteAll(
+        fd,
+        latencies,
+        sizeof(double) * (size_t)(result.nbOp));
+
+  // Free memory
+  free(latencies);
+  RunRecorderMeasureFree(&measure);
+  RunRecorderProjectFree(&project);
+  RunRecorderFree(&recorder);
+
+  return (isOk == true ? EXIT_SUCCESS : EXIT_FAILURE);
+
+}
+
+// Display the throughput and the latencies of one kind of processes
+// Inputs:
+//       label: the label of the kind of processes
+//      result: the cumulated results of the processes
+//   latencies: the latencies of all the successful operations
+//    duration: the duration of the run in seconds
+static void PrintResult(
+                char const* const label,
+  struct StressResult const* const result,
+                    double* const latencies,
+                     double const duration) {
+
+  // Sort the latencies to get their percentiles
+  qsort(
+    latencies,
+    (size_t)(result->nbOp),
+    sizeof(double),
+    CmpLatency);
+  double p50 = 0.0;
+  double p99 = 0.0;
+  double p999 = 0.0;
+  double max = 0.0;
+  if (result->nbOp > 0) {
+
+    p50 = latencies[result->nbOp * 50 / 100];
+    p99 = latencies[result->nbOp * 99 / 100];
+    p999 = latencies[result->nbOp * 999 / 1000];
+    max = latencies[result->nbOp - 1];
+
+  }
+
+  printf(
+    "  %7s %10.0f op/s p50 %8.3fms p99 %8.3fms p99.9 %8.3fms "
+    "max %8.3fms failed %ld retries %ld\n",
+    label,
+    (double)(result->nbOp) / duration,
+    p50 * 1e3,
+    p99 * 1e3,
+    p999 * 1e3,
+    max * 1e3,
+    result->nbFailed,
+    result->nbBusyRetry);
+  fflush(stdout);
+
+}
+
+// Run the stress benchmark with given options of the database: nbWriter
+// processes add measures and nbReader processes read them concurrently
+// during a given duration
+// Inputs:
+//    options: the options of the database
+//      label: the label of the options in the results
+//   nbWriter: the number of writer processes
+//   nbReader: the number of reader processes
+//   duration: the duration in seconds
+// Output:
+//   Return true if successful, else false
+static bool RunStress(
+  struct RunRecorderOptions const* const options,
+                  char const* const label,
+                         long const nbWriter,
+                         long const nbReader,
+                       double const duration) {
+
+  // Create the database with the options, and the project. The
+  // connection is closed before starting the processes.
+  remove(PATH_DB);
+  struct RunRecorder* recorder = NULL;
+  Try {
+
+    recorder =
+      RunRecorderAllocWithOptions(
+        PATH_DB,
+        options);
+    RunRecorderInit(recorder);
+    RunRecorderAddProject(
+      recorder,
+      PROJECT);
+    RunRecorderAddTypedMetric(
+      recorder,
+      PROJECT,
+      "m",
+      "0",
+      RunRecorderMetricType_double);
+
+  } CatchDefault {
+
+    fprintf(
+      stderr,
+      "Caught exception %s.\n",
+      TryCatchExcToStr(TryCatchGetLastExc()));
+    RunRecorderFree(&recorder);
+    remove(PATH_DB);
+    return false;
+
+  } EndCatch;
+  RunRecorderFree(&recorder);
+
+  // Start the processes, the writers first, each with a pipe to send its
+  // results
+  long const nbProcess = nbWriter + nbReader;
+  pid_t pids[nbProcess];
+  int fds[nbProcess];
+  double const deadline = GetTime() + duration;
+  bool isOk = true;
+  long nbStarted = 0;
+  while (isOk == true && nbStarted < nbProcess) {
+
+    int fdPipe[2];
+    if (pipe(fdPipe) != 0) {
+
+      isOk = false;
+
+    } else {
+
+      pid_t pid = fork();
+      if (pid == 0) {
+
+        close(fdPipe[0]);
+        int status =
+          RunProcess(
+            options,
+            (nbStarted < nbWriter),
+            deadline,
+            fdPipe[1]);
+        close(fdPipe[1]);
+        _exit(status);
+
+      }
+
+      close(fdPipe[1]);
+      if (pid < 0) {
+
+        close(fdPipe[0]);
+        isOk = false;
+
+      } else {
+
+        pids[nbStarted] = pid;
+        fds[nbStarted] = fdPipe[0];
+        ++nbStarted;
+
+      }
+
+    }
+
+  }
+
+  // Collect the results of the processes, per kind of process
+  struct StressResult results[2] = {
+    {.nbOp = 0, .nbFailed = 0, .nbBusyRetry = 0},
+    {.nbOp = 0, .nbFailed = 0, .nbBusyRetry = 0}};
+  double* latencies[2] = {NULL, NULL};
+  for (
+    long iProcess = 0;
+    iProcess < nbStarted;
+    ++iProcess) {
+
+    int const iKind = (iProcess < nbWriter ? 0 : 1);
+    struct StressResult result;
+    bool isRead =
+      ReadAll(
+        fds[iProcess],
+        &result,
+        sizeof(result));
+    // One more latency is allocated so that the size is never 0, in
+    // which case realloc would free the latencies when no operation
+    // has succeeded yet
+    if (isRead == true) {
+
+      double* ptr =
+        realloc(
+          latencies[iKind],
+          sizeof(double) *
+          (size_t)(results[iKind].nbOp + result.nbOp + 1));
+      if (ptr == NULL) isRead = false;
+      else latencies[iKind] = ptr;
+
+    }
+
+    if (isRead == true)
+      isRead =
+        ReadAll(
+          fds[iProcess],
+          latencies[iKind] + results[iKind].nbOp,
+          sizeof(double) * (size_t)(result.nbOp));
+    if (isRead == true) {
+
+      results[iKind].nbOp += result.nbOp;
+      results[iKind].nbFailed += result.nbFailed;
+      results[iKind].nbBusyRetry += result.nbBusyRetry;
+
+    } else {
+
+      isOk = false;
+
+    }
+
+    close(fds[iProcess]);
+    int status = 0;
+    waitpid(
+      pids[iProcess],
+      &status,
+      0);
+    if (WIFEXITED(status) == 0 || WEXITSTATUS(status) != EXIT_SUCCESS)
+      isOk = false;
+
+  }
+
+  // Display the results
+  if (isOk == false) {
+
+    fprintf(
+      stderr,
+      "%s: a process failed.\n",
+      label);
+
+  } else {
+
+    printf(
+      "%s (%ld writers, %ld readers, %.1fs):\n",
+      label,
+      nbWriter,
+      nbReader,
+      duration);
+    PrintResult(
+      "writers",
+      results,
+      latencies[0],
+      duration);
+    PrintResult(
+      "readers",
+      results + 1,
+      latencies[1],
+      duration);
+
+  }
+
+  // Free memory
+  free(latencies[0]);
+  free(latencies[1]);
+  remove(PATH_DB);
+  remove(PATH_DB "-wal");
+  remove(PATH_DB "-shm");
+
+  return isOk;
+
+}
+
+// Main function
+// Usage: stress [nbWriter] [nbReader] [duration in seconds]
+int main(
+     int argc,
+  char** argv) {
+
+  // Get the arguments
+  long nbWriter = NB_WRITER;
+  long nbReader = NB_READER;
+  double duration = DURATION;
+  if (argc > 1)
+    nbWriter =
+      strtol(
+        argv[1],
+        NULL,
+        10);
+  if (argc > 2)
+    nbReader =
+      strtol(
+        argv[2],
+        NULL,
+        10);
+  if (argc > 3)
+    duration =
+      strtod(
+        argv[3],
+        NULL);
+  if (
+    nbWriter < 0 ||
+    nbReader < 0 ||
+    nbWriter + nbReader == 0 ||
+    duration <= 0.0) {
+
+    fprintf(
+      stderr,
+      "Usage: %s [nbWriter] [nbReader] [duration in seconds]\n",
+      argv[0]);
+    return EXIT_FAILURE;
+
+  }
+
+  // Run the stress benchmark with the default options, and with the
+  // WAL journal mode and the normal synchronous level
+  struct RunRecorderOptions options = RunRecorderOptionsCreate();
+  bool isOk =
+    RunStress(
+      &options,
+      "default",
+      nbWriter,
+      nbReader,
+      duration);
+  options.journalMode = RunRecorderJournalMode_wal;
+  options.synchronous = RunRecorderSynchronous_normal;
+  if (isOk == true)
+    isOk =
+      RunStress(
+        &options,
+        "WAL, normal",
+        nbWriter,
+        nbReader,
+        duration);
+
+  return (isOk == true ? EXIT_SUCCESS : EXIT_FAILURE);
+
+}
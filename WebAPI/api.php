@@ -14,7 +14,153 @@ error_reporting(E_ALL);
 $pathDB = "./runrecorder.db";
 
 // Version of the database
-$versionDB = "01.00.00";
+$versionDB = "01.08.00";
+
+// Number of measures deleted per transaction when applying the retention
+// policies
+$sizeBatchRetention = 1000;
+
+// Command to set the vacuum mode of the database. In incremental mode the
+// pages freed by deletions are kept in the database file until they're
+// released by the action compact, instead of requiring a VACUUM which
+// rebuilds the whole file
+$cmdAutoVacuum = "PRAGMA auto_vacuum = INCREMENTAL";
+
+// Options of the database connection, null to keep the default of
+// SQLite. The WAL journal mode lets the readers run concurrently with the
+// writer, and with it the NORMAL synchronous level only syncs the journal
+// at checkpoints instead of at each commit. The cache size is in KiB, the
+// memory map size in bytes, and the page size (in bytes) only applies
+// when the database is created. The busy timeout is the maximum time in
+// milliseconds a request waits for the lock held by another request
+// before failing.
+$dbOptions = [
+  "journal_mode" => "WAL",
+  "synchronous" => "NORMAL",
+  "cache_size" => null,
+  "mmap_size" => null,
+  "page_size" => null,
+  "busy_timeout" => 5000];
+
+// Prefix of the name of the materialized table of a project
+$prefixMat = "_Mat_";
+
+// Commands to create the indexes of the database
+$cmdsIndex = [
+  "CREATE INDEX IF NOT EXISTS _ValueByMeasure " .
+  "ON _Value (RefMeasure, RefMetric, Value)",
+  "CREATE INDEX IF NOT EXISTS _MeasureByProject " .
+  "ON _Measure (RefProject, DateMeasure)",
+  "CREATE INDEX IF NOT EXISTS _MetricByProject " .
+  "ON _Metric (RefProject, Label)"];
+
+// Command to convert the dates of the measures recorded by previous
+// versions to the UTC date as "YYYY-MM-DD HH:MM:SS", which sorts in
+// chronological order. The C library used the local date formatted by
+// ctime(), "Www Mmm dd hh:mm:ss yyyy", and the Web API the local date as
+// "YYYY-MM-DD HH:MM:SS". Unrecognised dates are left unchanged.
+$cmdMigrateDateMeasure =
+  "UPDATE _Measure SET DateMeasure = IFNULL(datetime(" .
+  "CASE WHEN length(DateMeasure) = 24 AND substr(DateMeasure, 4, 1) = ' ' " .
+  "THEN printf('%s-%02d-%s %s', substr(DateMeasure, 21, 4), " .
+  "(instr('JanFebMarAprMayJunJulAugSepOctNovDec', " .
+  "substr(DateMeasure, 5, 3)) + 2) / 3, " .
+  "replace(substr(DateMeasure, 9, 2), ' ', '0'), " .
+  "substr(DateMeasure, 12, 8)) " .
+  "ELSE DateMeasure END, 'utc'), DateMeasure)";
+
+// Command to convert the dates of the measures from the UTC date as
+// "YYYY-MM-DD HH:MM:SS" to the number of microseconds since the Epoch.
+// Unrecognised dates are converted to the Epoch.
+$cmdMigrateDateMeasureEpoch =
+  "UPDATE _Measure SET DateMeasure = " .
+  "IFNULL(CAST(strftime('%s', DateMeasure) AS INTEGER), 0) * 1000000 " .
+  "WHERE typeof(DateMeasure) = 'text'";
+
+// Commands to store the values in their native type: add the type of the
+// metrics, and rebuild _Value without the TEXT affinity of its column
+// Value, which converted the numbers to strings. The existing metrics are
+// text metrics and their values are left unchanged.
+$cmdsMigrateTypedValues = array_merge([
+  "ALTER TABLE _Metric ADD COLUMN Type INTEGER NOT NULL DEFAULT 0",
+  "ALTER TABLE _Value RENAME TO _ValueText",
+  "CREATE TABLE _Value (" .
+  "  Ref INTEGER PRIMARY KEY," .
+  "  RefMeasure INTEGER NOT NULL," .
+  "  RefMetric INTEGER NOT NULL," .
+  "  Value NOT NULL)",
+  "INSERT INTO _Value (Ref, RefMeasure, RefMetric, Value) " .
+  "SELECT Ref, RefMeasure, RefMetric, Value FROM _ValueText",
+  "DROP TABLE _ValueText"],
+  $cmdsIndex);
+
+// SQLite types of the columns of the metrics in the materialized tables
+// and views, indexed by the type of the metric (0: text, 1: integer,
+// 2: double)
+$metricTypesSql = ["TEXT", "INTEGER", "REAL"];
+
+// Number of microseconds per second, the dates of the measures are
+// memorised as the number of microseconds since the Epoch (UTC)
+$usecPerSec = 1000000;
+
+// SQL functions of the aggregate functions, indexed by their name in the
+// action aggregate
+$aggregateFns = [
+  "min" => "MIN",
+  "max" => "MAX",
+  "mean" => "AVG",
+  "sum" => "SUM",
+  "count" => "COUNT"];
+
+// Default number of points returned by the action downsample
+$nbPointDownsample = 100;
+
+// Migration steps of the database, indexed by the version they apply to.
+// Each step is executed in one single transaction with the update of the
+// version. The commands which can't be executed in a transaction (like
+// VACUUM) are executed before it and must be harmless if executed again
+// after a failure of the step. The views of the projects are recreated,
+// and the dates in the materialized tables updated, after the last step
+// as they depend on the version.
+$migrations = [
+  "01.00.00" => [
+    "to" => "01.01.00",
+    "cmdsNoTransaction" => [],
+    "cmds" => $cmdsIndex],
+  "01.01.00" => [
+    "to" => "01.02.00",
+    "cmdsNoTransaction" => [],
+    "cmds" => []],
+  "01.02.00" => [
+    "to" => "01.03.00",
+    "cmdsNoTransaction" => [],
+    "cmds" => [
+      "ALTER TABLE _Project " .
+      "ADD COLUMN Materialized INTEGER NOT NULL DEFAULT 0"]],
+  "01.03.00" => [
+    "to" => "01.04.00",
+    "cmdsNoTransaction" => [$cmdAutoVacuum, "VACUUM"],
+    "cmds" => []],
+  "01.04.00" => [
+    "to" => "01.05.00",
+    "cmdsNoTransaction" => [],
+    "cmds" => [$cmdMigrateDateMeasure]],
+  "01.05.00" => [
+    "to" => "01.06.00",
+    "cmdsNoTransaction" => [],
+    "cmds" => [
+      "ALTER TABLE _Project " .
+      "ADD COLUMN RetentionAge INTEGER NOT NULL DEFAULT 0",
+      "ALTER TABLE _Project " .
+      "ADD COLUMN RetentionCount INTEGER NOT NULL DEFAULT 0"]],
+  "01.06.00" => [
+    "to" => "01.07.00",
+    "cmdsNoTransaction" => [],
+    "cmds" => [$cmdMigrateDateMeasureEpoch]],
+  "01.07.00" => [
+    "to" => "01.08.00",
+    "cmdsNoTransaction" => [],
+    "cmds" => $cmdsMigrateTypedValues]];
 
 // Create the database
 // Inputs:
@@ -26,33 +172,48 @@ function CreateDatabase(
   $path,
   $version) {
 
+  global $cmdsIndex;
+  global $cmdAutoVacuum;
+  global $dbOptions;
+
   try {
 
     // Create and open the database
     $db = new SQLite3($path);
 
-    // Create the database tables
-    $cmds = [
+    // Set the page size if requested and the vacuum mode, which must be
+    // done before the creation of the tables, and create the database
+    // tables
+    $cmds = [];
+    if ($dbOptions["page_size"] !== null)
+      $cmds[] = "PRAGMA page_size = " . intval($dbOptions["page_size"]);
+    $cmds = array_merge($cmds, [
+      $cmdAutoVacuum,
       "CREATE TABLE _Version (" .
       "  Ref INTEGER PRIMARY KEY," .
       "  Label TEXT NOT NULL)",
       "CREATE TABLE _Project (" .
       "  Ref INTEGER PRIMARY KEY," .
-      "  Label TEXT UNIQUE NOT NULL)",
+      "  Label TEXT UNIQUE NOT NULL," .
+      "  Materialized INTEGER NOT NULL DEFAULT 0," .
+      "  RetentionAge INTEGER NOT NULL DEFAULT 0," .
+      "  RetentionCount INTEGER NOT NULL DEFAULT 0)",
       "CREATE TABLE _Measure (" .
       "  Ref INTEGER PRIMARY KEY," .
       "  RefProject INTEGER NOT NULL," .
-      "  DateMeasure DATETIME NOT NULL)",
+      "  DateMeasure INTEGER NOT NULL)",
       "CREATE TABLE _Value (" .
       "  Ref INTEGER PRIMARY KEY," .
       "  RefMeasure INTEGER NOT NULL," .
       "  RefMetric INTEGER NOT NULL," .
-      "  Value TEXT NOT NULL)",
+      "  Value NOT NULL)",
       "CREATE TABLE _Metric (" .
       "  Ref INTEGER PRIMARY KEY," .
       "  RefProject INTEGER NOT NULL," .
       "  Label TEXT NOT NULL," .
-      "  DefaultValue TEXT NOT NULL)"];
+      "  DefaultValue TEXT NOT NULL," .
+      "  Type INTEGER NOT NULL DEFAULT 0)"]);
+    $cmds = array_merge($cmds, $cmdsIndex);
     foreach ($cmds as $cmd) {
 
       $success = $db->exec($cmd);
@@ -80,6 +241,40 @@ function CreateDatabase(
 
 }
 
+// Set the options of the database connection
+// Input:
+//   db: the database connection
+// Raise:
+//   Exception if an option couldn't be set
+function SetDatabaseOptions(
+  $db) {
+
+  global $dbOptions;
+
+  // Wait for the lock held by other requests instead of failing
+  if ($dbOptions["busy_timeout"] !== null)
+    $db->busyTimeout(intval($dbOptions["busy_timeout"]));
+
+  // Set the journal mode first, the other options are per connection
+  // and must be set again at each request
+  $cmds = [];
+  if ($dbOptions["journal_mode"] !== null)
+    $cmds[] = "PRAGMA journal_mode = " . $dbOptions["journal_mode"];
+  if ($dbOptions["synchronous"] !== null)
+    $cmds[] = "PRAGMA synchronous = " . $dbOptions["synchronous"];
+  if ($dbOptions["cache_size"] !== null)
+    $cmds[] = "PRAGMA cache_size = -" . intval($dbOptions["cache_size"]);
+  if ($dbOptions["mmap_size"] !== null)
+    $cmds[] = "PRAGMA mmap_size = " . intval($dbOptions["mmap_size"]);
+  foreach ($cmds as $cmd) {
+
+    $success = $db->exec($cmd);
+    if ($success === false) throw new Exception("exec() failed for " . $cmd);
+
+  }
+
+}
+
 // Get the version of the database
 // Input:
 //   db: the database connection
@@ -114,7 +309,8 @@ function GetVersion(
 
 }
 
-// Upgrade the database to a given version
+// Upgrade the database to a given version by applying the migration
+// steps in sequence, then recreate the views of the projects
 // Input:
 //           db: the database connection
 //   tgtVersion: the requested version
@@ -122,18 +318,73 @@ function UpgradeDB(
   $db,
   $tgtVersion) {
 
+  global $migrations;
+
   // Get the version of the database
   $rows = $db->query("SELECT Label FROM _Version LIMIT 1");
   if ($rows === false) throw new Exception("query() failed");
   $version = ($rows->fetchArray())["Label"];
 
-  // If the database version is older than the version of the API
-  if ($version < $tgtVersion) {
+  // Loop until the database is up to date
+  while ($version != $tgtVersion) {
+
+    // If there is no migration step for this version
+    if (!isset($migrations[$version]))
+      throw new Exception("No migration available from version " . $version);
+    $step = $migrations[$version];
+
+    // Execute the commands of the step which can't be executed in a
+    // transaction
+    foreach ($step["cmdsNoTransaction"] as $cmd) {
+
+      $success = $db->exec($cmd);
+      if ($success === false)
+        throw new Exception("exec() failed for " . $cmd);
+
+    }
+
+    // Apply the step and update the version in one single transaction
+    $cmds = $step["cmds"];
+    $cmds[] = "UPDATE _Version SET Label = '" . $step["to"] . "'";
+    $db->exec("BEGIN IMMEDIATE");
+    foreach ($cmds as $cmd) {
+
+      $success = $db->exec($cmd);
+      if ($success === false) {
+
+        $db->exec("ROLLBACK");
+        throw new Exception("exec() failed for " . $cmd);
+
+      }
+
+    }
+    $db->exec("COMMIT");
+
+    // Update the current version
+    $version = $step["to"];
+
+    // If it was the last step, recreate the views of the projects and
+    // update the dates in the materialized tables
+    if ($version == $tgtVersion) {
+
+      $db->exec("BEGIN IMMEDIATE");
+      try {
 
-    // Upgrade the database
-    // placeholder...
+        UpdateViewAllProjects($db);
+        SyncMaterializedDates($db);
+
+      } catch (Exception $e) {
+
+        $db->exec("ROLLBACK");
+        throw($e);
+
+      }
+      $db->exec("COMMIT");
+
+    }
 
   }
+
 }
 
 // Add a new project
@@ -246,7 +497,94 @@ function GetRefProject(
 
 }
 
-// Function to update the view for a project
+// Get the metrics of a project
+// Input:
+//           db: the database connection
+//   refProject: the project reference
+// Output:
+//   Return the dictionary ["labels" => [...], "refs" => [...], "defs" =>
+//   [...], "types" => [...]] of the metrics' label, reference, default
+//   value and type, sorted by label
+function GetMetricsOfProject(
+  $db,
+  $refProject) {
+
+  $cmd = 'SELECT Ref, Label, DefaultValue, Type FROM _Metric ' .
+    'WHERE RefProject = ' . $refProject . ' ORDER BY Label';
+  $rows = $db->query($cmd);
+  if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
+  $metrics = [
+    "labels" => array(),
+    "refs" => array(),
+    "defs" => array(),
+    "types" => array()];
+  while ($row = $rows->fetchArray()) {
+
+    array_push(
+      $metrics["labels"],
+      $row["Label"]);
+    array_push(
+      $metrics["refs"],
+      $row["Ref"]);
+    array_push(
+      $metrics["defs"],
+      $row["DefaultValue"]);
+    array_push(
+      $metrics["types"],
+      $row["Type"]);
+
+  }
+  return $metrics;
+
+}
+
+// Get the SQL columns of the values of the measure _Measure.Ref: for each
+// metric its value, found through the covering index on _Value, or its
+// default value converted to the type of the metric, inlined to be
+// resolved only once
+// Input:
+//   metrics: the metrics as returned by GetMetricsOfProject
+// Output:
+//   Return the columns as a string starting with a comma
+function GetColumnsMeasureCmd(
+  $metrics) {
+
+  global $metricTypesSql;
+
+  $cmd = "";
+  foreach($metrics["refs"] as $iMetric => $ref) {
+
+    $cmd .= ",IFNULL((SELECT Value FROM _Value ";
+    $cmd .= "WHERE RefMeasure=_Measure.Ref AND RefMetric=" . $ref . "),";
+    $cmd .= "CAST('" . SQLite3::escapeString($metrics["defs"][$iMetric]);
+    $cmd .= "' AS " . $metricTypesSql[$metrics["types"][$iMetric]] . "))";
+
+  }
+  return $cmd;
+
+}
+
+// Check if a project has a materialized table
+// Input:
+//           db: the database connection
+//   refProject: the project reference
+// Output:
+//   Return true if the project has a materialized table, else false
+function IsMaterialized(
+  $db,
+  $refProject) {
+
+  $cmd = 'SELECT Materialized FROM _Project WHERE Ref = ' . $refProject;
+  $rows = $db->query($cmd);
+  if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
+  $row = $rows->fetchArray();
+  return ($row !== false and $row["Materialized"] != 0);
+
+}
+
+// Function to update the view for a project. If the project has a
+// materialized table the view reads it, else it resolves the values of
+// each measure.
 // Input:
 //        db: the database connection
 //   project: the project's name
@@ -254,6 +592,8 @@ function UpdateViewProject(
   $db,
   $project) {
 
+  global $prefixMat;
+
   // Ensure the view doesn't exist
   $cmd = "DROP VIEW IF EXISTS \"" . $project . "\"";
   $success = $db->exec($cmd);
@@ -266,43 +606,138 @@ function UpdateViewProject(
       $project);
 
   // Get the metrics for the project
-  $cmd = 'SELECT Ref, Label FROM _Metric WHERE RefProject = ' .
-    $refProject . ' ORDER BY Label';
+  $metrics =
+    GetMetricsOfProject(
+      $db,
+      $refProject);
+
+  // Create the command for the view
+  $cmd = "CREATE VIEW \"" . $project . "\" (Ref,DateMeasure";
+  foreach($metrics["labels"] as $label) $cmd .= ",\"" . $label . "\"";
+
+  // If the project has a materialized table, read it in the order of its
+  // index on the date
+  if (IsMaterialized($db, $refProject)) {
+
+    $cmd .= ") AS SELECT Ref,DateMeasure";
+    foreach($metrics["labels"] as $label) $cmd .= ",\"" . $label . "\"";
+    $cmd .= " FROM \"" . $prefixMat . $project . "\"";
+    $cmd .= " ORDER BY DateMeasure, Ref";
+
+  // Else, resolve the values of each measure
+  } else {
+
+    $cmd .= ") AS SELECT _Measure.Ref,_Measure.DateMeasure";
+    $cmd .= GetColumnsMeasureCmd($metrics);
+    $cmd .= " FROM _Measure WHERE _Measure.RefProject = " . $refProject;
+    $cmd .= " ORDER BY _Measure.DateMeasure, _Measure.Ref";
+
+  }
+
+  // Create the view
+  $success = $db->exec($cmd);
+  if ($success === false) throw new Exception("exec() failed for " . $cmd);
+
+}
+
+// Update the views of all the projects
+// Input:
+//   db: the database connection
+function UpdateViewAllProjects(
+  $db) {
+
+  // Get the projects
+  $cmd = 'SELECT Label FROM _Project';
   $rows = $db->query($cmd);
   if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
-  $labels = array();
-  $refs = array();
-  $defs = array();
-  while ($row = $rows->fetchArray()) {
-
+  $projects = array();
+  while ($row = $rows->fetchArray())
     array_push(
-      $labels,
+      $projects,
       $row["Label"]);
+
+  // Update the view of each project
+  foreach ($projects as $project)
+    UpdateViewProject(
+      $db,
+      $project);
+
+}
+
+// Get the projects having a materialized table
+// Input:
+//   db: the database connection
+// Output:
+//   Return the array of the projects' name
+function GetMaterializedProjects(
+  $db) {
+
+  $cmd = 'SELECT Label FROM _Project WHERE Materialized = 1';
+  $rows = $db->query($cmd);
+  if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
+  $projects = array();
+  while ($row = $rows->fetchArray())
     array_push(
-      $refs,
-      $row["Ref"]);
+      $projects,
+      $row["Label"]);
+  return $projects;
 
-  }
+}
 
-  // Create the command for the view
-  $cmd = "CREATE VIEW \"" . $project . "\" (Ref";
-  foreach($labels as $label) $cmd .= ",\"" . $label . "\"";
-  $cmd .= ") AS SELECT _Measure.Ref ";
-  foreach($refs as $ref) {
+// Copy the dates of the measures into the materialized tables of all the
+// projects, after a migration which changed them
+// Input:
+//   db: the database connection
+function SyncMaterializedDates(
+  $db) {
 
-    $cmd .= ",IFNULL((SELECT Value FROM _Value ";
-    $cmd .= "WHERE RefMeasure=_Measure.Ref AND RefMetric=";
-    $cmd .= $ref;
-    $cmd .= "),(SELECT DefaultValue FROM _Metric WHERE Ref=";
-    $cmd .= $ref . ")) ";
+  global $prefixMat;
+
+  // Loop on the materialized projects
+  foreach (GetMaterializedProjects($db) as $project) {
+
+    // Copy the dates of the measures
+    $table = '"' . $prefixMat . $project . '"';
+    $cmd = 'UPDATE ' . $table . ' SET DateMeasure = ' .
+           '(SELECT DateMeasure FROM _Measure ' .
+           'WHERE _Measure.Ref = ' . $table . '.Ref)';
+    $success = $db->exec($cmd);
+    if ($success === false) throw new Exception("exec() failed for " . $cmd);
 
   }
-  $cmd .= "FROM _Measure WHERE _Measure.RefProject = ";
-  $cmd .= $refProject . " ORDER BY _Measure.DateMeasure, _Measure.Ref";
 
-  // Create the view
-  $success = $db->exec($cmd);
-  if ($success === false) throw new Exception("exec() failed for " . $cmd);
+}
+
+// Check if a value is valid for a type of metric
+// Input:
+//   value: the value as a string
+//    type: the type of the metric (0: text, 1: integer, 2: double)
+// Output:
+//   Return true if the value is a valid text or a number of the type of
+//   the metric, else false
+function IsValidValueOfType(
+  $value,
+  $type) {
+
+  if (preg_match('/^[^"=&]+$/', $value) == false) return false;
+  if ($type == 1) return (preg_match('/^[+-]?[0-9]+$/', $value) == true);
+  if ($type == 2) return is_numeric($value);
+  return true;
+
+}
+
+// Convert a value read from the database to a string. Doubles are
+// converted with the shortest representation converting back exactly,
+// instead of the 14 significant digits of the default conversion.
+// Input:
+//   value: the value
+// Output:
+//   Return the value as a string
+function FormatValue(
+  $value) {
+
+  if (is_float($value)) return var_export($value, true);
+  return "" . $value;
 
 }
 
@@ -312,6 +747,8 @@ function UpdateViewProject(
 //   project: the project's name
 //     label: the metrics's label
 //   default: the metric's default value
+//      type: the type of the values of the metric (0: text, 1: integer,
+//            2: double)
 // Output:
 //   If successful returns the dictionary {"ret":"0"}.
 //   Else, returns the dictionary {"ret":"1", "errMsg":"..."}.
@@ -319,7 +756,11 @@ function AddMetric(
   $db,
   $project,
   $label,
-  $default) {
+  $default,
+  $type = 0) {
+
+  global $prefixMat;
+  global $metricTypesSql;
 
   // Init the result dictionary
   $res = array();
@@ -336,11 +777,17 @@ function AddMetric(
     if (
       preg_match('/^[a-zA-Z][a-zA-Z0-9_]*$/', $label) == false or
       $label == "project" or
-      $label == "action")
+      $label == "action" or
+      $label == "DateMeasure")
       throw new Exception("The label " . $label. " is invalid.");
 
+    // Check the type
+    if (preg_match('/^[0-2]$/', "" . $type) == false)
+      throw new Exception("The type " . $type . " is invalid.");
+    $type = intval($type);
+
     // Check the default value
-    if (preg_match('/^[^"=&]+$/', $default) == false)
+    if (IsValidValueOfType($default, $type) == false)
       throw new Exception("The default value " . $default . " is invalid.");
 
     // If the metric doesn't already exists
@@ -354,12 +801,26 @@ function AddMetric(
         throw new Exception("The default value is invalid.");
 
       // Add the metric in the database
-      $cmd = 'INSERT INTO _Metric(RefProject, Label, DefaultValue) ' .
+      $cmd = 'INSERT INTO _Metric(RefProject, Label, DefaultValue, Type) ' .
              'VALUES (' . $refProject . ', "' . $label . '", "' .
-             $default . '")';
+             $default . '", ' . $type . ')';
       $success = $db->exec($cmd);
       if ($success === false) throw new Exception("exec() failed for " . $cmd);
 
+      // If the project has a materialized table, add the column of the
+      // metric, the existing measures get the default value
+      if (IsMaterialized($db, $refProject)) {
+
+        $cmd = 'ALTER TABLE "' . $prefixMat . $project . '" ' .
+               'ADD COLUMN "' . $label . '" ' . $metricTypesSql[$type] .
+               ' NOT NULL DEFAULT \'' . SQLite3::escapeString($default) .
+               '\'';
+        $success = $db->exec($cmd);
+        if ($success === false)
+          throw new Exception("exec() failed for " . $cmd);
+
+      }
+
     }
 
     // Update the view for the project
@@ -386,8 +847,9 @@ function AddMetric(
 //   project: the project's name
 // Output:
 //   If successful returns the dictionary {"ret":"0",
-//   "metrics":["Ref1":["Label":"Label1", "DefaultValue":"Value1"],
-//   "Ref2":["Label":"Label2", "DefaultValue":"Value2"],...]}.
+//   "metrics":["Ref1":["Label":"Label1", "DefaultValue":"Value1",
+//   "Type":"Type1"], "Ref2":["Label":"Label2", "DefaultValue":"Value2",
+//   "Type":"Type2"],...]}.
 //   Else, returns the dictionary {"ret":"1", "errMsg":"..."}.
 function GetMetrics(
   $db,
@@ -400,8 +862,8 @@ function GetMetrics(
 
     // Get the metrics for the project
     $rows = $db->query(
-      'SELECT _Metric.Ref, _Metric.Label, _Metric.DefaultValue ' .
-      'FROM _Metric, _Project ' .
+      'SELECT _Metric.Ref, _Metric.Label, _Metric.DefaultValue, ' .
+      '_Metric.Type FROM _Metric, _Project ' .
       'WHERE _Metric.RefProject = _Project.Ref AND ' . 
       '_Project.Label = "' . $project . '" ORDER BY _Metric.Label');
     if ($rows === false) throw new Exception("query() failed");
@@ -410,6 +872,7 @@ function GetMetrics(
       $res["metrics"][$row["Ref"]] = [];
       $res["metrics"][$row["Ref"]]["Label"] = $row["Label"];
       $res["metrics"][$row["Ref"]]["DefaultValue"] = $row["DefaultValue"];
+      $res["metrics"][$row["Ref"]]["Type"] = "" . $row["Type"];
     }
 
     // Set the success code in the result dictionary
@@ -427,6 +890,22 @@ function GetMetrics(
 
 }
 
+// Get the current date in the format of _Measure.DateMeasure, the number
+// of microseconds since the Epoch (UTC)
+// Output:
+//   Return the date
+function GetDateMeasureNow() {
+
+  global $usecPerSec;
+
+  // Get the current date as seconds and fraction of seconds, and convert
+  // it to microseconds without loss of precision
+  list($fraction, $sec) = explode(" ", microtime());
+  return
+    intval($sec) * $usecPerSec + intval(floatval($fraction) * $usecPerSec);
+
+}
+
 // Add a new measure in a project
 // Input:
 //        db: the database connection
@@ -441,6 +920,9 @@ function AddMeasure(
   $project,
   $values) {
 
+  global $prefixMat;
+  global $metricTypesSql;
+
   $res = array();
 
   try {
@@ -451,12 +933,12 @@ function AddMeasure(
         $db,
         $project);
 
-    // Get the date of the record
-    $date = date("Y-m-d H:m:s");
+    // Get the date of the record (use the current date)
+    $date = GetDateMeasureNow();
 
     // Add the measure in the database
     $cmd = 'INSERT INTO _Measure(RefProject, DateMeasure) VALUES (' . 
-           $refProject . ', "' . $date . '")';
+           $refProject . ', ' . $date . ')';
     $success = $db->exec($cmd);
     if ($success === false) throw new Exception("exec() failed for " . $cmd);
 
@@ -472,37 +954,47 @@ function AddMeasure(
     // Loop on the metrics in argument
     foreach ($values as $metric => $value) {
 
-      // If the value is not valid
-      $isValidValue =
-        preg_match(
-          '/^[^"=&]+$/',
-          $value);
-      if ($isValidValue == false) {
+      // Get the reference and type of the metric
+      $rows = $db->query('SELECT Ref, Type FROM _Metric WHERE Label = "' .
+                         $metric . '" AND RefProject = ' . $refProject);
+      if ($rows === false) throw new Exception("query() failed");
+      $row = $rows->fetchArray();
+
+      // If the value is not valid, for the type of the metric if it
+      // exists
+      $type = ($row !== false ? $row["Type"] : 0);
+      if (IsValidValueOfType($value, $type) == false) {
 
         $hasFailed = true;
 
-      // Else, the value is valid
-      } else {
+      // Else, if this metric exists
+      } else if ($row !== false) {
 
-        // Get the reference of the metric
-        $rows = $db->query('SELECT Ref FROM _Metric WHERE Label = "' .
-                           $metric . '" AND RefProject = ' . $refProject);
-        if ($rows === false) throw new Exception("query() failed");
+        // Add the value, converted to the type of the metric
+        $cmd = 'INSERT INTO _Value(RefMeasure, RefMetric, Value) VALUES (' .
+               $refMeasure . ', ' . $row["Ref"] . ', CAST("' . $value .
+               '" AS ' . $metricTypesSql[$row["Type"]] . '))';
+        $success = $db->exec($cmd);
+        if ($success === false) $hasFailed = true;
 
-        // If this metric exists
-        $row = $rows->fetchArray();
-        if ($row !== false) {
+      }
+   
+    }
 
-          // Add the value
-          $cmd = 'INSERT INTO _Value(RefMeasure, RefMetric, Value) VALUES (' .
-                 $refMeasure . ', ' . $row["Ref"] . ', "' . $value . '")';
-          $success = $db->exec($cmd);
-          if ($success === false) $hasFailed = true;
+    // If the project has a materialized table, add the measure to it
+    if (IsMaterialized($db, $refProject)) {
 
-        }
+      $metrics =
+        GetMetricsOfProject(
+          $db,
+          $refProject);
+      $cmd = 'INSERT INTO "' . $prefixMat . $project . '" ' .
+             'SELECT _Measure.Ref, _Measure.DateMeasure' .
+             GetColumnsMeasureCmd($metrics) .
+             ' FROM _Measure WHERE _Measure.Ref = ' . $refMeasure;
+      $success = $db->exec($cmd);
+      if ($success === false) $hasFailed = true;
 
-      }
-   
     }
 
     // Memorise the reference of the new measure as a string
@@ -526,6 +1018,172 @@ function AddMeasure(
 
 }
 
+// Add several measures in a project, in one single transaction
+// Input:
+//         db: the database connection
+//    project: the project's name
+//   measures: the measures as a JSON encoded array of dictionaries
+//             [{"metricA":"valueA", "metricB":"valueB",...}, ...]
+// Output:
+//   If successful returns the dictionary {"ret":"0", "refLastMeasure":"...",
+//   "nbFailed":"..."} with the reference of the last added measure and
+//   the number of measures which couldn't be entirely added. The policy
+//   is the same as for AddMeasure, the other measures are still added.
+//   Else, returns the dictionary {"ret":"1", "errMsg":"..."}.
+function AddMeasures(
+  $db,
+  $project,
+  $measures) {
+
+  global $prefixMat;
+  global $metricTypesSql;
+
+  $res = array();
+
+  try {
+
+    // Decode the measures
+    $measures = json_decode($measures, true);
+    if (is_array($measures) == false)
+      throw new Exception("The measures are invalid.");
+
+    // Get the project reference and its metrics, once for all the
+    // measures
+    $refProject =
+      GetRefProject(
+        $db,
+        $project);
+    $metrics =
+      GetMetricsOfProject(
+        $db,
+        $refProject);
+    $idxMetrics = array_flip($metrics["labels"]);
+
+    // Prepare the commands to add the measures and the values, per type
+    // of metric
+    $stmtMeasure = $db->prepare(
+      'INSERT INTO _Measure(RefProject, DateMeasure) VALUES (' .
+      $refProject . ', :date)');
+    if ($stmtMeasure === false) throw new Exception("prepare() failed");
+    $stmtValues = array();
+    foreach ($metricTypesSql as $type => $typeSql) {
+
+      $stmtValues[$type] = $db->prepare(
+        'INSERT INTO _Value(RefMeasure, RefMetric, Value) VALUES ' .
+        '(:measure, :metric, CAST(:value AS ' . $typeSql . '))');
+      if ($stmtValues[$type] === false)
+        throw new Exception("prepare() failed");
+
+    }
+
+    // Add the measures in one single transaction
+    $refFirstMeasure = 0;
+    $refMeasure = 0;
+    $nbFailed = 0;
+    $db->exec("BEGIN IMMEDIATE");
+    try {
+
+      // Loop on the measures
+      foreach ($measures as $values) {
+
+        // Add the measure with its date if given as "_date" (in
+        // microseconds since the Epoch, e.g. for measures spooled while
+        // the Web API couldn't be reached), else the current date. The
+        // metric labels start with a letter so "_date" can't be a metric
+        $date = GetDateMeasureNow();
+        if (is_array($values) and isset($values["_date"]) and
+            ctype_digit("" . $values["_date"]))
+          $date = intval($values["_date"]);
+        $stmtMeasure->bindValue(":date", $date, SQLITE3_INTEGER);
+        if ($stmtMeasure->execute() === false)
+          throw new Exception("execute() failed for INSERT INTO _Measure");
+        $stmtMeasure->reset();
+        $refMeasure = $db->lastInsertRowID();
+        if ($refFirstMeasure == 0) $refFirstMeasure = $refMeasure;
+
+        // Loop on the values of the measure, same policy as AddMeasure
+        $hasFailed = false;
+        if (is_array($values) == false) {
+
+          $hasFailed = true;
+          $values = array();
+
+        }
+        foreach ($values as $metric => $value) {
+
+          // If the metric doesn't exist, ignore the value
+          if (isset($idxMetrics[$metric]) == false) continue;
+          $iMetric = $idxMetrics[$metric];
+
+          // If the value is not valid for the type of the metric
+          $type = $metrics["types"][$iMetric];
+          if (IsValidValueOfType("" . $value, $type) == false) {
+
+            $hasFailed = true;
+
+          // Else, add the value
+          } else {
+
+            $stmt = $stmtValues[$type];
+            $stmt->bindValue(":measure", $refMeasure, SQLITE3_INTEGER);
+            $stmt->bindValue(
+              ":metric", $metrics["refs"][$iMetric], SQLITE3_INTEGER);
+            $stmt->bindValue(":value", "" . $value, SQLITE3_TEXT);
+            if ($stmt->execute() === false) $hasFailed = true;
+            $stmt->reset();
+
+          }
+
+        }
+        if ($hasFailed == true) ++$nbFailed;
+
+      }
+
+      // If the project has a materialized table, add the measures to it
+      if ($refFirstMeasure != 0 and IsMaterialized($db, $refProject)) {
+
+        $cmd = 'INSERT INTO "' . $prefixMat . $project . '" ' .
+               'SELECT _Measure.Ref, _Measure.DateMeasure' .
+               GetColumnsMeasureCmd($metrics) .
+               ' FROM _Measure WHERE _Measure.RefProject = ' . $refProject .
+               ' AND _Measure.Ref BETWEEN ' . $refFirstMeasure .
+               ' AND ' . $refMeasure;
+        $success = $db->exec($cmd);
+        if ($success === false)
+          throw new Exception("exec() failed for " . $cmd);
+
+      }
+
+    } catch (Exception $e) {
+
+      $db->exec("ROLLBACK");
+      throw($e);
+
+    }
+    $db->exec("COMMIT");
+
+    // Memorise the reference of the last measure and the number of
+    // failures as strings. The measures are added in one single
+    // transaction, so their references are consecutive and the clients
+    // can deduce the reference of each measure from the last one
+    $res["refLastMeasure"] = "" . $refMeasure;
+    $res["nbFailed"] = "" . $nbFailed;
+
+    // Set the success code in the result dictionary
+    $res["ret"] = "0";
+
+  } catch (Exception $e) {
+
+    $res["ret"] = "1";
+    $res["errMsg"] = "line " . $e->getLine() . ": " . $e->getMessage();
+
+  }
+
+  // Return the dictionary
+  return $res;
+
+}
+
 // Delete a measure
 // Input:
 //        db: the database connection
@@ -537,11 +1195,32 @@ function DeleteMeasure(
   $db,
   $measure) {
 
+  global $prefixMat;
+
   // Init the result dictionary
   $res = array();
 
   try {
 
+    // If the project of the measure has a materialized table, delete the
+    // measure from it
+    $cmd = 'SELECT _Project.Label FROM _Measure, _Project ' .
+           'WHERE _Measure.Ref = ' . intval($measure) .
+           ' AND _Project.Ref = _Measure.RefProject ' .
+           'AND _Project.Materialized = 1';
+    $rows = $db->query($cmd);
+    if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
+    $row = $rows->fetchArray();
+    if ($row !== false) {
+
+      $cmd = 'DELETE FROM "' . $prefixMat . $row["Label"] . '" ' .
+             'WHERE Ref = ' . intval($measure);
+      $success = $db->exec($cmd);
+      if ($success === false)
+        throw new Exception("exec() failed for " . $cmd);
+
+    }
+
     // Delete the values of the measure in the database
     $cmd = 'DELETE FROM _Value WHERE RefMeasure = ' . $measure;
     $success = $db->exec($cmd);
@@ -567,39 +1246,185 @@ function DeleteMeasure(
 
 }
 
-// Get the list measures for a project as CSV
+// Delete several measures in one single transaction, given either by the
+// list of their references, or by a range of references, or by a period
+// of time in a project
 // Input:
-//          db: the database connection
-//     project: the project's name
-//         sep: the character used as a separator
-//   nbMeasure: maximum number of measures to be returned. If 0, returns
-//              all the measure in the order they were added. If >0 returns
-//              at maximum the last nbMeasure measures ordered from the
-//              most recent to the oldest.
+//         db: the database connection
+//   measures: the references of the measures separated by commas, or null
+//    fromRef: the first reference of the range, or null
+//      toRef: the last reference of the range (included), or null
+//    project: the project's name, or null
+//   fromDate: the start of the period (seconds since epoch), or null
+//     toDate: the end of the period (seconds since epoch, excluded), or
+//             null
 // Output:
-//   If successful returns the data in CSV format as (e.g. sep=&)
-//   metricA&metricB&...
-//   valueA1&valueB1&...
-//   valueA2&valueB2&...
-//   ...
+//   If successful returns the dictionary {"ret":"0"}.
 //   Else, returns the dictionary {"ret":"1", "errMsg":"..."}.
-function GetMeasuresAsCSV(
+function DeleteMeasures(
   $db,
+  $measures,
+  $fromRef,
+  $toRef,
   $project,
-  $sep,
-  $nbMeasure) {
+  $fromDate,
+  $toDate) {
+
+  global $prefixMat;
+  global $usecPerSec;
 
   // Init the result dictionary
   $res = array();
 
+  $db->exec("BEGIN IMMEDIATE");
   try {
 
-    // Get the measures
+    // If the measures are given by their references
+    if ($measures !== null) {
+
+      // Loop on the measures and delete them
+      foreach (explode(",", $measures) as $measure) {
+
+        $ret = DeleteMeasure($db, intval($measure));
+        if ($ret["ret"] != "0") throw new Exception($ret["errMsg"]);
+
+      }
+
+    // Else, if the measures are given by a range of references
+    } else if ($fromRef !== null and $toRef !== null) {
+
+      // Create the commands to delete the measures in the materialized
+      // tables, the values and the measures
+      $range = ' BETWEEN ' . intval($fromRef) . ' AND ' . intval($toRef);
+      $cmds = array();
+      foreach (GetMaterializedProjects($db) as $matProject)
+        $cmds[] = 'DELETE FROM "' . $prefixMat . $matProject . '" ' .
+                  'WHERE Ref' . $range;
+      $cmds[] = 'DELETE FROM _Value WHERE RefMeasure' . $range;
+      $cmds[] = 'DELETE FROM _Measure WHERE Ref' . $range;
+
+      // Execute the commands
+      foreach ($cmds as $cmd) {
+
+        $success = $db->exec($cmd);
+        if ($success === false)
+          throw new Exception("exec() failed for " . $cmd);
+
+      }
+
+    // Else, if the measures are given by a period in a project
+    } else if ($project !== null and $fromDate !== null and
+               $toDate !== null) {
+
+      // Get the project reference
+      $refProject =
+        GetRefProject(
+          $db,
+          $project);
+
+      // Convert the dates to the format of _Measure.DateMeasure
+      $period =
+        ' DateMeasure >= ' . (intval($fromDate) * $usecPerSec) .
+        ' AND DateMeasure < ' . (intval($toDate) * $usecPerSec);
+
+      // Create the commands to delete the measures in the eventual
+      // materialized table, the values and the measures
+      $cmds = array();
+      if (IsMaterialized($db, $refProject))
+        $cmds[] = 'DELETE FROM "' . $prefixMat . $project . '" WHERE' .
+                  $period;
+      $cmds[] = 'DELETE FROM _Value WHERE RefMeasure IN ' .
+                '(SELECT Ref FROM _Measure WHERE RefProject = ' .
+                $refProject . ' AND' . $period . ')';
+      $cmds[] = 'DELETE FROM _Measure WHERE RefProject = ' . $refProject .
+                ' AND' . $period;
+
+      // Execute the commands
+      foreach ($cmds as $cmd) {
+
+        $success = $db->exec($cmd);
+        if ($success === false)
+          throw new Exception("exec() failed for " . $cmd);
+
+      }
+
+    // Else, the arguments are invalid
+    } else {
+
+      throw new Exception("Invalid arguments.");
+
+    }
+
+    // Commit the deletions
+    $db->exec("COMMIT");
+
+    // Set the success code in the result dictionary
+    $res["ret"] = "0";
+
+  } catch (Exception $e) {
+
+    // Cancel all the deletions
+    $db->exec("ROLLBACK");
+    $res["ret"] = "1";
+    $res["errMsg"] = "line " . $e->getLine() . ": " . $e->getMessage();
+
+  }
+
+  // Return the dictionary
+  return $res;
+
+}
+
+// Get the list measures for a project as CSV
+// Input:
+//          db: the database connection
+//     project: the project's name
+//         sep: the character used as a separator
+//   nbMeasure: maximum number of measures to be returned. If 0, returns
+//              all the measure in the order they were added. If >0 returns
+//              at maximum the last nbMeasure measures ordered from the
+//              most recent to the oldest.
+//    fromDate: if not null, only the measures at or after this date
+//              (seconds since epoch) are returned
+//      toDate: if not null, only the measures before this date (seconds
+//              since epoch) are returned
+//       limit: if nbMeasure is 0 and limit is >0, returns at maximum the
+//              first limit measures
+//       since: if not null, only the measures with a reference greater
+//              than since, i.e. added after the measure since, are
+//              returned, ordered by reference if nbMeasure is 0
+// Output:
+//   If successful returns the data in CSV format as (e.g. sep=&)
+//   metricA&metricB&...
+//   valueA1&valueB1&...
+//   valueA2&valueB2&...
+//   ...
+//   Else, returns the dictionary {"ret":"1", "errMsg":"..."}.
+function GetMeasuresAsCSV(
+  $db,
+  $project,
+  $sep,
+  $nbMeasure,
+  $fromDate = null,
+  $toDate = null,
+  $limit = 0,
+  $since = null) {
+
+  // Init the result dictionary
+  $res = array();
+
+  try {
+
+    // Get the measures
     $measures =
       GetMeasures(
         $db,
         $project,
-        $nbMeasure);
+        $nbMeasure,
+        $fromDate,
+        $toDate,
+        $limit,
+        $since);
     if ($measures["ret"] != "0") return $measures;
     
     // Create the first line with the metrics' label
@@ -633,6 +1458,15 @@ function GetMeasuresAsCSV(
 //              all the measure in the order they were added. If >0 returns
 //              at maximum the last nbMeasure measures ordered from the
 //              most recent to the oldest.
+//    fromDate: if not null, only the measures at or after this date
+//              (seconds since epoch) are returned
+//      toDate: if not null, only the measures before this date (seconds
+//              since epoch) are returned
+//       limit: if nbMeasure is 0 and limit is >0, returns at maximum the
+//              first limit measures
+//       since: if not null, only the measures with a reference greater
+//              than since, i.e. added after the measure since, are
+//              returned, ordered by reference if nbMeasure is 0
 // Output:
 //   If successful returns a dictionary {"ret":"0", "labels":["metricA",
 //   metricB", ...], "values":[["valueA1", "valueA2"], ["valueB1",
@@ -641,7 +1475,13 @@ function GetMeasuresAsCSV(
 function GetMeasures(
   $db,
   $project,
-  $nbMeasure) {
+  $nbMeasure,
+  $fromDate = null,
+  $toDate = null,
+  $limit = 0,
+  $since = null) {
+
+  global $usecPerSec;
 
   // Init the result dictionary
   $res = array();
@@ -663,6 +1503,7 @@ function GetMeasures(
     // Add the metrics' label to the result dictionary
     $res["labels"] = array();
     array_push($res["labels"], "Ref");
+    array_push($res["labels"], "DateMeasure");
     while ($row = $rows->fetchArray())
       array_push($res["labels"], $row["Label"]);
 
@@ -671,11 +1512,36 @@ function GetMeasures(
     foreach ($res["labels"] as $label) $cmd .= ',"' . $label . '"';
     $cmd .= ' FROM "' . $project . '"';
 
-    // Order the measures according to the number of returned measures
-    if ($nbMeasure > 0)
+    // Restrict the measures to the requested period, if any
+    $conds = array();
+    if ($fromDate !== null)
+      $conds[] = 'DateMeasure >= ' . (intval($fromDate) * $usecPerSec);
+    if ($toDate !== null)
+      $conds[] = 'DateMeasure < ' . (intval($toDate) * $usecPerSec);
+
+    // Restrict the measures to the ones added after the measure since, if
+    // any, they are found through the primary key of the measures
+    if ($since !== null) $conds[] = 'Ref > ' . intval($since);
+    if (count($conds) > 0) $cmd .= ' WHERE ' . implode(' AND ', $conds);
+
+    // Order the measures according to the number of returned measures,
+    // the oldest ones are read in the order of the index on their date,
+    // or of their reference when reading the ones added since a measure
+    if ($nbMeasure > 0) {
+
       $cmd .= ' ORDER BY Ref DESC LIMIT ' . $nbMeasure;
-    else
-      $cmd .= ' ORDER BY Ref ASC';
+
+    } else if ($since !== null) {
+
+      $cmd .= ' ORDER BY Ref';
+      if ($limit > 0) $cmd .= ' LIMIT ' . intval($limit);
+
+    } else {
+
+      $cmd .= ' ORDER BY DateMeasure, Ref';
+      if ($limit > 0) $cmd .= ' LIMIT ' . intval($limit);
+
+    }
  
     // Get the measures
     $rows = $db->query($cmd);
@@ -685,7 +1551,273 @@ function GetMeasures(
 
       // Add the values to the result dictionary
       $values = [];
-      foreach ($res["labels"] as $label) array_push($values, $row[$label]);
+      foreach ($res["labels"] as $label)
+        array_push($values, FormatValue($row[$label]));
+      array_push($res["values"], $values);
+
+    }
+
+    // Set the success code in the result dictionary
+    $res["ret"] = "0";
+
+  } catch (Exception $e) {
+
+    $res["ret"] = "1";
+    $res["errMsg"] = "line " . $e->getLine() . ": " . $e->getMessage();
+
+  }
+
+  // Return the dictionary
+  return $res;
+
+}
+
+// Aggregate the values of a metric of a project, in the database
+// Input:
+//         db: the database connection
+//    project: the project's name
+//     metric: the metric's label
+//         fn: the aggregate function (min, max, mean, sum or count)
+//   fromDate: if not null, only the measures at or after this date
+//             (seconds since epoch) are aggregated
+//     toDate: if not null, only the measures before this date (seconds
+//             since epoch) are aggregated
+//   interval: if not null, the measures are aggregated per interval of
+//             this duration in seconds, aligned on the epoch, instead of
+//             all together
+// Output:
+//   If successful returns a dictionary {"ret":"0", "value":"..."}, or if
+//   interval is not null a dictionary {"ret":"0", "dates":["...", ...],
+//   "values":["...", ...]} of the start date of the non empty intervals
+//   and their aggregated value. Values are empty if there is nothing to
+//   aggregate.
+//   Else, returns the dictionary {"ret":"1", "errMsg":"..."}.
+function Aggregate(
+  $db,
+  $project,
+  $metric,
+  $fn,
+  $fromDate = null,
+  $toDate = null,
+  $interval = null) {
+
+  global $usecPerSec;
+  global $aggregateFns;
+
+  // Init the result dictionary
+  $res = array();
+
+  try {
+
+    // Check the arguments, the project and metric are inserted in the
+    // command
+    $refProject =
+      GetRefProject(
+        $db,
+        $project);
+    $metrics =
+      GetMetricsOfProject(
+        $db,
+        $refProject);
+    if (in_array($metric, $metrics["labels"], true) == false)
+      throw new Exception("The metric " . $metric . " is invalid.");
+    if (isset($aggregateFns[$fn]) == false)
+      throw new Exception("The aggregate function " . $fn . " is invalid.");
+    if ($interval !== null and intval($interval) <= 0)
+      throw new Exception("The interval " . $interval . " is invalid.");
+
+    // Create the command to aggregate the values, grouped by the index
+    // of their interval since the epoch if requested
+    $cmd = 'SELECT ';
+    if ($interval !== null)
+      $cmd .= 'DateMeasure / ' . (intval($interval) * $usecPerSec) .
+        ' AS Bucket, ';
+    $cmd .= $aggregateFns[$fn] . '("' . $metric . '") AS Value ' .
+      'FROM "' . $project . '"';
+
+    // Restrict the measures to the requested period, if any
+    $conds = array();
+    if ($fromDate !== null)
+      $conds[] = 'DateMeasure >= ' . (intval($fromDate) * $usecPerSec);
+    if ($toDate !== null)
+      $conds[] = 'DateMeasure < ' . (intval($toDate) * $usecPerSec);
+    if (count($conds) > 0) $cmd .= ' WHERE ' . implode(' AND ', $conds);
+    if ($interval !== null) $cmd .= ' GROUP BY Bucket ORDER BY Bucket';
+
+    // Aggregate the values
+    $rows = $db->query($cmd);
+    if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
+    if ($interval !== null) {
+
+      $res["dates"] = array();
+      $res["values"] = array();
+      while ($row = $rows->fetchArray()) {
+
+        array_push(
+          $res["dates"],
+          "" . ($row["Bucket"] * intval($interval)));
+        array_push(
+          $res["values"],
+          FormatValue($row["Value"]));
+
+      }
+
+    } else {
+
+      $row = $rows->fetchArray();
+      $res["value"] = FormatValue($row["Value"]);
+
+    }
+
+    // Set the success code in the result dictionary
+    $res["ret"] = "0";
+
+  } catch (Exception $e) {
+
+    $res["ret"] = "1";
+    $res["errMsg"] = "line " . $e->getLine() . ": " . $e->getMessage();
+
+  }
+
+  // Return the dictionary
+  return $res;
+
+}
+
+// Downsample the measures of a project in a period of time: the period
+// is split into at most nbPoint intervals of equal duration and the
+// measures in each interval are reduced, in the database, to the minimum,
+// mean and maximum of the numeric metrics and the most recent value of the
+// text metrics. The cost of the result doesn't depend on the number of
+// measures in the project.
+// Input:
+//         db: the database connection
+//    project: the project's name
+//    nbPoint: the maximum number of intervals
+//   fromDate: if not null, the start of the period (seconds since epoch),
+//             else the date of the oldest measure
+//     toDate: if not null, the end of the period (seconds since epoch,
+//             excluded), else the date of the most recent measure
+// Output:
+//   If successful returns a dictionary {"ret":"0", "labels":["DateMeasure",
+//   "Nb", "metricA (min)", "metricA (mean)", "metricA (max)", ...,
+//   "metricB", ...], "values":[["date1", "nb1", "minA1", "meanA1",
+//   "maxA1", ..., "valueB1", ...], ...]} of the non empty intervals, from
+//   the oldest to the most recent, with their start date (microseconds
+//   since epoch) and their number of measures. The numeric metrics come
+//   before the text metrics.
+//   Else, returns the dictionary {"ret":"1", "errMsg":"..."}.
+function Downsample(
+  $db,
+  $project,
+  $nbPoint,
+  $fromDate = null,
+  $toDate = null) {
+
+  global $usecPerSec;
+
+  // Init the result dictionary
+  $res = array();
+
+  try {
+
+    // Check the arguments
+    $refProject =
+      GetRefProject(
+        $db,
+        $project);
+    $nbPoint = intval($nbPoint);
+    if ($nbPoint <= 0)
+      throw new Exception("The number of points " . $nbPoint .
+        " is invalid.");
+    $metrics =
+      GetMetricsOfProject(
+        $db,
+        $refProject);
+
+    // Get the boundaries of the period, in microseconds, the missing
+    // ones are given by the dates of the measures
+    $cmd = 'SELECT MIN(DateMeasure) AS DateMin, ' .
+      'MAX(DateMeasure) AS DateMax FROM _Measure ' .
+      'WHERE RefProject = ' . $refProject;
+    $rows = $db->query($cmd);
+    if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
+    $row = $rows->fetchArray();
+    $from =
+      ($fromDate !== null ?
+        intval($fromDate) * $usecPerSec : intval($row["DateMin"]));
+    $to =
+      ($toDate !== null ?
+        intval($toDate) * $usecPerSec : intval($row["DateMax"]) + 1);
+
+    // Duration of the intervals, rounded up for the period to be covered
+    // by nbPoint intervals
+    $width = intdiv($to - $from + $nbPoint - 1, $nbPoint);
+    if ($width < 1) $width = 1;
+
+    // Create the commands reducing the measures of each interval. The
+    // value of the text metrics is taken from the row of the most recent
+    // measure of the interval, which requires MAX to be the only
+    // aggregate function of its command.
+    $res["labels"] = ["DateMeasure", "Nb"];
+    $cmdBucket = 'SELECT (DateMeasure - ' . $from . ') / ' . $width .
+      ' AS Bucket';
+    $cmdPeriod = ' FROM "' . $project . '" WHERE DateMeasure >= ' . $from .
+      ' AND DateMeasure < ' . $to . ' GROUP BY Bucket ORDER BY Bucket';
+    $cmdNum = $cmdBucket . ', COUNT(*)';
+    $cmdText = $cmdBucket . ', MAX(DateMeasure)';
+    $labelsText = array();
+    foreach ($metrics["labels"] as $iMetric => $label) {
+
+      $col = '"' . $label . '"';
+      if ($metrics["types"][$iMetric] == 0) {
+
+        $cmdText .= ',' . $col;
+        array_push($labelsText, $label);
+
+      } else {
+
+        $cmdNum .= ',MIN(' . $col . '),AVG(' . $col . '),MAX(' . $col . ')';
+        array_push(
+          $res["labels"],
+          $label . " (min)",
+          $label . " (mean)",
+          $label . " (max)");
+
+      }
+
+    }
+    $res["labels"] = array_merge($res["labels"], $labelsText);
+
+    // Get the values of the text metrics per interval, if any
+    $valuesText = array();
+    if (count($labelsText) > 0) {
+
+      $cmd = $cmdText . $cmdPeriod;
+      $rows = $db->query($cmd);
+      if ($rows === false)
+        throw new Exception("query(" . $cmd . ") failed");
+      while ($row = $rows->fetchArray(SQLITE3_NUM))
+        $valuesText[$row[0]] = array_map(
+          "FormatValue",
+          array_slice($row, 2));
+
+    }
+
+    // Reduce the numeric metrics and merge them with the text metrics
+    $cmd = $cmdNum . $cmdPeriod;
+    $rows = $db->query($cmd);
+    if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
+    $res["values"] = array();
+    while ($row = $rows->fetchArray(SQLITE3_NUM)) {
+
+      // Add the start date of the interval and the reduced values to the
+      // result dictionary
+      $values = ["" . ($from + $row[0] * $width)];
+      for ($iCol = 1; $iCol < count($row); ++$iCol)
+        array_push($values, FormatValue($row[$iCol]));
+      if (count($labelsText) > 0)
+        $values = array_merge($values, $valuesText[$row[0]]);
       array_push($res["values"], $values);
 
     }
@@ -716,6 +1848,8 @@ function FlushProject(
   $db,
   $project) {
 
+  global $prefixMat;
+
   // Init the result dictionary
   $res = array();
 
@@ -749,6 +1883,11 @@ function FlushProject(
     $success = $db->exec($cmd);
     if ($success === false) throw new Exception("exec() failed for " . $cmd);
 
+    // Delete the eventual materialized table
+    $cmd = 'DROP TABLE IF EXISTS "' . $prefixMat . $project . '"';
+    $success = $db->exec($cmd);
+    if ($success === false) throw new Exception("exec() failed for " . $cmd);
+
     // Delete the project
     $cmd = 'DELETE FROM _Project WHERE Ref = ' . $refProject;
     $success = $db->exec($cmd);
@@ -769,6 +1908,332 @@ function FlushProject(
 
 }
 
+// Enable or disable the materialized table of a project. When enabled,
+// the measures of the project are also stored in a table with one row per
+// measure and one column per metric, kept up to date when measures and
+// metrics are added or deleted, and read by the view of the project.
+// Input:
+//        db: the database connection
+//   project: the project's name
+//    enable: "1" to enable, "0" to disable
+// Output:
+//   If successful returns a dictionary {"ret":"0"}
+//   Else, returns the dictionary {"ret":"1", "errMsg":"..."}.
+function Materialize(
+  $db,
+  $project,
+  $enable) {
+
+  global $prefixMat;
+  global $metricTypesSql;
+
+  // Init the result dictionary
+  $res = array();
+
+  try {
+
+    // Get the project reference
+    $refProject =
+      GetRefProject(
+        $db,
+        $project);
+
+    // If the project is not already in the requested state
+    $enable = ($enable == "1");
+    if (IsMaterialized($db, $refProject) != $enable) {
+
+      // Create the commands to create and populate the table, or to
+      // delete it
+      $table = '"' . $prefixMat . $project . '"';
+      if ($enable) {
+
+        $metrics =
+          GetMetricsOfProject(
+            $db,
+            $refProject);
+        $cmd = 'CREATE TABLE ' . $table . ' (Ref INTEGER PRIMARY KEY,' .
+               'DateMeasure INTEGER NOT NULL';
+        foreach($metrics["labels"] as $iMetric => $label)
+          $cmd .= ',"' . $label . '" ' .
+                  $metricTypesSql[$metrics["types"][$iMetric]] .
+                  ' NOT NULL DEFAULT \'' .
+                  SQLite3::escapeString($metrics["defs"][$iMetric]) . '\'';
+        $cmd .= ')';
+        $cmds = [
+          $cmd,
+          'CREATE INDEX "' . $prefixMat . $project . '_ByDate" ON ' .
+          $table . ' (DateMeasure)',
+          'INSERT INTO ' . $table .
+          ' SELECT _Measure.Ref, _Measure.DateMeasure' .
+          GetColumnsMeasureCmd($metrics) .
+          ' FROM _Measure WHERE _Measure.RefProject = ' . $refProject];
+
+      } else {
+
+        $cmds = ['DROP TABLE ' . $table];
+
+      }
+      $cmds[] = 'UPDATE _Project SET Materialized = ' . ($enable ? 1 : 0) .
+                ' WHERE Ref = ' . $refProject;
+
+      // Apply the commands and update the view in one single transaction
+      $db->exec("BEGIN IMMEDIATE");
+      try {
+
+        foreach ($cmds as $cmd) {
+
+          $success = $db->exec($cmd);
+          if ($success === false)
+            throw new Exception("exec() failed for " . $cmd);
+
+        }
+        UpdateViewProject($db, $project);
+
+      } catch (Exception $e) {
+
+        $db->exec("ROLLBACK");
+        throw($e);
+
+      }
+      $db->exec("COMMIT");
+
+    }
+
+    // Set the success code in the result dictionary
+    $res["ret"] = "0";
+
+  } catch (Exception $e) {
+
+    $res["ret"] = "1";
+    $res["errMsg"] = "line " . $e->getLine() . ": " . $e->getMessage();
+
+  }
+
+  // Return the dictionary
+  return $res;
+
+}
+
+// Release the free pages of the database. Deletions don't shrink the
+// database file, the freed pages are kept for reuse. They are released in
+// bounded steps to keep the database available to writers.
+// Input:
+//       db: the database connection
+//   budget: the maximum number of pages to release, if <= 0 all the free
+//           pages are released
+// Output:
+//   If successful returns a dictionary {"ret":"0", "nbFreePage":"..."}
+//   with the number of free pages remaining
+//   Else, returns the dictionary {"ret":"1", "errMsg":"..."}.
+function Compact(
+  $db,
+  $budget) {
+
+  // Init the result dictionary
+  $res = array();
+
+  try {
+
+    // Release the pages
+    $budget = intval($budget);
+    if ($budget <= 0) $budget = -1;
+    $cmd = 'PRAGMA incremental_vacuum(' . $budget . ')';
+    $success = $db->exec($cmd);
+    if ($success === false) throw new Exception("exec() failed for " . $cmd);
+
+    // Get the number of remaining free pages
+    $cmd = 'PRAGMA freelist_count';
+    $rows = $db->query($cmd);
+    if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
+    $res["nbFreePage"] = "" . ($rows->fetchArray())[0];
+
+    // Set the success code in the result dictionary
+    $res["ret"] = "0";
+
+  } catch (Exception $e) {
+
+    $res["ret"] = "1";
+    $res["errMsg"] = "line " . $e->getLine() . ": " . $e->getMessage();
+
+  }
+
+  // Return the dictionary
+  return $res;
+
+}
+
+// Set the retention policy of a project. The measures older than the
+// maximum age, and the oldest measures beyond the maximum number of
+// measures, are deleted by the action apply_retention.
+// Input:
+//             db: the database connection
+//        project: the project's name
+//         maxAge: the maximum age of the measures in seconds, 0 for no
+//                 limit
+//   maxNbMeasure: the maximum number of measures, 0 for no limit
+// Output:
+//   If successful returns a dictionary {"ret":"0"}
+//   Else, returns the dictionary {"ret":"1", "errMsg":"..."}.
+function SetRetention(
+  $db,
+  $project,
+  $maxAge,
+  $maxNbMeasure) {
+
+  // Init the result dictionary
+  $res = array();
+
+  try {
+
+    // Get the project reference
+    $refProject =
+      GetRefProject(
+        $db,
+        $project);
+
+    // Update the retention policy
+    $cmd = 'UPDATE _Project SET RetentionAge = ' . max(0, intval($maxAge)) .
+           ', RetentionCount = ' . max(0, intval($maxNbMeasure)) .
+           ' WHERE Ref = ' . $refProject;
+    $success = $db->exec($cmd);
+    if ($success === false) throw new Exception("exec() failed for " . $cmd);
+
+    // Set the success code in the result dictionary
+    $res["ret"] = "0";
+
+  } catch (Exception $e) {
+
+    $res["ret"] = "1";
+    $res["errMsg"] = "line " . $e->getLine() . ": " . $e->getMessage();
+
+  }
+
+  // Return the dictionary
+  return $res;
+
+}
+
+// Apply the retention policy of all the projects. The expired measures are
+// deleted by batches, each in its own transaction, to keep the database
+// available to writers.
+// Input:
+//   db: the database connection
+// Output:
+//   If successful returns a dictionary {"ret":"0", "nbDeleted":"..."}
+//   with the number of deleted measures
+//   Else, returns the dictionary {"ret":"1", "errMsg":"..."}.
+function ApplyRetention(
+  $db) {
+
+  global $sizeBatchRetention;
+  global $usecPerSec;
+
+  // Init the result dictionary
+  $res = array();
+
+  try {
+
+    // Get the projects having a retention policy
+    $cmd = 'SELECT Ref, RetentionAge, RetentionCount FROM _Project ' .
+           'WHERE RetentionAge > 0 OR RetentionCount > 0';
+    $rows = $db->query($cmd);
+    if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
+    $projects = array();
+    while ($row = $rows->fetchArray()) array_push($projects, $row);
+
+    // Loop on the projects
+    $nbDeleted = 0;
+    foreach ($projects as $project) {
+
+      // The expired measures are the ones before the cutoff (date, ref) in
+      // the order of the measures, (DateMeasure, Ref). Start with a date
+      // before any date.
+      $cutoffDate = -1;
+      $cutoffRef = 0;
+
+      // If there is a maximum age, the measures before its date are
+      // expired
+      if ($project["RetentionAge"] > 0)
+        $cutoffDate =
+          GetDateMeasureNow() - $project["RetentionAge"] * $usecPerSec;
+
+      // If there is a maximum number of measures, get the most recent
+      // measure beyond that number, it and the measures before it are
+      // expired
+      if ($project["RetentionCount"] > 0) {
+
+        $cmd = 'SELECT DateMeasure, Ref FROM _Measure WHERE RefProject = ' .
+               $project["Ref"] . ' ORDER BY DateMeasure DESC, Ref DESC ' .
+               'LIMIT 1 OFFSET ' . $project["RetentionCount"];
+        $rows = $db->query($cmd);
+        if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
+        $row = $rows->fetchArray();
+
+        // If there is such a measure and it's after the cutoff of the
+        // maximum age, it becomes the cutoff
+        if ($row !== false and
+            ($row["DateMeasure"] > $cutoffDate or
+             ($row["DateMeasure"] == $cutoffDate and
+              $row["Ref"] > $cutoffRef))) {
+
+          $cutoffDate = $row["DateMeasure"];
+          $cutoffRef = $row["Ref"];
+
+        }
+
+      }
+
+      // Loop on the batches of expired measures
+      do {
+
+        // Get the next batch of expired measures
+        $cmd = 'SELECT Ref FROM _Measure WHERE RefProject = ' .
+               $project["Ref"] . ' AND (DateMeasure < ' . $cutoffDate .
+               ' OR (DateMeasure = ' . $cutoffDate . ' AND Ref <= ' .
+               $cutoffRef . ')) LIMIT ' . $sizeBatchRetention;
+        $rows = $db->query($cmd);
+        if ($rows === false) throw new Exception("query(" . $cmd . ") failed");
+        $refs = array();
+        while ($row = $rows->fetchArray()) array_push($refs, $row["Ref"]);
+
+        // Delete the batch in one single transaction
+        if (count($refs) > 0) {
+
+          $ret =
+            DeleteMeasures(
+              $db,
+              implode(",", $refs),
+              null,
+              null,
+              null,
+              null,
+              null);
+          if ($ret["ret"] != "0") throw new Exception($ret["errMsg"]);
+          $nbDeleted += count($refs);
+
+        }
+
+      } while (count($refs) == $sizeBatchRetention);
+
+    }
+
+    // Set the success code and the number of deleted measures in the
+    // result dictionary
+    $res["nbDeleted"] = "" . $nbDeleted;
+    $res["ret"] = "0";
+
+  } catch (Exception $e) {
+
+    $res["ret"] = "1";
+    $res["errMsg"] = "line " . $e->getLine() . ": " . $e->getMessage();
+
+  }
+
+  // Return the dictionary
+  return $res;
+
+}
+
 // -------------------------------- Main block --------------------------
 
 try {
@@ -792,6 +2257,9 @@ try {
 
   }
 
+  // Set the options of the database connection
+  SetDatabaseOptions($db);
+
   // Automatically upgrade the database if necessary
   UpgradeDB(
     $db,
@@ -832,7 +2300,8 @@ try {
           $db,
           $_POST["project"],
           $_POST["label"],
-          $_POST["default"]);
+          $_POST["default"],
+          $_POST["type"] ?? 0);
       echo json_encode($res);
 
     // If the user requested the list of metrics
@@ -856,6 +2325,18 @@ try {
           $_POST);
       echo json_encode($res);
 
+    // If the user requested to add several measures
+    } else if ($_POST["action"] == "add_measures" and
+               isset($_POST["project"]) and
+               isset($_POST["measures"])) {
+
+      $res =
+        AddMeasures(
+          $db,
+          $_POST["project"],
+          $_POST["measures"]);
+      echo json_encode($res);
+
     // If the user requested to delete a measure
     } else if ($_POST["action"] == "delete_measure" and 
                isset($_POST["measure"])) {
@@ -866,6 +2347,20 @@ try {
         $_POST["measure"]);
       echo json_encode($res);
 
+    // If the user requested to delete several measures
+    } else if ($_POST["action"] == "delete_measures") {
+
+      $res =
+        DeleteMeasures(
+          $db,
+          $_POST["measures"] ?? null,
+          $_POST["from_ref"] ?? null,
+          $_POST["to_ref"] ?? null,
+          $_POST["project"] ?? null,
+          $_POST["from_date"] ?? null,
+          $_POST["to_date"] ?? null);
+      echo json_encode($res);
+
     // If the user requested the data in JSON format
     } else if ($_POST["action"] == "measures" and 
                isset($_POST["project"])) {
@@ -877,7 +2372,11 @@ try {
         GetMeasures(
           $db,
           $_POST["project"],
-          $_POST["last"]);
+          $_POST["last"],
+          $_POST["from"] ?? null,
+          $_POST["to"] ?? null,
+          $_POST["limit"] ?? 0,
+          $_POST["since"] ?? null);
       echo json_encode($res);
 
     // If the user requested the data in csv format
@@ -893,9 +2392,43 @@ try {
         GetMeasuresAsCSV($db,
         $_POST["project"],
         $_POST["sep"],
-        $_POST["last"]);
+        $_POST["last"],
+        $_POST["from"] ?? null,
+        $_POST["to"] ?? null,
+        $_POST["limit"] ?? 0,
+        $_POST["since"] ?? null);
       echo $res;
 
+    // If the user requested to aggregate the values of a metric
+    } else if ($_POST["action"] == "aggregate" and
+               isset($_POST["project"]) and
+               isset($_POST["metric"]) and
+               isset($_POST["fn"])) {
+
+      $res =
+        Aggregate(
+          $db,
+          $_POST["project"],
+          $_POST["metric"],
+          $_POST["fn"],
+          $_POST["from"] ?? null,
+          $_POST["to"] ?? null,
+          $_POST["interval"] ?? null);
+      echo json_encode($res);
+
+    // If the user requested the downsampled measures of a project
+    } else if ($_POST["action"] == "downsample" and
+               isset($_POST["project"])) {
+
+      $res =
+        Downsample(
+          $db,
+          $_POST["project"],
+          $_POST["nb"] ?? $nbPointDownsample,
+          $_POST["from"] ?? null,
+          $_POST["to"] ?? null);
+      echo json_encode($res);
+
     // If the user requested to delete a project
     } else if ($_POST["action"] == "flush" and 
                isset($_POST["project"])) {
@@ -906,19 +2439,81 @@ try {
           $_POST["project"]);
       echo json_encode($res);
 
+    // If the user requested to enable or disable the materialized table
+    // of a project
+    } else if ($_POST["action"] == "materialize" and
+               isset($_POST["project"]) and
+               isset($_POST["enable"])) {
+
+      $res =
+        Materialize(
+          $db,
+          $_POST["project"],
+          $_POST["enable"]);
+      echo json_encode($res);
+
+    // If the user requested to release the free pages of the database
+    } else if ($_POST["action"] == "compact") {
+
+      // If the user hasn't specified a budget, set it by default to 0
+      if (!isset($_POST["budget"])) $_POST["budget"] = 0;
+      $res =
+        Compact(
+          $db,
+          $_POST["budget"]);
+      echo json_encode($res);
+
+    // If the user requested to set the retention policy of a project
+    } else if ($_POST["action"] == "set_retention" and
+               isset($_POST["project"])) {
+
+      // If the user hasn't specified a limit, set it by default to 0
+      if (!isset($_POST["max_age"])) $_POST["max_age"] = 0;
+      if (!isset($_POST["max_nb_measure"])) $_POST["max_nb_measure"] = 0;
+      $res =
+        SetRetention(
+          $db,
+          $_POST["project"],
+          $_POST["max_age"],
+          $_POST["max_nb_measure"]);
+      echo json_encode($res);
+
+    // If the user requested to apply the retention policies
+    } else if ($_POST["action"] == "apply_retention") {
+
+      $res = ApplyRetention($db);
+      echo json_encode($res);
+
     // If the user requested the help
     } else if ($_POST["action"] == "help") {
 
       echo '{"ret":"0","actions":"version, ' . 
         'add_project&label=..., ' .
         'projects, ' .
-        'add_metric&project=...&label=...&default=..., ' .
+        'add_metric&project=...&label=...&default=...' .
+        '[&type=...(0: text, 1: integer, 2: double, default: 0)], ' .
         'metrics&project=..., ' .
         'add_measure&project=...&...=...&..., ' .
+        'add_measures&project=...&measures=...(JSON array of ' .
+        'dictionaries metric:value, with an optional _date in ' .
+        'microseconds), ' .
         'delete_measure&measure=..., ' .
-        'measures&project=...[&last=...(default: 0)], ' .
-        'csv&project=...[&sep=...(default: &)&last=...(default: 0)], ' .
-        'flush&project=..."}';
+        'delete_measures&(measures=...,...,...|from_ref=...&to_ref=...|' .
+        'project=...&from_date=...&to_date=...), ' .
+        'measures&project=...[&last=...(default: 0)][&from=...][&to=...]' .
+        '[&limit=...(default: 0)][&since=...], ' .
+        'csv&project=...[&sep=...(default: &)&last=...(default: 0)]' .
+        '[&from=...][&to=...][&limit=...(default: 0)][&since=...], ' .
+        'aggregate&project=...&metric=...&fn=...(min, max, mean, sum ' .
+        'or count)[&from=...][&to=...][&interval=...], ' .
+        'downsample&project=...[&nb=...(default: 100)][&from=...]' .
+        '[&to=...], ' .
+        'flush&project=..., ' .
+        'materialize&project=...&enable=...(0 or 1), ' .
+        'compact[&budget=...(default: 0)], ' .
+        'set_retention&project=...[&max_age=...(default: 0)]' .
+        '[&max_nb_measure=...(default: 0)], ' .
+        'apply_retention"}';
 
     // If the user requested an unknown or invalid action
     } else {